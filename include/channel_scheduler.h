@@ -0,0 +1,130 @@
+#ifndef CHANNEL_SCHEDULER_H
+#define CHANNEL_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Escalonador de canais para o modo promíscuo.
+//
+// Os canais são visitados sempre na mesma ordem (nenhum canal é pulado), mas
+// no modo adaptativo o tempo de permanência (dwell) de cada visita é
+// proporcional à taxa de probes observada no canal (média móvel exponencial).
+// Uma fração do ciclo (orçamento de exploração) é dividida igualmente entre
+// todos os canais e nenhum dwell fica abaixo do mínimo, então canais pouco
+// movimentados continuam sendo amostrados e a estimativa se adapta a mudanças.
+//
+// Cada dwell recebe um identificador sequencial (dwell_id). Os frames são
+// marcados com o dwell em que chegaram, então o host pode atribuir cada captura
+// à janela de permanência correspondente.
+
+#define CHANNEL_SCHED_ROUND_ROBIN 0  // todos os canais, dwell fixo (comportamento original)
+#define CHANNEL_SCHED_ADAPTIVE 1     // todos os canais, dwell ponderado pelo tráfego
+#define CHANNEL_SCHED_FIXED_LIST 2   // apenas CHANNEL_SCHED_LIST, dwell fixo
+
+#ifndef CHANNEL_SCHED_MODE
+#define CHANNEL_SCHED_MODE CHANNEL_SCHED_ADAPTIVE
+#endif
+
+// Duração de um ciclo completo no modo adaptativo (padrão: o mesmo de um ciclo round-robin)
+#ifndef CHANNEL_SCHED_CYCLE_MS
+#define CHANNEL_SCHED_CYCLE_MS 6500
+#endif
+
+// Dwell mínimo por visita no modo adaptativo
+#ifndef CHANNEL_SCHED_MIN_DWELL_MS
+#define CHANNEL_SCHED_MIN_DWELL_MS 100
+#endif
+
+// Percentual do ciclo dividido igualmente entre os canais (exploração)
+#ifndef CHANNEL_SCHED_EXPLORE_PCT
+#define CHANNEL_SCHED_EXPLORE_PCT 20
+#endif
+
+// Peso da nova amostra na média móvel: alpha = 1 / 2^SHIFT
+#ifndef CHANNEL_SCHED_EWMA_SHIFT
+#define CHANNEL_SCHED_EWMA_SHIFT 2
+#endif
+
+// Canais do modo CHANNEL_SCHED_FIXED_LIST (inicializador de array)
+#ifndef CHANNEL_SCHED_LIST
+#define CHANNEL_SCHED_LIST {1, 6, 11}
+#endif
+
+#define CHANNEL_SCHED_MAX_CHANNELS 14
+
+// Ordem de prioridade usada para dividir os canais entre nós de um cluster:
+// canais primários primeiro, para que cada nó (até 3) fique com um deles
+#ifndef CHANNEL_PRIORITY_ORDER
+#define CHANNEL_PRIORITY_ORDER {1, 6, 11, 3, 8, 2, 4, 5, 7, 9, 10, 12, 13}
+#endif
+
+typedef struct {
+  uint8_t channel;
+  uint32_t rate_ewma;   // probes/s em ponto fixo 24.8
+  uint32_t probes;      // total de probes recebidos no canal
+  uint32_t dwell_ms;    // tempo total passado no canal
+  uint32_t visits;
+  uint32_t last_dwell_id;  // dwell_id da visita mais recente
+} channel_stats_t;
+
+typedef struct {
+  uint8_t mode;
+  uint8_t count;                  // canais no ciclo
+  uint8_t index;                  // posição atual em stats[]
+  uint32_t fixed_dwell_ms;        // dwell dos modos round-robin e lista fixa
+  uint32_t dwell_start_ms;
+  uint32_t dwell_target_ms;
+  std::atomic<uint32_t> dwell_probes;  // incrementado no callback do driver
+  // dwell_id (24 bits, incrementado a cada troca) << 8 | canal do dwell.
+  // Publicados juntos para o callback nunca ver um sem o outro.
+  std::atomic<uint32_t> dwell_state;
+  uint32_t late_frames;                // frames do canal anterior entregues após a troca
+  channel_stats_t stats[CHANNEL_SCHED_MAX_CHANNELS];
+} channel_scheduler_t;
+
+void channel_scheduler_init(channel_scheduler_t* sched, uint8_t mode, const uint8_t* channels,
+                            uint8_t count, uint32_t fixed_dwell_ms, uint32_t now_ms);
+
+inline uint8_t channel_scheduler_current(const channel_scheduler_t* sched) {
+  return sched->stats[sched->index].channel;
+}
+
+inline uint32_t channel_scheduler_dwell_id(const channel_scheduler_t* sched) {
+  return sched->dwell_state.load(std::memory_order_acquire) >> 8;
+}
+
+// Produtor (callback do driver): conta um probe recebido no canal rx_channel e
+// retorna o dwell_id ao qual ele pertence. Frames ainda do canal anterior
+// (enfileirados pelo driver antes da troca) são atribuídos ao dwell anterior e
+// não entram na taxa do canal atual.
+inline uint32_t channel_scheduler_count(channel_scheduler_t* sched, uint8_t rx_channel) {
+  uint32_t state = sched->dwell_state.load(std::memory_order_acquire);
+  uint32_t id = state >> 8;
+  if (rx_channel != (state & 0xFF)) {
+    sched->late_frames++;
+    return (id - 1) & 0xFFFFFF;
+  }
+  sched->dwell_probes.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+// Fecha o dwell atual e avança para o próximo canal (sem checar o tempo).
+// Retorna o dwell alvo do novo canal em ms.
+uint32_t channel_scheduler_advance(channel_scheduler_t* sched, uint32_t now_ms);
+
+// Troca a lista de canais em execução (ex: nova divisão do cluster). As
+// estatísticas por canal recomeçam e o dwell_id continua a sequência.
+void channel_scheduler_reconfigure(channel_scheduler_t* sched, const uint8_t* channels,
+                                   uint8_t count, uint32_t now_ms);
+
+// Divide source[0..source_count) entre cluster_size nós: o nó cluster_index
+// fica com as posições p em que p % cluster_size == cluster_index. Os conjuntos
+// são disjuntos e juntos cobrem toda a lista. Retorna o número de canais em out.
+uint8_t channel_plan_partition(const uint8_t* source, uint8_t source_count,
+                               uint8_t cluster_index, uint8_t cluster_size, uint8_t* out);
+
+// Dwell que o canal na posição index receberia na próxima visita
+uint32_t channel_scheduler_dwell_for(const channel_scheduler_t* sched, uint8_t index);
+
+#endif // CHANNEL_SCHEDULER_H
@@ -0,0 +1,94 @@
+#ifndef DEVICE_CACHE_H
+#define DEVICE_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Cache de deduplicação de dispositivos com capacidade fixa.
+//
+// As entradas ficam em um pool fixo e são localizadas por uma tabela de
+// índices com endereçamento aberto (sondagem linear) chaveada no track_id
+// (track_correlator.h) quando o probe tem trilha, senão em SA (6 bytes) + hash
+// do fingerprint de IEs. Com trilha, os MACs rotacionados de um aparelho somam
+// na mesma entrada, que guarda o SA e o fingerprint mais recentes. Uma lista duplamente encadeada
+// (índices no próprio pool) mantém a ordem LRU; quando o pool enche, a entrada
+// menos recentemente vista é despejada. A remoção na tabela usa backward-shift,
+// então não há tombstones e as entradas do pool nunca mudam de posição.
+
+// Capacidade padrão (ajustada por placa no platformio.ini)
+#ifndef DEVICE_CACHE_CAPACITY
+#define DEVICE_CACHE_CAPACITY 256
+#endif
+
+// Tabela de índices com 2x a capacidade mantém a ocupação em no máximo 50%
+#define DEVICE_CACHE_INDEX_SIZE (DEVICE_CACHE_CAPACITY * 2)
+#define DEVICE_CACHE_NONE 0xFFFF
+
+// Capacidade com o pool de entradas na PSRAM (mem_placement.h); o índice
+// (2 bytes por posição) fica na SRAM interna. Limite de 16384: índices u16.
+#ifndef DEVICE_CACHE_CAPACITY_PSRAM
+#define DEVICE_CACHE_CAPACITY_PSRAM 16384
+#endif
+
+#if (DEVICE_CACHE_INDEX_SIZE & (DEVICE_CACHE_INDEX_SIZE - 1)) != 0
+#error "DEVICE_CACHE_CAPACITY deve ser potência de 2"
+#endif
+
+#if (DEVICE_CACHE_CAPACITY_PSRAM & (DEVICE_CACHE_CAPACITY_PSRAM - 1)) != 0 || DEVICE_CACHE_CAPACITY_PSRAM > 16384
+#error "DEVICE_CACHE_CAPACITY_PSRAM deve ser potência de 2 e no máximo 16384"
+#endif
+
+typedef struct {
+  uint8_t sa[6];            // com trilha: SA do probe mais recente
+  bool mac_randomized;
+  bool in_use;
+  uint32_t fp_hash;
+  uint32_t track_id;        // chave da entrada quando != TRACK_ID_NONE (track_correlator.h)
+  uint32_t first_seen_ms;   // millis() da primeira observação
+  uint32_t last_seen_ms;    // millis() da última observação
+  uint32_t total_count;     // probes desde a criação da entrada
+  // Agregados da janela atual (zerados a cada flush)
+  uint32_t window_count;
+  uint32_t window_first_ms;
+  int32_t rssi_sum;
+  int8_t rssi_min;
+  int8_t rssi_max;
+  uint16_t channels_mask;   // bit n = canal n
+  // Encadeamento LRU (índices no pool)
+  uint16_t lru_prev;
+  uint16_t lru_next;
+} device_entry_t;
+
+// Chamado para cada entrada com probes pendentes na janela (flush ou despejo);
+// ctx é o emit_ctx de device_cache_init()
+typedef void (*device_emit_cb_t)(void* ctx, const device_entry_t* entry, uint32_t window_start_ms);
+
+typedef struct {
+  device_entry_t* entries;
+  uint16_t* index;
+  uint16_t capacity;
+  uint16_t index_mask;
+  uint16_t used;
+  uint16_t lru_head;        // mais recente
+  uint16_t lru_tail;        // menos recente (próximo a ser despejado)
+  uint32_t window_start_ms;
+  device_emit_cb_t emit;
+  void* emit_ctx;
+  // Contadores
+  uint32_t inserts;         // entradas criadas (inclui reinserções após despejo)
+  uint32_t evictions;
+  uint32_t hits;
+} device_cache_t;
+
+void device_cache_init(device_cache_t* cache, device_entry_t* entries, uint16_t capacity,
+                       uint16_t* index, uint16_t index_size, device_emit_cb_t emit, void* emit_ctx);
+
+// Registra uma observação; retorna a entrada atualizada (nunca NULL)
+device_entry_t* device_cache_observe(device_cache_t* cache, const uint8_t* sa, uint32_t fp_hash,
+                                     bool mac_randomized, uint32_t track_id, int8_t rssi,
+                                     uint8_t channel, uint32_t now_ms);
+
+// Emite todas as entradas com probes na janela e inicia uma nova janela
+void device_cache_flush(device_cache_t* cache, uint32_t now_ms);
+
+#endif // DEVICE_CACHE_H
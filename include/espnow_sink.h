@@ -0,0 +1,112 @@
+#ifndef ESPNOW_SINK_H
+#define ESPNOW_SINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "output_transport.h"
+
+// Sink de saída por ESP-NOW para um nó gateway (env esp32-gateway), que
+// repassa os registros ao host pela serial. O nó continua em modo promíscuo:
+// os datagramas acumulados só são enviados enquanto o escalonador está em
+// ESPNOW_SINK_CHANNEL (incluído automaticamente no plano de canais). A troca
+// de canal espera a fila esvaziar (até ESPNOW_SINK_HOLD_MAX_MS), para que os
+// datagramas já entregues ao driver não saiam em outro canal.
+//
+// Datagrama (little-endian):
+//   u8  magic            ESPNOW_SINK_MAGIC
+//   u8  version
+//   u8  flags            ESPNOW_FLAG_FRAGMENT / _FIRST / _LAST
+//   u8  records          registros completos no datagrama
+//   u32 seq              contador de datagramas do nó (lacunas = perda)
+//   u32 session          FNV-1a do capture_id (muda a cada boot)
+//   u8  payload[]        registros inteiros (linhas JSON ou quadros COBS)
+//
+// Registros maiores que ESPNOW_SINK_PAYLOAD_MAX vão sozinhos em fragmentos
+// consecutivos (ESPNOW_FLAG_FRAGMENT, marcados com _FIRST e _LAST nas pontas);
+// o gateway descarta o registro inteiro se algum fragmento se perder.
+//
+// Toda a saída de um ciclo de canais precisa caber na fila até a próxima
+// visita ao canal do gateway: ESPNOW_SINK_QUEUE_LEN x ESPNOW_SINK_PAYLOAD_MAX
+// (~7,6 KB na SRAM interna, ~122 KB com PSRAM). Por isso o sink exige
+// OUTPUT_FORMAT_BINARY ou OUTPUT_MODE_AGGREGATE; JSON por pacote não cabe.
+
+#define ESPNOW_SINK_MAGIC 0xE5
+#define ESPNOW_SINK_VERSION 1
+#define ESPNOW_SINK_HEADER_SIZE 12
+#define ESPNOW_SINK_DATAGRAM_MAX 250  // ESP_NOW_MAX_DATA_LEN
+#define ESPNOW_SINK_PAYLOAD_MAX (ESPNOW_SINK_DATAGRAM_MAX - ESPNOW_SINK_HEADER_SIZE)
+
+#define ESPNOW_FLAG_FRAGMENT 0x01
+#define ESPNOW_FLAG_LAST 0x02
+#define ESPNOW_FLAG_FIRST 0x04
+
+// Canal em que nó e gateway se encontram
+#ifndef ESPNOW_SINK_CHANNEL
+#define ESPNOW_SINK_CHANNEL 1
+#endif
+
+// MAC do gateway (inicializador de array); broadcast dispensa parear
+#ifndef ESPNOW_SINK_PEER
+#define ESPNOW_SINK_PEER {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF}
+#endif
+
+// Datagramas aguardando o canal do gateway (~250 bytes cada, potências de 2).
+// Com PSRAM a fila usa ESPNOW_SINK_QUEUE_LEN_PSRAM (mem_placement.h).
+#ifndef ESPNOW_SINK_QUEUE_LEN
+#define ESPNOW_SINK_QUEUE_LEN 32
+#endif
+
+#ifndef ESPNOW_SINK_QUEUE_LEN_PSRAM
+#define ESPNOW_SINK_QUEUE_LEN_PSRAM 512
+#endif
+
+#if (ESPNOW_SINK_QUEUE_LEN & (ESPNOW_SINK_QUEUE_LEN - 1)) != 0 || \
+    (ESPNOW_SINK_QUEUE_LEN_PSRAM & (ESPNOW_SINK_QUEUE_LEN_PSRAM - 1)) != 0
+#error "ESPNOW_SINK_QUEUE_LEN e ESPNOW_SINK_QUEUE_LEN_PSRAM devem ser potências de 2"
+#endif
+
+// No canal do gateway a troca é adiada em passos de ESPNOW_SINK_HOLD_STEP_MS
+// enquanto houver datagramas pendentes, até ESPNOW_SINK_HOLD_MAX_MS por visita
+#ifndef ESPNOW_SINK_HOLD_STEP_MS
+#define ESPNOW_SINK_HOLD_STEP_MS 5
+#endif
+
+#ifndef ESPNOW_SINK_HOLD_MAX_MS
+#define ESPNOW_SINK_HOLD_MAX_MS 200
+#endif
+
+// Idade máxima de um datagrama parcialmente preenchido antes de ser fechado
+#ifndef ESPNOW_SINK_FLUSH_MS
+#define ESPNOW_SINK_FLUSH_MS 200
+#endif
+
+typedef struct {
+  uint32_t seq;               // próximo número de sequência
+  uint32_t records;           // registros aceitos pelo sink
+  uint32_t datagrams;         // datagramas fechados
+  uint32_t sent;              // aceitos por esp_now_send()
+  uint32_t send_ok;           // confirmados no callback de envio
+  uint32_t send_failed;       // sem ACK do gateway (apenas peer unicast)
+  uint32_t send_busy;         // esp_now_send() recusou (fila do driver cheia)
+  uint32_t dropped;           // datagramas descartados com a fila cheia
+  uint32_t queue_high_water;
+  uint32_t queue_capacity;    // datagramas (ESPNOW_SINK_QUEUE_LEN ou _PSRAM)
+  uint32_t off_channel;       // envios adiados por o canal ter mudado no meio da fila
+  uint32_t hop_holds;         // trocas de canal adiadas com datagramas pendentes
+} espnow_sink_stats_t;
+
+// Requer WiFi já iniciado (modo STA); session identifica o boot no gateway
+bool espnow_sink_begin(uint32_t session);
+
+extern const output_sink_t espnow_sink;
+
+const espnow_sink_stats_t* espnow_sink_get_stats();
+uint32_t espnow_sink_queued();
+
+// Datagramas na fila ou entregues ao driver sem o callback de envio (ainda no ar)
+uint32_t espnow_sink_pending();
+
+// Chamado pelo timer de troca de canal: true se a troca deve esperar ESPNOW_SINK_HOLD_STEP_MS
+bool espnow_sink_hold_hop(uint8_t current_channel);
+
+#endif // ESPNOW_SINK_H
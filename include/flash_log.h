@@ -0,0 +1,80 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Log circular append-only sobre uma região de flash NOR (partição "probelog").
+//
+// A região é dividida em setores de FLASH_LOG_SECTOR_SIZE (unidade de erase) e
+// páginas de FLASH_LOG_PAGE_SIZE (unidade de gravação). Cada página é gravada
+// uma única vez, inteira:
+//   u16 crc      CRC-16/CCITT-FALSE de len, seq e payload (ver wire_crc16)
+//   u16 len      bytes válidos do payload (0xFFFF = página apagada)
+//   u32 seq      número de sequência global da página
+//   u8  payload[FLASH_LOG_PAGE_PAYLOAD]
+//
+// O payload é o fluxo de saída do firmware (quadros COBS do formato binário ou
+// linhas JSON), então o despejo das páginas em ordem reproduz o stream serial.
+// A cabeça avança sequencialmente e cada setor é apagado ao ser alcançado de
+// novo: o desgaste fica distribuído por igual entre todos os setores.
+// Na inicialização a cabeça é recuperada pelo maior seq válido.
+//
+// Independente do hardware: o acesso à flash é feito por flash_log_io_t
+// (esp_partition no firmware, RAM nos testes do host).
+
+#define FLASH_LOG_SECTOR_SIZE 4096
+#define FLASH_LOG_PAGE_SIZE 256
+#define FLASH_LOG_PAGE_HEADER 8
+#define FLASH_LOG_PAGE_PAYLOAD (FLASH_LOG_PAGE_SIZE - FLASH_LOG_PAGE_HEADER)
+#define FLASH_LOG_PAGES_PER_SECTOR (FLASH_LOG_SECTOR_SIZE / FLASH_LOG_PAGE_SIZE)
+
+#define FLASH_LOG_PAGE_VALID 0
+#define FLASH_LOG_PAGE_ERASED 1
+#define FLASH_LOG_PAGE_CORRUPT 2   // CRC inválido (gravação interrompida ou dado alheio)
+
+typedef struct {
+  void* ctx;
+  bool (*read)(void* ctx, uint32_t offset, void* out, size_t len);
+  bool (*write)(void* ctx, uint32_t offset, const void* data, size_t len);
+  bool (*erase_sector)(void* ctx, uint32_t offset);
+  uint32_t size;                   // bytes, múltiplo de FLASH_LOG_SECTOR_SIZE
+} flash_log_io_t;
+
+typedef struct {
+  flash_log_io_t io;
+  uint32_t page_count;
+  uint32_t head;                   // próxima página a gravar
+  uint32_t next_seq;
+  uint32_t oldest_seq;             // páginas com seq menor já foram sobrescritas
+  uint32_t base_seq;               // apagamento lógico: páginas anteriores são ignoradas
+  bool head_erased;                // setor da cabeça já apagado para novas gravações
+  uint32_t pages_written;
+  uint32_t sector_erases;
+  uint32_t write_errors;
+} flash_log_t;
+
+typedef struct {
+  uint32_t page;
+  uint32_t remaining;              // páginas ainda não visitadas
+} flash_log_cursor_t;
+
+// Recupera cabeça e sequência a partir do conteúdo da flash
+bool flash_log_init(flash_log_t* log, const flash_log_io_t* io, uint32_t base_seq);
+
+// Grava uma página (len <= FLASH_LOG_PAGE_PAYLOAD); apaga o próximo setor quando necessário
+bool flash_log_append(flash_log_t* log, const uint8_t* payload, uint16_t len);
+
+// Páginas válidas retidas (entre max(oldest_seq, base_seq) e next_seq)
+uint32_t flash_log_used_pages(const flash_log_t* log);
+
+// Apagamento lógico instantâneo: o chamador persiste o novo base_seq
+uint32_t flash_log_clear(flash_log_t* log);
+
+// Iteração da página mais antiga à mais recente
+void flash_log_cursor_begin(const flash_log_t* log, flash_log_cursor_t* cursor);
+
+// Próxima página válida: retorna len (>0) ou -1 no fim; payload com FLASH_LOG_PAGE_PAYLOAD bytes
+int flash_log_read_next(flash_log_t* log, flash_log_cursor_t* cursor, uint8_t* payload);
+
+#endif // FLASH_LOG_H
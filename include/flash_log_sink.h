@@ -0,0 +1,85 @@
+#ifndef FLASH_LOG_SINK_H
+#define FLASH_LOG_SINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "flash_log.h"
+#include "output_transport.h"
+
+// Sink de saída que grava o stream do firmware no log circular em flash
+// (partição FLASH_LOG_PARTITION), para operação sem host conectado.
+//
+// output_write() apenas copia os bytes para páginas de staging em RAM; uma
+// task de baixa prioridade grava as páginas completas na flash (erase e
+// programação bloqueiam a flash por milissegundos, longe do caminho de
+// captura). Uma página parcial é gravada após FLASH_LOG_FLUSH_MS.
+//
+// O apagamento (LOG ERASE) é lógico: o seq base fica na NVS (chave "log_base").
+//
+// Opcional (FLASH_LOG_ENABLED): o log grava continuamente, com ou sem host, e
+// cada volta da cabeça apaga todos os setores. Com JSON a ~20 KB/s uma partição
+// de 1.6 MB dá a volta a cada ~80 s (meses de vida útil da flash); usar com
+// OUTPUT_FORMAT_BINARY e, em implantações longas, OUTPUT_MODE_AGGREGATE.
+
+#ifndef FLASH_LOG_ENABLED
+#define FLASH_LOG_ENABLED 0
+#endif
+
+#define FLASH_LOG_PARTITION "probelog"
+#define FLASH_LOG_PARTITION_SUBTYPE 0x40   // subtipo de dados customizado (partitions_*.csv)
+
+// Páginas de staging entre o sink e a task de gravação (potência de 2)
+#ifndef FLASH_LOG_STAGING_PAGES
+#define FLASH_LOG_STAGING_PAGES 32
+#endif
+
+// Com PSRAM (mem_placement.h): absorve rajadas longas enquanto a flash apaga setores
+#ifndef FLASH_LOG_STAGING_PAGES_PSRAM
+#define FLASH_LOG_STAGING_PAGES_PSRAM 256
+#endif
+
+#ifndef FLASH_LOG_FLUSH_MS
+#define FLASH_LOG_FLUSH_MS 10000
+#endif
+
+#define FLASH_LOG_TASK_PRIORITY 1
+#define FLASH_LOG_TASK_STACK_SIZE 4096
+#define FLASH_LOG_TASK_CORE 0
+
+#if (FLASH_LOG_STAGING_PAGES & (FLASH_LOG_STAGING_PAGES - 1)) != 0
+#error "FLASH_LOG_STAGING_PAGES deve ser potência de 2"
+#endif
+
+#if (FLASH_LOG_STAGING_PAGES_PSRAM & (FLASH_LOG_STAGING_PAGES_PSRAM - 1)) != 0
+#error "FLASH_LOG_STAGING_PAGES_PSRAM deve ser potência de 2"
+#endif
+
+typedef struct {
+  uint32_t partition_size;
+  uint32_t used_pages;
+  uint32_t pages_written;
+  uint32_t sector_erases;
+  uint32_t write_errors;
+  uint32_t staging_pages;     // capacidade do staging (maior com PSRAM)
+  uint32_t staged_pages;      // aguardando a task de gravação
+  uint32_t dropped_bytes;     // staging cheio (flash não acompanhou)
+} flash_log_sink_stats_t;
+
+// Localiza a partição, recupera a cabeça e inicia a task de gravação
+bool flash_log_sink_begin();
+
+extern const output_sink_t flash_log_sink;
+
+// Grava a página parcial e esvazia o staging (antes de reiniciar)
+void flash_log_sink_flush();
+
+// Envia todo o log ao host, do mais antigo ao mais recente, entre linhas
+// "# LOG: {"event":"dump_begin"...}" e "dump_end". Bloqueia o transporte.
+void flash_log_sink_dump();
+
+// Apagamento lógico; retorna false se a NVS não pôde ser gravada
+bool flash_log_sink_erase();
+
+void flash_log_sink_get_stats(flash_log_sink_stats_t* out);
+
+#endif // FLASH_LOG_SINK_H
@@ -0,0 +1,28 @@
+#ifndef FNV_HASH_H
+#define FNV_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// FNV-1a 32 bits, usado para fingerprints de IEs e chaves de tabelas hash.
+// Incremental: h = fnv1a_init(); h = fnv1a_update(h, ...); ...
+
+#define FNV1A_32_OFFSET 2166136261u
+#define FNV1A_32_PRIME 16777619u
+
+inline uint32_t fnv1a_init() {
+  return FNV1A_32_OFFSET;
+}
+
+inline uint32_t fnv1a_byte(uint32_t h, uint8_t b) {
+  return (h ^ b) * FNV1A_32_PRIME;
+}
+
+inline uint32_t fnv1a_update(uint32_t h, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    h = (h ^ data[i]) * FNV1A_32_PRIME;
+  }
+  return h;
+}
+
+#endif // FNV_HASH_H
@@ -0,0 +1,70 @@
+#ifndef FRAME_REPLAY_H
+#define FRAME_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Gerador de carga do modo replay (-DREPLAY_ENABLED=1, comando REPLAY): frames
+// gravados (o corpus de test/corpus/probe_corpus.h, em flash, ou frames
+// enviados pelo host com REPLAY ADD) entram em wifi_promiscuous_rx() no lugar
+// do driver, a uma taxa fixa. Os frames chegam no canal atual do escalonador,
+// como os reais (o canal gravado não é usado).
+//
+// Cada frame gerado é a cópia de um frame do corpus com SA e seq_ctrl
+// reescritos, para simular uma população de dispositivos: o dispositivo d usa
+// sempre o frame d % count (mesmo fingerprint), mantém os 3 primeiros bytes do
+// SA (OUI ou bit de MAC randomizado) e tem os 3 últimos xor (d + 1). Os
+// dispositivos se alternam em round-robin; devices 0 mantém os SAs originais.
+// Sem Arduino/IDF: coberto pelos testes nativos.
+
+#define REPLAY_MAX_DEVICES 0xFFFFFFu
+#define REPLAY_MIN_FRAME_LEN 28  // cabeçalho management (24) + FCS
+
+typedef struct {
+  const uint8_t* frame;
+  uint16_t len;      // inclui o FCS (como rx_ctrl.sig_len)
+  int8_t rssi;
+} replay_frame_t;
+
+typedef struct {
+  const replay_frame_t* frames;
+  size_t count;
+  uint32_t devices;
+  uint32_t generated;  // frames produzidos desde o init
+  uint16_t seq;        // número de sequência 802.11 (12 bits)
+} replay_source_t;
+
+void replay_source_init(replay_source_t* src, const replay_frame_t* frames, size_t count, uint32_t devices);
+
+// Copia o próximo frame para out (len em *len) e retorna o frame do corpus de
+// origem (RSSI); NULL com o corpus vazio ou frame maior que out_size
+const replay_frame_t* replay_source_next(replay_source_t* src, uint8_t* out, size_t out_size, uint16_t* len);
+
+// Frames que já deveriam ter sido gerados após elapsed_us a rate frames/s,
+// descontados os sent já gerados (0 se adiantado)
+uint32_t replay_due(uint32_t rate, uint64_t elapsed_us, uint32_t sent);
+
+// Corpus em RAM recebido do host: bytes em hexadecimal anexados ao frame em
+// montagem (várias linhas REPLAY ADD) e fechados com o RSSI (REPLAY END)
+#define REPLAY_STORE_MAX_FRAMES 64
+
+typedef struct {
+  uint8_t* pool;
+  size_t pool_size;
+  size_t pool_used;    // frames fechados
+  size_t pending_len;  // bytes do frame em montagem, após pool_used
+  replay_frame_t frames[REPLAY_STORE_MAX_FRAMES];
+  size_t count;
+} replay_store_t;
+
+void replay_store_init(replay_store_t* store, uint8_t* pool, size_t pool_size);
+void replay_store_clear(replay_store_t* store);
+
+// false se hex for inválido (número ímpar de dígitos) ou não couber no pool;
+// o frame em montagem é descartado
+bool replay_store_append_hex(replay_store_t* store, const char* hex);
+
+// false se o frame for curto demais ou a tabela estiver cheia (frame descartado)
+bool replay_store_commit(replay_store_t* store, int8_t rssi);
+
+#endif // FRAME_REPLAY_H
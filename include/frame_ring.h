@@ -0,0 +1,106 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Buffer circular lock-free SPSC (single-producer/single-consumer) para frames
+// capturados. O produtor é o callback do driver WiFi, que apenas copia o frame
+// bruto para um slot pré-alocado; o consumidor é a task de parsing.
+
+// Capacidade em slots (deve ser potência de 2) - ajustada por placa no platformio.ini
+#ifndef FRAME_RING_CAPACITY
+#define FRAME_RING_CAPACITY 32
+#endif
+
+// Tamanho máximo de frame armazenado por slot (bytes)
+#ifndef FRAME_RING_SLOT_SIZE
+#define FRAME_RING_SLOT_SIZE 512
+#endif
+
+// Capacidade quando o ring fica na PSRAM (mem_placement.h); sem PSRAM vale FRAME_RING_CAPACITY
+#ifndef FRAME_RING_CAPACITY_PSRAM
+#define FRAME_RING_CAPACITY_PSRAM 1024
+#endif
+
+#if (FRAME_RING_CAPACITY & (FRAME_RING_CAPACITY - 1)) != 0
+#error "FRAME_RING_CAPACITY deve ser potência de 2"
+#endif
+
+#if (FRAME_RING_CAPACITY_PSRAM & (FRAME_RING_CAPACITY_PSRAM - 1)) != 0
+#error "FRAME_RING_CAPACITY_PSRAM deve ser potência de 2"
+#endif
+
+typedef struct {
+  uint16_t len;           // bytes válidos em data[]
+  uint16_t orig_len;      // tamanho do frame no ar (sig_len, com FCS); > len se cortado
+  int8_t rssi;
+  uint8_t channel;
+  bool clipped;           // data[] cortado em FRAME_RING_SLOT_SIZE: sem o FCS no fim
+  uint32_t timestamp_us;  // rx_ctrl.timestamp do driver
+  uint32_t dwell_id;      // dwell do escalonador de canais em que o frame chegou
+  uint8_t data[FRAME_RING_SLOT_SIZE];
+} frame_slot_t;
+
+typedef struct {
+  frame_slot_t* slots;
+  uint32_t mask;
+  std::atomic<uint32_t> head;  // escrito apenas pelo produtor
+  std::atomic<uint32_t> tail;  // escrito apenas pelo consumidor
+  uint32_t high_water;         // maior ocupação observada
+  uint32_t dropped;            // frames descartados por buffer cheio
+} frame_ring_t;
+
+// Inicializa o ring sobre um array de slots já alocado (capacity potência de 2)
+inline void frame_ring_init(frame_ring_t* ring, frame_slot_t* slots, uint32_t capacity) {
+  ring->slots = slots;
+  ring->mask = capacity - 1;
+  ring->head.store(0, std::memory_order_relaxed);
+  ring->tail.store(0, std::memory_order_relaxed);
+  ring->high_water = 0;
+  ring->dropped = 0;
+}
+
+inline uint32_t frame_ring_capacity(const frame_ring_t* ring) {
+  return ring->mask + 1;
+}
+
+inline uint32_t frame_ring_occupancy(const frame_ring_t* ring) {
+  return ring->head.load(std::memory_order_acquire) - ring->tail.load(std::memory_order_acquire);
+}
+
+// Produtor: obtém o próximo slot livre ou NULL se o ring estiver cheio
+inline frame_slot_t* frame_ring_reserve(frame_ring_t* ring) {
+  uint32_t head = ring->head.load(std::memory_order_relaxed);
+  uint32_t used = head - ring->tail.load(std::memory_order_acquire);
+  if (used > ring->mask) {
+    ring->dropped++;
+    return NULL;
+  }
+  if (used + 1 > ring->high_water) {
+    ring->high_water = used + 1;
+  }
+  return &ring->slots[head & ring->mask];
+}
+
+// Produtor: publica o slot obtido em frame_ring_reserve()
+inline void frame_ring_commit(frame_ring_t* ring) {
+  ring->head.store(ring->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Consumidor: slot mais antigo ainda não processado ou NULL se vazio
+inline frame_slot_t* frame_ring_peek(frame_ring_t* ring) {
+  uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+  if (tail == ring->head.load(std::memory_order_acquire)) {
+    return NULL;
+  }
+  return &ring->slots[tail & ring->mask];
+}
+
+// Consumidor: libera o slot retornado por frame_ring_peek()
+inline void frame_ring_release(frame_ring_t* ring) {
+  ring->tail.store(ring->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+#endif // FRAME_RING_H
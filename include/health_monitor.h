@@ -0,0 +1,85 @@
+#ifndef HEALTH_MONITOR_H
+#define HEALTH_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Monitor de saúde para operação contínua (substitui o reboot a cada hora).
+//
+// O caminho por pacote não aloca memória; o monitor amostra periodicamente o
+// heap interno, o ring de frames e o contador de frames do driver, e aponta um
+// gatilho quando um limite é ultrapassado:
+//   heap_low         heap interno livre abaixo de HEALTH_MIN_FREE_HEAP
+//   heap_fragmented  maior bloco livre abaixo de HEALTH_MIN_LARGEST_BLOCK
+//                    (ambos sustentados por HEALTH_HEAP_TRIP_CHECKS amostras)
+//   worker_stall     ring com frames e consumidor parado por HEALTH_WORKER_STALL_MS
+//   rx_stall         nenhum frame do driver por HEALTH_RX_STALL_MS
+// Travamentos dentro de uma task (probe_worker, loop) ficam com o watchdog de
+// tasks do IDF, que reinicia com panic e aparece como task_wdt no boot seguinte.
+//
+// Quem chama decide o reboot e guarda o gatilho em RTC (main.cpp).
+
+#ifndef HEALTH_CHECK_INTERVAL_MS
+#define HEALTH_CHECK_INTERVAL_MS 1000
+#endif
+
+#ifndef HEALTH_MIN_FREE_HEAP
+#define HEALTH_MIN_FREE_HEAP 16384
+#endif
+
+#ifndef HEALTH_MIN_LARGEST_BLOCK
+#define HEALTH_MIN_LARGEST_BLOCK 8192
+#endif
+
+#ifndef HEALTH_HEAP_TRIP_CHECKS
+#define HEALTH_HEAP_TRIP_CHECKS 30
+#endif
+
+#ifndef HEALTH_WORKER_STALL_MS
+#define HEALTH_WORKER_STALL_MS 10000
+#endif
+
+// 0 desativa (ambientes sem nenhum tráfego 802.11)
+#ifndef HEALTH_RX_STALL_MS
+#define HEALTH_RX_STALL_MS 300000
+#endif
+
+#ifndef HEALTH_TASK_WDT_TIMEOUT_S
+#define HEALTH_TASK_WDT_TIMEOUT_S 10
+#endif
+
+#define HEALTH_TRIGGER_NONE 0
+#define HEALTH_TRIGGER_HEAP_LOW 1
+#define HEALTH_TRIGGER_HEAP_FRAGMENTED 2
+#define HEALTH_TRIGGER_WORKER_STALL 3
+#define HEALTH_TRIGGER_RX_STALL 4
+#define HEALTH_TRIGGER_TASK_WDT 5   // apenas no boot, a partir do motivo do reset
+
+typedef struct {
+  uint32_t free_heap;        // heap interno livre (bytes)
+  uint32_t largest_block;    // maior bloco interno livre (bytes)
+  uint32_t ring_occupancy;
+  uint32_t ring_tail;        // avança a cada frame consumido
+  uint32_t rx_frames;        // frames entregues pelo driver
+} health_sample_t;
+
+typedef struct {
+  uint32_t checks;
+  uint32_t heap_low_checks;      // amostras consecutivas abaixo do limite
+  uint32_t fragmented_checks;
+  uint32_t min_free_heap;
+  uint32_t min_largest_block;
+  uint32_t ring_tail;
+  uint32_t ring_progress_ms;     // última vez que o consumidor avançou (ou o ring esvaziou)
+  uint32_t rx_frames;
+  uint32_t rx_progress_ms;
+} health_monitor_t;
+
+void health_monitor_init(health_monitor_t* m, uint32_t now_ms);
+
+// Retorna o primeiro gatilho ultrapassado (HEALTH_TRIGGER_NONE se saudável)
+uint8_t health_monitor_check(health_monitor_t* m, const health_sample_t* sample, uint32_t now_ms);
+
+const char* health_trigger_name(uint8_t trigger);
+
+#endif // HEALTH_MONITOR_H
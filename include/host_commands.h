@@ -0,0 +1,26 @@
+#ifndef HOST_COMMANDS_H
+#define HOST_COMMANDS_H
+
+#include <stddef.h>
+
+// Comandos de texto recebidos do host pela serial, uma linha por comando:
+//   NOME [argumentos]\n
+// O nome não diferencia maiúsculas/minúsculas. Respostas são linhas
+// "# <NOME>: {...}" para não se confundirem com os registros de captura.
+
+#define HOST_COMMAND_LINE_MAX 96
+
+typedef void (*host_command_fn)(const char* args);
+
+typedef struct {
+  const char* name;
+  host_command_fn handler;
+  const char* usage;
+} host_command_t;
+
+void host_commands_init(const host_command_t* table, size_t count);
+
+// Lê o que estiver disponível na serial (não bloqueia) e executa linhas completas
+void host_commands_poll();
+
+#endif // HOST_COMMANDS_H
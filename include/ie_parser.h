@@ -0,0 +1,109 @@
+#ifndef IE_PARSER_H
+#define IE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Parser de Information Elements em uma única passada e sem cópias.
+//
+// ie_parse() percorre os tagged parameters e grava apenas visões
+// {id, len, offset} para o buffer do frame capturado (o slot do ring, válido
+// enquanto o frame está sendo processado). Os decodificadores trabalham sobre
+// essas visões, então os corpos dos IEs ficam disponíveis por inteiro para o
+// emissor, sem truncamento. O fingerprint (ver fnv_hash.h) é calculado na
+// mesma passada.
+
+// Information Element IDs
+#define IE_SSID 0
+#define IE_SUPPORTED_RATES 1
+#define IE_DS_PARAMETER 3
+#define IE_EXTENDED_RATES 50
+#define IE_HT_CAPABILITIES 45
+#define IE_EXTENDED_CAPABILITIES 127
+#define IE_VHT_CAPABILITIES 191
+#define IE_VENDOR_SPECIFIC 221
+#define IE_ELEMENT_EXTENSION 255
+
+// Element ID Extension: o primeiro byte do corpo do IE 255 identifica o elemento
+#define IE_EXT_HE_CAPABILITIES 35
+#define IE_EXT_EHT_CAPABILITIES 108
+
+// Bits de Extended Capabilities (IE 127) reportados individualmente
+#define EXT_CAP_BSS_TRANSITION 19
+#define EXT_CAP_INTERWORKING 31
+#define EXT_CAP_OPMODE_NOTIFICATION 62
+#define EXT_CAP_FTM_INITIATOR 71
+
+// Visões por frame: 4 bytes cada. Frames com mais IEs são marcados como truncated.
+#ifndef IE_PARSER_MAX_IES
+#define IE_PARSER_MAX_IES 48
+#endif
+
+#define IE_VIEW_NONE 0xFF
+
+typedef struct {
+  uint8_t id;
+  uint8_t len;
+  uint16_t offset;  // início do corpo (após id/len) no buffer do frame
+} ie_view_t;
+
+// Campos de capacidade decodificados durante a mesma passada de ie_parse().
+// Válidos apenas quando o índice correspondente em ie_list_t != IE_VIEW_NONE.
+typedef struct {
+  uint16_t ht_info;          // HT Capability Information
+  uint8_t ht_mcs[4];         // Rx MCS bitmask, MCS 0-31 (1 byte por spatial stream)
+  uint32_t vht_info;         // VHT Capabilities Information
+  uint16_t vht_rx_mcs_map;   // 2 bits por spatial stream (3 = não suportado)
+  uint8_t he_mac0;           // primeiro byte de HE MAC Capabilities
+  uint8_t he_phy0;           // primeiro byte de HE PHY Capabilities (channel width set)
+  uint16_t he_rx_mcs_80;     // Rx HE-MCS map <= 80 MHz
+} ie_caps_t;
+
+typedef struct {
+  const uint8_t* buf;             // buffer do frame (não copiado)
+  ie_view_t ies[IE_PARSER_MAX_IES];
+  uint8_t count;
+  bool truncated;                 // mais IEs do que IE_PARSER_MAX_IES
+  bool malformed;                 // último IE ultrapassa o fim do frame
+  // Índices em ies[] dos IEs decodificados (IE_VIEW_NONE se ausentes)
+  uint8_t ssid;
+  uint8_t rates;
+  uint8_t ext_rates;
+  uint8_t ht;
+  uint8_t vht;
+  uint8_t ext_caps;
+  uint8_t he;                     // Element ID Extension 35
+  uint8_t eht;                    // Element ID Extension 108
+  uint8_t vendor_count;
+  ie_caps_t caps;
+  uint32_t fp_hash;
+} ie_list_t;
+
+// Percorre buf[start..end) (end exclusivo, sem FCS)
+void ie_parse(ie_list_t* list, const uint8_t* buf, size_t start, size_t end);
+
+inline const uint8_t* ie_body(const ie_list_t* list, const ie_view_t* view) {
+  return list->buf + view->offset;
+}
+
+inline const ie_view_t* ie_get(const ie_list_t* list, uint8_t index) {
+  return index == IE_VIEW_NONE ? NULL : &list->ies[index];
+}
+
+// SSID com apenas caracteres imprimíveis; out com pelo menos 33 bytes.
+// Retorna o tamanho escrito (0 para probe wildcard).
+size_t ie_decode_ssid(const ie_list_t* list, char* out, size_t out_size);
+
+// Taxas em unidades de 500 kbps sem o bit "basic rate"; retorna a quantidade
+size_t ie_decode_rates(const ie_list_t* list, uint8_t index, uint8_t* out, size_t out_size);
+
+// Maior índice MCS HT suportado (0-31) ou -1 se o bitmask estiver vazio
+int ie_ht_max_mcs(const ie_caps_t* caps);
+
+// Spatial streams de um mapa VHT/HE de 2 bits por stream (0 se nenhum)
+uint8_t ie_mcs_map_streams(uint16_t map);
+
+// Bit n do IE Extended Capabilities (false se ausente ou curto demais)
+bool ie_ext_cap_bit(const ie_list_t* list, uint8_t bit);
+
+#endif // IE_PARSER_H
@@ -0,0 +1,55 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Escritor JSON em streaming, sem alocação: escreve direto em um buffer
+// fornecido pelo chamador. Vírgulas são inseridas automaticamente conforme o
+// nível de aninhamento. Se o buffer estourar, overflow fica true e o conteúdo
+// deve ser descartado.
+
+#define JSON_WRITER_MAX_DEPTH 16
+
+typedef struct {
+  char* buf;
+  size_t cap;
+  size_t len;
+  bool overflow;
+  uint8_t depth;
+  bool has_items[JSON_WRITER_MAX_DEPTH];  // nível já possui algum elemento
+  bool after_key;                         // próximo valor segue uma chave
+} json_writer_t;
+
+void json_begin(json_writer_t* w, char* buf, size_t cap);
+
+void json_object_begin(json_writer_t* w);
+void json_object_end(json_writer_t* w);
+void json_array_begin(json_writer_t* w);
+void json_array_end(json_writer_t* w);
+void json_key(json_writer_t* w, const char* key);
+
+void json_string(json_writer_t* w, const char* s);
+void json_uint(json_writer_t* w, uint32_t v);
+void json_int(json_writer_t* w, int32_t v);
+void json_bool(json_writer_t* w, bool v);
+void json_null(json_writer_t* w);
+void json_fixed(json_writer_t* w, float v, uint8_t decimals);  // zeros à direita removidos
+void json_hex(json_writer_t* w, const uint8_t* data, size_t len);  // string hex minúscula
+void json_mac(json_writer_t* w, const uint8_t* mac);              // "aa:bb:cc:dd:ee:ff"
+void json_raw(json_writer_t* w, const char* s);  // valor já serializado, copiado sem escape
+
+// Atalhos chave + valor
+inline void json_kv_string(json_writer_t* w, const char* k, const char* v) { json_key(w, k); json_string(w, v); }
+inline void json_kv_uint(json_writer_t* w, const char* k, uint32_t v) { json_key(w, k); json_uint(w, v); }
+inline void json_kv_int(json_writer_t* w, const char* k, int32_t v) { json_key(w, k); json_int(w, v); }
+inline void json_kv_bool(json_writer_t* w, const char* k, bool v) { json_key(w, k); json_bool(w, v); }
+inline void json_kv_null(json_writer_t* w, const char* k) { json_key(w, k); json_null(w); }
+
+// Codificação hex por tabela de nibbles; out precisa de 2*len bytes (sem terminador)
+void hex_encode(const uint8_t* data, size_t len, char* out);
+
+// Valor de 32 bits como 8 dígitos hex (big-endian) + terminador; out com 9 bytes
+void hex_encode_u32(uint32_t v, char* out);
+
+#endif // JSON_WRITER_H
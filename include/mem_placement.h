@@ -0,0 +1,51 @@
+#ifndef MEM_PLACEMENT_H
+#define MEM_PLACEMENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Alocação dos buffers grandes e frios (ring de frames, tabela do cache de
+// dispositivos, staging do log em flash) no boot. Com PSRAM (ESP32-S3 com
+// BOARD_HAS_PSRAM) esses buffers vão para a memória externa e ganham
+// capacidades maiores (*_PSRAM); o estado quente por pacote (pilha da task,
+// ie_list, índice do cache) continua na SRAM interna.
+//
+// Nada é liberado: as regiões vivem até o reboot e são listadas em
+// "# STATS:" memory.regions.
+
+// frame_ring, device_cache, device_index, track_table, track_index,
+// flash_staging, replay_pool e espnow_queue, com folga para duas. Alocações além disso ainda
+// são feitas, mas não entram na lista: mem_regions_dropped() as conta.
+#ifndef MEM_MAX_REGIONS
+#define MEM_MAX_REGIONS 10
+#endif
+
+typedef struct {
+  const void* ptr;
+  const char* name;
+  uint32_t bytes;
+  bool psram;
+} mem_region_t;
+
+// true se há PSRAM mapeada no heap
+bool mem_psram_available();
+
+// PSRAM se a placa tem e o bloco cabe; NULL caso contrário
+void* mem_alloc_psram(const char* name, size_t bytes);
+
+// SRAM interna (alocação de boot, sem fallback)
+void* mem_alloc_internal(const char* name, size_t bytes);
+
+// true se ptr é o início de uma região alocada na PSRAM
+bool mem_is_psram(const void* ptr);
+
+size_t mem_psram_total();
+size_t mem_psram_free();
+
+// Regiões alocadas até agora, na ordem
+uint8_t mem_regions(const mem_region_t** out);
+
+// Alocações que não couberam na lista de regiões
+uint8_t mem_regions_dropped();
+
+#endif // MEM_PLACEMENT_H
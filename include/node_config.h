@@ -0,0 +1,42 @@
+#ifndef NODE_CONFIG_H
+#define NODE_CONFIG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Configuração do nó persistida em NVS (namespace NODE_CONFIG_NAMESPACE).
+//
+// node_id: NVS > -DNODE_ID em build_flags > derivado do MAC da efuse
+// ("esp32-" + 12 dígitos hex), então placas com o mesmo firmware têm IDs
+// distintos sem editar o código.
+//
+// Modo cluster: cluster_size nós no mesmo local dividem os canais em
+// conjuntos disjuntos (ver channel_plan_partition()); cluster_index é a
+// posição deste nó (0..cluster_size-1). cluster_size 1 = nó isolado.
+
+#define NODE_CONFIG_NAMESPACE "probe_mon"
+#define NODE_ID_MAX_LEN 31
+#define NODE_ID_PREFIX "esp32-"
+
+typedef struct {
+  char node_id[NODE_ID_MAX_LEN + 1];
+  uint8_t cluster_size;
+  uint8_t cluster_index;
+  bool node_id_from_nvs;
+} node_config_t;
+
+// IDs aceitos: até NODE_ID_MAX_LEN caracteres [A-Za-z0-9._-] (seguros em JSON e CSV)
+bool node_id_valid(const char* node_id);
+
+// Requer nvs_flash_init() já executado
+void node_config_load(node_config_t* cfg);
+
+bool node_config_save_node_id(const char* node_id);
+bool node_config_save_cluster(uint8_t index, uint8_t size);
+
+// Blobs de configuração de outros módulos (ex: regras do pré-filtro).
+// load retorna false se a chave não existir ou o tamanho gravado for diferente.
+bool node_config_load_blob(const char* key, void* out, size_t size);
+bool node_config_save_blob(const char* key, const void* data, size_t size);
+
+#endif // NODE_CONFIG_H
@@ -0,0 +1,24 @@
+#ifndef OUI_TABLE_H
+#define OUI_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Tabela de vendors por OUI (blocos MA-L de 24 bits), gerada em build por
+// tools/gen_oui_table.py a partir de tools/vendors/mac-vendors-export.json.
+// Arrays ordenados por OUI e const: ficam na flash, sem custo de RAM.
+//
+//   oui_keys[i]                     OUI (0xAABBCC), ordem crescente
+//   oui_name_ids[i]                 índice do nome em oui_name_offsets
+//   oui_name_offsets[id]            offset do nome (terminado em '\0') em oui_names
+
+extern const uint32_t oui_table_size;
+extern const uint32_t oui_keys[];
+extern const uint16_t oui_name_ids[];
+extern const uint32_t oui_name_offsets[];
+extern const char oui_names[];
+
+// Busca binária pelo OUI dos 3 primeiros octetos do MAC; NULL se desconhecido
+const char* oui_lookup(const uint8_t* mac);
+
+#endif // OUI_TABLE_H
@@ -0,0 +1,102 @@
+#ifndef OUTPUT_TRANSPORT_H
+#define OUTPUT_TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Camada de saída dos registros (JSON, binário, "# STATS:", respostas de comandos).
+//
+// OUTPUT_TRANSPORT_UART: UART0 com ring de TX do driver (OUTPUT_TX_BUFFER_SIZE);
+// o ISR do driver esvazia o ring para a FIFO, então write() só copia bytes.
+// OUTPUT_TRANSPORT_USB_CDC: USB Serial/JTAG nativo do ESP32-S3 (ARDUINO_USB_MODE=1
+// + ARDUINO_USB_CDC_ON_BOOT=1); a velocidade é a do barramento, o baud é ignorado.
+//
+// output_write() nunca bloqueia esperando o host: um registro que não cabe
+// inteiro no espaço livre do ring é descartado e contado em output_stats_t
+// (registros parciais corromperiam o enquadramento JSON/COBS).
+//
+// Sinks adicionais (output_add_sink) recebem cópia de todo registro, mesmo os
+// descartados pela serial: sem host USB conectado os dados seguem pela rede.
+
+#define OUTPUT_TRANSPORT_UART 0
+#define OUTPUT_TRANSPORT_USB_CDC 1
+
+// Sink de rede opcional (selecionado em tempo de compilação)
+#define OUTPUT_SINK_NONE 0
+#define OUTPUT_SINK_ESPNOW 1   // datagramas para um nó gateway (ver espnow_sink.h)
+#ifndef OUTPUT_SINK
+#define OUTPUT_SINK OUTPUT_SINK_NONE
+#endif
+
+#ifndef OUTPUT_TRANSPORT
+#if defined(ARDUINO_USB_MODE) && ARDUINO_USB_MODE && defined(ARDUINO_USB_CDC_ON_BOOT) && ARDUINO_USB_CDC_ON_BOOT
+#define OUTPUT_TRANSPORT OUTPUT_TRANSPORT_USB_CDC
+#else
+#define OUTPUT_TRANSPORT OUTPUT_TRANSPORT_UART
+#endif
+#endif
+
+// Baud da UART: vem de monitor_speed no platformio.ini (921600 a 3000000,
+// conforme o conversor USB-serial da placa)
+#ifndef OUTPUT_BAUD
+#define OUTPUT_BAUD 921600
+#endif
+
+// Ring de TX do driver: absorve rajadas de vários registros de ~1 KB
+#ifndef OUTPUT_TX_BUFFER_SIZE
+#define OUTPUT_TX_BUFFER_SIZE 16384
+#endif
+
+#define OUTPUT_RX_BUFFER_SIZE 256   // comandos do host (HOST_COMMAND_LINE_MAX por linha)
+#define OUTPUT_LINE_MAX 512         // maior linha formatada por output_printf()
+#define OUTPUT_LOCK_TIMEOUT_MS 5    // espera máxima por outro escritor antes de descartar
+#define OUTPUT_MAX_SINKS 2
+
+typedef struct {
+  uint32_t records;          // registros escritos inteiros
+  uint32_t bytes;
+  uint32_t dropped_records;  // overrun: ring sem espaço (host lento ou desconectado)
+  uint32_t dropped_bytes;
+  uint32_t lock_timeouts;    // descartes por outro escritor segurando o transporte
+  uint32_t tx_free_min;      // menor espaço livre observado no ring de TX
+} output_stats_t;
+
+// Funções chamadas com o transporte travado (nunca concorrentes entre si);
+// não podem bloquear
+typedef struct {
+  const char* name;
+  void (*write)(const uint8_t* data, size_t len);
+  void (*poll)(uint32_t now_ms);  // envio periódico, chamado por output_poll()
+} output_sink_t;
+
+// Configura buffers e inicia o transporte; substitui Serial.begin()
+void output_begin();
+
+bool output_add_sink(const output_sink_t* sink);
+
+// Chamado pelo loop(): repassa a vez aos sinks para fechar e enviar lotes
+void output_poll(uint32_t now_ms);
+
+// Escreve o registro inteiro ou nada; seguro entre tasks. Retorna false se descartado.
+bool output_write(const uint8_t* data, size_t len);
+
+// Lote de registros inteiros concatenados (workers de parsing), tudo ou nada;
+// os sinks recebem o lote em uma única chamada de write()
+bool output_write_records(const uint8_t* data, size_t len, uint32_t records);
+
+// Linha de texto curta (respostas "# NOME: {...}"); truncada em OUTPUT_LINE_MAX
+bool output_printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// Despejos longos (LOG DUMP): output_lock() segura o transporte e
+// output_write_blocking() espera espaço no ring em vez de descartar. Registros
+// de outras tasks são descartados (lock_timeouts) até output_unlock(); os sinks
+// não recebem os bytes despejados.
+void output_lock();
+void output_write_blocking(const uint8_t* data, size_t len);
+void output_unlock();
+
+const char* output_transport_name();
+uint32_t output_baud();  // 0 no USB CDC
+const output_stats_t* output_get_stats();
+
+#endif // OUTPUT_TRANSPORT_H
@@ -0,0 +1,129 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Contadores de ciclos por estágio do caminho de captura (-DPERF_ENABLED=1).
+//
+// Cada estágio guarda um histograma de ciclos de CPU em buckets fixos de
+// potência de 2 (bucket b: [2^b, 2^(b+1)); o bucket 0 inclui o 0), além de
+// count/min/max/soma. p50/p99 saem do histograma como o limite superior do
+// bucket que contém o percentil (limitado ao max): erro de até 2x, suficiente
+// para achar o estágio que trava a captura. Sem alocação nem lock; registrar
+// é um clz, uma soma de 64 bits e três incrementos, seguro no callback do driver.
+//
+// Cada histograma tem um único escritor: o callback do driver (core 0) ou o
+// worker de parsing dono do conjunto (perf_shard, um por worker). O leitor
+// (loop) copia sem lock, soma os conjuntos e pode ver um registro pela metade.
+// A janela (perf_snapshot) zera os histogramas de forma preguiçosa: o escritor
+// descarta o conteúdo na primeira amostra da janela nova.
+//
+// Desativado (padrão), PERF_BEGIN/PERF_END não geram código.
+
+#ifndef PERF_ENABLED
+#define PERF_ENABLED 0
+#endif
+
+// Cobre até 2^24 ciclos (~70 ms a 240 MHz); acima disso tudo cai no último bucket
+#define PERF_HIST_BUCKETS 24
+
+// Estágios (ciclos de CPU)
+#define PERF_STAGE_RX_CALLBACK 0   // wifi_promiscuous_rx() inteiro, inclusive frames descartados
+#define PERF_STAGE_FRAME 1         // process_frame() inteiro
+#define PERF_STAGE_PARSE 2         // parse_probe_request() (inclui ie_parse e vendor)
+#define PERF_STAGE_IE_PARSE 3
+#define PERF_STAGE_VENDOR 4        // get_vendor_from_mac()
+#define PERF_STAGE_DEVICE_CACHE 5  // track_correlator_observe() + device_cache_observe()
+#define PERF_STAGE_SERIALIZE 6     // format_capture_json() ou encode_capture_binary()
+#define PERF_STAGE_OUTPUT 7        // output_write(): espera pelo lock + cópia para o ring de TX
+// Amostras (sem unidade de tempo)
+#define PERF_SAMPLE_RING_DEPTH 8   // ocupação do frame ring a cada frame consumido
+#define PERF_SAMPLE_RX_TO_EMIT 9   // us da chegada do frame até o registro entrar no transporte
+#define PERF_HIST_COUNT 10
+
+typedef struct {
+  uint32_t window;   // janela a que o conteúdo pertence (perf_window)
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint32_t buckets[PERF_HIST_BUCKETS];
+} perf_hist_t;
+
+// Conjuntos de histogramas: um por worker de parsing (PROBE_WORKER_COUNT)
+#define PERF_SHARDS 2
+
+extern perf_hist_t perf_hists[PERF_SHARDS][PERF_HIST_COUNT];
+extern std::atomic<uint32_t> perf_window;
+extern thread_local uint8_t perf_shard;  // conjunto da task atual (0 fora dos workers)
+
+// Contador de ciclos do core atual (inline: utilizável em IRAM). Fora do alvo
+// não há fonte e os estágios registram 0.
+#if defined(ESP_PLATFORM)
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_cpu.h>
+#define perf_cycles() ((uint32_t)esp_cpu_get_cycle_count())
+#else
+#include <hal/cpu_hal.h>
+#define perf_cycles() ((uint32_t)cpu_hal_get_cycle_count())
+#endif
+#else
+#define perf_cycles() ((uint32_t)0)
+#endif
+
+inline void perf_hist_clear(perf_hist_t* h) {
+  h->count = 0;
+  h->min = 0;
+  h->max = 0;
+  h->sum = 0;
+  for (uint8_t b = 0; b < PERF_HIST_BUCKETS; b++) h->buckets[b] = 0;
+}
+
+inline uint8_t perf_bucket(uint32_t value) {
+  if (value == 0) return 0;
+  uint32_t b = 31 - __builtin_clz(value);
+  return b < PERF_HIST_BUCKETS ? b : PERF_HIST_BUCKETS - 1;
+}
+
+inline void perf_hist_add(perf_hist_t* h, uint32_t value) {
+  if (h->count == 0 || value < h->min) h->min = value;
+  if (value > h->max) h->max = value;
+  h->count++;
+  h->sum += value;
+  h->buckets[perf_bucket(value)]++;
+}
+
+// Escritor: registra no histograma da janela atual
+inline void perf_record(uint8_t index, uint32_t value) {
+  perf_hist_t* h = &perf_hists[perf_shard][index];
+  uint32_t window = perf_window.load(std::memory_order_relaxed);
+  if (h->window != window) {
+    perf_hist_clear(h);
+    h->window = window;
+  }
+  perf_hist_add(h, value);
+}
+
+#if PERF_ENABLED
+#define PERF_BEGIN(var) uint32_t var = perf_cycles()
+#define PERF_END(stage, var) perf_record(stage, perf_cycles() - (var))
+#define PERF_SAMPLE(index, value) perf_record(index, value)
+#else
+#define PERF_BEGIN(var)
+#define PERF_END(stage, var)
+#define PERF_SAMPLE(index, value)
+#endif
+
+// Limite superior do bucket que contém o percentil (permille: 500 = p50, 990 = p99)
+uint32_t perf_hist_percentile(const perf_hist_t* h, uint16_t permille);
+uint32_t perf_hist_avg(const perf_hist_t* h);
+
+// Leitor: soma a janela atual de todos os conjuntos em out[PERF_HIST_COUNT] e inicia a próxima
+void perf_snapshot(perf_hist_t* out);
+
+const char* perf_hist_name(uint8_t index);
+
+#endif // PERF_COUNTERS_H
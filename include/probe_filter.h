@@ -0,0 +1,90 @@
+#ifndef PROBE_FILTER_H
+#define PROBE_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Pré-filtro aplicado no callback do driver, antes do frame ir para o ring.
+//
+// Usa apenas campos do cabeçalho 802.11 (SA), o RSSI do rx_ctrl e o IE de
+// SSID, então o custo de parsing/serialização fica só com os frames mantidos.
+// Estágios em ordem de custo; o primeiro que rejeitar encerra a avaliação e
+// incrementa o seu contador:
+//   1. rssi        RSSI abaixo de rssi_min
+//   2. randomized  política de MAC randomizado (apenas randomizados/apenas globais)
+//   3. mac         denylist (qualquer match rejeita) e allowlist (exige um match),
+//                  entradas com máscara por comprimento de prefixo
+//   4. ssid        exige SSID igual (ou prefixo, se terminar em '*') a uma entrada;
+//                  probes wildcard (SSID vazio) são rejeitados
+//
+// As regras são um POD versionado, gravado como blob na NVS.
+
+#define PROBE_FILTER_VERSION 1
+#define PROBE_FILTER_MAX_MACS 8
+#define PROBE_FILTER_MAX_SSIDS 4
+#define PROBE_FILTER_SSID_MAX 32
+
+#define PROBE_FILTER_RSSI_ANY -128
+
+#define PROBE_FILTER_RANDOMIZED_ANY 0
+#define PROBE_FILTER_RANDOMIZED_ONLY 1     // apenas MACs randomizados
+#define PROBE_FILTER_RANDOMIZED_EXCLUDE 2  // apenas MACs globais (OUI real)
+
+#define PROBE_FILTER_MAC_ALLOW 0
+#define PROBE_FILTER_MAC_DENY 1
+
+typedef struct {
+  uint8_t addr[6];
+  uint8_t prefix_bits;  // 1..48
+  uint8_t action;       // PROBE_FILTER_MAC_ALLOW / PROBE_FILTER_MAC_DENY
+} probe_filter_mac_t;
+
+typedef struct {
+  uint8_t version;
+  int8_t rssi_min;
+  uint8_t randomized;
+  uint8_t mac_count;
+  uint8_t ssid_count;
+  probe_filter_mac_t macs[PROBE_FILTER_MAX_MACS];
+  char ssids[PROBE_FILTER_MAX_SSIDS][PROBE_FILTER_SSID_MAX + 2];  // + '*' + '\0'
+} probe_filter_rules_t;
+
+typedef struct {
+  uint32_t checked;
+  uint32_t accepted;
+  uint32_t rejected_rssi;
+  uint32_t rejected_randomized;
+  uint32_t rejected_mac;
+  uint32_t rejected_ssid;
+} probe_filter_counters_t;
+
+// Duas cópias das regras: alterações são feitas na inativa e publicadas com
+// uma troca atômica do índice, então o callback nunca vê regras pela metade
+typedef struct {
+  probe_filter_rules_t rules[2];
+  std::atomic<uint8_t> active;
+  probe_filter_counters_t counters;  // escritos apenas pelo callback
+} probe_filter_t;
+
+void probe_filter_rules_clear(probe_filter_rules_t* rules);
+bool probe_filter_rules_valid(const probe_filter_rules_t* rules);
+
+void probe_filter_init(probe_filter_t* filter);
+
+inline const probe_filter_rules_t* probe_filter_rules(const probe_filter_t* filter) {
+  return &filter->rules[filter->active.load(std::memory_order_acquire)];
+}
+
+// Publica novas regras (copiadas para o buffer inativo)
+void probe_filter_publish(probe_filter_t* filter, const probe_filter_rules_t* rules);
+
+// frame: frame 802.11 completo; len sem o FCS. Retorna true se o frame deve ser mantido.
+bool probe_filter_match(probe_filter_t* filter, const uint8_t* frame, size_t len, int8_t rssi);
+
+// Adição de entradas (retornam false se a lista estiver cheia ou o valor for inválido)
+bool probe_filter_add_mac(probe_filter_rules_t* rules, const uint8_t* addr, uint8_t prefix_bits,
+                          uint8_t action);
+bool probe_filter_add_ssid(probe_filter_rules_t* rules, const char* ssid);
+
+#endif // PROBE_FILTER_H
@@ -0,0 +1,125 @@
+#ifndef PROBE_RECORD_H
+#define PROBE_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ie_parser.h"
+#include "wire_format.h"
+
+// Registro de captura de um probe request: parsing do frame e serialização
+// (JSON por linha e registro binário enquadrado). Sem dependência do Arduino
+// nem do IDF, compilado também no env native (testes e benchmark em test/).
+// Nenhuma função aloca heap; os buffers de saída são do chamador.
+
+// IEEE 802.11 Frame Control Field definitions
+#define WIFI_FRAME_TYPE_MANAGEMENT 0x00
+#define WIFI_FRAME_SUBTYPE_PROBE_REQ 0x04
+#define WIFI_MGMT_HEADER_LEN 24   // cabeçalho de frames management (sem addr4)
+#define WIFI_FCS_LEN 4            // CRC32 incluído em rx_ctrl.sig_len
+
+// Information Element IDs: ver ie_parser.h
+
+// Frequency band definitions
+#define FREQ_2_4GHZ_BASE 2412
+#define CHANNEL_TO_FREQ(ch) (FREQ_2_4GHZ_BASE + ((ch - 1) * 5))
+
+// Estruturas para dados dos probe requests
+// Registros POD de tamanho fixo: nenhum campo aloca heap no caminho de captura,
+// a conversão para texto acontece apenas na emissão (format_capture_json).
+// Os IEs não são copiados: packet.ies guarda visões para o frame capturado.
+#define FRAME_RAW_MAX 32            // bytes do frame bruto incluídos em frame_raw_hex
+#define SSID_MAX_LEN 32
+
+typedef struct {
+  uint8_t da[6];      // destination address
+  uint8_t sa[6];      // source address
+  uint8_t bssid[6];   // BSSID
+  uint16_t duration;
+  uint16_t seq_ctrl;
+  const char* type;     // string estática
+  const char* subtype;  // string estática
+} ieee80211_info_t;
+
+typedef struct {
+  uint8_t channel;
+  uint16_t freq_mhz;
+  const char* band;     // string estática
+  uint8_t bandwidth_mhz;
+  uint8_t antenna;
+  uint32_t dwell_id;    // dwell do escalonador de canais (ver channel_scheduler.h)
+  uint32_t rx_us;       // rx_ctrl.timestamp bruto (epoch no host pelas âncoras "# TIME:")
+} radio_info_t;
+
+// Fingerprint compacto: FNV-1a 32 bits sobre a lista ordenada de IDs de IE e
+// os corpos dos IEs de capacidade (rates, HT/VHT/HE, extended caps, OUI+tipo
+// dos vendor IEs), calculado na mesma passada de ie_parse().
+// SSID e DS Parameter ficam de fora: variam entre probes do mesmo dispositivo.
+typedef struct {
+  uint32_t ie_hash;
+  float confidence;
+} fingerprint_t;
+
+typedef struct {
+  uint32_t pkt_seq;          // contador da sessão (renderizado em pkt_id)
+  radio_info_t radio;
+  ieee80211_info_t ieee80211;
+  int8_t rssi_dbm;
+  const uint8_t* frame;      // frame capturado (slot do ring), válido durante process_frame()
+  uint16_t frame_len;        // sem o FCS
+  ie_list_t ies;             // visões dos IEs sobre frame
+  bool mac_randomized;
+  const char* vendor_inferred;  // aponta para a tabela de vendors
+  fingerprint_t fingerprint;
+  uint32_t track_id;         // trilha do track_correlator (preenchida pelo chamador; 0 = sem correlação)
+} packet_data_t;
+
+typedef struct {
+  const char* capture_id;    // metadados constantes da sessão (preenchidos pelo chamador)
+  const char* scanner_id;
+  const char* firmware;
+  uint16_t scanner_tag;      // 16 bits baixos do MAC da efuse (em pkt_id)
+  uint32_t capture_epoch_s;  // capture_ts bruto (renderizado em ISO8601), derivado de rx_us
+  uint16_t capture_ms;
+  packet_data_t packet;
+} capture_data_t;
+
+typedef struct {
+  unsigned frame_ctrl:16;
+  unsigned duration_id:16;
+  uint8_t addr1[6]; // receiver address
+  uint8_t addr2[6]; // sender address
+  uint8_t addr3[6]; // filtering address
+  unsigned sequence_ctrl:16;
+  uint8_t addr4[6]; // optional
+} wifi_ieee80211_mac_hdr_t;
+
+typedef struct {
+  wifi_ieee80211_mac_hdr_t hdr;
+  uint8_t payload[0]; // network data ended with 4 bytes csum (CRC32)
+} wifi_ieee80211_packet_t;
+
+// Preenche os campos derivados do frame. has_fcs: os últimos 4 bytes de len são
+// o FCS (frame inteiro, como rx_ctrl.sig_len); false para frames cortados, em
+// que o fim são bytes dos IEs. Zera o registro: metadados da sessão, pkt_seq, dwell_id, rx_us e o instante
+// de captura ficam a cargo do chamador. false se o frame for menor que o cabeçalho.
+bool parse_probe_request(const uint8_t* frame, size_t len, bool has_fcs, int8_t rssi, uint8_t channel, capture_data_t& capture);
+
+// Documento JSON do schema seguido de "\r\n" em out. Retorna o tamanho ou 0
+// se o registro não couber em out_size.
+size_t format_capture_json(const capture_data_t& capture, char* out, size_t out_size);
+
+// Registro WIRE_RECORD_PACKET enquadrado (ver wire_format.h). Retorna o tamanho ou 0.
+size_t encode_capture_binary(const capture_data_t& capture, uint8_t* out, size_t out_size);
+// Idem, ou WIRE_RECORD_DELTA se o pacote repete o keyframe do dispositivo em delta
+size_t encode_capture_binary_delta(const capture_data_t& capture, wire_delta_t* delta,
+                                   uint8_t* out, size_t out_size);
+
+void frame_to_hex(const uint8_t* frame, size_t len, char* out);
+void mac_to_string(const uint8_t* mac, char* out);
+void format_oui(const uint8_t* oui, char* out);
+void format_packet_id(char* out, uint32_t pkt_seq, uint32_t epoch_s, uint16_t ms, uint16_t scanner_tag);
+void format_iso8601_timestamp(char* out, uint32_t epoch_s, uint16_t ms);
+bool is_randomized_mac(const uint8_t* mac);
+const char* get_vendor_from_mac(const uint8_t* mac);
+
+#endif // PROBE_RECORD_H
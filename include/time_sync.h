@@ -0,0 +1,100 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Relógio de captura: cada registro leva o rx_ctrl.timestamp bruto do driver
+// (us, 32 bits, relógio do MAC WiFi) e o host converte para epoch a partir de
+// âncoras periódicas. Sem gmtime()/sprintf() por pacote.
+//
+// Três relógios:
+//   rx_us     rx_ctrl.timestamp (wrap a cada ~71 min)
+//   timer_us  esp_timer_get_time() (64 bits, desde o boot)
+//   epoch_us  UTC
+// rx -> timer: offset constante estimado no callback do driver como o menor
+//   (timer - rx) observado (o de menor latência de entrega) por intervalo.
+// timer -> epoch: modelo ajustado pela fonte de tempo (compilação, comando
+//   TIME do host ou borda de PPS).
+//
+// Âncora: um mesmo instante nos relógios rx e epoch. Para um registro com
+// rx_us, epoch_us = anchor.epoch_us + (int32_t)(rx_us - anchor.rx_us), válido
+// enquanto as âncoras chegarem em menos de ~35 min.
+
+#define TIME_SOURCE_NONE 0    // sem BUILD_TIME_UNIX: epoch = tempo desde o boot
+#define TIME_SOURCE_BUILD 1   // timestamp de compilação (ou relógio preservado no reset)
+#define TIME_SOURCE_HOST 2    // comando TIME pela serial
+#define TIME_SOURCE_PPS 3     // borda de PPS (segundo inteiro) sobre uma fonte anterior
+
+// Intervalo entre âncoras emitidas (e após cada ajuste)
+#ifndef TIME_ANCHOR_INTERVAL_MS
+#define TIME_ANCHOR_INTERVAL_MS 10000
+#endif
+
+// GPIO do PPS (borda de subida); -1 desativa
+#ifndef TIME_PPS_GPIO
+#define TIME_PPS_GPIO -1
+#endif
+
+typedef struct {
+  int64_t offset_us;      // epoch_us - timer_us
+  uint8_t source;
+  uint32_t adjustments;
+  int32_t last_step_us;   // correção aplicada no último ajuste (saturada)
+} time_model_t;
+
+// Escrito pelo callback do driver, lido pela loop()
+typedef struct {
+  std::atomic<uint32_t> offset;     // timer_us (32 bits baixos) - rx_us, menor do intervalo
+  std::atomic<bool> valid;
+  std::atomic<bool> restart;        // pedido de nova janela de mínimo
+} rx_clock_t;
+
+typedef struct {
+  uint32_t seq;
+  uint8_t source;
+  uint32_t epoch_s;
+  uint32_t epoch_frac_us;
+  uint32_t rx_us;
+} time_anchor_t;
+
+void time_model_init(time_model_t* m, int64_t epoch_us, int64_t timer_us, uint8_t source);
+void time_model_set(time_model_t* m, int64_t epoch_us, int64_t timer_us, uint8_t source);
+
+// Ajusta o offset para que a borda caia no segundo inteiro mais próximo
+// (exige uma fonte anterior com erro menor que 0,5 s)
+void time_model_pps(time_model_t* m, int64_t edge_timer_us);
+
+inline int64_t time_model_epoch_us(const time_model_t* m, int64_t timer_us) {
+  return timer_us + m->offset_us;
+}
+
+void rx_clock_init(rx_clock_t* c);
+
+// Callback do driver: timer32 = (uint32_t)esp_timer_get_time() na chegada
+inline void rx_clock_observe(rx_clock_t* c, uint32_t timer32, uint32_t rx_us) {
+  uint32_t candidate = timer32 - rx_us;
+  if (c->restart.exchange(false, std::memory_order_relaxed) || !c->valid.load(std::memory_order_relaxed)) {
+    c->offset.store(candidate, std::memory_order_relaxed);
+    c->valid.store(true, std::memory_order_release);
+  } else if ((int32_t)(candidate - c->offset.load(std::memory_order_relaxed)) < 0) {
+    c->offset.store(candidate, std::memory_order_relaxed);
+  }
+}
+
+// Converte rx_us para o relógio do esp_timer (pacote no passado, < ~71 min)
+inline int64_t rx_clock_to_timer(uint32_t rx_us, uint32_t rx_offset, int64_t now_timer_us) {
+  return now_timer_us - (uint32_t)((uint32_t)now_timer_us - (rx_us + rx_offset));
+}
+
+// Âncora no instante timer_us (rx_us correspondente pelo offset atual)
+void time_anchor_make(time_anchor_t* out, const time_model_t* m, uint32_t rx_offset,
+                      int64_t timer_us, uint32_t seq);
+
+const char* time_source_name(uint8_t source);
+
+// Interpreta "segundos[.fração]" do comando TIME; false se inválido
+bool time_parse_epoch(const char* s, int64_t* epoch_us);
+
+#endif // TIME_SYNC_H
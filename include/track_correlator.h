@@ -0,0 +1,100 @@
+#ifndef TRACK_CORRELATOR_H
+#define TRACK_CORRELATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Correlação de MACs randomizados em trilhas (track_id estável por dispositivo).
+//
+// Cada par SA + fingerprint observado ocupa uma entrada, com o track_id da
+// trilha a que pertence. Um par novo herda o track_id de uma entrada vista há
+// no máximo TRACK_LINK_WINDOW_MS quando:
+//   - é o mesmo SA com outro fingerprint; ou
+//   - ambos os SAs são randomizados, o fingerprint é o mesmo, o número de
+//     sequência 802.11 continua o da entrada (avanço de 1 a TRACK_SEQ_MAX_GAP,
+//     módulo 4096) e o RSSI difere no máximo TRACK_RSSI_MAX_DELTA dB.
+// Entre os candidatos vence o menor avanço de sequência (depois o menor
+// desvio de RSSI). A entrada ligada é marcada como sucedida e não liga outro
+// SA: dois dispositivos iguais lado a lado não se fundem em uma trilha só.
+//
+// Mesma organização do device_cache: pool fixo, índice com sondagem linear e
+// remoção por backward-shift, lista LRU. A busca por candidatos percorre a
+// LRU a partir do mais recente e para ao sair da janela (ou após
+// TRACK_LINK_SCAN_MAX entradas), então só SAs novos pagam a varredura.
+// Sem Arduino/IDF: coberto pelos testes nativos.
+
+#ifndef TRACK_CORRELATOR_CAPACITY
+#define TRACK_CORRELATOR_CAPACITY 512
+#endif
+
+// Com o pool na PSRAM (mem_placement.h); índices u16, no máximo 16384
+#ifndef TRACK_CORRELATOR_CAPACITY_PSRAM
+#define TRACK_CORRELATOR_CAPACITY_PSRAM 4096
+#endif
+
+#ifndef TRACK_LINK_WINDOW_MS
+#define TRACK_LINK_WINDOW_MS 10000
+#endif
+
+#ifndef TRACK_SEQ_MAX_GAP
+#define TRACK_SEQ_MAX_GAP 64
+#endif
+
+#ifndef TRACK_RSSI_MAX_DELTA
+#define TRACK_RSSI_MAX_DELTA 10
+#endif
+
+#ifndef TRACK_LINK_SCAN_MAX
+#define TRACK_LINK_SCAN_MAX 64
+#endif
+
+#define TRACK_ID_NONE 0
+#define TRACK_CORRELATOR_NONE 0xFFFF
+
+#if (TRACK_CORRELATOR_CAPACITY & (TRACK_CORRELATOR_CAPACITY - 1)) != 0
+#error "TRACK_CORRELATOR_CAPACITY deve ser potência de 2"
+#endif
+
+#if (TRACK_CORRELATOR_CAPACITY_PSRAM & (TRACK_CORRELATOR_CAPACITY_PSRAM - 1)) != 0 || TRACK_CORRELATOR_CAPACITY_PSRAM > 16384
+#error "TRACK_CORRELATOR_CAPACITY_PSRAM deve ser potência de 2 e no máximo 16384"
+#endif
+
+typedef struct {
+  uint8_t sa[6];
+  bool in_use;
+  bool mac_randomized;
+  bool superseded;          // a trilha já passou para um SA mais novo
+  int8_t last_rssi;
+  uint16_t last_seq;        // número de sequência (12 bits) do último frame
+  uint32_t fp_hash;
+  uint32_t track_id;
+  uint32_t last_seen_ms;
+  uint16_t lru_prev;
+  uint16_t lru_next;
+} track_entry_t;
+
+typedef struct {
+  track_entry_t* entries;
+  uint16_t* index;
+  uint16_t capacity;
+  uint16_t index_mask;
+  uint16_t used;
+  uint16_t lru_head;        // mais recente
+  uint16_t lru_tail;
+  uint32_t next_track_id;
+  // Contadores
+  uint32_t tracks;          // trilhas criadas
+  uint32_t links;           // SAs novos ligados a uma trilha existente
+  uint32_t evictions;
+} track_correlator_t;
+
+// index_size = 2 * capacity (potência de 2)
+void track_correlator_init(track_correlator_t* tc, track_entry_t* entries, uint16_t capacity,
+                           uint16_t* index, uint16_t index_size);
+
+// Registra um frame e retorna o track_id do dispositivo (nunca TRACK_ID_NONE).
+// seq é o número de sequência já sem o fragmento (ieee80211.seq_ctrl).
+uint32_t track_correlator_observe(track_correlator_t* tc, const uint8_t* sa, uint32_t fp_hash,
+                                  bool mac_randomized, uint16_t seq, int8_t rssi, uint32_t now_ms);
+
+#endif // TRACK_CORRELATOR_H
@@ -5,173 +5,291 @@
 #include <WiFi.h>
 #include <esp_wifi.h>
 #include <esp_event.h>
-#include <ArduinoJson.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include <esp_heap_caps.h>
+#include "frame_ring.h"
+#include "wire_format.h"
+#include "device_cache.h"
+#include "fnv_hash.h"
+#include "oui_table.h"
+#include "channel_scheduler.h"
+#include "node_config.h"
+#include "host_commands.h"
+#include "probe_filter.h"
+#include "ie_parser.h"
+#include "probe_record.h"
+#include "output_transport.h"
+#include "espnow_sink.h"
+#include "flash_log_sink.h"
+#include "mem_placement.h"
+#include "health_monitor.h"
+#include "time_sync.h"
+#include "perf_counters.h"
+#include "window_sketch.h"
+#include "frame_replay.h"
+#include "track_correlator.h"
 
 // Configurações do sistema
-#define NODE_ID "esp32-node-01"
+// NODE_ID: opcional em build_flags (-DNODE_ID=\"entrada-01\"); sem ele o ID vem
+// da NVS (comando NODE) ou do MAC da efuse (ver node_config.h)
 #define FIRMWARE_VERSION "watchtower-v1.2.3"
 #define MAX_CHANNELS 13
-#define CHANNEL_SWITCH_INTERVAL 500  // ms
+#define CHANNEL_SWITCH_INTERVAL 500  // ms - dwell fixo dos modos round-robin e lista fixa
 #define MAX_SSID_COUNT 20
-#define MAX_VENDOR_IES 3  // Reduzido ainda mais de 5 para 3
-#define MAX_IES 15        // Reduzido de 25 para 15
 #define BEACON_TIMEOUT 30000  // ms
-#define JSON_BUFFER_SIZE 512  // Reduzido de 1024 para 512
+#define JSON_BUFFER_SIZE 4096 // Buffer de saída de format_capture_json (registro completo + "\r\n")
+#define STATS_BUFFER_SIZE 6144 // Linha "# STATS:" completa (~3 KB com 13 canais)
+#define PERF_BUFFER_SIZE 4096  // Linha "# PERF:" (PERF_ENABLED) com todos os buckets preenchidos
+#define SUMMARY_BUFFER_SIZE 3072 // Linha "# SUMMARY:" com SUMMARY_TOP_N talkers e SSIDs de 32 bytes
 
-// Configurações específicas para ESP32-32U com antena externa
-#ifdef ESP32_32U_EXTERNAL_ANTENNA
-  #define WIFI_ANT_SWITCH_GPIO 0          // GPIO para controle de switch de antena
-  #define WIFI_MAX_TX_POWER 78            // Potência máxima (19.5 dBm = 78/4)
-  #define WIFI_RX_SENSITIVITY_2_4G -96    // Sensibilidade melhorada com antena externa
-#else
-  #define WIFI_MAX_TX_POWER 68            // Potência padrão (17 dBm = 68/4)
-  #define WIFI_RX_SENSITIVITY_2_4G -88    // Sensibilidade padrão
+// Tasks de processamento (consomem o frame ring fora do contexto do driver WiFi).
+// Com PROBE_WORKER_COUNT 2 há um worker por core, cada um com o próprio frame
+// ring, cache de dispositivos e buffers de serialização; o callback escolhe o
+// worker pelo hash do SA, então o estado de cada dispositivo fica em um único
+// core sem locks. Os registros de cada worker são juntados em um lote de até
+// OUTPUT_BATCH_SIZE bytes e entregues inteiros ao transporte, cujo lock é o
+// único ponto de encontro entre os workers.
+#ifndef PROBE_WORKER_COUNT
+#define PROBE_WORKER_COUNT 1
+#endif
+#if PROBE_WORKER_COUNT < 1 || PROBE_WORKER_COUNT > PERF_SHARDS
+#error "PROBE_WORKER_COUNT deve ser 1 ou 2"
+#endif
+#if PROBE_WORKER_COUNT > 1 && defined(CONFIG_FREERTOS_UNICORE) && CONFIG_FREERTOS_UNICORE
+#error "PROBE_WORKER_COUNT 2 requer um chip dual-core (ESP32, ESP32-S3)"
+#endif
+#ifndef PROBE_WORKER_CORE
+#define PROBE_WORKER_CORE 1          // Core oposto ao da task do driver WiFi (core 0)
+#endif
+#define PROBE_WORKER_PRIORITY 1
+#define PROBE_WORKER_STACK_SIZE 8192
+#define PROBE_WORKER_IDLE_WAIT 100   // ms sem notificação antes de reverificar o ring
+// Frames por lote de drenagem. Com o ring ainda ocupado ao fim do lote o worker
+// cede o core por um tick (vTaskDelay) em vez de esperar notificação: com
+// PROBE_WORKER_COUNT 2 o segundo worker roda no core 0 acima de IDLE0, e o
+// task watchdog (idle_core_mask = core 0, com panic) reiniciaria o nó se a
+// drenagem contínua sob carga nunca deixasse a IDLE0 rodar.
+#ifndef PROBE_WORKER_BATCH_FRAMES
+#define PROBE_WORKER_BATCH_FRAMES 256
+#endif
+#ifndef PROBE_WORKER_WDT_RESET_FRAMES
+#define PROBE_WORKER_WDT_RESET_FRAMES 64  // frames drenados entre resets do task watchdog
 #endif
 
-// IEEE 802.11 Frame Control Field definitions
-#define WIFI_FRAME_TYPE_MANAGEMENT 0x00
-#define WIFI_FRAME_SUBTYPE_PROBE_REQ 0x04
-
-// Information Element IDs
-#define IE_SSID 0
-#define IE_SUPPORTED_RATES 1
-#define IE_DS_PARAMETER 3
-#define IE_EXTENDED_RATES 50
-#define IE_HT_CAPABILITIES 45
-#define IE_VHT_CAPABILITIES 191
-#define IE_HE_CAPABILITIES 255
-#define IE_VENDOR_SPECIFIC 221
-
-// Frequency band definitions
-#define FREQ_2_4GHZ_BASE 2412
-#define CHANNEL_TO_FREQ(ch) (FREQ_2_4GHZ_BASE + ((ch - 1) * 5))
-
-// Estruturas para dados dos probe requests
-typedef struct {
-  uint8_t id;
-  uint8_t len;
-  uint8_t value[64]; // Reduzido de 255 para 64
-} information_element_t;
-
-typedef struct {
-  uint8_t oui[3];
-  uint8_t vendor_type;
-  uint8_t payload[64]; // Reduzido de 252 para 64
-  uint8_t payload_len;
-  String meaning;
-} vendor_ie_t;
-
-typedef struct {
-  uint8_t da[6];      // destination address
-  uint8_t sa[6];      // source address
-  uint8_t bssid[6];   // BSSID
-  uint16_t duration;
-  uint16_t seq_ctrl;
-  String type;
-  String subtype;
-} ieee80211_info_t;
+// Lote de saída por worker; 0 escreve cada registro direto no transporte.
+// Registros maiores que o lote também vão direto. No máximo GATEWAY_RECORD_MAX
+// (4096) com o sink ESP-NOW: o gateway remonta cada write() como um registro.
+#ifndef OUTPUT_BATCH_SIZE
+#if PROBE_WORKER_COUNT > 1
+#define OUTPUT_BATCH_SIZE 4096         // ~2 registros JSON ou ~15 binários
+#else
+#define OUTPUT_BATCH_SIZE 0
+#endif
+#endif
 
-typedef struct {
-  uint8_t channel;
-  uint16_t freq_mhz;
-  String band;
-  uint8_t bandwidth_mhz;
-  uint8_t antenna;
-} radio_info_t;
+// Filtro do driver no modo promíscuo (esp_wifi_set_promiscuous_filter). O driver não
+// oferece filtro por subtipo de management: PROBE_REQ descarta os demais subtipos no
+// primeiro byte do frame control, antes de qualquer outro trabalho no callback.
+#define CAPTURE_RX_FILTER_ALL 0        // todos os tipos (referência da carga de callbacks)
+#define CAPTURE_RX_FILTER_MGMT 1       // apenas management (padrão)
+#define CAPTURE_RX_FILTER_PROBE_REQ 2  // management no driver + só probe requests no callback
+#ifndef CAPTURE_RX_FILTER
+#define CAPTURE_RX_FILTER CAPTURE_RX_FILTER_MGMT
+#endif
 
-typedef struct {
-  String ssid;
-  bool ssid_hidden;
-} probe_info_t;
+// Formato de saída dos probe requests (selecionado em tempo de compilação)
+#define OUTPUT_FORMAT_JSON 0    // um documento JSON por linha (padrão)
+#define OUTPUT_FORMAT_BINARY 1  // registros binários enquadrados (ver wire_format.h)
+#define OUTPUT_FORMAT_PCAP 2    // todo frame management bruto em registros pcap/radiotap, sem parsing
+#ifndef OUTPUT_FORMAT
+#define OUTPUT_FORMAT OUTPUT_FORMAT_JSON
+#endif
 
-typedef struct {
-  bool present;
-  String mcs_set;
-} ht_capabilities_t;
+// No formato binário, probes repetidos de um dispositivo (mesmo SA e IEs, só
+// canal, RSSI, seq_ctrl e instante mudam) saem como registros delta de 17
+// bytes em vez do registro completo; 0 emite sempre o registro completo
+#ifndef OUTPUT_BINARY_DELTA
+#define OUTPUT_BINARY_DELTA 1
+#endif
+#define OUTPUT_DELTA_ENABLED (OUTPUT_FORMAT == OUTPUT_FORMAT_BINARY && OUTPUT_BINARY_DELTA)
+#if OUTPUT_DELTA_ENABLED && PROBE_WORKER_COUNT * WIRE_DELTA_SLOTS >= WIRE_DELTA_REF_NONE
+#error "PROBE_WORKER_COUNT * WIRE_DELTA_SLOTS excede as referências delta de 8 bits"
+#endif
 
-typedef struct {
-  uint8_t supported_rates[16];
-  uint8_t extended_rates[16];
-  uint8_t supported_rates_count;
-  uint8_t extended_rates_count;
-  ht_capabilities_t ht_capabilities;
-  bool vht_capabilities;
-  bool he_capabilities;
-} capabilities_info_t;
+// Modo de saída: cada probe individual ou um registro agregado por dispositivo por janela
+#define OUTPUT_MODE_FRAMES 0
+#define OUTPUT_MODE_AGGREGATE 1
+#ifndef OUTPUT_MODE
+#define OUTPUT_MODE OUTPUT_MODE_FRAMES
+#endif
+#ifndef AGGREGATION_WINDOW_MS
+#define AGGREGATION_WINDOW_MS 60000  // janela de agregação "device seen"
+#endif
+#if OUTPUT_SINK == OUTPUT_SINK_ESPNOW && OUTPUT_FORMAT != OUTPUT_FORMAT_BINARY && OUTPUT_MODE != OUTPUT_MODE_AGGREGATE
+#error "OUTPUT_SINK_ESPNOW requer OUTPUT_FORMAT_BINARY ou OUTPUT_MODE_AGGREGATE (a fila guarda um ciclo de canais)"
+#endif
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_PCAP && OUTPUT_MODE != OUTPUT_MODE_FRAMES
+#error "OUTPUT_FORMAT_PCAP não faz parsing: use OUTPUT_MODE_FRAMES"
+#endif
 
-typedef struct {
-  String ie_signature;
-  float confidence;
-} fingerprint_t;
+// Resumo por janela em memória fixa (ver window_sketch.h): MACs e fingerprints
+// distintos (HyperLogLog) e top-N de talkers e SSIDs (Space-Saving), em
+// qualquer OUTPUT_MODE e sem depender da capacidade do cache de dispositivos.
+// Cada worker alterna entre dois sketches; a loop() junta os fechados e emite
+// "# SUMMARY:". 0 desabilita.
+#ifndef SUMMARY_WINDOW_MS
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_PCAP
+#define SUMMARY_WINDOW_MS 0  // sem parsing não há o que resumir
+#else
+#define SUMMARY_WINDOW_MS 60000
+#endif
+#endif
+#ifndef SUMMARY_TOP_N
+#define SUMMARY_TOP_N 10
+#endif
 
-typedef struct {
-  String pkt_id;
-  radio_info_t radio;
-  ieee80211_info_t ieee80211;
-  int8_t rssi_dbm;
-  String frame_raw_hex;
-  probe_info_t probe;
-  capabilities_info_t capabilities;
-  vendor_ie_t vendor_ies[MAX_VENDOR_IES];
-  uint8_t vendor_ies_count;
-  information_element_t ies_raw[MAX_IES];
-  uint8_t ies_count;
-  bool mac_randomized;
-  String oui;
-  String vendor_inferred;
-  fingerprint_t fingerprint;
-} packet_data_t;
+// Correlação de MACs randomizados (ver track_correlator.h): cada probe recebe o
+// track_id da trilha do dispositivo (packet.track_id no JSON, track_id nos
+// registros binários e nos agregados). A tabela é única e compartilhada pelos
+// workers, já que o SA novo de um dispositivo pode cair no outro worker; com
+// PROBE_WORKER_COUNT 2 o acesso é serializado por um spinlock. 0 desabilita.
+#ifndef TRACK_CORRELATION_ENABLED
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_PCAP
+#define TRACK_CORRELATION_ENABLED 0  // sem parsing não há fingerprint
+#else
+#define TRACK_CORRELATION_ENABLED 1
+#endif
+#endif
 
-typedef struct {
-  String capture_id;
-  String capture_ts;
-  String scanner_id;
-  String firmware;
-  packet_data_t packet;
-} capture_data_t;
+// Replay de frames gravados (comando REPLAY, ver frame_replay.h) para teste de
+// carga em bancada: uma task no core do driver chama wifi_promiscuous_rx()
+// com o corpus de test/corpus (flash) ou o recebido por REPLAY ADD, na taxa
+// pedida. A captura real fica pausada durante a execução (o ring é SPSC).
+#ifndef REPLAY_ENABLED
+#define REPLAY_ENABLED 0
+#endif
+#define REPLAY_TASK_CORE 0             // mesmo core da task do driver WiFi
+#define REPLAY_TASK_PRIORITY 3         // acima dos workers, como o driver
+#define REPLAY_TASK_STACK_SIZE 4096
+#define REPLAY_BURST_MAX 64            // frames por tick (1 ms): teto da taxa e do "REPLAY MAX"
+#define REPLAY_POOL_SIZE 16384         // bytes dos frames de REPLAY ADD
+#define REPLAY_FRAME_MAX 1600          // maior frame injetado (rx_ctrl.sig_len)
+#define REPLAY_DEFAULT_DEVICES 256
+#define REPLAY_DRAIN_TIMEOUT_MS 2000   // espera pelos rings vazios antes do relatório
 
-typedef struct {
-  unsigned frame_ctrl:16;
-  unsigned duration_id:16;
-  uint8_t addr1[6]; // receiver address
-  uint8_t addr2[6]; // sender address
-  uint8_t addr3[6]; // filtering address
-  unsigned sequence_ctrl:16;
-  uint8_t addr4[6]; // optional
-} wifi_ieee80211_mac_hdr_t;
+// Configurações específicas para ESP32-32U com antena externa
+#ifdef ESP32_32U_EXTERNAL_ANTENNA
+  #define WIFI_ANT_SWITCH_GPIO 0          // GPIO para controle de switch de antena
+  #define WIFI_MAX_TX_POWER 78            // Potência máxima (19.5 dBm = 78/4)
+  #define WIFI_RX_SENSITIVITY_2_4G -96    // Sensibilidade melhorada com antena externa
+#else
+  #define WIFI_MAX_TX_POWER 68            // Potência padrão (17 dBm = 68/4)
+  #define WIFI_RX_SENSITIVITY_2_4G -88    // Sensibilidade padrão
+#endif
 
+// Contadores de descarte por motivo (queue_full fica em frame_ring.dropped)
 typedef struct {
-  wifi_ieee80211_mac_hdr_t hdr;
-  uint8_t payload[0]; // network data ended with 4 bytes csum (CRC32)
-} wifi_ieee80211_packet_t;
+  unsigned long truncated;   // frame menor que o cabeçalho 802.11
+} capture_drops_t;
 
 // Estatísticas do sistema
 typedef struct {
-  unsigned long total_packets;
+  unsigned long rx_callbacks[4]; // callbacks do driver por wifi_promiscuous_pkt_type_t (mgmt, ctrl, data, misc)
+  unsigned long total_packets;   // frames management
   unsigned long probe_requests;
-  unsigned long unique_devices;
+  unsigned long probes_queued;
+  unsigned long frames_clipped;  // frames maiores que FRAME_RING_SLOT_SIZE (enfileirados truncados)
+  unsigned long json_overflows;  // linhas da loop() (STATS, PERF, SUMMARY) maiores que o buffer; workers em probe_worker_t
+  capture_drops_t drops;
   unsigned long uptime_ms;
   uint8_t current_channel;
+  // Trocas de canal pelo esp_timer
+  unsigned long hops;
+  uint32_t last_hop_us;           // esp_timer_get_time() da última troca (us, 32 bits)
+  uint32_t hop_jitter_max_us;     // maior desvio entre dwell real e alvo
 } system_stats_t;
 
+// Estado de um worker de parsing; escrito apenas pela própria task (exceto o
+// produtor do ring), lido sem lock pelo STATS
+typedef struct {
+  uint8_t index;
+  uint8_t core;
+  TaskHandle_t handle;
+  frame_ring_t ring;
+  device_cache_t cache;          // dispositivos cujo SA cai neste worker
+  capture_data_t capture;
+  char json[JSON_BUFFER_SIZE];
+#if OUTPUT_DELTA_ENABLED
+  wire_delta_t delta;            // keyframes por dispositivo; referências a partir de index * WIRE_DELTA_SLOTS
+#endif
+#if OUTPUT_BATCH_SIZE > 0
+  uint8_t batch[OUTPUT_BATCH_SIZE];
+  size_t batch_len;
+  uint32_t batch_records;
+  unsigned long batches;
+#endif
+  unsigned long probes_parsed;
+  unsigned long json_overflows;  // registros descartados por excederem JSON_BUFFER_SIZE
+  unsigned long ies_truncated;   // frames com mais IEs do que IE_PARSER_MAX_IES
+  unsigned long ies_malformed;   // frames cujo último IE ultrapassa o fim
+  uint64_t busy_us;              // tempo processando frames (utilização do core)
+  hll_t macs_seen;               // SAs distintos desde o boot (unique_devices do STATS)
+#if PERF_ENABLED
+  int64_t frame_rx_timer_us;     // chegada (esp_timer) do frame em process_frame(); 0 fora dele
+  int64_t batch_rx_timer_us;     // chegada do registro mais antigo do lote
+#endif
+#if SUMMARY_WINDOW_MS > 0
+  window_sketch_t sketches[2];   // janela corrente e a última fechada
+  uint8_t sketch_current;
+  std::atomic<const window_sketch_t*> sketch_closed;  // publicado para a loop()
+#endif
+} probe_worker_t;
+
 // Protótipos de funções
 void wifi_init_promiscuous();
+const char* capture_rx_filter_name();
 void wifi_promiscuous_rx(void* buf, wifi_promiscuous_pkt_type_t type);
-void parse_probe_request(const uint8_t* frame, size_t len, int8_t rssi, uint8_t channel);
-void extract_information_elements(const uint8_t* payload, size_t payload_len, packet_data_t& packet);
-String extract_ssid(const uint8_t* payload, size_t payload_len);
-void extract_supported_rates(const uint8_t* payload, size_t payload_len, capabilities_info_t& capabilities);
-void extract_vendor_ies(const uint8_t* payload, size_t payload_len, packet_data_t& packet);
-String frame_to_hex(const uint8_t* frame, size_t len);
-String mac_to_string(const uint8_t* mac);
-String generate_packet_id();
-String generate_capture_id();
-String get_iso8601_timestamp();
-void print_capture_data(const capture_data_t& capture);
+uint8_t probe_worker_for(const uint8_t* sa);
+void probe_worker_task(void* arg);
+void process_frame(probe_worker_t* worker, const frame_slot_t* slot);
+void worker_output(probe_worker_t* worker, const uint8_t* data, size_t len);
+void worker_flush(probe_worker_t* worker);
+void generate_capture_id(char* out);
+void print_capture_data(probe_worker_t* worker, const capture_data_t& capture);
+void print_capture_binary(probe_worker_t* worker, const capture_data_t& capture);
+void print_capture_pcap(probe_worker_t* worker, const frame_slot_t* slot);
+void print_session_binary();
+void print_device_record(void* ctx, const device_entry_t* entry, uint32_t window_start_ms);
+bool alloc_capture_buffers();
+void health_boot();
+void health_check(uint32_t now_ms);
+void health_restart(uint8_t trigger);
+const char* reset_reason_name(esp_reset_reason_t reason);
+void channel_scheduler_setup();
+uint8_t build_channel_plan(uint8_t* channels);
+void cmd_node(const char* args);
+void cmd_cluster(const char* args);
+void print_cluster_status();
+void cmd_filter(const char* args);
+void print_filter_status();
+void cmd_log(const char* args);
+void cmd_time(const char* args);
+int64_t rx_to_epoch_us(uint32_t rx_us);
+void time_sync_apply(int64_t epoch_us, int64_t timer_us, uint8_t source);
+void time_sync_poll(uint32_t now_ms);
+void print_time_anchor();
+void pps_isr();
+void channel_hop_timer_cb(void* arg);
 void switch_channel();
 void print_system_stats();
-bool is_randomized_mac(const uint8_t* mac);
-String get_vendor_from_mac(const uint8_t* mac);
-String create_fingerprint(const packet_data_t& packet);
+void print_perf_stats();
+void worker_sketch_roll(probe_worker_t* worker, uint32_t now_ms);
+void print_window_summary();
+void replay_setup();
+void replay_poll();
+void cmd_replay(const char* args);
+
 
 #endif // WIFI_PROBE_MONITOR_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef WINDOW_SKETCH_H
+#define WINDOW_SKETCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Resumos de memória fixa por janela de tempo, independentes do tamanho da
+// multidão (o cache de dispositivos transborda em locais densos):
+//
+//   HyperLogLog   estimativa de cardinalidade (MACs e fingerprints distintos)
+//                 com 2^HLL_PRECISION registradores de 1 byte; erro padrão
+//                 de 1.04 / sqrt(2^p) (3.3% com p = 10)
+//   Space-Saving  top-N (MACs que mais enviam probes, SSIDs mais procurados)
+//                 com SKETCH_TOPK_CAPACITY contadores; todo item com mais de
+//                 total / capacidade ocorrências está na lista, e o count de
+//                 cada entrada excede o real em no máximo error
+//
+// Ambos se combinam entre instâncias (HLL: máximo por registrador; top-N:
+// soma por chave), então cada worker de parsing mantém os seus sem locks.
+
+#ifndef HLL_PRECISION
+#define HLL_PRECISION 10
+#endif
+#define HLL_REGISTERS (1u << HLL_PRECISION)
+
+#if HLL_PRECISION < 4 || HLL_PRECISION > 16
+#error "HLL_PRECISION deve estar entre 4 e 16"
+#endif
+
+#ifndef SKETCH_TOPK_CAPACITY
+#define SKETCH_TOPK_CAPACITY 32
+#endif
+#define SKETCH_LABEL_MAX 32   // SSID (até 32 bytes) ou MAC (6 bytes)
+
+typedef struct {
+  uint8_t registers[HLL_REGISTERS];
+} hll_t;
+
+typedef struct {
+  uint32_t key;         // hash do rótulo (comparação rápida)
+  uint32_t count;
+  uint32_t error;       // superestimativa máxima de count
+  uint8_t label_len;
+  uint8_t label[SKETCH_LABEL_MAX];
+} topk_entry_t;
+
+typedef struct {
+  uint8_t used;
+  topk_entry_t entries[SKETCH_TOPK_CAPACITY];
+} topk_t;
+
+typedef struct {
+  uint32_t window_id;     // 1 + índice da janela (0: nunca usado)
+  uint32_t probes;
+  hll_t macs;
+  hll_t fingerprints;
+  topk_t talkers;         // rótulo: SA (6 bytes)
+  topk_t ssids;           // rótulo: SSID decodificado, sem wildcard
+} window_sketch_t;
+
+// Espalha os bits de um hash FNV (fraco nos bits altos) antes do HLL
+uint32_t sketch_mix32(uint32_t h);
+
+void hll_clear(hll_t* hll);
+void hll_add(hll_t* hll, uint32_t hash);
+void hll_merge(hll_t* dst, const hll_t* src);
+uint32_t hll_estimate(const hll_t* hll);
+float hll_std_error();
+
+void topk_clear(topk_t* topk);
+void topk_add(topk_t* topk, const uint8_t* label, uint8_t label_len);
+
+// Combina as listas de count instâncias em out (ordem decrescente de count,
+// chaves repetidas somadas); retorna quantas entradas foram escritas
+size_t topk_collect(const topk_t* const* sketches, uint8_t count, topk_entry_t* out, size_t out_cap);
+
+void window_sketch_reset(window_sketch_t* sketch, uint32_t window_id);
+void window_sketch_observe(window_sketch_t* sketch, const uint8_t* sa, uint32_t fp_hash,
+                           const char* ssid, uint8_t ssid_len);
+
+#endif // WINDOW_SKETCH_H
@@ -0,0 +1,243 @@
+#ifndef WIRE_FORMAT_H
+#define WIRE_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Formato binário compacto de saída (alternativa ao JSON por pacote)
+//
+// Enquadramento no link serial:
+//   0x00 | COBS( registro || crc16 ) | 0x00
+//
+// O COBS garante que o registro codificado nunca contém 0x00, então o
+// delimitador separa registros de forma inequívoca mesmo com linhas de texto
+// (ex: "# STATS: ...") intercaladas. O CRC-16/CCITT-FALSE (little-endian) cobre
+// todo o registro. Todos os campos multibyte são little-endian.
+//
+// Registro de sessão (WIRE_RECORD_SESSION), enviado no boot e junto com as
+// estatísticas periódicas para que o host possa sincronizar a qualquer momento:
+//   u8  type, u8 version
+//   u32 epoch_s          timestamp unix no momento da emissão
+//   u32 uptime_ms        millis() no momento da emissão
+//   u8  len + capture_id
+//   u8  len + scanner_id
+//   u8  len + firmware
+//
+// Registro de pacote (WIRE_RECORD_PACKET), layout fixo + blob de IEs:
+//   u8  type, u8 version
+//   u32 pkt_seq          contador de pacotes da sessão
+//   u32 epoch_s          derivado de rx_us pelo modelo de tempo do nó
+//   u16 epoch_ms
+//   u8  channel
+//   i8  rssi_dbm
+//   u16 frame_ctrl
+//   u16 duration
+//   u8  addr1[6]         DA
+//   u8  addr2[6]         SA
+//   u8  addr3[6]         BSSID
+//   u16 seq_ctrl         campo completo (sequência << 4 | fragmento)
+//   u32 fp_hash          fingerprint de IEs (a partir da versão 2)
+//   u32 dwell_id         dwell do escalonador de canais (a partir da versão 3)
+//   u32 rx_us            rx_ctrl.timestamp bruto (a partir da versão 4; epoch
+//                        preciso no host pelas âncoras "# TIME:", ver time_sync.h)
+//   u8  delta_ref        referência para registros delta seguintes (a partir da
+//                        versão 5; WIRE_DELTA_REF_NONE = keyframe não referenciável)
+//   u32 track_id         trilha do dispositivo (a partir da versão 6; 0 = sem
+//                        correlação, ver track_correlator.h)
+//   u16 ies_len
+//   u8  ies[ies_len]     tagged parameters do frame, sem o FCS
+//
+// Registro delta (WIRE_RECORD_DELTA): repetição de um pacote com o mesmo SA,
+// cabeçalho (frame_ctrl, duration, addr1, addr3), track_id e IEs idênticos aos do último
+// pacote com delta_ref igual (o keyframe). Carrega só o que muda entre os
+// probes de uma rajada; os demais campos vêm do keyframe:
+//   u8  type, u8 version
+//   u8  delta_ref
+//   u16 key_seq          16 bits baixos do pkt_seq do keyframe (o host descarta
+//                        o delta se o keyframe que tem para a referência for outro)
+//   u16 seq_offset       pkt_seq - pkt_seq do keyframe
+//   u32 rx_offset_us     rx_us - rx_us do keyframe (epoch = do keyframe + offset)
+//   u16 dwell_offset     dwell_id - dwell_id do keyframe
+//   u8  channel
+//   i8  rssi_dbm
+//   u16 seq_ctrl
+//
+// Registro agregado de dispositivo (WIRE_RECORD_DEVICE), um por dispositivo
+// por janela no modo OUTPUT_MODE_AGGREGATE:
+//   u8  type, u8 version
+//   u32 window_start_s   epoch do início da janela
+//   u32 first_seen_s     epoch da primeira observação na janela
+//   u32 last_seen_s      epoch da última observação
+//   u8  sa[6]
+//   u32 fp_hash
+//   u32 count            probes na janela
+//   i8  rssi_min, i8 rssi_max, i8 rssi_avg
+//   u16 channels_mask    bit n = canal n
+//   u8  flags            bit 0 = MAC randomizado
+//   u32 track_id         trilha do último probe na janela (a partir da versão 6)
+//
+// Registro pcap (WIRE_RECORD_PCAP), modo OUTPUT_FORMAT_PCAP: o corpo após
+// type/version é um registro pcap completo (linktype 127, radiotap), que o
+// extrator do host (tools/pcap_extract.py) copia para o arquivo .pcap:
+//   u8  type, u8 version
+//   u32 ts_sec, u32 ts_usec   epoch derivado de rx_us
+//   u32 incl_len              radiotap + bytes capturados
+//   u32 orig_len              radiotap + tamanho do frame no ar (com FCS)
+//   radiotap (WIRE_RADIOTAP_SIZE bytes): TSFT = rx_us, flags = FCS no fim
+//                             (só sem corte, incl_len == orig_len),
+//                             canal (MHz, 2 GHz), sinal em dBm
+//   u8  frame[]               frame 802.11 como entregue pelo driver
+
+// Registro de origem (WIRE_RECORD_SOURCE), inserido pelo gateway ESP-NOW
+// antes dos registros repassados de um nó quando a origem muda. Registros de
+// pacote e delta não carregam o nó: o host mantém sessão e keyframes por
+// origem e usa os da última origem anunciada (sem registro de origem, o
+// stream inteiro é de um nó só):
+//   u8  type, u8 version
+//   u8  src[6]           MAC ESP-NOW do nó
+//   u32 session          session do datagrama (FNV-1a do capture_id do nó)
+
+#define WIRE_FORMAT_VERSION 6
+
+#define WIRE_RECORD_SESSION 0x01
+#define WIRE_RECORD_PACKET  0x02
+#define WIRE_RECORD_DEVICE  0x03
+#define WIRE_RECORD_DELTA   0x04
+#define WIRE_RECORD_PCAP    0x05
+#define WIRE_RECORD_SOURCE  0x06
+
+#define WIRE_PACKET_HEADER_SIZE 57
+#define WIRE_DEVICE_RECORD_SIZE 38
+#define WIRE_DELTA_RECORD_SIZE 17
+#define WIRE_SOURCE_RECORD_SIZE 12
+#define WIRE_RADIOTAP_SIZE 23
+#define WIRE_PCAP_HEADER_SIZE (2 + 16 + WIRE_RADIOTAP_SIZE)
+#define WIRE_PCAP_LINKTYPE_RADIOTAP 127
+#define WIRE_CRC_SIZE 2
+
+#define WIRE_DEVICE_FLAG_RANDOMIZED 0x01
+
+// Tamanho máximo de um registro enquadrado: overhead do COBS (1 byte a cada
+// 254) + CRC + dois delimitadores
+#define WIRE_FRAMED_SIZE(record_len) \
+  ((record_len) + WIRE_CRC_SIZE + ((record_len) + WIRE_CRC_SIZE) / 254 + 1 + 2)
+
+typedef struct {
+  uint32_t pkt_seq;
+  uint32_t epoch_s;
+  uint16_t epoch_ms;
+  uint8_t channel;
+  int8_t rssi_dbm;
+  uint16_t frame_ctrl;
+  uint16_t duration;
+  uint8_t addr1[6];
+  uint8_t addr2[6];
+  uint8_t addr3[6];
+  uint16_t seq_ctrl;
+  uint32_t fp_hash;
+  uint32_t dwell_id;
+  uint32_t rx_us;
+  uint8_t delta_ref;
+  uint32_t track_id;
+} wire_packet_header_t;
+
+typedef struct {
+  uint32_t epoch_s;
+  uint32_t uptime_ms;
+  const char* capture_id;
+  const char* scanner_id;
+  const char* firmware;
+} wire_session_t;
+
+typedef struct {
+  uint32_t window_start_s;
+  uint32_t first_seen_s;
+  uint32_t last_seen_s;
+  uint8_t sa[6];
+  uint32_t fp_hash;
+  uint32_t count;
+  int8_t rssi_min;
+  int8_t rssi_max;
+  int8_t rssi_avg;
+  uint16_t channels_mask;
+  uint8_t flags;
+  uint32_t track_id;
+} wire_device_t;
+
+// Codificador delta por dispositivo (um por worker; as referências de cada um
+// começam em ref_base). Mapeamento direto pelo hash do SA: um dispositivo que
+// colide com outro apenas volta a emitir keyframes. Keyframe a cada
+// WIRE_DELTA_KEYFRAME_INTERVAL deltas ou WIRE_DELTA_KEYFRAME_US, para que um
+// host que conecte (ou perca registros) no meio do stream ressincronize.
+#define WIRE_DELTA_REF_NONE 0xFF
+#ifndef WIRE_DELTA_SLOTS
+#define WIRE_DELTA_SLOTS 64
+#endif
+#ifndef WIRE_DELTA_KEYFRAME_INTERVAL
+#define WIRE_DELTA_KEYFRAME_INTERVAL 16
+#endif
+#ifndef WIRE_DELTA_KEYFRAME_US
+#define WIRE_DELTA_KEYFRAME_US 10000000
+#endif
+
+typedef struct {
+  bool valid;
+  uint8_t deltas;          // deltas desde o keyframe
+  uint16_t ies_len;
+  uint32_t ies_hash;       // FNV-1a do blob de IEs completo (inclui o SSID)
+  uint16_t frame_ctrl;
+  uint16_t duration;
+  uint8_t addr1[6];
+  uint8_t addr2[6];
+  uint8_t addr3[6];
+  uint32_t track_id;
+  uint32_t key_seq;
+  uint32_t key_rx_us;
+  uint32_t key_dwell_id;
+} wire_delta_slot_t;
+
+typedef struct {
+  uint8_t ref_base;
+  uint32_t keyframes;
+  uint32_t deltas;
+  wire_delta_slot_t slots[WIRE_DELTA_SLOTS];
+} wire_delta_t;
+
+typedef struct {
+  uint8_t src[6];
+  uint32_t session;
+} wire_source_t;
+
+typedef struct {
+  uint32_t ts_sec;
+  uint32_t ts_usec;
+  uint32_t rx_us;
+  uint16_t freq_mhz;
+  int8_t rssi_dbm;
+  uint16_t orig_len;        // frame no ar, incluindo o FCS (>= len capturado)
+} wire_pcap_t;
+
+uint16_t wire_crc16(const uint8_t* data, size_t len);
+
+// Serializa os registros em out (sem CRC nem enquadramento).
+// Retornam o tamanho escrito ou 0 se out_size for insuficiente.
+size_t wire_encode_session(uint8_t* out, size_t out_size, const wire_session_t* session);
+size_t wire_encode_packet(uint8_t* out, size_t out_size, const wire_packet_header_t* header,
+                          const uint8_t* ies, uint16_t ies_len);
+size_t wire_encode_device(uint8_t* out, size_t out_size, const wire_device_t* device);
+
+size_t wire_encode_pcap(uint8_t* out, size_t out_size, const wire_pcap_t* pcap,
+                        const uint8_t* frame, uint16_t frame_len);
+size_t wire_encode_source(uint8_t* out, size_t out_size, const wire_source_t* source);
+
+void wire_delta_init(wire_delta_t* delta, uint8_t ref_base);
+// Registro delta se o pacote repete o keyframe do dispositivo; senão um
+// registro de pacote completo que passa a ser o keyframe (header->delta_ref
+// é ignorado)
+size_t wire_encode_packet_delta(wire_delta_t* delta, uint8_t* out, size_t out_size,
+                                const wire_packet_header_t* header, const uint8_t* ies, uint16_t ies_len);
+
+// Anexa CRC, aplica COBS e delimitadores. Retorna o tamanho final ou 0.
+size_t wire_frame(const uint8_t* record, size_t record_len, uint8_t* out, size_t out_size);
+
+#endif // WIRE_FORMAT_H
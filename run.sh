@@ -14,6 +14,29 @@ exit_if_fail() {
 LOGNAME="./data/raw/probe_data_$(date +%Y%m%d_%H%M%S).log"
 SILENT="--silent"
 
+# Formato binário (-DOUTPUT_FORMAT=OUTPUT_FORMAT_BINARY) precisa do stream bruto;
+# o filtro "printable" removeria os delimitadores dos registros
+MONITOR_FILTER="--filter printable"
+ENV_CONFIG=$(platformio project config 2>/dev/null | sed -n "/^env:$1\$/,/^env:/p")
+if echo "$ENV_CONFIG" | grep -q "OUTPUT_FORMAT_BINARY"; then
+    MONITOR_FILTER="--raw"
+fi
+
+# Modo pcap (-DOUTPUT_FORMAT=OUTPUT_FORMAT_PCAP): o stream bruto vira um .pcap
+# em data/raw/ durante a captura; o texto intercalado fica no .log
+PCAPNAME=""
+if echo "$ENV_CONFIG" | grep -q "OUTPUT_FORMAT_PCAP"; then
+    MONITOR_FILTER="--raw"
+    PCAPNAME="${LOGNAME%.log}.pcap"
+fi
+
+# Velocidade do monitor = monitor_speed do ambiente (o firmware usa o mesmo valor em OUTPUT_BAUD)
+MONITOR_SPEED=$(platformio project config --json-output 2>/dev/null | python3 -c '
+import json, sys
+sections = {name: dict(options) for name, options in json.load(sys.stdin)}
+env = sections.get("env:" + sys.argv[1], {})
+print(env.get("monitor_speed", sections.get("env", {}).get("monitor_speed", 115200)))' "$1")
+
 echo "=== ESP32 WiFi Probe Monitor ==="
 echo "Checking for Python venv..."
 if [ ! -d "./.venv" ]; then
@@ -46,13 +69,25 @@ MONITOR_PID=$!
 # Trap to kill background process when script exits
 trap "kill $MONITOR_PID 2>/dev/null" EXIT
 
-echo "Starting serial port monitoring..."
+echo "Starting serial port monitoring at ${MONITOR_SPEED} baud..."
 echo "Monitoring WiFi probes... Press CTRL+C to stop capture and analyze data."
-platformio device monitor --environment $1 --quiet --filter printable > "$LOGNAME"
+if [ -n "$PCAPNAME" ]; then
+    echo "Writing radiotap capture to $PCAPNAME (open it in Wireshark)"
+    platformio device monitor --environment $1 --baud $MONITOR_SPEED --quiet $MONITOR_FILTER \
+        | python3 ./tools/pcap_extract.py - "$PCAPNAME" --text "$LOGNAME"
+    exit 0
+fi
+platformio device monitor --environment $1 --baud $MONITOR_SPEED --quiet $MONITOR_FILTER > "$LOGNAME"
 
 echo "=== RUN PROBE ANALYSIS ==="
 if [ -s "$LOGNAME" ]; then
-    python ./tools/analyze_probes.py "$LOGNAME"
+    # Com o probe_ingest compilado (tools/ingest), a análise lê o arquivo colunar
+    INGEST=./tools/ingest/build/probe_ingest
+    if [ -x "$INGEST" ] && "$INGEST" "$LOGNAME"; then
+        python ./tools/analyze_probes.py "${LOGNAME%.log}.pcol"
+    else
+        python ./tools/analyze_probes.py "$LOGNAME"
+    fi
 else
     echo "Log file is empty or not found. Skipping analysis."
 fi
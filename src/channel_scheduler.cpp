@@ -0,0 +1,108 @@
+#include "channel_scheduler.h"
+
+void channel_scheduler_init(channel_scheduler_t* sched, uint8_t mode, const uint8_t* channels,
+                            uint8_t count, uint32_t fixed_dwell_ms, uint32_t now_ms) {
+  if (count > CHANNEL_SCHED_MAX_CHANNELS) count = CHANNEL_SCHED_MAX_CHANNELS;
+
+  sched->mode = mode;
+  sched->count = count;
+  sched->index = 0;
+  sched->fixed_dwell_ms = fixed_dwell_ms;
+  for (uint8_t i = 0; i < count; i++) {
+    channel_stats_t* st = &sched->stats[i];
+    st->channel = channels[i];
+    st->rate_ewma = 0;
+    st->probes = 0;
+    st->dwell_ms = 0;
+    st->visits = 0;
+    st->last_dwell_id = 0;
+  }
+  sched->dwell_probes.store(0, std::memory_order_relaxed);
+  sched->dwell_state.store(count > 0 ? channels[0] : 0, std::memory_order_relaxed);
+  sched->late_frames = 0;
+  sched->dwell_start_ms = now_ms;
+  sched->dwell_target_ms = channel_scheduler_dwell_for(sched, 0);
+}
+
+uint32_t channel_scheduler_dwell_for(const channel_scheduler_t* sched, uint8_t index) {
+  if (sched->mode != CHANNEL_SCHED_ADAPTIVE || sched->count == 0) {
+    return sched->fixed_dwell_ms;
+  }
+
+  uint32_t explore_ms = (uint32_t)CHANNEL_SCHED_CYCLE_MS * CHANNEL_SCHED_EXPLORE_PCT / 100;
+  uint32_t weighted_ms = CHANNEL_SCHED_CYCLE_MS - explore_ms;
+
+  uint64_t total_rate = 0;
+  for (uint8_t i = 0; i < sched->count; i++) {
+    total_rate += sched->stats[i].rate_ewma;
+  }
+
+  uint32_t dwell;
+  if (total_rate == 0) {
+    // Sem tráfego observado ainda: divisão igual do ciclo
+    dwell = CHANNEL_SCHED_CYCLE_MS / sched->count;
+  } else {
+    dwell = explore_ms / sched->count +
+            (uint32_t)((uint64_t)weighted_ms * sched->stats[index].rate_ewma / total_rate);
+  }
+
+  return dwell < CHANNEL_SCHED_MIN_DWELL_MS ? CHANNEL_SCHED_MIN_DWELL_MS : dwell;
+}
+
+uint32_t channel_scheduler_advance(channel_scheduler_t* sched, uint32_t now_ms) {
+  if (sched->count == 0) return sched->fixed_dwell_ms;
+
+  // Fechar o dwell atual e atualizar a taxa do canal
+  uint32_t elapsed = now_ms - sched->dwell_start_ms;
+  channel_stats_t* st = &sched->stats[sched->index];
+  uint32_t probes = sched->dwell_probes.exchange(0, std::memory_order_relaxed);
+  st->probes += probes;
+  st->dwell_ms += elapsed;
+
+  if (elapsed > 0) {
+    uint32_t rate = (uint32_t)((uint64_t)probes * 1000 * 256 / elapsed);
+    if (st->visits == 0) {
+      st->rate_ewma = rate;
+    } else {
+      int32_t delta = (int32_t)(rate - st->rate_ewma);
+      st->rate_ewma += delta / (1 << CHANNEL_SCHED_EWMA_SHIFT);
+    }
+  }
+  st->visits++;
+
+  // Frames do canal antigo que chegarem depois daqui (inclusive antes do
+  // esp_wifi_set_channel) caem em late_frames com o dwell_id anterior
+  uint32_t id = (channel_scheduler_dwell_id(sched) + 1) & 0xFFFFFF;
+  sched->index = (sched->index + 1) % sched->count;
+  sched->stats[sched->index].last_dwell_id = id;
+  sched->dwell_state.store((id << 8) | sched->stats[sched->index].channel, std::memory_order_release);
+  sched->dwell_start_ms = now_ms;
+  sched->dwell_target_ms = channel_scheduler_dwell_for(sched, sched->index);
+
+  return sched->dwell_target_ms;
+}
+
+void channel_scheduler_reconfigure(channel_scheduler_t* sched, const uint8_t* channels,
+                                   uint8_t count, uint32_t now_ms) {
+  uint32_t id = (channel_scheduler_dwell_id(sched) + 1) & 0xFFFFFF;
+  uint32_t late = sched->late_frames;
+
+  channel_scheduler_init(sched, sched->mode, channels, count, sched->fixed_dwell_ms, now_ms);
+
+  sched->late_frames = late;
+  sched->stats[0].last_dwell_id = id;
+  sched->dwell_state.store((id << 8) | sched->stats[0].channel, std::memory_order_release);
+}
+
+uint8_t channel_plan_partition(const uint8_t* source, uint8_t source_count,
+                               uint8_t cluster_index, uint8_t cluster_size, uint8_t* out) {
+  if (cluster_size == 0) cluster_size = 1;
+
+  uint8_t count = 0;
+  for (uint8_t p = 0; p < source_count && count < CHANNEL_SCHED_MAX_CHANNELS; p++) {
+    if (p % cluster_size == cluster_index) {
+      out[count++] = source[p];
+    }
+  }
+  return count;
+}
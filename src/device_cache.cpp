@@ -0,0 +1,190 @@
+#include <string.h>
+#include "device_cache.h"
+#include "fnv_hash.h"
+#include "track_correlator.h"
+
+// Chave: a trilha quando há uma (todos os MACs rotacionados do aparelho caem
+// na mesma entrada), senão SA + fingerprint
+static uint32_t key_hash(const uint8_t* sa, uint32_t fp_hash, uint32_t track_id) {
+  uint32_t h = fnv1a_init();
+  if (track_id != TRACK_ID_NONE) {
+    for (int i = 0; i < 4; i++) h = fnv1a_byte(h, (track_id >> (i * 8)) & 0xFF);
+    return h;
+  }
+  // FNV-1a sobre SA + fingerprint
+  h = fnv1a_update(h, sa, 6);
+  for (int i = 0; i < 4; i++) {
+    h = fnv1a_byte(h, (fp_hash >> (i * 8)) & 0xFF);
+  }
+  return h;
+}
+
+static inline bool key_equals(const device_entry_t* e, const uint8_t* sa, uint32_t fp_hash, uint32_t track_id) {
+  if (track_id != TRACK_ID_NONE) return e->track_id == track_id;
+  return e->track_id == TRACK_ID_NONE && e->fp_hash == fp_hash && memcmp(e->sa, sa, 6) == 0;
+}
+
+static void lru_unlink(device_cache_t* cache, uint16_t slot) {
+  device_entry_t* e = &cache->entries[slot];
+  if (e->lru_prev != DEVICE_CACHE_NONE) cache->entries[e->lru_prev].lru_next = e->lru_next;
+  else cache->lru_head = e->lru_next;
+  if (e->lru_next != DEVICE_CACHE_NONE) cache->entries[e->lru_next].lru_prev = e->lru_prev;
+  else cache->lru_tail = e->lru_prev;
+  e->lru_prev = e->lru_next = DEVICE_CACHE_NONE;
+}
+
+static void lru_push_front(device_cache_t* cache, uint16_t slot) {
+  device_entry_t* e = &cache->entries[slot];
+  e->lru_prev = DEVICE_CACHE_NONE;
+  e->lru_next = cache->lru_head;
+  if (cache->lru_head != DEVICE_CACHE_NONE) cache->entries[cache->lru_head].lru_prev = slot;
+  cache->lru_head = slot;
+  if (cache->lru_tail == DEVICE_CACHE_NONE) cache->lru_tail = slot;
+}
+
+// Posição na tabela de índices que contém slot (ou onde ele seria inserido)
+static uint16_t index_find(const device_cache_t* cache, const uint8_t* sa, uint32_t fp_hash,
+                           uint32_t track_id, bool* found) {
+  uint16_t pos = key_hash(sa, fp_hash, track_id) & cache->index_mask;
+  for (;;) {
+    uint16_t slot = cache->index[pos];
+    if (slot == DEVICE_CACHE_NONE) {
+      *found = false;
+      return pos;
+    }
+    if (key_equals(&cache->entries[slot], sa, fp_hash, track_id)) {
+      *found = true;
+      return pos;
+    }
+    pos = (pos + 1) & cache->index_mask;
+  }
+}
+
+// Remoção com backward-shift: reposiciona os elementos seguintes do cluster
+static void index_remove(device_cache_t* cache, uint16_t pos) {
+  uint16_t hole = pos;
+  uint16_t next = (pos + 1) & cache->index_mask;
+  while (cache->index[next] != DEVICE_CACHE_NONE) {
+    const device_entry_t* e = &cache->entries[cache->index[next]];
+    uint16_t home = key_hash(e->sa, e->fp_hash, e->track_id) & cache->index_mask;
+    // Move se a posição ideal não estiver entre (hole, next]
+    bool in_range = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+    if (!in_range) {
+      cache->index[hole] = cache->index[next];
+      hole = next;
+    }
+    next = (next + 1) & cache->index_mask;
+  }
+  cache->index[hole] = DEVICE_CACHE_NONE;
+}
+
+static void window_reset(device_entry_t* e) {
+  e->window_count = 0;
+  e->window_first_ms = 0;
+  e->rssi_sum = 0;
+  e->rssi_min = 0;
+  e->rssi_max = -128;
+  e->channels_mask = 0;
+}
+
+void device_cache_init(device_cache_t* cache, device_entry_t* entries, uint16_t capacity,
+                       uint16_t* index, uint16_t index_size, device_emit_cb_t emit, void* emit_ctx) {
+  cache->entries = entries;
+  cache->index = index;
+  cache->capacity = capacity;
+  cache->index_mask = index_size - 1;
+  cache->used = 0;
+  cache->lru_head = cache->lru_tail = DEVICE_CACHE_NONE;
+  cache->window_start_ms = 0;
+  cache->emit = emit;
+  cache->emit_ctx = emit_ctx;
+  cache->inserts = cache->evictions = cache->hits = 0;
+  memset(entries, 0, sizeof(device_entry_t) * capacity);
+  for (uint16_t i = 0; i < index_size; i++) index[i] = DEVICE_CACHE_NONE;
+}
+
+static uint16_t evict_lru(device_cache_t* cache) {
+  uint16_t slot = cache->lru_tail;
+  device_entry_t* e = &cache->entries[slot];
+
+  // Não perder os probes ainda não emitidos da entrada despejada
+  if (e->window_count > 0 && cache->emit) {
+    cache->emit(cache->emit_ctx, e, cache->window_start_ms);
+  }
+
+  bool found;
+  uint16_t pos = index_find(cache, e->sa, e->fp_hash, e->track_id, &found);
+  if (found) index_remove(cache, pos);
+  lru_unlink(cache, slot);
+  e->in_use = false;
+  cache->evictions++;
+  return slot;
+}
+
+device_entry_t* device_cache_observe(device_cache_t* cache, const uint8_t* sa, uint32_t fp_hash,
+                                     bool mac_randomized, uint32_t track_id, int8_t rssi,
+                                     uint8_t channel, uint32_t now_ms) {
+  bool found;
+  uint16_t pos = index_find(cache, sa, fp_hash, track_id, &found);
+  uint16_t slot;
+
+  if (found) {
+    slot = cache->index[pos];
+    lru_unlink(cache, slot);
+    cache->hits++;
+  } else {
+    if (cache->used < cache->capacity) {
+      slot = cache->used++;
+    } else {
+      slot = evict_lru(cache);
+      // O backward-shift pode ter movido o ponto de inserção
+      pos = index_find(cache, sa, fp_hash, track_id, &found);
+    }
+    device_entry_t* e = &cache->entries[slot];
+    memcpy(e->sa, sa, 6);
+    e->fp_hash = fp_hash;
+    e->mac_randomized = mac_randomized;
+    e->track_id = track_id;
+    e->in_use = true;
+    e->first_seen_ms = now_ms;
+    e->total_count = 0;
+    window_reset(e);
+    cache->index[pos] = slot;
+    cache->inserts++;
+  }
+  lru_push_front(cache, slot);
+
+  device_entry_t* e = &cache->entries[slot];
+  // Entrada de trilha: SA, fingerprint e flag do probe mais recente (a chave não muda)
+  if (found && track_id != TRACK_ID_NONE) {
+    memcpy(e->sa, sa, 6);
+    e->fp_hash = fp_hash;
+    e->mac_randomized = mac_randomized;
+  }
+  e->last_seen_ms = now_ms;
+  e->total_count++;
+  if (e->window_count == 0) {
+    e->window_first_ms = now_ms;
+    e->rssi_min = rssi;
+    e->rssi_max = rssi;
+  }
+  e->window_count++;
+  e->rssi_sum += rssi;
+  if (rssi < e->rssi_min) e->rssi_min = rssi;
+  if (rssi > e->rssi_max) e->rssi_max = rssi;
+  if (channel < 16) e->channels_mask |= (1u << channel);
+  return e;
+}
+
+void device_cache_flush(device_cache_t* cache, uint32_t now_ms) {
+  for (uint16_t slot = cache->lru_head; slot != DEVICE_CACHE_NONE; slot = cache->entries[slot].lru_next) {
+    device_entry_t* e = &cache->entries[slot];
+    if (e->window_count == 0) {
+      // Lista em ordem LRU: daqui em diante não há mais entradas vistas na janela
+      break;
+    }
+    if (cache->emit) cache->emit(cache->emit_ctx, e, cache->window_start_ms);
+    window_reset(e);
+  }
+  cache->window_start_ms = now_ms;
+}
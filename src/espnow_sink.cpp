@@ -0,0 +1,185 @@
+#include <Arduino.h>
+#include <esp_wifi.h>
+#include <esp_now.h>
+#include "espnow_sink.h"
+#include "mem_placement.h"
+
+typedef struct {
+  uint8_t len;
+  uint8_t data[ESPNOW_SINK_DATAGRAM_MAX];
+} espnow_datagram_t;
+
+static const uint8_t sink_peer[6] = ESPNOW_SINK_PEER;
+static uint32_t sink_session = 0;
+static espnow_sink_stats_t sink_stats = {0};
+
+// Datagrama em montagem (registros inteiros)
+static espnow_datagram_t current;
+static uint8_t current_records = 0;
+static uint32_t current_started_ms = 0;
+
+// Fila circular de datagramas fechados aguardando o canal do gateway
+// (alocada em espnow_sink_begin, PSRAM quando disponível)
+static espnow_datagram_t* queue = NULL;
+static uint32_t queue_mask = 0;
+static volatile uint32_t queue_head = 0;
+static volatile uint32_t queue_tail = 0;
+static uint32_t hold_ms = 0;   // adiamento acumulado da troca de canal nesta visita
+
+static void put_u32(uint8_t* p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+// Fecha um datagrama: o número de sequência é consumido mesmo se a fila
+// estiver cheia, então o descarte local aparece como lacuna no gateway
+static void enqueue(const uint8_t* payload, size_t len, uint8_t flags, uint8_t records) {
+  uint32_t seq = sink_stats.seq++;
+  sink_stats.datagrams++;
+
+  uint32_t used = queue_head - queue_tail;
+  if (queue == NULL || used > queue_mask) {
+    sink_stats.dropped++;
+    return;
+  }
+  if (used + 1 > sink_stats.queue_high_water) {
+    sink_stats.queue_high_water = used + 1;
+  }
+
+  espnow_datagram_t* d = &queue[queue_head & queue_mask];
+  d->data[0] = ESPNOW_SINK_MAGIC;
+  d->data[1] = ESPNOW_SINK_VERSION;
+  d->data[2] = flags;
+  d->data[3] = records;
+  put_u32(d->data + 4, seq);
+  put_u32(d->data + 8, sink_session);
+  memcpy(d->data + ESPNOW_SINK_HEADER_SIZE, payload, len);
+  d->len = ESPNOW_SINK_HEADER_SIZE + len;
+  queue_head++;
+}
+
+static void close_current() {
+  if (current.len == 0) return;
+  enqueue(current.data, current.len, 0, current_records);
+  current.len = 0;
+  current_records = 0;
+}
+
+static void sink_write(const uint8_t* data, size_t len) {
+  sink_stats.records++;
+
+  if (len > ESPNOW_SINK_PAYLOAD_MAX) {
+    // Registro grande: fragmentos próprios, na ordem, sem misturar com outros registros
+    close_current();
+    uint8_t flags = ESPNOW_FLAG_FRAGMENT | ESPNOW_FLAG_FIRST;
+    while (len > 0) {
+      size_t chunk = len > ESPNOW_SINK_PAYLOAD_MAX ? ESPNOW_SINK_PAYLOAD_MAX : len;
+      bool last = chunk == len;
+      enqueue(data, chunk, flags | (last ? ESPNOW_FLAG_LAST : 0), last ? 1 : 0);
+      flags = ESPNOW_FLAG_FRAGMENT;
+      data += chunk;
+      len -= chunk;
+    }
+    return;
+  }
+
+  if (current.len + len > ESPNOW_SINK_PAYLOAD_MAX) {
+    close_current();
+  }
+  if (current.len == 0) {
+    current_started_ms = millis();
+  }
+  memcpy(current.data + current.len, data, len);
+  current.len += len;
+  current_records++;
+}
+
+static void sink_poll(uint32_t now_ms) {
+  if (current.len > 0 && now_ms - current_started_ms >= ESPNOW_SINK_FLUSH_MS) {
+    close_current();
+  }
+  if (queue_head == queue_tail) return;
+
+  // Fora do canal do gateway o quadro iria para o ar sem ninguém ouvindo.
+  // Conferido a cada envio: o timer de troca pode mudar o canal no meio da fila
+  // (ele espera os pendentes só até ESPNOW_SINK_HOLD_MAX_MS).
+  bool first = true;
+  while (queue_head != queue_tail) {
+    uint8_t primary;
+    wifi_second_chan_t second;
+    if (esp_wifi_get_channel(&primary, &second) != ESP_OK || primary != ESPNOW_SINK_CHANNEL) {
+      if (!first) sink_stats.off_channel++;
+      return;
+    }
+    first = false;
+    espnow_datagram_t* d = &queue[queue_tail & queue_mask];
+    if (esp_now_send(sink_peer, d->data, d->len) != ESP_OK) {
+      sink_stats.send_busy++;  // fila interna do ESP-NOW cheia: tenta no próximo poll
+      return;
+    }
+    sink_stats.sent++;
+    queue_tail++;
+  }
+}
+
+// Task do WiFi: apenas contadores
+static void on_sent(const uint8_t* mac, esp_now_send_status_t status) {
+  if (status == ESP_NOW_SEND_SUCCESS) {
+    sink_stats.send_ok++;
+  } else {
+    sink_stats.send_failed++;
+  }
+}
+
+const output_sink_t espnow_sink = {"espnow", sink_write, sink_poll};
+
+bool espnow_sink_begin(uint32_t session) {
+  sink_session = session;
+  uint32_t capacity = ESPNOW_SINK_QUEUE_LEN_PSRAM;
+  queue = (espnow_datagram_t*)mem_alloc_psram("espnow_queue", sizeof(espnow_datagram_t) * capacity);
+  if (queue == NULL) {
+    capacity = ESPNOW_SINK_QUEUE_LEN;
+    queue = (espnow_datagram_t*)mem_alloc_internal("espnow_queue", sizeof(espnow_datagram_t) * capacity);
+  }
+  if (queue == NULL) return false;
+  queue_mask = capacity - 1;
+  sink_stats.queue_capacity = capacity;
+
+  if (esp_now_init() != ESP_OK) return false;
+  esp_now_register_send_cb(on_sent);
+
+  // Canal 0 = canal atual da interface (acompanha o escalonador)
+  esp_now_peer_info_t peer = {};
+  memcpy(peer.peer_addr, sink_peer, 6);
+  peer.channel = 0;
+  peer.ifidx = WIFI_IF_STA;
+  peer.encrypt = false;
+  return esp_now_add_peer(&peer) == ESP_OK;
+}
+
+const espnow_sink_stats_t* espnow_sink_get_stats() {
+  return &sink_stats;
+}
+
+uint32_t espnow_sink_queued() {
+  return queue_head - queue_tail;
+}
+
+uint32_t espnow_sink_pending() {
+  uint32_t done = sink_stats.send_ok + sink_stats.send_failed;
+  uint32_t in_flight = sink_stats.sent > done ? sink_stats.sent - done : 0;
+  return (queue_head - queue_tail) + in_flight;
+}
+
+bool espnow_sink_hold_hop(uint8_t current_channel) {
+  if (current_channel == ESPNOW_SINK_CHANNEL && espnow_sink_pending() > 0 &&
+      hold_ms + ESPNOW_SINK_HOLD_STEP_MS <= ESPNOW_SINK_HOLD_MAX_MS) {
+    hold_ms += ESPNOW_SINK_HOLD_STEP_MS;
+    sink_stats.hop_holds++;
+    return true;
+  }
+  hold_ms = 0;
+  return false;
+}
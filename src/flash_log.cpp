@@ -0,0 +1,180 @@
+#include <string.h>
+#include "flash_log.h"
+#include "wire_format.h"
+
+static uint32_t sector_count(const flash_log_t* log) {
+  return log->page_count / FLASH_LOG_PAGES_PER_SECTOR;
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Lê a página inteira em page[FLASH_LOG_PAGE_SIZE] e classifica
+static int read_page(flash_log_t* log, uint32_t index, uint8_t* page, uint32_t* seq, uint16_t* len) {
+  if (!log->io.read(log->io.ctx, index * FLASH_LOG_PAGE_SIZE, page, FLASH_LOG_PAGE_SIZE)) {
+    return FLASH_LOG_PAGE_CORRUPT;
+  }
+
+  bool erased = true;
+  for (size_t i = 0; i < FLASH_LOG_PAGE_SIZE && erased; i++) {
+    erased = page[i] == 0xFF;
+  }
+  if (erased) return FLASH_LOG_PAGE_ERASED;
+
+  *len = page[2] | (page[3] << 8);
+  *seq = get_u32(page + 4);
+  if (*len > FLASH_LOG_PAGE_PAYLOAD) return FLASH_LOG_PAGE_CORRUPT;
+  uint16_t crc = page[0] | (page[1] << 8);
+  if (crc != wire_crc16(page + 2, FLASH_LOG_PAGE_HEADER - 2 + *len)) return FLASH_LOG_PAGE_CORRUPT;
+  return FLASH_LOG_PAGE_VALID;
+}
+
+bool flash_log_init(flash_log_t* log, const flash_log_io_t* io, uint32_t base_seq) {
+  memset(log, 0, sizeof(*log));
+  log->io = *io;
+  log->page_count = (io->size / FLASH_LOG_SECTOR_SIZE) * FLASH_LOG_PAGES_PER_SECTOR;
+  log->base_seq = base_seq;
+  if (log->page_count == 0) return false;
+
+  uint8_t page[FLASH_LOG_PAGE_SIZE];
+  uint32_t seq;
+  uint16_t len;
+
+  // Primeira página de cada setor: maior seq = setor da cabeça, menor = dado mais antigo
+  bool found = false;
+  uint32_t head_sector = 0;
+  uint32_t max_seq = 0;
+  uint32_t min_seq = 0;
+  for (uint32_t s = 0; s < sector_count(log); s++) {
+    if (read_page(log, s * FLASH_LOG_PAGES_PER_SECTOR, page, &seq, &len) != FLASH_LOG_PAGE_VALID) continue;
+    if (!found || seq > max_seq) {
+      max_seq = seq;
+      head_sector = s;
+    }
+    if (!found || seq < min_seq) min_seq = seq;
+    found = true;
+  }
+
+  if (!found) {
+    // Partição vazia (ou com dado alheio): começa no setor 0, apagado antes da primeira gravação
+    log->head = 0;
+    log->next_seq = base_seq;
+    log->oldest_seq = base_seq;
+    log->head_erased = false;
+    return true;
+  }
+
+  // Avança pelas páginas consecutivas do setor da cabeça
+  uint32_t head = head_sector * FLASH_LOG_PAGES_PER_SECTOR;
+  uint32_t last_seq = max_seq;
+  uint32_t end = head + FLASH_LOG_PAGES_PER_SECTOR;
+  head++;
+  while (head < end && read_page(log, head, page, &seq, &len) == FLASH_LOG_PAGE_VALID &&
+         seq == last_seq + 1) {
+    last_seq = seq;
+    head++;
+  }
+
+  // Continua no mesmo setor só se a página seguinte estiver intacta (0xFF);
+  // gravação interrompida ou setor cheio: segue para o próximo setor
+  log->head_erased = head < end && read_page(log, head, page, &seq, &len) == FLASH_LOG_PAGE_ERASED;
+  if (!log->head_erased) {
+    head = end % log->page_count;
+  }
+  log->head = head;
+  log->next_seq = last_seq + 1 > base_seq ? last_seq + 1 : base_seq;
+  log->oldest_seq = min_seq;
+  return true;
+}
+
+bool flash_log_append(flash_log_t* log, const uint8_t* payload, uint16_t len) {
+  if (len > FLASH_LOG_PAGE_PAYLOAD || log->page_count == 0) return false;
+
+  if (!log->head_erased) {
+    // O setor alcançado guarda os dados mais antigos: eles deixam o log
+    uint8_t page[FLASH_LOG_PAGE_SIZE];
+    uint32_t seq;
+    uint16_t old_len;
+    if (read_page(log, log->head, page, &seq, &old_len) == FLASH_LOG_PAGE_VALID &&
+        seq + FLASH_LOG_PAGES_PER_SECTOR > log->oldest_seq) {
+      log->oldest_seq = seq + FLASH_LOG_PAGES_PER_SECTOR;
+    }
+    if (!log->io.erase_sector(log->io.ctx, (log->head / FLASH_LOG_PAGES_PER_SECTOR) * FLASH_LOG_SECTOR_SIZE)) {
+      log->write_errors++;
+      return false;
+    }
+    log->sector_erases++;
+    log->head_erased = true;
+  }
+
+  uint8_t page[FLASH_LOG_PAGE_SIZE];
+  uint32_t seq = log->next_seq;
+  memset(page, 0xFF, sizeof(page));
+  page[2] = len & 0xFF;
+  page[3] = len >> 8;
+  page[4] = seq;
+  page[5] = seq >> 8;
+  page[6] = seq >> 16;
+  page[7] = seq >> 24;
+  memcpy(page + FLASH_LOG_PAGE_HEADER, payload, len);
+  uint16_t crc = wire_crc16(page + 2, FLASH_LOG_PAGE_HEADER - 2 + len);
+  page[0] = crc & 0xFF;
+  page[1] = crc >> 8;
+
+  // Mesmo com erro a cabeça avança: a página não está mais apagada
+  bool ok = log->io.write(log->io.ctx, log->head * FLASH_LOG_PAGE_SIZE, page, sizeof(page));
+  if (ok) {
+    log->pages_written++;
+  } else {
+    log->write_errors++;
+  }
+
+  log->next_seq++;
+  log->head = (log->head + 1) % log->page_count;
+  if (log->head % FLASH_LOG_PAGES_PER_SECTOR == 0) {
+    log->head_erased = false;
+  }
+  return ok;
+}
+
+uint32_t flash_log_used_pages(const flash_log_t* log) {
+  uint32_t first = log->oldest_seq > log->base_seq ? log->oldest_seq : log->base_seq;
+  if (first >= log->next_seq) return 0;
+  uint32_t used = log->next_seq - first;
+  return used < log->page_count ? used : log->page_count;
+}
+
+uint32_t flash_log_clear(flash_log_t* log) {
+  log->base_seq = log->next_seq;
+  return log->base_seq;
+}
+
+void flash_log_cursor_begin(const flash_log_t* log, flash_log_cursor_t* cursor) {
+  if (!log->head_erased) {
+    // Cabeça no início de um setor ainda não apagado: ele inteiro é o mais antigo
+    cursor->page = log->head;
+    cursor->remaining = log->page_count;
+  } else {
+    uint32_t next_sector = (log->head / FLASH_LOG_PAGES_PER_SECTOR + 1) % sector_count(log);
+    cursor->page = next_sector * FLASH_LOG_PAGES_PER_SECTOR;
+    cursor->remaining = (log->head + log->page_count - cursor->page) % log->page_count;
+    if (cursor->remaining == 0) cursor->remaining = log->page_count;
+  }
+}
+
+int flash_log_read_next(flash_log_t* log, flash_log_cursor_t* cursor, uint8_t* payload) {
+  uint8_t page[FLASH_LOG_PAGE_SIZE];
+  while (cursor->remaining > 0) {
+    uint32_t seq;
+    uint16_t len;
+    int status = read_page(log, cursor->page, page, &seq, &len);
+    cursor->page = (cursor->page + 1) % log->page_count;
+    cursor->remaining--;
+    if (status == FLASH_LOG_PAGE_VALID && seq >= log->base_seq && seq < log->next_seq && len > 0) {
+      memcpy(payload, page + FLASH_LOG_PAGE_HEADER, len);
+      return len;
+    }
+  }
+  return -1;
+}
@@ -0,0 +1,210 @@
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <esp_task_wdt.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "flash_log_sink.h"
+#include "mem_placement.h"
+#include "node_config.h"
+
+typedef struct {
+  uint16_t len;
+  uint8_t data[FLASH_LOG_PAGE_PAYLOAD];
+} staging_page_t;
+
+static const esp_partition_t* partition = NULL;
+static flash_log_t flash_log;
+static SemaphoreHandle_t log_mutex = NULL;
+static TaskHandle_t writer_handle = NULL;
+static bool active = false;
+
+// SPSC: o sink (com o transporte travado) preenche staging[head], a task grava até head.
+// Alocado em flash_log_sink_begin(): FLASH_LOG_STAGING_PAGES_PSRAM páginas na PSRAM, se houver
+static staging_page_t* staging = NULL;
+static uint32_t staging_pages = 0;
+static uint32_t staging_mask = 0;
+static std::atomic<uint32_t> staging_head(0);
+static std::atomic<uint32_t> staging_tail(0);
+static uint32_t fill_started_ms = 0;
+static uint32_t dropped_bytes = 0;
+
+static bool partition_read(void* ctx, uint32_t offset, void* out, size_t len) {
+  return esp_partition_read(partition, offset, out, len) == ESP_OK;
+}
+
+static bool partition_write(void* ctx, uint32_t offset, const void* data, size_t len) {
+  return esp_partition_write(partition, offset, data, len) == ESP_OK;
+}
+
+static bool partition_erase_sector(void* ctx, uint32_t offset) {
+  return esp_partition_erase_range(partition, offset, FLASH_LOG_SECTOR_SIZE) == ESP_OK;
+}
+
+// Produtor: entrega a página em preenchimento para a task
+static void publish_fill_page() {
+  uint32_t head = staging_head.load(std::memory_order_relaxed);
+  if (head - staging_tail.load(std::memory_order_acquire) >= staging_pages) return;
+  if (staging[head & staging_mask].len == 0) return;
+  staging_head.store(head + 1, std::memory_order_release);
+  if (writer_handle != NULL) xTaskNotifyGive(writer_handle);
+}
+
+// Consumidor: grava as páginas publicadas (com log_mutex)
+static void drain_locked() {
+  uint32_t tail = staging_tail.load(std::memory_order_relaxed);
+  while (tail != staging_head.load(std::memory_order_acquire)) {
+    staging_page_t* page = &staging[tail & staging_mask];
+    flash_log_append(&flash_log, page->data, page->len);
+    page->len = 0;
+    staging_tail.store(++tail, std::memory_order_release);
+  }
+}
+
+static void flash_log_writer_task(void* arg) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xSemaphoreTake(log_mutex, portMAX_DELAY);
+    drain_locked();
+    xSemaphoreGive(log_mutex);
+  }
+}
+
+static void sink_write(const uint8_t* data, size_t len) {
+  if (!active) return;
+
+  // Registro inteiro ou nada, como na serial
+  uint32_t head = staging_head.load(std::memory_order_relaxed);
+  uint32_t used = head - staging_tail.load(std::memory_order_acquire);
+  size_t free_bytes = (staging_pages - used) * FLASH_LOG_PAGE_PAYLOAD;
+  if (used < staging_pages) free_bytes -= staging[head & staging_mask].len;
+  if (free_bytes < len) {
+    dropped_bytes += len;
+    return;
+  }
+
+  while (len > 0) {
+    staging_page_t* page = &staging[staging_head.load(std::memory_order_relaxed) & staging_mask];
+    if (page->len == 0) fill_started_ms = millis();
+    size_t chunk = FLASH_LOG_PAGE_PAYLOAD - page->len;
+    if (chunk > len) chunk = len;
+    memcpy(page->data + page->len, data, chunk);
+    page->len += chunk;
+    data += chunk;
+    len -= chunk;
+    if (page->len == FLASH_LOG_PAGE_PAYLOAD) publish_fill_page();
+  }
+}
+
+static void sink_poll(uint32_t now_ms) {
+  if (active && now_ms - fill_started_ms >= FLASH_LOG_FLUSH_MS) {
+    publish_fill_page();
+  }
+}
+
+const output_sink_t flash_log_sink = {"flash_log", sink_write, sink_poll};
+
+bool flash_log_sink_begin() {
+  partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                       (esp_partition_subtype_t)FLASH_LOG_PARTITION_SUBTYPE,
+                                       FLASH_LOG_PARTITION);
+  if (partition == NULL) return false;
+
+  uint32_t base_seq = 0;
+  node_config_load_blob("log_base", &base_seq, sizeof(base_seq));
+
+  flash_log_io_t io;
+  io.ctx = NULL;
+  io.read = partition_read;
+  io.write = partition_write;
+  io.erase_sector = partition_erase_sector;
+  io.size = partition->size - partition->size % FLASH_LOG_SECTOR_SIZE;
+  if (!flash_log_init(&flash_log, &io, base_seq)) return false;
+
+  staging_pages = FLASH_LOG_STAGING_PAGES_PSRAM;
+  staging = (staging_page_t*)mem_alloc_psram("flash_staging", sizeof(staging_page_t) * staging_pages);
+  if (staging == NULL) {
+    staging_pages = FLASH_LOG_STAGING_PAGES;
+    staging = (staging_page_t*)mem_alloc_internal("flash_staging", sizeof(staging_page_t) * staging_pages);
+    if (staging == NULL) return false;
+  }
+  memset(staging, 0, sizeof(staging_page_t) * staging_pages);
+  staging_mask = staging_pages - 1;
+
+  log_mutex = xSemaphoreCreateMutex();
+  xTaskCreatePinnedToCore(flash_log_writer_task, "flash_log", FLASH_LOG_TASK_STACK_SIZE, NULL,
+                          FLASH_LOG_TASK_PRIORITY, &writer_handle, FLASH_LOG_TASK_CORE);
+  active = true;
+  return true;
+}
+
+void flash_log_sink_flush() {
+  if (!active) return;
+  output_lock();
+  publish_fill_page();
+  output_unlock();
+
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  drain_locked();
+  xSemaphoreGive(log_mutex);
+}
+
+void flash_log_sink_dump() {
+  char line[160];
+  int len;
+  if (!active) {
+    output_printf("# ERROR: {\"command\":\"LOG\",\"error\":\"no flash log partition\"}\n");
+    return;
+  }
+
+  // Sem escritores concorrentes: o despejo termina em fronteira de registro
+  output_lock();
+  publish_fill_page();
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  drain_locked();
+
+  uint32_t pages = flash_log_used_pages(&flash_log);
+  len = snprintf(line, sizeof(line), "\n# LOG: {\"event\":\"dump_begin\",\"pages\":%u,\"max_bytes\":%u}\n",
+                 pages, pages * FLASH_LOG_PAGE_PAYLOAD);
+  output_write_blocking((const uint8_t*)line, len);
+
+  flash_log_cursor_t cursor;
+  uint8_t payload[FLASH_LOG_PAGE_PAYLOAD];
+  uint32_t bytes = 0;
+  uint32_t dumped = 0;
+  int n;
+  flash_log_cursor_begin(&flash_log, &cursor);
+  while ((n = flash_log_read_next(&flash_log, &cursor, payload)) > 0) {
+    output_write_blocking(payload, n);
+    esp_task_wdt_reset();  // despejo longo na loop(): alimenta o watchdog
+    bytes += n;
+    dumped++;
+  }
+
+  len = snprintf(line, sizeof(line), "\n# LOG: {\"event\":\"dump_end\",\"pages\":%u,\"bytes\":%u}\n",
+                 dumped, bytes);
+  output_write_blocking((const uint8_t*)line, len);
+
+  xSemaphoreGive(log_mutex);
+  output_unlock();
+}
+
+bool flash_log_sink_erase() {
+  if (!active) return false;
+  xSemaphoreTake(log_mutex, portMAX_DELAY);
+  uint32_t base_seq = flash_log_clear(&flash_log);
+  xSemaphoreGive(log_mutex);
+  return node_config_save_blob("log_base", &base_seq, sizeof(base_seq));
+}
+
+void flash_log_sink_get_stats(flash_log_sink_stats_t* out) {
+  out->partition_size = active ? flash_log.io.size : 0;
+  out->used_pages = flash_log_used_pages(&flash_log);
+  out->pages_written = flash_log.pages_written;
+  out->sector_erases = flash_log.sector_erases;
+  out->write_errors = flash_log.write_errors;
+  out->staging_pages = staging_pages;
+  out->staged_pages = staging_head.load(std::memory_order_acquire) - staging_tail.load(std::memory_order_acquire);
+  out->dropped_bytes = dropped_bytes;
+}
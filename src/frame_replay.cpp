@@ -0,0 +1,93 @@
+#include <string.h>
+#include "frame_replay.h"
+
+#define REPLAY_SA_OFFSET 10
+#define REPLAY_SEQ_CTRL_OFFSET 22
+
+void replay_source_init(replay_source_t* src, const replay_frame_t* frames, size_t count, uint32_t devices) {
+  src->frames = frames;
+  src->count = count;
+  src->devices = devices > REPLAY_MAX_DEVICES ? REPLAY_MAX_DEVICES : devices;
+  src->generated = 0;
+  src->seq = 0;
+}
+
+const replay_frame_t* replay_source_next(replay_source_t* src, uint8_t* out, size_t out_size, uint16_t* len) {
+  if (src->count == 0) return NULL;
+  uint32_t n = src->generated++;
+  uint32_t device = src->devices ? n % src->devices : 0;
+  const replay_frame_t* f = &src->frames[(src->devices ? device : n) % src->count];
+  if (f->len > out_size) return NULL;
+
+  memcpy(out, f->frame, f->len);
+  *len = f->len;
+  if (f->len < REPLAY_MIN_FRAME_LEN) return f;
+
+  if (src->devices) {
+    uint32_t id = device + 1;
+    out[REPLAY_SA_OFFSET + 3] ^= (uint8_t)(id >> 16);
+    out[REPLAY_SA_OFFSET + 4] ^= (uint8_t)(id >> 8);
+    out[REPLAY_SA_OFFSET + 5] ^= (uint8_t)id;
+  }
+  // Número de sequência nos 12 bits altos; o fragmento (4 bits baixos) é mantido
+  uint16_t seq_ctrl = (uint16_t)((src->seq << 4) | (out[REPLAY_SEQ_CTRL_OFFSET] & 0x0F));
+  out[REPLAY_SEQ_CTRL_OFFSET] = (uint8_t)seq_ctrl;
+  out[REPLAY_SEQ_CTRL_OFFSET + 1] = (uint8_t)(seq_ctrl >> 8);
+  src->seq = (src->seq + 1) & 0x0FFF;
+  return f;
+}
+
+uint32_t replay_due(uint32_t rate, uint64_t elapsed_us, uint32_t sent) {
+  uint64_t target = (uint64_t)rate * elapsed_us / 1000000;
+  return target > sent ? (uint32_t)(target - sent) : 0;
+}
+
+void replay_store_init(replay_store_t* store, uint8_t* pool, size_t pool_size) {
+  store->pool = pool;
+  store->pool_size = pool_size;
+  replay_store_clear(store);
+}
+
+void replay_store_clear(replay_store_t* store) {
+  store->pool_used = 0;
+  store->pending_len = 0;
+  store->count = 0;
+}
+
+static int hex_digit(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool replay_store_append_hex(replay_store_t* store, const char* hex) {
+  uint8_t* out = store->pool + store->pool_used + store->pending_len;
+  size_t free_bytes = store->pool_size - store->pool_used - store->pending_len;
+  size_t n = 0;
+  while (hex[0] != '\0') {
+    int hi = hex_digit(hex[0]);
+    int lo = hi < 0 ? -1 : hex_digit(hex[1]);
+    if (lo < 0 || n == free_bytes) {
+      store->pending_len = 0;
+      return false;
+    }
+    out[n++] = (uint8_t)(hi << 4 | lo);
+    hex += 2;
+  }
+  store->pending_len += n;
+  return true;
+}
+
+bool replay_store_commit(replay_store_t* store, int8_t rssi) {
+  size_t len = store->pending_len;
+  store->pending_len = 0;
+  if (len < REPLAY_MIN_FRAME_LEN || len > 0xFFFF || store->count == REPLAY_STORE_MAX_FRAMES) return false;
+
+  replay_frame_t* f = &store->frames[store->count++];
+  f->frame = store->pool + store->pool_used;
+  f->len = (uint16_t)len;
+  f->rssi = rssi;
+  store->pool_used += len;
+  return true;
+}
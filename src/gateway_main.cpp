@@ -0,0 +1,242 @@
+// Firmware do nó gateway (env esp32-gateway): recebe os datagramas ESP-NOW
+// dos nós de captura no canal ESPNOW_SINK_CHANNEL e repassa os registros ao
+// host pela serial, no mesmo formato que os nós emitiriam diretamente.
+// Perdas (lacunas de sequência) e reinícios dos nós são reportados em
+// linhas "# GATEWAY: {...}".
+//
+// Registros binários de vários nós se intercalam no mesmo stream e não dizem
+// de qual nó vieram: antes de repassar um payload binário de outra origem o
+// gateway insere um registro WIRE_RECORD_SOURCE, pelo qual o host separa
+// sessão e keyframes delta de cada nó.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_wifi.h>
+#include <esp_now.h>
+#include "espnow_sink.h"
+#include "frame_ring.h"
+#include "output_transport.h"
+#include "wire_format.h"
+
+#define GATEWAY_MAX_SOURCES 16
+#define GATEWAY_RECORD_MAX 4096          // maior registro remontado (JSON por pacote)
+#define GATEWAY_RING_CAPACITY 64
+#define GATEWAY_STATS_INTERVAL 30000     // ms
+
+typedef struct {
+  uint8_t mac[6];
+  bool active;
+  uint32_t session;
+  uint32_t next_seq;
+  uint32_t datagrams;
+  uint32_t records;
+  uint32_t lost;                         // datagramas que não chegaram
+  uint32_t duplicates;                   // datagramas repetidos ou fora de ordem (descartados)
+  uint32_t restarts;                     // mudanças de session (reboot do nó)
+  uint16_t partial_len;                  // registro fragmentado em remontagem
+  bool partial_valid;
+  uint8_t partial[GATEWAY_RECORD_MAX];
+} gateway_source_t;
+
+// Slot do ring: MAC de origem nos 6 primeiros bytes, depois o datagrama
+static frame_slot_t ring_storage[GATEWAY_RING_CAPACITY];
+static frame_ring_t ring;
+static gateway_source_t sources[GATEWAY_MAX_SOURCES];
+static uint32_t invalid_datagrams = 0;
+static uint32_t unknown_sources = 0;
+static unsigned long last_stats_print = 0;
+static const gateway_source_t* forwarded_source = NULL;  // origem anunciada no stream
+static uint32_t forwarded_session = 0;
+
+static void handle_recv(const uint8_t* mac, const uint8_t* data, int len) {
+  if (len < ESPNOW_SINK_HEADER_SIZE || len > ESPNOW_SINK_DATAGRAM_MAX) return;
+  frame_slot_t* slot = frame_ring_reserve(&ring);
+  if (slot == NULL) return;  // contado em ring.dropped
+  memcpy(slot->data, mac, 6);
+  memcpy(slot->data + 6, data, len);
+  slot->len = 6 + len;
+  frame_ring_commit(&ring);
+}
+
+// Task do WiFi: apenas copia para o ring
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+static void on_recv(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
+  handle_recv(info->src_addr, data, len);
+}
+#else
+static void on_recv(const uint8_t* mac, const uint8_t* data, int len) {
+  handle_recv(mac, data, len);
+}
+#endif
+
+static uint32_t get_u32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void format_mac(const uint8_t* mac, char* out) {
+  snprintf(out, 18, "%02x:%02x:%02x:%02x:%02x:%02x", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+static gateway_source_t* find_source(const uint8_t* mac) {
+  gateway_source_t* free_slot = NULL;
+  for (uint8_t i = 0; i < GATEWAY_MAX_SOURCES; i++) {
+    if (sources[i].active && memcmp(sources[i].mac, mac, 6) == 0) return &sources[i];
+    if (!sources[i].active && free_slot == NULL) free_slot = &sources[i];
+  }
+  if (free_slot != NULL) {
+    memset(free_slot, 0, sizeof(*free_slot));
+    memcpy(free_slot->mac, mac, 6);
+    free_slot->active = true;
+  }
+  return free_slot;
+}
+
+// Repassa um payload inteiro; com quadros binários (delimitadores 0x00) de uma
+// origem diferente da anterior, é precedido do registro de origem
+static void forward_record(const gateway_source_t* src, const uint8_t* payload, size_t len) {
+  if (memchr(payload, 0x00, len) != NULL &&
+      (src != forwarded_source || src->session != forwarded_session)) {
+    wire_source_t source;
+    memcpy(source.src, src->mac, 6);
+    source.session = src->session;
+    uint8_t record[WIRE_SOURCE_RECORD_SIZE];
+    uint8_t framed[WIRE_FRAMED_SIZE(WIRE_SOURCE_RECORD_SIZE)];
+    size_t framed_len = wire_frame(record, wire_encode_source(record, sizeof(record), &source),
+                                   framed, sizeof(framed));
+    output_write(framed, framed_len);
+    forwarded_source = src;
+    forwarded_session = src->session;
+  }
+  output_write(payload, len);
+}
+
+static void process_datagram(const uint8_t* mac, const uint8_t* d, size_t len) {
+  if (d[0] != ESPNOW_SINK_MAGIC || d[1] != ESPNOW_SINK_VERSION) {
+    invalid_datagrams++;
+    return;
+  }
+  gateway_source_t* src = find_source(mac);
+  if (src == NULL) {
+    unknown_sources++;
+    return;
+  }
+
+  uint8_t flags = d[2];
+  uint32_t seq = get_u32(d + 4);
+  uint32_t session = get_u32(d + 8);
+  char mac_str[18];
+
+  if (src->datagrams == 0 || session != src->session) {
+    if (src->datagrams > 0) {
+      src->restarts++;
+      format_mac(mac, mac_str);
+      output_printf("# GATEWAY: {\"src\":\"%s\",\"event\":\"restart\",\"session\":\"%08x\"}\n",
+                    mac_str, session);
+    }
+    src->session = session;
+    src->next_seq = seq;
+    src->partial_valid = false;
+  }
+
+  // Diferença com sinal: seq abaixo do esperado é repetição (retransmissão do
+  // driver) ou datagrama atrasado, não uma perda de ~4 bilhões
+  int32_t gap = (int32_t)(seq - src->next_seq);
+  if (gap < 0) {
+    src->duplicates++;
+    return;
+  }
+  if (gap > 0) {
+    // Datagramas perdidos no ar ou descartados na fila do nó
+    src->lost += gap;
+    src->partial_valid = false;
+    format_mac(mac, mac_str);
+    output_printf("# GATEWAY: {\"src\":\"%s\",\"event\":\"loss\",\"lost\":%u,\"total_lost\":%u}\n",
+                  mac_str, (unsigned)gap, src->lost);
+  }
+  src->next_seq = seq + 1;
+  src->datagrams++;
+
+  const uint8_t* payload = d + ESPNOW_SINK_HEADER_SIZE;
+  size_t payload_len = len - ESPNOW_SINK_HEADER_SIZE;
+
+  if (!(flags & ESPNOW_FLAG_FRAGMENT)) {
+    src->records += d[3];
+    forward_record(src, payload, payload_len);
+    return;
+  }
+
+  // Fragmentos do meio sem o início (lacuna já descartou a parcial) são ignorados
+  if (flags & ESPNOW_FLAG_FIRST) {
+    src->partial_len = 0;
+    src->partial_valid = true;
+  } else if (!src->partial_valid) {
+    return;
+  }
+  if (src->partial_len + payload_len > GATEWAY_RECORD_MAX) {
+    src->partial_valid = false;
+    return;
+  }
+  memcpy(src->partial + src->partial_len, payload, payload_len);
+  src->partial_len += payload_len;
+  if (flags & ESPNOW_FLAG_LAST) {
+    src->records++;
+    forward_record(src, src->partial, src->partial_len);
+    src->partial_valid = false;
+  }
+}
+
+// Uma linha de totais e uma por nó: cada uma cabe em OUTPUT_LINE_MAX com
+// qualquer número de nós (GATEWAY_MAX_SOURCES)
+static void print_gateway_stats() {
+  uint8_t active = 0;
+  for (uint8_t i = 0; i < GATEWAY_MAX_SOURCES; i++) {
+    if (sources[i].active) active++;
+  }
+  output_printf("# GATEWAY: {\"event\":\"stats\",\"ring_dropped\":%u,\"invalid\":%u,"
+                "\"unknown_sources\":%u,\"sources\":%u}\n",
+                ring.dropped, invalid_datagrams, unknown_sources, active);
+  for (uint8_t i = 0; i < GATEWAY_MAX_SOURCES; i++) {
+    const gateway_source_t& src = sources[i];
+    if (!src.active) continue;
+    char mac_str[18];
+    format_mac(src.mac, mac_str);
+    output_printf("# GATEWAY: {\"src\":\"%s\",\"event\":\"source_stats\",\"datagrams\":%u,\"records\":%u,"
+                  "\"lost\":%u,\"duplicates\":%u,\"restarts\":%u}\n",
+                  mac_str, src.datagrams, src.records, src.lost, src.duplicates, src.restarts);
+  }
+}
+
+void setup() {
+  output_begin();
+  delay(1000);
+
+  frame_ring_init(&ring, ring_storage, GATEWAY_RING_CAPACITY);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.disconnect();
+  esp_wifi_set_channel(ESPNOW_SINK_CHANNEL, WIFI_SECOND_CHAN_NONE);
+
+  if (esp_now_init() != ESP_OK) {
+    output_printf("# GATEWAY: {\"event\":\"error\",\"error\":\"esp_now_init\"}\n");
+    return;
+  }
+  esp_now_register_recv_cb(on_recv);
+
+  output_printf("# GATEWAY: {\"event\":\"start\",\"channel\":%d,\"mac\":\"%s\"}\n",
+                ESPNOW_SINK_CHANNEL, WiFi.macAddress().c_str());
+}
+
+void loop() {
+  frame_slot_t* slot;
+  while ((slot = frame_ring_peek(&ring)) != NULL) {
+    process_datagram(slot->data, slot->data + 6, slot->len - 6);
+    frame_ring_release(&ring);
+  }
+
+  if (millis() - last_stats_print > GATEWAY_STATS_INTERVAL) {
+    print_gateway_stats();
+    last_stats_print = millis();
+  }
+
+  delay(1);
+}
@@ -0,0 +1,52 @@
+#include "health_monitor.h"
+
+void health_monitor_init(health_monitor_t* m, uint32_t now_ms) {
+  m->checks = 0;
+  m->heap_low_checks = 0;
+  m->fragmented_checks = 0;
+  m->min_free_heap = UINT32_MAX;
+  m->min_largest_block = UINT32_MAX;
+  m->ring_tail = 0;
+  m->ring_progress_ms = now_ms;
+  m->rx_frames = 0;
+  m->rx_progress_ms = now_ms;
+}
+
+uint8_t health_monitor_check(health_monitor_t* m, const health_sample_t* sample, uint32_t now_ms) {
+  m->checks++;
+  if (sample->free_heap < m->min_free_heap) m->min_free_heap = sample->free_heap;
+  if (sample->largest_block < m->min_largest_block) m->min_largest_block = sample->largest_block;
+
+  // Heap: só conta se persistir (picos curtos de alocação do driver não disparam)
+  m->heap_low_checks = sample->free_heap < HEALTH_MIN_FREE_HEAP ? m->heap_low_checks + 1 : 0;
+  m->fragmented_checks = sample->largest_block < HEALTH_MIN_LARGEST_BLOCK ? m->fragmented_checks + 1 : 0;
+
+  // Consumidor parado só conta com trabalho pendente
+  if (sample->ring_occupancy == 0 || sample->ring_tail != m->ring_tail) {
+    m->ring_progress_ms = now_ms;
+  }
+  m->ring_tail = sample->ring_tail;
+
+  if (sample->rx_frames != m->rx_frames) {
+    m->rx_progress_ms = now_ms;
+  }
+  m->rx_frames = sample->rx_frames;
+
+  if (m->heap_low_checks >= HEALTH_HEAP_TRIP_CHECKS) return HEALTH_TRIGGER_HEAP_LOW;
+  if (m->fragmented_checks >= HEALTH_HEAP_TRIP_CHECKS) return HEALTH_TRIGGER_HEAP_FRAGMENTED;
+  if (now_ms - m->ring_progress_ms >= HEALTH_WORKER_STALL_MS) return HEALTH_TRIGGER_WORKER_STALL;
+  if (HEALTH_RX_STALL_MS > 0 && now_ms - m->rx_progress_ms >= HEALTH_RX_STALL_MS) return HEALTH_TRIGGER_RX_STALL;
+  return HEALTH_TRIGGER_NONE;
+}
+
+const char* health_trigger_name(uint8_t trigger) {
+  switch (trigger) {
+    case HEALTH_TRIGGER_NONE: return "none";
+    case HEALTH_TRIGGER_HEAP_LOW: return "heap_low";
+    case HEALTH_TRIGGER_HEAP_FRAGMENTED: return "heap_fragmented";
+    case HEALTH_TRIGGER_WORKER_STALL: return "worker_stall";
+    case HEALTH_TRIGGER_RX_STALL: return "rx_stall";
+    case HEALTH_TRIGGER_TASK_WDT: return "task_wdt";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,72 @@
+#include <Arduino.h>
+#include "host_commands.h"
+#include "output_transport.h"
+
+static const host_command_t* command_table = NULL;
+static size_t command_count = 0;
+static char line[HOST_COMMAND_LINE_MAX];
+static size_t line_len = 0;
+static bool line_overflow = false;
+
+static void print_help() {
+  char out[OUTPUT_LINE_MAX];
+  size_t len = snprintf(out, sizeof(out), "# HELP: {\"commands\":[");
+  for (size_t i = 0; i < command_count && len < sizeof(out); i++) {
+    len += snprintf(out + len, sizeof(out) - len, "%s\"%s\"", i ? "," : "", command_table[i].usage);
+  }
+  if (len < sizeof(out)) {
+    snprintf(out + len, sizeof(out) - len, "]}\n");
+  }
+  output_printf("%s", out);
+}
+
+static void dispatch(char* cmd) {
+  while (*cmd == ' ') cmd++;
+  if (*cmd == '\0') return;
+
+  char* args = cmd;
+  while (*args && *args != ' ') args++;
+  if (*args) *args++ = '\0';
+  while (*args == ' ') args++;
+
+  if (strcasecmp(cmd, "HELP") == 0) {
+    print_help();
+    return;
+  }
+
+  for (size_t i = 0; i < command_count; i++) {
+    if (strcasecmp(cmd, command_table[i].name) == 0) {
+      command_table[i].handler(args);
+      return;
+    }
+  }
+
+  output_printf("# ERROR: {\"command\":\"%s\",\"error\":\"unknown command\"}\n", cmd);
+}
+
+void host_commands_init(const host_command_t* table, size_t count) {
+  command_table = table;
+  command_count = count;
+  line_len = 0;
+  line_overflow = false;
+}
+
+void host_commands_poll() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c < 0) break;
+
+    if (c == '\n' || c == '\r') {
+      if (!line_overflow && line_len > 0) {
+        line[line_len] = '\0';
+        dispatch(line);
+      }
+      line_len = 0;
+      line_overflow = false;
+    } else if (line_len < sizeof(line) - 1) {
+      line[line_len++] = (char)c;
+    } else {
+      line_overflow = true; // linha longa demais: descartada inteira
+    }
+  }
+}
@@ -0,0 +1,167 @@
+#include <string.h>
+#include "ie_parser.h"
+#include "fnv_hash.h"
+
+#define SSID_MAX_LEN 32
+
+void ie_parse(ie_list_t* list, const uint8_t* buf, size_t start, size_t end) {
+  list->buf = buf;
+  list->count = 0;
+  list->truncated = false;
+  list->malformed = false;
+  list->ssid = IE_VIEW_NONE;
+  list->rates = IE_VIEW_NONE;
+  list->ext_rates = IE_VIEW_NONE;
+  list->ht = IE_VIEW_NONE;
+  list->vht = IE_VIEW_NONE;
+  list->ext_caps = IE_VIEW_NONE;
+  list->he = IE_VIEW_NONE;
+  list->eht = IE_VIEW_NONE;
+  list->vendor_count = 0;
+
+  uint32_t fp = fnv1a_init();
+  size_t offset = start;
+
+  while (offset + 2 <= end) {
+    uint8_t id = buf[offset];
+    uint8_t len = buf[offset + 1];
+    const uint8_t* body = buf + offset + 2;
+
+    if (offset + 2 + len > end) {
+      list->malformed = true;
+      break;
+    }
+    if (list->count >= IE_PARSER_MAX_IES) {
+      list->truncated = true;
+      break;
+    }
+
+    uint8_t index = list->count++;
+    ie_view_t* view = &list->ies[index];
+    view->id = id;
+    view->len = len;
+    view->offset = (uint16_t)(offset + 2);
+
+    // Fingerprint: IDs em ordem + corpos dos IEs de capacidade. SSID e DS
+    // Parameter ficam de fora: variam entre probes do mesmo dispositivo.
+    fp = fnv1a_byte(fp, id);
+
+    switch (id) {
+      case IE_SSID:
+        if (list->ssid == IE_VIEW_NONE) list->ssid = index;
+        break;
+
+      case IE_SUPPORTED_RATES:
+        fp = fnv1a_update(fp, body, len);
+        if (list->rates == IE_VIEW_NONE) list->rates = index;
+        break;
+
+      case IE_EXTENDED_RATES:
+        fp = fnv1a_update(fp, body, len);
+        if (list->ext_rates == IE_VIEW_NONE) list->ext_rates = index;
+        break;
+
+      case IE_HT_CAPABILITIES:
+        // Capability Information (2) | A-MPDU (1) | Supported MCS Set (16) | ...
+        fp = fnv1a_update(fp, body, len);
+        if (len >= 26 && list->ht == IE_VIEW_NONE) {
+          list->ht = index;
+          list->caps.ht_info = body[0] | (body[1] << 8);
+          memcpy(list->caps.ht_mcs, body + 3, 4);
+        }
+        break;
+
+      case IE_VHT_CAPABILITIES:
+        // Capabilities Information (4) | Rx MCS Map (2) | Rx Highest (2) | Tx MCS Map (2) | Tx Highest (2)
+        fp = fnv1a_update(fp, body, len);
+        if (len >= 12 && list->vht == IE_VIEW_NONE) {
+          list->vht = index;
+          list->caps.vht_info = (uint32_t)body[0] | ((uint32_t)body[1] << 8) |
+                                ((uint32_t)body[2] << 16) | ((uint32_t)body[3] << 24);
+          list->caps.vht_rx_mcs_map = body[4] | (body[5] << 8);
+        }
+        break;
+
+      case IE_EXTENDED_CAPABILITIES:
+        fp = fnv1a_update(fp, body, len);
+        if (list->ext_caps == IE_VIEW_NONE) list->ext_caps = index;
+        break;
+
+      case IE_ELEMENT_EXTENSION:
+        // O ID de extensão entra no hash junto com o corpo
+        fp = fnv1a_update(fp, body, len);
+        if (len >= 1) {
+          if (body[0] == IE_EXT_HE_CAPABILITIES && len >= 22 && list->he == IE_VIEW_NONE) {
+            // Ext ID (1) | HE MAC Capabilities (6) | HE PHY Capabilities (11) | Rx HE-MCS <= 80 (2) | ...
+            list->he = index;
+            list->caps.he_mac0 = body[1];
+            list->caps.he_phy0 = body[7];
+            list->caps.he_rx_mcs_80 = body[18] | (body[19] << 8);
+          } else if (body[0] == IE_EXT_EHT_CAPABILITIES && len >= 12 && list->eht == IE_VIEW_NONE) {
+            // Ext ID (1) | EHT MAC Capabilities (2) | EHT PHY Capabilities (9) | ...
+            list->eht = index;
+          }
+        }
+        break;
+
+      case IE_VENDOR_SPECIFIC:
+        // Apenas OUI + tipo: o restante do payload pode conter contadores/nonces
+        fp = fnv1a_update(fp, body, len < 4 ? len : 4);
+        if (len >= 3) list->vendor_count++;
+        break;
+    }
+
+    offset += 2 + len;
+  }
+
+  list->fp_hash = fp;
+}
+
+size_t ie_decode_ssid(const ie_list_t* list, char* out, size_t out_size) {
+  const ie_view_t* view = ie_get(list, list->ssid);
+  size_t n = 0;
+
+  if (view != NULL && view->len <= SSID_MAX_LEN) {
+    const uint8_t* body = ie_body(list, view);
+    for (uint8_t i = 0; i < view->len && n + 1 < out_size; i++) {
+      if (body[i] >= 32 && body[i] <= 126) {
+        out[n++] = (char)body[i];
+      }
+    }
+  }
+  out[n] = '\0';
+  return n;
+}
+
+size_t ie_decode_rates(const ie_list_t* list, uint8_t index, uint8_t* out, size_t out_size) {
+  const ie_view_t* view = ie_get(list, index);
+  if (view == NULL) return 0;
+
+  const uint8_t* body = ie_body(list, view);
+  size_t n = 0;
+  for (uint8_t i = 0; i < view->len && n < out_size; i++) {
+    out[n++] = body[i] & 0x7F;
+  }
+  return n;
+}
+
+int ie_ht_max_mcs(const ie_caps_t* caps) {
+  for (int i = 31; i >= 0; i--) {
+    if (caps->ht_mcs[i / 8] & (1 << (i % 8))) return i;
+  }
+  return -1;
+}
+
+uint8_t ie_mcs_map_streams(uint16_t map) {
+  uint8_t streams = 0;
+  for (uint8_t nss = 0; nss < 8; nss++) {
+    if (((map >> (nss * 2)) & 0x03) != 0x03) streams = nss + 1;
+  }
+  return streams;
+}
+
+bool ie_ext_cap_bit(const ie_list_t* list, uint8_t bit) {
+  const ie_view_t* view = ie_get(list, list->ext_caps);
+  if (view == NULL || bit / 8 >= view->len) return false;
+  return (ie_body(list, view)[bit / 8] >> (bit % 8)) & 0x01;
+}
@@ -0,0 +1,197 @@
+#include <string.h>
+#include "json_writer.h"
+
+static const char hex_digits[] = "0123456789abcdef";
+
+void hex_encode(const uint8_t* data, size_t len, char* out) {
+  for (size_t i = 0; i < len; i++) {
+    out[2 * i] = hex_digits[data[i] >> 4];
+    out[2 * i + 1] = hex_digits[data[i] & 0x0F];
+  }
+}
+
+void hex_encode_u32(uint32_t v, char* out) {
+  for (int i = 7; i >= 0; i--) {
+    out[i] = hex_digits[v & 0x0F];
+    v >>= 4;
+  }
+  out[8] = '\0';
+}
+
+static inline bool reserve(json_writer_t* w, size_t n) {
+  if (w->overflow || w->len + n > w->cap) {
+    w->overflow = true;
+    return false;
+  }
+  return true;
+}
+
+static inline void put_char(json_writer_t* w, char c) {
+  if (reserve(w, 1)) w->buf[w->len++] = c;
+}
+
+static inline void put_bytes(json_writer_t* w, const char* s, size_t n) {
+  if (reserve(w, n)) {
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+  }
+}
+
+// Insere a vírgula antes de um novo elemento (valores após chave não precisam)
+static void begin_value(json_writer_t* w) {
+  if (w->after_key) {
+    w->after_key = false;
+    return;
+  }
+  if (w->depth > 0) {
+    if (w->has_items[w->depth - 1]) put_char(w, ',');
+    w->has_items[w->depth - 1] = true;
+  }
+}
+
+static void push(json_writer_t* w, char open) {
+  begin_value(w);
+  put_char(w, open);
+  if (w->depth < JSON_WRITER_MAX_DEPTH) {
+    w->has_items[w->depth++] = false;
+  } else {
+    w->overflow = true;
+  }
+}
+
+static void pop(json_writer_t* w, char close) {
+  if (w->depth > 0) w->depth--;
+  put_char(w, close);
+}
+
+void json_begin(json_writer_t* w, char* buf, size_t cap) {
+  w->buf = buf;
+  w->cap = cap;
+  w->len = 0;
+  w->overflow = false;
+  w->depth = 0;
+  w->after_key = false;
+}
+
+void json_object_begin(json_writer_t* w) { push(w, '{'); }
+void json_object_end(json_writer_t* w) { pop(w, '}'); }
+void json_array_begin(json_writer_t* w) { push(w, '['); }
+void json_array_end(json_writer_t* w) { pop(w, ']'); }
+
+static void put_escaped(json_writer_t* w, const char* s) {
+  put_char(w, '"');
+  for (; *s; s++) {
+    unsigned char c = (unsigned char)*s;
+    if (c == '"' || c == '\\') {
+      put_char(w, '\\');
+      put_char(w, c);
+    } else if (c < 0x20) {
+      char esc[6] = {'\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0x0F]};
+      put_bytes(w, esc, sizeof(esc));
+    } else {
+      put_char(w, c);
+    }
+  }
+  put_char(w, '"');
+}
+
+void json_key(json_writer_t* w, const char* key) {
+  begin_value(w);
+  put_escaped(w, key);
+  put_char(w, ':');
+  w->after_key = true;
+}
+
+void json_string(json_writer_t* w, const char* s) {
+  begin_value(w);
+  put_escaped(w, s ? s : "");
+}
+
+static void put_uint(json_writer_t* w, uint32_t v) {
+  char tmp[10];
+  size_t n = 0;
+  do {
+    tmp[n++] = '0' + (v % 10);
+    v /= 10;
+  } while (v > 0);
+  if (reserve(w, n)) {
+    while (n > 0) w->buf[w->len++] = tmp[--n];
+  }
+}
+
+void json_uint(json_writer_t* w, uint32_t v) {
+  begin_value(w);
+  put_uint(w, v);
+}
+
+void json_int(json_writer_t* w, int32_t v) {
+  begin_value(w);
+  if (v < 0) {
+    put_char(w, '-');
+    put_uint(w, (uint32_t)(-(int64_t)v));
+  } else {
+    put_uint(w, (uint32_t)v);
+  }
+}
+
+void json_bool(json_writer_t* w, bool v) {
+  begin_value(w);
+  if (v) put_bytes(w, "true", 4);
+  else put_bytes(w, "false", 5);
+}
+
+void json_null(json_writer_t* w) {
+  begin_value(w);
+  put_bytes(w, "null", 4);
+}
+
+void json_fixed(json_writer_t* w, float v, uint8_t decimals) {
+  begin_value(w);
+  if (v < 0) {
+    put_char(w, '-');
+    v = -v;
+  }
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+  uint32_t scaled = (uint32_t)(v * scale + 0.5f);
+  put_uint(w, scaled / scale);
+
+  uint32_t frac = scaled % scale;
+  if (frac == 0) return;
+  char digits[10];
+  uint8_t n = decimals;
+  for (uint8_t i = decimals; i > 0; i--) {
+    digits[i - 1] = '0' + (frac % 10);
+    frac /= 10;
+  }
+  while (n > 0 && digits[n - 1] == '0') n--;
+  put_char(w, '.');
+  put_bytes(w, digits, n);
+}
+
+void json_hex(json_writer_t* w, const uint8_t* data, size_t len) {
+  begin_value(w);
+  put_char(w, '"');
+  if (reserve(w, len * 2)) {
+    hex_encode(data, len, w->buf + w->len);
+    w->len += len * 2;
+  }
+  put_char(w, '"');
+}
+
+void json_mac(json_writer_t* w, const uint8_t* mac) {
+  begin_value(w);
+  char out[19];
+  out[0] = '"';
+  for (int i = 0; i < 6; i++) {
+    out[1 + i * 3] = hex_digits[mac[i] >> 4];
+    out[2 + i * 3] = hex_digits[mac[i] & 0x0F];
+    out[3 + i * 3] = i < 5 ? ':' : '"';
+  }
+  put_bytes(w, out, sizeof(out));
+}
+
+void json_raw(json_writer_t* w, const char* s) {
+  begin_value(w);
+  put_bytes(w, s, strlen(s));
+}
@@ -4,154 +4,182 @@
 #include <esp_wifi.h>
 #include <esp_event.h>
 #include <nvs_flash.h>
-#include <ArduinoJson.h>
 #include <time.h>
 #include <sys/time.h>
 #include "wifi_probe_monitor.h"
+#include "json_writer.h"
+#if REPLAY_ENABLED
+// Mesmo corpus dos testes nativos e do benchmark (const: fica na flash)
+#include "../test/corpus/probe_corpus.h"
+#endif
 
 // Variáveis globais
-static uint8_t current_channel = 1;
-static unsigned long last_channel_switch = 0;
+static channel_scheduler_t channel_scheduler;
+static esp_timer_handle_t channel_hop_timer = NULL;
+static uint32_t channel_hop_target_us = 0;
+
+// Nova divisão de canais (comando CLUSTER), aplicada pela task do timer na próxima troca
+static uint8_t pending_channels[CHANNEL_SCHED_MAX_CHANNELS];
+static uint8_t pending_channel_count = 0;
+static std::atomic<bool> channel_plan_pending(false);
+
+// ID do nó e modo cluster (NVS)
+static node_config_t node_config;
+
+// Pré-filtro do callback (regras na NVS, chave "filter")
+static probe_filter_t probe_filter;
+
+static const host_command_t host_command_table[] = {
+  {"NODE", cmd_node, "NODE [id|-]"},
+  {"CLUSTER", cmd_cluster, "CLUSTER [<index> <size>|OFF]"},
+  {"FILTER", cmd_filter, "FILTER [CLEAR|RSSI <dbm>|RSSI OFF|RANDOMIZED ONLY|EXCLUDE|ANY|"
+                         "ALLOW <mac>[/bits]|DENY <mac>[/bits]|SSID <ssid>[*]]"},
+  {"TIME", cmd_time, "TIME [<unix_s>[.frac]]"},
+#if FLASH_LOG_ENABLED
+  {"LOG", cmd_log, "LOG [DUMP|ERASE]"},
+#endif
+#if REPLAY_ENABLED
+  {"REPLAY", cmd_replay, "REPLAY [<rate>|MAX [<seconds>] [<devices>]|STOP|ADD <hex>|END <rssi>|CLEAR]"},
+#endif
+};
 static unsigned long last_stats_print = 0;
-static unsigned long startup_time = 0;
 static system_stats_t stats = {0};
-static String current_capture_id = "";
-static uint32_t packet_counter = 0;
+static char current_capture_id[37] = "";
+static std::atomic<uint32_t> packet_counter(0);  // pkt_seq compartilhado entre os workers
+static uint16_t scanner_tag = 0;  // 16 bits baixos do MAC da efuse (pkt_id)
+
+// Workers de parsing: cada um com o ring de frames entre o callback do driver
+// (produtor) e a própria task (consumidor) e o cache de deduplicação dos seus
+// dispositivos. Slots e pool do cache alocados no boot por alloc_capture_buffers()
+// (PSRAM quando disponível; índice do cache sempre na SRAM interna)
+static probe_worker_t workers[PROBE_WORKER_COUNT];
+
+#if TRACK_CORRELATION_ENABLED
+// Trilhas de MACs randomizados, únicas para todos os workers (pool alocado em
+// alloc_capture_buffers(), como o do cache)
+static track_correlator_t track_correlator;
+static portMUX_TYPE track_mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
 
-// Intervalo de reinicialização (1 hora = 3.600.000 ms)
-const unsigned long RESTART_INTERVAL = 3600000;
+// Monitor de saúde: reboot apenas quando um limite é ultrapassado. O gatilho
+// fica em RTC_NOINIT (sobrevive ao ESP.restart()) e é reportado no boot seguinte
+#define HEALTH_RESET_MAGIC 0x4845414c
+RTC_NOINIT_ATTR static uint32_t health_reset_magic;
+RTC_NOINIT_ATTR static uint32_t health_reset_trigger;
+RTC_NOINIT_ATTR static uint32_t health_reset_uptime_s;
+static health_monitor_t health_monitor;
+static unsigned long last_health_check = 0;
+static esp_reset_reason_t boot_reset_reason = ESP_RST_UNKNOWN;
+static uint8_t boot_health_trigger = HEALTH_TRIGGER_NONE;
+static uint32_t boot_health_uptime_s = 0;
+
+// Relógio de captura (time_sync.h): modelo timer -> epoch protegido por time_mux,
+// offset rx -> timer estimado no callback e publicado a cada âncora
+static portMUX_TYPE time_mux = portMUX_INITIALIZER_UNLOCKED;
+static time_model_t time_model;
+static rx_clock_t rx_clock;
+static std::atomic<uint32_t> rx_offset_published(0);
+static std::atomic<bool> rx_offset_ready(false);
+static uint32_t time_anchor_seq = 0;
+static unsigned long last_anchor_print = 0;
+static volatile int64_t pps_edge_us = 0;
+static std::atomic<bool> pps_pending(false);
+
+#if REPLAY_ENABLED
+// Execução do comando REPLAY: parâmetros e base dos contadores escritos pela
+// loop() com a task parada; a task publica o fim em done
+typedef struct {
+  TaskHandle_t handle;
+  std::atomic<bool> running;
+  std::atomic<bool> stop;
+  std::atomic<bool> done;
+  bool from_store;
+  uint32_t rate;              // frames/s; 0 = REPLAY_BURST_MAX por tick
+  uint32_t duration_s;        // 0 = até REPLAY STOP
+  uint32_t devices;
+  uint32_t injected;
+  uint32_t elapsed_ms;
+  uint32_t heap_start;
+  uint32_t heap_min;
+  uint32_t largest_block_min;
+  unsigned long base_queued;
+  uint32_t base_queue_full;
+  unsigned long base_parsed;
+  uint32_t base_filtered;
+  uint32_t base_output_dropped;
+} replay_state_t;
+static replay_state_t replay;
+static replay_frame_t replay_flash_frames[PROBE_CORPUS_COUNT];
+static replay_store_t replay_store;
+#endif
 
 // Protótipo da função para configurar RTC
 void setup_rtc_time();
 
-// Função para obter timestamp atual (RTC se disponível, senão millis())
-uint32_t get_current_timestamp() {
-#ifdef BUILD_TIME_UNIX
-  time_t now;
-  time(&now);
-  return (uint32_t)now;
-#else
-  return millis();
-#endif
+static time_model_t time_model_snapshot() {
+  portENTER_CRITICAL(&time_mux);
+  time_model_t m = time_model;
+  portEXIT_CRITICAL(&time_mux);
+  return m;
 }
 
-// Função para gerar UUID simples baseado em timestamp e contador
-String generate_packet_id() {
-  char uuid[37];
-  uint32_t ts = get_current_timestamp();
-  uint32_t counter = packet_counter++;
-  uint64_t chip_id = ESP.getEfuseMac(); // Usar EfuseMac em vez de getChipId
-  sprintf(uuid, "%08x-%04x-%04x-%04x-%08x%04x",
-          ts,
-          (uint16_t)(counter & 0xFFFF),
-          (uint16_t)((counter >> 16) & 0xFFFF),
-          (uint16_t)(chip_id & 0xFFFF),
-          ts,
-          (uint16_t)(millis() & 0xFFFF));
-  return String(uuid);
+// Nenhum frame recebido ainda: rx_us sem referência
+static bool rx_offset_known() {
+  return rx_offset_ready.load(std::memory_order_acquire) || rx_clock.valid.load(std::memory_order_acquire);
+}
+
+// Offset rx -> timer da última âncora (ou do intervalo atual antes da primeira)
+static uint32_t rx_offset_current() {
+  return rx_offset_ready.load(std::memory_order_acquire) ? rx_offset_published.load(std::memory_order_relaxed)
+                                                         : rx_clock.offset.load(std::memory_order_acquire);
+}
+
+// Epoch (us) de um frame a partir do rx_ctrl.timestamp
+int64_t rx_to_epoch_us(uint32_t rx_us) {
+  time_model_t m = time_model_snapshot();
+  return time_model_epoch_us(&m, rx_clock_to_timer(rx_us, rx_offset_current(), esp_timer_get_time()));
+}
+
+// Função para obter timestamp atual (segundos; desde o boot sem BUILD_TIME_UNIX)
+uint32_t get_current_timestamp() {
+  time_model_t m = time_model_snapshot();
+  return (uint32_t)(time_model_epoch_us(&m, esp_timer_get_time()) / 1000000);
 }
 
 // Função para gerar capture ID (um por sessão)
-String generate_capture_id() {
-  char uuid[37];
+void generate_capture_id(char* out) {
   uint32_t ts = get_current_timestamp();
   uint64_t chip_id = ESP.getEfuseMac(); // Usar EfuseMac em vez de getChipId
-  sprintf(uuid, "%08x-%04x-%04x-%04x-%08x%04x",
+  sprintf(out, "%08x-%04x-%04x-%04x-%08x%04x",
           ts,
           (uint16_t)(chip_id & 0xFFFF),
           (uint16_t)((chip_id >> 16) & 0xFFFF),
           0x4000 | ((ts >> 16) & 0x0FFF),
           ts,
           (uint16_t)(chip_id & 0xFFFF));
-  return String(uuid);
 }
 
-// Função para gerar timestamp ISO8601
-String get_iso8601_timestamp() {
-#ifdef BUILD_TIME_UNIX
-  time_t now;
-  time(&now);
-  struct tm* timeinfo = gmtime(&now);
-
-  char buffer[32];
-  sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
-          timeinfo->tm_year + 1900,
-          timeinfo->tm_mon + 1,
-          timeinfo->tm_mday,
-          timeinfo->tm_hour,
-          timeinfo->tm_min,
-          timeinfo->tm_sec,
-          (int)(millis() % 1000));
-  return String(buffer);
-#else
-  // Fallback usando millis para timestamp relativo
-  unsigned long ms = millis();
-  unsigned long seconds = ms / 1000;
-  unsigned long minutes = seconds / 60;
-  unsigned long hours = minutes / 60;
-
-  char buffer[32];
-  sprintf(buffer, "1970-01-01T%02lu:%02lu:%02lu.%03luZ",
-          hours % 24,
-          minutes % 60,
-          seconds % 60,
-          ms % 1000);
-  return String(buffer);
-#endif
-}
-
-// Lista de alguns OUIs conhecidos para identificação de vendors
-const char* known_vendors[][2] = {
-  {"00:16:01", "Android"},
-  {"00:1B:63", "Apple"},
-  {"00:23:12", "Apple"},
-  {"00:25:00", "Apple"},
-  {"28:E0:2C", "Apple"},
-  {"3C:15:C2", "Apple"},
-  {"40:A6:D9", "Apple"},
-  {"64:20:9F", "Apple"},
-  {"68:96:7B", "Apple"},
-  {"70:56:81", "Apple"},
-  {"7C:6D:62", "Apple"},
-  {"88:63:DF", "Apple"},
-  {"90:B0:ED", "Apple"},
-  {"A4:5E:60", "Apple"},
-  {"AC:BC:32", "Apple"},
-  {"BC:52:B7", "Apple"},
-  {"D0:A6:37", "Apple"},
-  {"E8:8D:28", "Apple"},
-  {"F0:98:9D", "Apple"},
-  {"F4:0F:24", "Apple"},
-  {"F8:1E:DF", "Apple"},
-  {"18:3A:2D", "Samsung"},
-  {"1C:62:B8", "Samsung"},
-  {"34:23:87", "Samsung"},
-  {"38:AA:3C", "Samsung"},
-  {"40:4E:36", "Samsung"},
-  {"5C:0A:5B", "Samsung"},
-  {"78:1F:DB", "Samsung"},
-  {"8C:45:00", "Samsung"},
-  {"A0:02:DC", "Samsung"},
-  {"C8:19:F7", "Samsung"},
-  {"E8:50:8B", "Samsung"},
-  {NULL, NULL}
-};
-
+// Em "pio test" o setup()/loop() vêm do teste (ex: test_benchmark no alvo)
+#ifndef PIO_UNIT_TESTING
 void setup() {
-  Serial.begin(115200);
+  output_begin();
   delay(1000);
 
-  Serial.println("=== ESP32 WiFi Probe Request Monitor v2.0 ===");
-  Serial.println("Formato: JSON Schema conforme especificação");
-  Serial.println("Desenvolvido para detecção de dispositivos WiFi");
-  Serial.println("");
+  output_printf("=== ESP32 WiFi Probe Request Monitor v2.0 ===\n");
+  output_printf("Formato: JSON Schema conforme especificação\n");
+  output_printf("Desenvolvido para detecção de dispositivos WiFi\n");
+  output_printf("\n");
 
-  // Gerar capture ID para esta sessão
-  current_capture_id = generate_capture_id();
+  // Motivo do reset e gatilho do monitor de saúde no boot anterior
+  health_boot();
 
-  // Configurar RTC com tempo de compilação
+  // Configurar RTC e o relógio de captura (antes do capture ID, que usa o epoch)
   setup_rtc_time();
 
+  // Gerar capture ID para esta sessão
+  generate_capture_id(current_capture_id);
+  scanner_tag = (uint16_t)(ESP.getEfuseMac() & 0xFFFF);
+
   // Inicializar NVS
   esp_err_t ret = nvs_flash_init();
   if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -159,44 +187,139 @@ void setup() {
     ret = nvs_flash_init();
   }
 
+  // ID do nó e posição no cluster (NVS > build flags > MAC da efuse)
+  node_config_load(&node_config);
+  output_printf("Node ID: %s | Cluster: %u/%u\n", node_config.node_id,
+                node_config.cluster_index, node_config.cluster_size);
+  host_commands_init(host_command_table, sizeof(host_command_table) / sizeof(host_command_table[0]));
+
+  // Regras do pré-filtro salvas pelo comando FILTER
+  probe_filter_init(&probe_filter);
+  probe_filter_rules_t filter_rules;
+  if (node_config_load_blob("filter", &filter_rules, sizeof(filter_rules)) &&
+      probe_filter_rules_valid(&filter_rules)) {
+    probe_filter_publish(&probe_filter, &filter_rules);
+    print_filter_status();
+  }
+
+  // Iniciar ring de frames e task de parsing antes de habilitar a captura
+  if (!alloc_capture_buffers()) {
+    output_printf("Erro: memória insuficiente para o ring de frames e o cache de dispositivos\n");
+    return;
+  }
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) {
+    // Segundo worker no core do driver WiFi, que tem prioridade maior e o preempta
+    workers[i].index = i;
+    workers[i].core = i == 0 ? PROBE_WORKER_CORE : 1 - PROBE_WORKER_CORE;
+    hll_clear(&workers[i].macs_seen);
+#if OUTPUT_DELTA_ENABLED
+    wire_delta_init(&workers[i].delta, i * WIRE_DELTA_SLOTS);
+#endif
+    char name[16] = "probe_worker";
+    if (i > 0) snprintf(name, sizeof(name), "probe_worker%u", (unsigned)i);
+    xTaskCreatePinnedToCore(probe_worker_task, name, PROBE_WORKER_STACK_SIZE, &workers[i],
+                            PROBE_WORKER_PRIORITY, &workers[i].handle, workers[i].core);
+  }
+
+#if REPLAY_ENABLED
+  replay_setup();
+#endif
+
   // Configurar WiFi em modo promíscuo
   wifi_init_promiscuous();
 
-  Serial.printf("Sistema iniciado! Capture ID: %s\n", current_capture_id.c_str());
-  Serial.println("=========================================================================");
+#if OUTPUT_SINK == OUTPUT_SINK_ESPNOW
+  // Sink ESP-NOW: session distingue os boots deste nó no gateway
+  if (espnow_sink_begin(fnv1a_update(fnv1a_init(), (const uint8_t*)current_capture_id,
+                                     strlen(current_capture_id))) &&
+      output_add_sink(&espnow_sink)) {
+    output_printf("Sink ESP-NOW ativo no canal %d\n", ESPNOW_SINK_CHANNEL);
+  } else {
+    output_printf("Erro ao iniciar sink ESP-NOW\n");
+  }
+#endif
+
+#if FLASH_LOG_ENABLED
+  // Log circular em flash: registros continuam guardados sem host conectado
+  if (flash_log_sink_begin() && output_add_sink(&flash_log_sink)) {
+    flash_log_sink_stats_t log_stats;
+    flash_log_sink_get_stats(&log_stats);
+    output_printf("Log em flash: %u KB, %u páginas retidas\n", log_stats.partition_size / 1024,
+                  log_stats.used_pages);
+  } else {
+    output_printf("Log em flash indisponível (partição \"%s\" ausente)\n", FLASH_LOG_PARTITION);
+  }
+#endif
+
+  output_printf("Sistema iniciado! Capture ID: %s\n", current_capture_id);
+  output_printf("=========================================================================\n");
 
-  // Registrar tempo de inicialização
-  startup_time = millis();
+#if TIME_PPS_GPIO >= 0
+  // PPS de um receptor GNSS: alinha o modelo de tempo ao segundo inteiro
+  pinMode(TIME_PPS_GPIO, INPUT);
+  attachInterrupt(digitalPinToInterrupt(TIME_PPS_GPIO), pps_isr, RISING);
+#endif
+
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_BINARY
+  print_session_binary();
+#endif
 
   stats.uptime_ms = millis();
+  health_monitor_init(&health_monitor, millis());
+
+  // Watchdog de tasks com panic: probe_worker se inscreve na própria task,
+  // a loop() é alimentada pelo core do Arduino a cada iteração
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+  esp_task_wdt_config_t wdt_config = {};
+  wdt_config.timeout_ms = HEALTH_TASK_WDT_TIMEOUT_S * 1000;
+  wdt_config.idle_core_mask = 1 << 0;
+  wdt_config.trigger_panic = true;
+  esp_task_wdt_reconfigure(&wdt_config);
+#else
+  esp_task_wdt_init(HEALTH_TASK_WDT_TIMEOUT_S, true);
+#endif
+  enableLoopWDT();
 }
 
 void loop() {
   unsigned long current_time = millis();
 
-  // Verificar se é hora de reiniciar (a cada 1 hora)
-  if (current_time - startup_time >= RESTART_INTERVAL) {
-    Serial.println("# RESTART: Reiniciando ESP32 após 1 hora de operação...");
-    Serial.flush(); // Garantir que a mensagem seja enviada
-    delay(1000);
-    ESP.restart();
+  // Reboot apenas por gatilho do monitor de saúde (heap, ring parado, rádio mudo)
+  if (current_time - last_health_check >= HEALTH_CHECK_INTERVAL_MS) {
+    health_check(current_time);
+    last_health_check = current_time;
   }
 
-  // Alternar canal WiFi periodicamente para máxima cobertura
-  if (current_time - last_channel_switch > CHANNEL_SWITCH_INTERVAL) {
-    switch_channel();
-    last_channel_switch = current_time;
-  }
+  // Comandos do host pela serial (NODE, CLUSTER, ...)
+  host_commands_poll();
+
+  // Envio dos lotes dos sinks de rede
+  output_poll(current_time);
+
+  // Borda de PPS e âncoras periódicas do relógio de captura
+  time_sync_poll(current_time);
 
   // Imprimir estatísticas a cada 30 segundos
   if (current_time - last_stats_print > 30000) {
     print_system_stats();
+#if PERF_ENABLED
+    print_perf_stats();
+#endif
     last_stats_print = current_time;
   }
 
+  // Resumo (HLL e top-N) da janela que todos os workers já fecharam
+  print_window_summary();
+
+#if REPLAY_ENABLED
+  // Fim de um REPLAY: captura real retomada e relatório
+  replay_poll();
+#endif
+
   // Pequeno delay para não sobrecarregar o sistema
   delay(10);
 }
+#endif // PIO_UNIT_TESTING
 
 void wifi_init_promiscuous() {
   // Desconectar WiFi se estiver conectado
@@ -210,7 +333,7 @@ void wifi_init_promiscuous() {
 
 #ifdef ESP32_32U_EXTERNAL_ANTENNA
   // Configuração específica para ESP32-32U com antena externa
-  Serial.println("Configurando ESP32-32U com antena externa 2.4GHz...");
+  output_printf("Configurando ESP32-32U com antena externa 2.4GHz...\n");
 
   // Configurar GPIO para controle de antena (após WiFi init)
   wifi_ant_gpio_config_t ant_gpio_config = {
@@ -222,13 +345,13 @@ void wifi_init_promiscuous() {
 
   esp_err_t ant_result = esp_wifi_set_ant_gpio(&ant_gpio_config);
   if (ant_result == ESP_OK) {
-    Serial.println("GPIO antena configurado com sucesso");
+    output_printf("GPIO antena configurado com sucesso\n");
   } else {
-    Serial.printf("Erro ao configurar GPIO antena: %d (0x%x)\n", ant_result, ant_result);
+    output_printf("Erro ao configurar GPIO antena: %d (0x%x)\n", ant_result, ant_result);
     if (ant_result == 0x3001) {
-      Serial.println("ESP_ERR_WIFI_NOT_INIT - WiFi não inicializado");
+      output_printf("ESP_ERR_WIFI_NOT_INIT - WiFi não inicializado\n");
     } else if (ant_result == 0x3002) {
-      Serial.println("ESP_ERR_WIFI_NOT_STARTED - WiFi não iniciado");
+      output_printf("ESP_ERR_WIFI_NOT_STARTED - WiFi não iniciado\n");
     }
   }
 
@@ -243,45 +366,76 @@ void wifi_init_promiscuous() {
 
   esp_err_t ant_set_result = esp_wifi_set_ant(&ant_config);
   if (ant_set_result == ESP_OK) {
-    Serial.println("Configuração de antena externa aplicada com sucesso");
+    output_printf("Configuração de antena externa aplicada com sucesso\n");
   } else {
-    Serial.printf("Erro ao configurar antena externa: %d (0x%x)\n", ant_set_result, ant_set_result);
+    output_printf("Erro ao configurar antena externa: %d (0x%x)\n", ant_set_result, ant_set_result);
     if (ant_set_result == 0x3001) {
-      Serial.println("ESP_ERR_WIFI_NOT_INIT - WiFi não inicializado");
+      output_printf("ESP_ERR_WIFI_NOT_INIT - WiFi não inicializado\n");
     } else if (ant_set_result == 0x3002) {
-      Serial.println("ESP_ERR_WIFI_NOT_STARTED - WiFi não iniciado");
+      output_printf("ESP_ERR_WIFI_NOT_STARTED - WiFi não iniciado\n");
     } else if (ant_set_result == 0x3003) {
-      Serial.println("ESP_ERR_WIFI_CONN - WiFi interno erro de conexão");
+      output_printf("ESP_ERR_WIFI_CONN - WiFi interno erro de conexão\n");
     }
   }
 
   // Aumentar potência de transmissão para antena externa
   esp_wifi_set_max_tx_power(78); // 19.5 dBm (78/4)
-  Serial.println("Potência TX configurada para antena externa");
+  output_printf("Potência TX configurada para antena externa\n");
+#else
+  output_printf("Usando configuração padrão de antena interna\n");
+#endif
+
+  // Escalonador precisa estar pronto antes do callback começar a contar probes
+  channel_scheduler_setup();
+
+  // Filtro no driver: com CAPTURE_RX_FILTER_ALL o callback recebe também data e control,
+  // apenas para medir a carga evitada (rx em "# STATS:")
+  wifi_promiscuous_filter_t filter = {};
+#if CAPTURE_RX_FILTER == CAPTURE_RX_FILTER_ALL
+  filter.filter_mask = WIFI_PROMIS_FILTER_MASK_ALL;
+  wifi_promiscuous_filter_t ctrl_filter = {};
+  ctrl_filter.filter_mask = WIFI_PROMIS_CTRL_FILTER_MASK_ALL;
+  esp_wifi_set_promiscuous_ctrl_filter(&ctrl_filter);
 #else
-  Serial.println("Usando configuração padrão de antena interna");
+  filter.filter_mask = WIFI_PROMIS_FILTER_MASK_MGMT;
 #endif
+  esp_wifi_set_promiscuous_filter(&filter);
 
   // Configurar modo promíscuo
   esp_wifi_set_promiscuous(true);
   esp_wifi_set_promiscuous_rx_cb(&wifi_promiscuous_rx);
-  esp_wifi_set_channel(current_channel, WIFI_SECOND_CHAN_NONE);
-
-  stats.current_channel = current_channel;
-  Serial.printf("WiFi promiscuous mode iniciado no canal %d\n", current_channel);
+  switch_channel();
+
+  output_printf("WiFi promiscuous mode iniciado no canal %d (filtro: %s)\n",
+                stats.current_channel, capture_rx_filter_name());
+
+  // Trocas de canal por timer one-shot (reagendado a cada dwell), independentes do loop().
+  // Roda mesmo com um único canal para que uma nova divisão do cluster seja aplicada.
+  esp_timer_create_args_t timer_args = {};
+  timer_args.callback = &channel_hop_timer_cb;
+  timer_args.dispatch_method = ESP_TIMER_TASK;
+  timer_args.name = "channel_hop";
+  esp_timer_create(&timer_args, &channel_hop_timer);
+
+  stats.last_hop_us = (uint32_t)esp_timer_get_time();
+  channel_hop_target_us = channel_scheduler.dwell_target_ms * 1000;
+  esp_timer_start_once(channel_hop_timer, channel_hop_target_us);
 }
 
-void IRAM_ATTR wifi_promiscuous_rx(void* buf, wifi_promiscuous_pkt_type_t type) {
+// Corpo do callback; o wrapper mede o tempo de todos os caminhos de retorno
+static void IRAM_ATTR capture_rx(void* buf, wifi_promiscuous_pkt_type_t type) {
+  stats.rx_callbacks[type & 3]++;
   if (type != WIFI_PKT_MGMT) return;
 
-  // Verificar memória disponível antes de processar - aumentar threshold
-  if (ESP.getFreeHeap() < 20000) {
-    return; // Pular se memória muito baixa
-  }
-
   stats.total_packets++;
 
   wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)buf;
+#if CAPTURE_RX_FILTER == CAPTURE_RX_FILTER_PROBE_REQ
+  // Frame control = 0x40: management/probe request (demais subtipos saem aqui)
+  if (pkt->payload[0] != ((WIFI_FRAME_SUBTYPE_PROBE_REQ << 4) | (WIFI_FRAME_TYPE_MANAGEMENT << 2))) return;
+#endif
+  // Todo frame management alimenta a estimativa do offset rx -> esp_timer
+  rx_clock_observe(&rx_clock, (uint32_t)esp_timer_get_time(), pkt->rx_ctrl.timestamp);
   wifi_ieee80211_packet_t* ipkt = (wifi_ieee80211_packet_t*)pkt->payload;
   wifi_ieee80211_mac_hdr_t* hdr = &ipkt->hdr;
 
@@ -289,460 +443,1693 @@ void IRAM_ATTR wifi_promiscuous_rx(void* buf, wifi_promiscuous_pkt_type_t type)
   uint8_t frame_type = (hdr->frame_ctrl & 0x0C) >> 2;    // bits 3-2: type
   uint8_t frame_subtype = (hdr->frame_ctrl & 0xF0) >> 4; // bits 7-4: subtype
 
-  if (frame_type == WIFI_FRAME_TYPE_MANAGEMENT && frame_subtype == WIFI_FRAME_SUBTYPE_PROBE_REQ) {
-    stats.probe_requests++;
+  bool probe_request = frame_type == WIFI_FRAME_TYPE_MANAGEMENT && frame_subtype == WIFI_FRAME_SUBTYPE_PROBE_REQ;
+#if OUTPUT_FORMAT != OUTPUT_FORMAT_PCAP
+  if (!probe_request) {
+    return;
+  }
+#endif
+  // No modo pcap os demais frames management seguem sem filtro nem dwell
+
+  if (probe_request) stats.probe_requests++;
 
-    // Limitar processamento para evitar sobrecarga
-    static unsigned long last_process = 0;
-    if (millis() - last_process > 10) { // Processar no máximo a cada 10ms
-      parse_probe_request(pkt->payload, pkt->rx_ctrl.sig_len, pkt->rx_ctrl.rssi, pkt->rx_ctrl.channel);
-      last_process = millis();
+  // Captura sem perdas silenciosas: todo probe request é enfileirado ou
+  // contabilizado em um contador de descarte (ou de rejeição do filtro) com o motivo
+  uint16_t len = pkt->rx_ctrl.sig_len;
+  if (len < sizeof(wifi_ieee80211_mac_hdr_t)) {
+    stats.drops.truncated++;
+    return;
+  }
+
+  uint32_t dwell_id = 0;
+  if (probe_request) {
+    // Pré-filtro sobre cabeçalho, RSSI e IE de SSID (contadores por estágio no filtro)
+    if (!probe_filter_match(&probe_filter, pkt->payload, len - WIFI_FCS_LEN, pkt->rx_ctrl.rssi)) {
+      return;
     }
+
+    // O escalonador pondera os canais pelos probes que passam no filtro
+    dwell_id = channel_scheduler_count(&channel_scheduler, pkt->rx_ctrl.channel);
   }
+
+  // Apenas copiar o frame para o ring do worker do SA; o parsing acontece na probe_worker_task
+  probe_worker_t* worker = &workers[probe_worker_for(pkt->payload + 10)];
+  frame_slot_t* slot = frame_ring_reserve(&worker->ring);
+  if (slot == NULL) {
+    return; // contabilizado em ring.dropped (queue_full)
+  }
+
+  slot->clipped = len > FRAME_RING_SLOT_SIZE;
+  if (slot->clipped) {
+    len = FRAME_RING_SLOT_SIZE;
+    stats.frames_clipped++;
+  }
+  memcpy(slot->data, pkt->payload, len);
+  slot->len = len;
+  slot->orig_len = pkt->rx_ctrl.sig_len;
+  slot->rssi = pkt->rx_ctrl.rssi;
+  slot->channel = pkt->rx_ctrl.channel;
+  slot->timestamp_us = pkt->rx_ctrl.timestamp;
+  slot->dwell_id = dwell_id;
+  frame_ring_commit(&worker->ring);
+  stats.probes_queued++;
+  xTaskNotifyGive(worker->handle);
 }
 
-void parse_probe_request(const uint8_t* frame, size_t len, int8_t rssi, uint8_t channel) {
-  if (len < sizeof(wifi_ieee80211_mac_hdr_t)) return;
+void IRAM_ATTR wifi_promiscuous_rx(void* buf, wifi_promiscuous_pkt_type_t type) {
+  PERF_BEGIN(rx_start);
+  capture_rx(buf, type);
+  PERF_END(PERF_STAGE_RX_CALLBACK, rx_start);
+}
 
-  // Usar variável global estática em vez de malloc para evitar heap corruption
-  static capture_data_t capture;
+// Worker dono do SA: todo probe de um dispositivo cai no mesmo cache
+uint8_t IRAM_ATTR probe_worker_for(const uint8_t* sa) {
+#if PROBE_WORKER_COUNT > 1
+  return fnv1a_update(fnv1a_init(), sa, 6) % PROBE_WORKER_COUNT;
+#else
+  return 0;
+#endif
+}
 
-  wifi_ieee80211_packet_t* pkt = (wifi_ieee80211_packet_t*)frame;
+void probe_worker_task(void* arg) {
+  probe_worker_t* worker = (probe_worker_t*)arg;
+  perf_shard = worker->index;
+  worker->cache.window_start_ms = millis();
+  worker_sketch_roll(worker, millis());
+  esp_task_wdt_add(NULL);
+
+  bool backlog = false;
+  for (;;) {
+    if (backlog) {
+      // Lote cheio com frames pendentes: ceder o core por um tick. O worker
+      // do core 0 tem prioridade acima de IDLE0, que o task watchdog vigia
+      vTaskDelay(1);
+    } else {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PROBE_WORKER_IDLE_WAIT));
+    }
+    esp_task_wdt_reset();
+
+    // Drenar o ring em lotes de até PROBE_WORKER_BATCH_FRAMES frames
+    int64_t busy_start = esp_timer_get_time();
+    frame_slot_t* slot;
+    uint32_t drained = 0;
+    while (drained < PROBE_WORKER_BATCH_FRAMES && (slot = frame_ring_peek(&worker->ring)) != NULL) {
+      // Com o nó saturado o ring não esvazia: alimentar o watchdog durante a drenagem
+      if (++drained % PROBE_WORKER_WDT_RESET_FRAMES == 0) esp_task_wdt_reset();
+      PERF_SAMPLE(PERF_SAMPLE_RING_DEPTH, frame_ring_occupancy(&worker->ring));
+      PERF_BEGIN(frame_start);
+#if PERF_ENABLED
+      worker->frame_rx_timer_us =
+          rx_clock_to_timer(slot->timestamp_us, rx_offset_current(), esp_timer_get_time());
+#endif
+      process_frame(worker, slot);
+      PERF_END(PERF_STAGE_FRAME, frame_start);
+      frame_ring_release(&worker->ring);
+      worker->probes_parsed++;
+    }
+#if PERF_ENABLED
+    worker->frame_rx_timer_us = 0;  // registros da janela de agregação não têm frame de origem
+#endif
 
-  // Limpar estrutura antes do uso
-  memset(&capture, 0, sizeof(capture_data_t));
+    // Fechar a janela de agregação (no modo frames apenas reinicia os agregados)
+    uint32_t now = millis();
+    if (now - worker->cache.window_start_ms >= AGGREGATION_WINDOW_MS) {
+      device_cache_flush(&worker->cache, now);
+    }
+    worker_sketch_roll(worker, now);
+
+    // O lote parcial vai para o transporte antes de dormir (ou de ceder o core)
+    worker_flush(worker);
+    worker->busy_us += esp_timer_get_time() - busy_start;
+    backlog = frame_ring_peek(&worker->ring) != NULL;
+  }
+}
+
+void process_frame(probe_worker_t* worker, const frame_slot_t* slot) {
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_PCAP
+  print_capture_pcap(worker, slot);
+  return;
+#endif
+  capture_data_t& capture = worker->capture;
+
+  PERF_BEGIN(parse_start);
+  bool parsed = parse_probe_request(slot->data, slot->len, !slot->clipped, slot->rssi, slot->channel, capture);
+  PERF_END(PERF_STAGE_PARSE, parse_start);
+  if (!parsed) {
+    return;
+  }
+  if (capture.packet.ies.truncated) worker->ies_truncated++;
+  if (capture.packet.ies.malformed) worker->ies_malformed++;
 
-  // Preencher dados básicos da captura
   capture.capture_id = current_capture_id;
-  capture.capture_ts = get_iso8601_timestamp();
-  capture.scanner_id = NODE_ID;
+  capture.scanner_id = node_config.node_id;
   capture.firmware = FIRMWARE_VERSION;
+  capture.scanner_tag = scanner_tag;
+  capture.packet.pkt_seq = packet_counter.fetch_add(1, std::memory_order_relaxed);
+  capture.packet.radio.dwell_id = slot->dwell_id;
+  capture.packet.radio.rx_us = slot->timestamp_us;
+
+  // Segundos e milissegundos do mesmo instante: o de chegada do frame
+  int64_t epoch_us = rx_to_epoch_us(slot->timestamp_us);
+  capture.capture_epoch_s = (uint32_t)(epoch_us / 1000000);
+  capture.capture_ms = (uint16_t)(epoch_us % 1000000 / 1000);
+
+  PERF_BEGIN(cache_start);
+  uint32_t now_ms = millis();
+#if TRACK_CORRELATION_ENABLED
+#if PROBE_WORKER_COUNT > 1
+  portENTER_CRITICAL(&track_mux);
+#endif
+  capture.packet.track_id = track_correlator_observe(&track_correlator, capture.packet.ieee80211.sa,
+                                                     capture.packet.fingerprint.ie_hash,
+                                                     capture.packet.mac_randomized,
+                                                     capture.packet.ieee80211.seq_ctrl, slot->rssi, now_ms);
+#if PROBE_WORKER_COUNT > 1
+  portEXIT_CRITICAL(&track_mux);
+#endif
+#endif
+  device_cache_observe(&worker->cache, capture.packet.ieee80211.sa,
+                       capture.packet.fingerprint.ie_hash, capture.packet.mac_randomized,
+                       capture.packet.track_id, slot->rssi, slot->channel, now_ms);
+  hll_add(&worker->macs_seen, sketch_mix32(fnv1a_update(fnv1a_init(), capture.packet.ieee80211.sa, 6)));
+  PERF_END(PERF_STAGE_DEVICE_CACHE, cache_start);
+
+#if SUMMARY_WINDOW_MS > 0
+  char ssid[SSID_MAX_LEN + 1];
+  size_t ssid_len = ie_decode_ssid(&capture.packet.ies, ssid, sizeof(ssid));
+  window_sketch_observe(&worker->sketches[worker->sketch_current], capture.packet.ieee80211.sa,
+                        capture.packet.fingerprint.ie_hash, ssid, ssid_len);
+#endif
 
-  // Preencher dados do pacote
-  capture.packet.pkt_id = generate_packet_id();
-
-  // Informações de rádio
-  capture.packet.radio.channel = channel;
-  capture.packet.radio.freq_mhz = CHANNEL_TO_FREQ(channel);
-  capture.packet.radio.band = "2.4GHz";
-  capture.packet.radio.bandwidth_mhz = 20;
-  capture.packet.radio.antenna = 0;
-
-  // Informações IEEE 802.11
-  capture.packet.ieee80211.type = "management";
-  capture.packet.ieee80211.subtype = "probe-request";
-  capture.packet.ieee80211.duration = pkt->hdr.duration_id;
-  capture.packet.ieee80211.seq_ctrl = (pkt->hdr.sequence_ctrl & 0xFFF0) >> 4;
-
-  // Endereços
-  memcpy(capture.packet.ieee80211.da, pkt->hdr.addr1, 6);    // destination
-  memcpy(capture.packet.ieee80211.sa, pkt->hdr.addr2, 6);    // source
-  memcpy(capture.packet.ieee80211.bssid, pkt->hdr.addr3, 6); // BSSID
-
-  // RSSI
-  capture.packet.rssi_dbm = rssi;
-
-  // Frame raw em hex (limitar tamanho para economizar memória)
-  size_t hex_len = (len > 64) ? 64 : len; // Reduzir ainda mais para 64 bytes
-  capture.packet.frame_raw_hex = frame_to_hex(frame, hex_len);
-
-  // Analisar MAC randomization
-  capture.packet.mac_randomized = is_randomized_mac(pkt->hdr.addr2);
-
-  // OUI e vendor
-  capture.packet.oui = mac_to_string(pkt->hdr.addr2).substring(0, 8);
-  capture.packet.vendor_inferred = get_vendor_from_mac(pkt->hdr.addr2);
-
-  // Extrair Information Elements se há payload
-  size_t payload_offset = sizeof(wifi_ieee80211_mac_hdr_t);
-  if (len > payload_offset) {
-    extract_information_elements(frame + payload_offset, len - payload_offset, capture.packet);
-  }
-
-  // Criar fingerprint
-  capture.packet.fingerprint.ie_signature = create_fingerprint(capture.packet);
-  capture.packet.fingerprint.confidence = 0.65; // valor padrão
-
-  // Imprimir resultado
-  print_capture_data(capture);
-}
-
-void extract_information_elements(const uint8_t* payload, size_t payload_len, packet_data_t& packet) {
-  size_t offset = 0;
-
-  // Inicializar estruturas
-  packet.probe.ssid = "";
-  packet.probe.ssid_hidden = false;
-  packet.capabilities.supported_rates_count = 0;
-  packet.capabilities.extended_rates_count = 0;
-  packet.capabilities.ht_capabilities.present = false;
-  packet.capabilities.vht_capabilities = false;
-  packet.capabilities.he_capabilities = false;
-  packet.vendor_ies_count = 0;
-  packet.ies_count = 0;
-
-  // Pular os campos fixos do probe request (timestamp, beacon interval, capability info)
-  offset += 12; // 8 bytes timestamp + 2 bytes beacon interval + 2 bytes capability
-
-  // Processar Information Elements
-  while (offset + 2 < payload_len && packet.ies_count < MAX_IES) {
-    uint8_t element_id = payload[offset];
-    uint8_t element_length = payload[offset + 1];
-
-    if (offset + 2 + element_length > payload_len) break;
-
-    // Armazenar IE raw
-    if (packet.ies_count < MAX_IES) {
-      packet.ies_raw[packet.ies_count].id = element_id;
-      packet.ies_raw[packet.ies_count].len = element_length;
-      uint8_t copy_len = (element_length > 64) ? 64 : element_length; // Limitar a 64 bytes
-      memcpy(packet.ies_raw[packet.ies_count].value, payload + offset + 2, copy_len);
-      packet.ies_count++;
-    }
+#if OUTPUT_MODE == OUTPUT_MODE_FRAMES
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_BINARY
+  print_capture_binary(worker, capture);
+#else
+  print_capture_data(worker, capture);
+#endif
+#endif
+}
 
-    switch (element_id) {
-      case IE_SSID:
-        if (element_length > 0 && element_length <= 32) {
-          packet.probe.ssid = "";
-          for (uint8_t i = 0; i < element_length; i++) {
-            char c = payload[offset + 2 + i];
-            if (c >= 32 && c <= 126) {
-              packet.probe.ssid += c;
-            }
-          }
-        } else {
-          packet.probe.ssid = "";
-          packet.probe.ssid_hidden = false;
-        }
-        break;
-
-      case IE_SUPPORTED_RATES:
-        if (element_length <= 16) {
-          for (uint8_t i = 0; i < element_length && packet.capabilities.supported_rates_count < 16; i++) {
-            uint8_t rate = payload[offset + 2 + i] & 0x7F; // Remove MSB
-            packet.capabilities.supported_rates[packet.capabilities.supported_rates_count++] = rate;
-          }
-        }
-        break;
-
-      case IE_EXTENDED_RATES:
-        if (element_length <= 16) {
-          for (uint8_t i = 0; i < element_length && packet.capabilities.extended_rates_count < 16; i++) {
-            uint8_t rate = payload[offset + 2 + i] & 0x7F; // Remove MSB
-            packet.capabilities.extended_rates[packet.capabilities.extended_rates_count++] = rate;
-          }
-        }
-        break;
-
-      case IE_HT_CAPABILITIES:
-        if (element_length >= 26) {
-          packet.capabilities.ht_capabilities.present = true;
-          packet.capabilities.ht_capabilities.mcs_set = "0-7"; // Simplificado
-        }
-        break;
-
-      case IE_VHT_CAPABILITIES:
-        if (element_length >= 12) {
-          packet.capabilities.vht_capabilities = true;
-        }
-        break;
-
-      case IE_VENDOR_SPECIFIC:
-        if (element_length >= 3 && packet.vendor_ies_count < MAX_VENDOR_IES) {
-          vendor_ie_t& vendor_ie = packet.vendor_ies[packet.vendor_ies_count];
-          memcpy(vendor_ie.oui, payload + offset + 2, 3);
-          vendor_ie.vendor_type = element_length > 3 ? payload[offset + 5] : 0;
-          vendor_ie.payload_len = element_length > 4 ? element_length - 4 : 0;
-          if (vendor_ie.payload_len > 64) vendor_ie.payload_len = 64; // Limitar a 64 bytes
-          if (vendor_ie.payload_len > 0) {
-            memcpy(vendor_ie.payload, payload + offset + 6, vendor_ie.payload_len);
-          }
-          vendor_ie.meaning = ""; // Pode ser preenchido com lógica específica
-          packet.vendor_ies_count++;
-        }
-        break;
-    }
+#if PERF_ENABLED
+// Latência da chegada do frame (relógio do esp_timer) até a entrega ao transporte
+static void perf_sample_rx_to_emit(int64_t rx_timer_us) {
+  if (rx_timer_us != 0) PERF_SAMPLE(PERF_SAMPLE_RX_TO_EMIT, (uint32_t)(esp_timer_get_time() - rx_timer_us));
+}
+#endif
 
-    offset += 2 + element_length;
-  }
-}
-
-String frame_to_hex(const uint8_t* frame, size_t len) {
-  // Limitar drasticamente o tamanho para evitar uso excessivo de memória
-  if (len > 32) len = 32; // Reduzir para apenas 32 bytes
-
-  String hex = "";
-  hex.reserve(len * 2 + 1); // Pre-allocate string
-
-  for (size_t i = 0; i < len; i++) {
-    char buf[3];
-    sprintf(buf, "%02x", frame[i]);
-    hex += buf;
-  }
-  return hex;
-}String mac_to_string(const uint8_t* mac) {
-  char mac_str[18];
-  sprintf(mac_str, "%02x:%02x:%02x:%02x:%02x:%02x",
-          mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-  return String(mac_str);
-}
-
-void print_capture_data(const capture_data_t& capture) {
-  JsonDocument doc;
-
-  // Campos obrigatórios do schema
-  doc["capture_id"] = capture.capture_id;
-  doc["capture_ts"] = capture.capture_ts;
-  doc["scanner_id"] = capture.scanner_id;
-  doc["firmware"] = capture.firmware;
-
-  // Opcional: location (null por enquanto)
-  doc["location"]["lat"] = nullptr;
-  doc["location"]["lon"] = nullptr;
-  doc["location"]["label"] = nullptr;
-
-  // Objeto packet (obrigatório)
-  JsonObject packet = doc["packet"].to<JsonObject>();
-  packet["pkt_id"] = capture.packet.pkt_id;
-
-  // Radio info
-  JsonObject radio = packet["radio"].to<JsonObject>();
-  radio["channel"] = capture.packet.radio.channel;
-  radio["freq_mhz"] = capture.packet.radio.freq_mhz;
-  radio["band"] = capture.packet.radio.band;
-  radio["bandwidth_mhz"] = capture.packet.radio.bandwidth_mhz;
-  radio["antenna"] = capture.packet.radio.antenna;
-
-  // IEEE 802.11 info
-  JsonObject ieee80211 = packet["ieee80211"].to<JsonObject>();
-  ieee80211["type"] = capture.packet.ieee80211.type;
-  ieee80211["subtype"] = capture.packet.ieee80211.subtype;
-  ieee80211["duration"] = capture.packet.ieee80211.duration;
-  ieee80211["da"] = mac_to_string(capture.packet.ieee80211.da);
-  ieee80211["sa"] = mac_to_string(capture.packet.ieee80211.sa);
-  ieee80211["bssid"] = mac_to_string(capture.packet.ieee80211.bssid);
-  ieee80211["seq_ctrl"] = capture.packet.ieee80211.seq_ctrl;
-
-  // Campos obrigatórios do packet
-  packet["rssi_dbm"] = capture.packet.rssi_dbm;
-  packet["frame_raw_hex"] = capture.packet.frame_raw_hex;
-
-  // Probe info
-  JsonObject probe = packet["probe"].to<JsonObject>();
-  probe["ssid"] = capture.packet.probe.ssid;
-  probe["ssid_hidden"] = capture.packet.probe.ssid_hidden;
-
-  // Supported rates
-  if (capture.packet.capabilities.supported_rates_count > 0) {
-    JsonArray supported_rates = packet["supported_rates"].to<JsonArray>();
-    for (uint8_t i = 0; i < capture.packet.capabilities.supported_rates_count; i++) {
-      supported_rates.add(capture.packet.capabilities.supported_rates[i]);
-    }
+// Registro inteiro de um worker: acumulado no lote ou escrito direto
+void worker_output(probe_worker_t* worker, const uint8_t* data, size_t len) {
+#if OUTPUT_BATCH_SIZE > 0
+  if (worker->batch_len + len > OUTPUT_BATCH_SIZE) worker_flush(worker);
+  if (len <= OUTPUT_BATCH_SIZE) {
+#if PERF_ENABLED
+    // O lote inteiro sai junto: a latência medida é a do registro mais antigo
+    if (worker->batch_len == 0) worker->batch_rx_timer_us = worker->frame_rx_timer_us;
+#endif
+    memcpy(worker->batch + worker->batch_len, data, len);
+    worker->batch_len += len;
+    worker->batch_records++;
+    return;
   }
+#endif
+  PERF_BEGIN(output_start);
+  output_write(data, len);
+  PERF_END(PERF_STAGE_OUTPUT, output_start);
+#if PERF_ENABLED
+  perf_sample_rx_to_emit(worker->frame_rx_timer_us);
+#endif
+}
+
+// Entrega o lote ao transporte (o lock do transporte junta os lotes dos workers)
+void worker_flush(probe_worker_t* worker) {
+#if OUTPUT_BATCH_SIZE > 0
+  if (worker->batch_len == 0) return;
+  PERF_BEGIN(output_start);
+  output_write_records(worker->batch, worker->batch_len, worker->batch_records);
+  PERF_END(PERF_STAGE_OUTPUT, output_start);
+#if PERF_ENABLED
+  perf_sample_rx_to_emit(worker->batch_rx_timer_us);
+#endif
+  worker->batches++;
+  worker->batch_len = 0;
+  worker->batch_records = 0;
+#endif
+}
+
+void print_capture_data(probe_worker_t* worker, const capture_data_t& capture) {
+  PERF_BEGIN(serialize_start);
+  size_t len = format_capture_json(capture, worker->json, sizeof(worker->json));
+  PERF_END(PERF_STAGE_SERIALIZE, serialize_start);
+  if (len == 0) {
+    worker->json_overflows++;
+    return;
+  }
+  worker_output(worker, (const uint8_t*)worker->json, len);
+}
 
-  // Extended rates
-  if (capture.packet.capabilities.extended_rates_count > 0) {
-    JsonArray extended_rates = packet["extended_rates"].to<JsonArray>();
-    for (uint8_t i = 0; i < capture.packet.capabilities.extended_rates_count; i++) {
-      extended_rates.add(capture.packet.capabilities.extended_rates[i]);
+void print_capture_binary(probe_worker_t* worker, const capture_data_t& capture) {
+  // O registro binário enquadrado cabe no buffer JSON do worker
+  static_assert(WIRE_FRAMED_SIZE(WIRE_PACKET_HEADER_SIZE + FRAME_RING_SLOT_SIZE) <= JSON_BUFFER_SIZE,
+                "JSON_BUFFER_SIZE menor que um registro binário");
+  uint8_t* framed = (uint8_t*)worker->json;
+  PERF_BEGIN(serialize_start);
+#if OUTPUT_DELTA_ENABLED
+  size_t framed_len = encode_capture_binary_delta(capture, &worker->delta, framed, sizeof(worker->json));
+#else
+  size_t framed_len = encode_capture_binary(capture, framed, sizeof(worker->json));
+#endif
+  PERF_END(PERF_STAGE_SERIALIZE, serialize_start);
+  if (framed_len > 0) {
+    worker_output(worker, framed, framed_len);
+  }
+}
+
+// Frame bruto como registro pcap enquadrado, sem parsing (OUTPUT_FORMAT_PCAP)
+void print_capture_pcap(probe_worker_t* worker, const frame_slot_t* slot) {
+  static_assert(WIRE_FRAMED_SIZE(WIRE_PCAP_HEADER_SIZE + FRAME_RING_SLOT_SIZE) <= JSON_BUFFER_SIZE,
+                "JSON_BUFFER_SIZE menor que um registro pcap");
+  uint8_t record[WIRE_PCAP_HEADER_SIZE + FRAME_RING_SLOT_SIZE];
+  uint8_t* framed = (uint8_t*)worker->json;
+
+  int64_t epoch_us = rx_to_epoch_us(slot->timestamp_us);
+  wire_pcap_t pcap;
+  pcap.ts_sec = (uint32_t)(epoch_us / 1000000);
+  pcap.ts_usec = (uint32_t)(epoch_us % 1000000);
+  pcap.rx_us = slot->timestamp_us;
+  pcap.freq_mhz = CHANNEL_TO_FREQ(slot->channel);
+  pcap.rssi_dbm = slot->rssi;
+  pcap.orig_len = slot->orig_len;
+
+  PERF_BEGIN(serialize_start);
+  size_t record_len = wire_encode_pcap(record, sizeof(record), &pcap, slot->data, slot->len);
+  size_t framed_len = record_len ? wire_frame(record, record_len, framed, sizeof(worker->json)) : 0;
+  PERF_END(PERF_STAGE_SERIALIZE, serialize_start);
+  if (framed_len > 0) {
+    worker_output(worker, framed, framed_len);
+  }
+}
+
+void print_session_binary() {
+  uint8_t record[128];
+  uint8_t framed[WIRE_FRAMED_SIZE(sizeof(record))];
+
+  wire_session_t session;
+  session.epoch_s = get_current_timestamp();
+  session.uptime_ms = millis();
+  session.capture_id = current_capture_id;
+  session.scanner_id = node_config.node_id;
+  session.firmware = FIRMWARE_VERSION;
+
+  size_t record_len = wire_encode_session(record, sizeof(record), &session);
+  size_t framed_len = wire_frame(record, record_len, framed, sizeof(framed));
+  if (framed_len > 0) {
+    output_write(framed, framed_len);
+  }
+}
+
+// Converte um instante em millis() para epoch (us), por um único snapshot do modelo de tempo
+static int64_t uptime_to_epoch_us(uint32_t ms) {
+  time_model_t m = time_model_snapshot();
+  return time_model_epoch_us(&m, esp_timer_get_time()) - (int64_t)(millis() - ms) * 1000;
+}
+
+static uint32_t uptime_to_epoch(uint32_t ms) {
+  return (uint32_t)(uptime_to_epoch_us(ms) / 1000000);
+}
+
+// ISO8601 de um instante em millis(): segundos e milissegundos do mesmo valor
+static inline void format_uptime_timestamp(char* out, uint32_t ms) {
+  int64_t epoch_us = uptime_to_epoch_us(ms);
+  format_iso8601_timestamp(out, (uint32_t)(epoch_us / 1000000), (uint16_t)(epoch_us % 1000000 / 1000));
+}
+
+// Emissão do cache de um worker (ctx): flush da janela ou despejo
+void print_device_record(void* ctx, const device_entry_t* entry, uint32_t window_start_ms) {
+  probe_worker_t* worker = (probe_worker_t*)ctx;
+  int8_t rssi_avg = entry->window_count ? entry->rssi_sum / (int32_t)entry->window_count : 0;
+
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_BINARY
+  wire_device_t device;
+  device.window_start_s = uptime_to_epoch(window_start_ms);
+  device.first_seen_s = uptime_to_epoch(entry->window_first_ms);
+  device.last_seen_s = uptime_to_epoch(entry->last_seen_ms);
+  memcpy(device.sa, entry->sa, 6);
+  device.fp_hash = entry->fp_hash;
+  device.count = entry->window_count;
+  device.rssi_min = entry->rssi_min;
+  device.rssi_max = entry->rssi_max;
+  device.rssi_avg = rssi_avg;
+  device.channels_mask = entry->channels_mask;
+  device.flags = entry->mac_randomized ? WIRE_DEVICE_FLAG_RANDOMIZED : 0;
+  device.track_id = entry->track_id;
+
+  uint8_t record[WIRE_DEVICE_RECORD_SIZE];
+  uint8_t framed[WIRE_FRAMED_SIZE(WIRE_DEVICE_RECORD_SIZE)];
+  size_t record_len = wire_encode_device(record, sizeof(record), &device);
+  size_t framed_len = wire_frame(record, record_len, framed, sizeof(framed));
+  if (framed_len > 0) {
+    worker_output(worker, framed, framed_len);
+  }
+#else
+  char* output = worker->json;
+  json_writer_t w;
+  json_begin(&w, output, sizeof(worker->json) - 2);
+
+  char ts[32];
+  char oui[9];
+  char fp_hash[9];
+
+  json_raw(&w, "# DEVICE: ");
+  json_object_begin(&w);
+  json_kv_string(&w, "type", "device");
+  json_kv_string(&w, "capture_id", current_capture_id);
+  json_kv_string(&w, "scanner_id", node_config.node_id);
+  format_uptime_timestamp(ts, window_start_ms);
+  json_kv_string(&w, "window_start_ts", ts);
+  json_kv_uint(&w, "window_ms", AGGREGATION_WINDOW_MS);
+  json_key(&w, "sa");
+  json_mac(&w, entry->sa);
+  format_oui(entry->sa, oui);
+  json_kv_string(&w, "oui", oui);
+  json_kv_bool(&w, "mac_randomized", entry->mac_randomized);
+  json_kv_string(&w, "vendor_inferred", get_vendor_from_mac(entry->sa));
+  hex_encode_u32(entry->fp_hash, fp_hash);
+  json_kv_string(&w, "fp_hash", fp_hash);
+  if (entry->track_id != TRACK_ID_NONE) json_kv_uint(&w, "track_id", entry->track_id);
+  format_uptime_timestamp(ts, entry->window_first_ms);
+  json_kv_string(&w, "first_seen_ts", ts);
+  format_uptime_timestamp(ts, entry->last_seen_ms);
+  json_kv_string(&w, "last_seen_ts", ts);
+  json_kv_uint(&w, "count", entry->window_count);
+  json_kv_uint(&w, "total_count", entry->total_count);
+  json_kv_int(&w, "rssi_min", entry->rssi_min);
+  json_kv_int(&w, "rssi_max", entry->rssi_max);
+  json_kv_int(&w, "rssi_avg", rssi_avg);
+  json_key(&w, "channels");
+  json_array_begin(&w);
+  for (uint8_t ch = 1; ch <= MAX_CHANNELS; ch++) {
+    if (entry->channels_mask & (1u << ch)) json_uint(&w, ch);
+  }
+  json_array_end(&w);
+  json_object_end(&w);
+
+  if (w.overflow) {
+    worker->json_overflows++;
+    return;
+  }
+  output[w.len++] = '\r';
+  output[w.len++] = '\n';
+  worker_output(worker, (const uint8_t*)output, w.len);
+#endif
+}
+
+uint8_t build_channel_plan(uint8_t* channels) {
+#if CHANNEL_SCHED_MODE == CHANNEL_SCHED_FIXED_LIST
+  static const uint8_t source[] = CHANNEL_SCHED_LIST;
+  uint8_t source_count = sizeof(source) / sizeof(source[0]);
+#else
+  // Nó isolado varre 1..MAX_CHANNELS em ordem; em cluster os primários são divididos primeiro
+  static const uint8_t priority[] = CHANNEL_PRIORITY_ORDER;
+  uint8_t sequential[MAX_CHANNELS];
+  for (uint8_t i = 0; i < MAX_CHANNELS; i++) {
+    sequential[i] = i + 1;
+  }
+  const uint8_t* source = node_config.cluster_size > 1 ? priority : sequential;
+  uint8_t source_count = node_config.cluster_size > 1 ? sizeof(priority) / sizeof(priority[0])
+                                                       : MAX_CHANNELS;
+#endif
+
+  uint8_t count = channel_plan_partition(source, source_count, node_config.cluster_index,
+                                         node_config.cluster_size, channels);
+  if (count == 0) {
+    // Mais nós do que canais: este nó repete o canal da sua posição módulo a lista
+    channels[0] = source[node_config.cluster_index % source_count];
+    count = 1;
+  }
+
+#if OUTPUT_SINK == OUTPUT_SINK_ESPNOW
+  // Os lotes só saem no canal do gateway: todo nó precisa visitá-lo
+  bool has_sink_channel = false;
+  for (uint8_t i = 0; i < count; i++) {
+    if (channels[i] == ESPNOW_SINK_CHANNEL) has_sink_channel = true;
+  }
+  if (!has_sink_channel && count < CHANNEL_SCHED_MAX_CHANNELS) {
+    channels[count++] = ESPNOW_SINK_CHANNEL;
+  }
+#endif
+  return count;
+}
+
+void channel_scheduler_setup() {
+  uint8_t channels[CHANNEL_SCHED_MAX_CHANNELS];
+  uint8_t count = build_channel_plan(channels);
+
+  channel_scheduler_init(&channel_scheduler, CHANNEL_SCHED_MODE, channels, count,
+                         CHANNEL_SWITCH_INTERVAL, millis());
+}
+
+void print_cluster_status() {
+  char line[OUTPUT_LINE_MAX];
+  int len = snprintf(line, sizeof(line),
+                     "# CLUSTER: {\"node_id\":\"%s\",\"cluster_index\":%u,\"cluster_size\":%u,\"channels\":[",
+                     node_config.node_id, node_config.cluster_index, node_config.cluster_size);
+  uint8_t channels[CHANNEL_SCHED_MAX_CHANNELS];
+  uint8_t count = build_channel_plan(channels);
+  for (uint8_t i = 0; i < count; i++) {
+    len += snprintf(line + len, sizeof(line) - len, "%s%u", i ? "," : "", channels[i]);
+  }
+  snprintf(line + len, sizeof(line) - len, "]}\n");
+  output_printf("%s", line);
+}
+
+void cmd_cluster(const char* args) {
+  unsigned index = 0;
+  unsigned size = 1;
+
+  if (args[0] == '\0') {
+    print_cluster_status();
+    return;
+  }
+  if (strcasecmp(args, "OFF") != 0) {
+    if (sscanf(args, "%u %u", &index, &size) != 2 || size == 0 || size > CHANNEL_SCHED_MAX_CHANNELS ||
+        index >= size) {
+      output_printf("# ERROR: {\"command\":\"CLUSTER\",\"error\":\"usage: CLUSTER <index> <size>|OFF\"}\n");
+      return;
     }
   }
 
-  // HT capabilities
-  if (capture.packet.capabilities.ht_capabilities.present) {
-    JsonObject ht_cap = packet["ht_capabilities"].to<JsonObject>();
-    ht_cap["present"] = true;
-    ht_cap["mcs_set"] = capture.packet.capabilities.ht_capabilities.mcs_set;
-  } else {
-    packet["ht_capabilities"] = nullptr;
+  // A task do timer aplica a nova lista na próxima troca (sem parar a captura)
+  if (channel_plan_pending.load(std::memory_order_acquire)) {
+    output_printf("# ERROR: {\"command\":\"CLUSTER\",\"error\":\"previous plan not applied yet\"}\n");
+    return;
   }
 
-  // VHT e HE capabilities
-  if (capture.packet.capabilities.vht_capabilities) {
-    packet["vht_capabilities"]["present"] = true;
+  node_config.cluster_index = index;
+  node_config.cluster_size = size;
+  node_config_save_cluster(index, size);
+
+  pending_channel_count = build_channel_plan(pending_channels);
+  channel_plan_pending.store(true, std::memory_order_release);
+  print_cluster_status();
+}
+
+// "aa:bb:cc[:dd:ee:ff][/bits]" - prefixo sem /bits usa o número de octetos informados
+static bool parse_mac_prefix(const char* s, uint8_t* addr, uint8_t* prefix_bits) {
+  uint8_t octets = 0;
+  memset(addr, 0, 6);
+  while (octets < 6) {
+    char* end;
+    unsigned long v = strtoul(s, &end, 16);
+    if (end == s || end - s > 2 || v > 0xFF) return false;
+    addr[octets++] = (uint8_t)v;
+    s = end;
+    if (*s != ':') break;
+    s++;
+  }
+
+  *prefix_bits = octets * 8;
+  if (*s == '/') {
+    char* end;
+    unsigned long bits = strtoul(s + 1, &end, 10);
+    if (end == s + 1 || bits == 0 || bits > 48) return false;
+    *prefix_bits = (uint8_t)bits;
+    s = end;
+  }
+  return *s == '\0';
+}
+
+void print_filter_status() {
+  static const char prefix[] = "# FILTER: ";
+  static char output[768];
+  const probe_filter_rules_t* rules = probe_filter_rules(&probe_filter);
+  const probe_filter_counters_t& c = probe_filter.counters;
+  json_writer_t w;
+
+  // Prefixo no mesmo buffer: a linha sai em uma única escrita
+  memcpy(output, prefix, sizeof(prefix) - 1);
+  json_begin(&w, output + sizeof(prefix) - 1, sizeof(output) - (sizeof(prefix) - 1));
+  json_object_begin(&w);
+  if (rules->rssi_min == PROBE_FILTER_RSSI_ANY) {
+    json_kv_null(&w, "rssi_min");
   } else {
-    packet["vht_capabilities"] = nullptr;
+    json_kv_int(&w, "rssi_min", rules->rssi_min);
+  }
+  static const char* const randomized_names[] = {"any", "only", "exclude"};
+  json_kv_string(&w, "randomized", randomized_names[rules->randomized]);
+
+  json_key(&w, "macs");
+  json_array_begin(&w);
+  for (uint8_t i = 0; i < rules->mac_count; i++) {
+    const probe_filter_mac_t& m = rules->macs[i];
+    json_object_begin(&w);
+    json_key(&w, "mac");
+    json_mac(&w, m.addr);
+    json_kv_uint(&w, "bits", m.prefix_bits);
+    json_kv_string(&w, "action", m.action == PROBE_FILTER_MAC_DENY ? "deny" : "allow");
+    json_object_end(&w);
   }
+  json_array_end(&w);
 
-  if (capture.packet.capabilities.he_capabilities) {
-    packet["he_capabilities"]["present"] = true;
+  json_key(&w, "ssids");
+  json_array_begin(&w);
+  for (uint8_t i = 0; i < rules->ssid_count; i++) {
+    json_string(&w, rules->ssids[i]);
+  }
+  json_array_end(&w);
+
+  json_key(&w, "counters");
+  json_object_begin(&w);
+  json_kv_uint(&w, "checked", c.checked);
+  json_kv_uint(&w, "accepted", c.accepted);
+  json_kv_uint(&w, "rssi", c.rejected_rssi);
+  json_kv_uint(&w, "randomized", c.rejected_randomized);
+  json_kv_uint(&w, "mac", c.rejected_mac);
+  json_kv_uint(&w, "ssid", c.rejected_ssid);
+  json_object_end(&w);
+  json_object_end(&w);
+
+  if (!w.overflow) {
+    // "\n" cabe no espaço reservado por json_begin()
+    output[sizeof(prefix) - 1 + w.len] = '\n';
+    output_write((const uint8_t*)output, sizeof(prefix) + w.len);
+  }
+}
+
+void cmd_filter(const char* args) {
+  probe_filter_rules_t rules;
+  memcpy(&rules, probe_filter_rules(&probe_filter), sizeof(rules));
+
+  char sub[12];
+  size_t n = 0;
+  while (args[n] && args[n] != ' ' && n < sizeof(sub) - 1) {
+    sub[n] = args[n];
+    n++;
+  }
+  sub[n] = '\0';
+  const char* value = args + n;
+  while (*value == ' ') value++;
+
+  bool ok = true;
+  if (sub[0] == '\0') {
+    print_filter_status();
+    return;
+  } else if (strcasecmp(sub, "CLEAR") == 0) {
+    probe_filter_rules_clear(&rules);
+  } else if (strcasecmp(sub, "RSSI") == 0) {
+    char* end;
+    long dbm = strtol(value, &end, 10);
+    if (strcasecmp(value, "OFF") == 0) {
+      rules.rssi_min = PROBE_FILTER_RSSI_ANY;
+    } else if (end != value && *end == '\0' && dbm >= -127 && dbm <= 0) {
+      rules.rssi_min = (int8_t)dbm;
+    } else {
+      ok = false;
+    }
+  } else if (strcasecmp(sub, "RANDOMIZED") == 0) {
+    if (strcasecmp(value, "ONLY") == 0) {
+      rules.randomized = PROBE_FILTER_RANDOMIZED_ONLY;
+    } else if (strcasecmp(value, "EXCLUDE") == 0) {
+      rules.randomized = PROBE_FILTER_RANDOMIZED_EXCLUDE;
+    } else if (strcasecmp(value, "ANY") == 0) {
+      rules.randomized = PROBE_FILTER_RANDOMIZED_ANY;
+    } else {
+      ok = false;
+    }
+  } else if (strcasecmp(sub, "ALLOW") == 0 || strcasecmp(sub, "DENY") == 0) {
+    uint8_t addr[6];
+    uint8_t bits;
+    uint8_t action = strcasecmp(sub, "DENY") == 0 ? PROBE_FILTER_MAC_DENY : PROBE_FILTER_MAC_ALLOW;
+    ok = parse_mac_prefix(value, addr, &bits) && probe_filter_add_mac(&rules, addr, bits, action);
+  } else if (strcasecmp(sub, "SSID") == 0) {
+    ok = probe_filter_add_ssid(&rules, value);
   } else {
-    packet["he_capabilities"] = nullptr;
-  }
-
-  // Vendor IEs
-  JsonArray vendor_ies = packet["vendor_ies"].to<JsonArray>();
-  for (uint8_t i = 0; i < capture.packet.vendor_ies_count; i++) {
-    JsonObject vendor_ie = vendor_ies.add<JsonObject>();
-    char oui_str[9];
-    sprintf(oui_str, "%02x:%02x:%02x",
-            capture.packet.vendor_ies[i].oui[0],
-            capture.packet.vendor_ies[i].oui[1],
-            capture.packet.vendor_ies[i].oui[2]);
-    vendor_ie["oui"] = oui_str;
-    vendor_ie["vendor_type"] = capture.packet.vendor_ies[i].vendor_type;
-
-    // Payload em hex
-    String payload_hex = "";
-    for (uint8_t j = 0; j < capture.packet.vendor_ies[i].payload_len; j++) {
-      char hex_byte[3];
-      sprintf(hex_byte, "%02x", capture.packet.vendor_ies[i].payload[j]);
-      payload_hex += hex_byte;
+    ok = false;
+  }
+
+  if (!ok) {
+    output_printf("# ERROR: {\"command\":\"FILTER\",\"error\":\"invalid rule or list full (see HELP)\"}\n");
+    return;
+  }
+
+  probe_filter_publish(&probe_filter, &rules);
+  node_config_save_blob("filter", &rules, sizeof(rules));
+  print_filter_status();
+}
+
+void cmd_node(const char* args) {
+  if (args[0] != '\0') {
+    // "-" remove o ID da NVS (volta ao NODE_ID de build ou ao MAC da efuse)
+    const char* id = strcmp(args, "-") == 0 ? "" : args;
+    if (!node_id_valid(id)) {
+      output_printf("# ERROR: {\"command\":\"NODE\",\"error\":\"node id: up to 31 chars [A-Za-z0-9._-]\"}\n");
+      return;
     }
-    vendor_ie["payload_hex"] = payload_hex;
-    vendor_ie["meaning"] = capture.packet.vendor_ies[i].meaning;
-  }
-
-  // IEs raw
-  JsonArray ies_raw = packet["ies_raw"].to<JsonArray>();
-  for (uint8_t i = 0; i < capture.packet.ies_count; i++) {
-    JsonObject ie_raw = ies_raw.add<JsonObject>();
-    ie_raw["id"] = capture.packet.ies_raw[i].id;
-    ie_raw["len"] = capture.packet.ies_raw[i].len;
-
-    String value_hex = "";
-    for (uint8_t j = 0; j < capture.packet.ies_raw[i].len; j++) {
-      char hex_byte[3];
-      sprintf(hex_byte, "%02x", capture.packet.ies_raw[i].value[j]);
-      value_hex += hex_byte;
+    node_config_save_node_id(id);
+    // O ID em uso não muda durante a sessão: registros já emitidos e o host
+    // continuam consistentes até o próximo boot
+    output_printf("# NODE: {\"node_id\":\"%s\",\"saved\":\"%s\",\"applies\":\"next_boot\"}\n",
+                  node_config.node_id, id);
+    return;
+  }
+  output_printf("# NODE: {\"node_id\":\"%s\",\"source\":\"%s\"}\n", node_config.node_id,
+                node_config.node_id_from_nvs ? "nvs" : "default");
+}
+
+void cmd_log(const char* args) {
+  if (strcasecmp(args, "DUMP") == 0) {
+    flash_log_sink_dump();
+    return;
+  }
+  if (strcasecmp(args, "ERASE") == 0) {
+    if (!flash_log_sink_erase()) {
+      output_printf("# ERROR: {\"command\":\"LOG\",\"error\":\"erase failed\"}\n");
+      return;
     }
-    ie_raw["value_hex"] = value_hex;
+  } else if (args[0] != '\0') {
+    output_printf("# ERROR: {\"command\":\"LOG\",\"error\":\"usage: LOG [DUMP|ERASE]\"}\n");
+    return;
   }
 
-  // MAC info
-  packet["mac_randomized"] = capture.packet.mac_randomized;
-  packet["oui"] = capture.packet.oui;
-  packet["vendor_inferred"] = capture.packet.vendor_inferred;
+  flash_log_sink_stats_t log_stats;
+  flash_log_sink_get_stats(&log_stats);
+  output_printf("# LOG: {\"partition_size\":%u,\"used_pages\":%u,\"used_bytes_max\":%u,"
+                "\"pages_written\":%u,\"sector_erases\":%u,\"write_errors\":%u,\"dropped_bytes\":%u}\n",
+                log_stats.partition_size, log_stats.used_pages,
+                log_stats.used_pages * FLASH_LOG_PAGE_PAYLOAD, log_stats.pages_written,
+                log_stats.sector_erases, log_stats.write_errors, log_stats.dropped_bytes);
+}
 
-  // Fingerprint
-  JsonObject fingerprint = packet["fingerprint"].to<JsonObject>();
-  fingerprint["ie_signature"] = capture.packet.fingerprint.ie_signature;
-  fingerprint["confidence"] = capture.packet.fingerprint.confidence;
+void channel_hop_timer_cb(void* arg) {
+  // Executa na task do esp_timer: dwell não depende de delay() nem do trabalho no loop()
+#if OUTPUT_SINK == OUTPUT_SINK_ESPNOW
+  // No canal do gateway a fila drena antes da troca; o dwell alvo cresce junto
+  // para o adiamento não aparecer como jitter
+  if (espnow_sink_hold_hop(channel_scheduler_current(&channel_scheduler))) {
+    channel_hop_target_us += ESPNOW_SINK_HOLD_STEP_MS * 1000;
+    esp_timer_start_once(channel_hop_timer, ESPNOW_SINK_HOLD_STEP_MS * 1000);
+    return;
+  }
+#endif
+  int64_t now = esp_timer_get_time();
+  uint32_t now_us = (uint32_t)now;
+  uint32_t actual_us = now_us - stats.last_hop_us;
+  uint32_t jitter_us = actual_us > channel_hop_target_us ? actual_us - channel_hop_target_us
+                                                         : channel_hop_target_us - actual_us;
+  if (jitter_us > stats.hop_jitter_max_us) {
+    stats.hop_jitter_max_us = jitter_us;
+  }
 
-  String output;
-  serializeJson(doc, output);
-  Serial.println(output);
+  uint32_t dwell_ms;
+  if (channel_plan_pending.load(std::memory_order_acquire)) {
+    channel_scheduler_reconfigure(&channel_scheduler, pending_channels, pending_channel_count,
+                                  (uint32_t)(now / 1000));
+    channel_plan_pending.store(false, std::memory_order_release);
+    dwell_ms = channel_scheduler.dwell_target_ms;
+  } else {
+    dwell_ms = channel_scheduler_advance(&channel_scheduler, (uint32_t)(now / 1000));
+  }
+  switch_channel();
+  stats.hops++;
+  stats.last_hop_us = now_us;
+
+  channel_hop_target_us = dwell_ms * 1000;
+  esp_timer_start_once(channel_hop_timer, channel_hop_target_us);
 }
 
-bool is_randomized_mac(const uint8_t* mac) {
-  // Bit 1 do primeiro octeto indica MAC address randomizado (locally administered)
-  return (mac[0] & 0x02) != 0;
+const char* capture_rx_filter_name() {
+  switch (CAPTURE_RX_FILTER) {
+    case CAPTURE_RX_FILTER_ALL: return "all";
+    case CAPTURE_RX_FILTER_PROBE_REQ: return "probe_req";
+    default: return "mgmt";
+  }
 }
 
-String get_vendor_from_mac(const uint8_t* mac) {
-  char oui[9];
-  sprintf(oui, "%02X:%02X:%02X", mac[0], mac[1], mac[2]);
+void switch_channel() {
+  uint8_t channel = channel_scheduler_current(&channel_scheduler);
+  esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+  stats.current_channel = channel;
+}
+
+// Soma dos contadores dos workers (lidos sem lock: valores aproximados entre si)
+typedef struct {
+  uint32_t ring_capacity;
+  uint32_t ring_occupancy;
+  uint32_t ring_high_water;
+  uint32_t ring_tail;
+  uint32_t queue_full;
+  unsigned long probes_parsed;
+  unsigned long json_overflows;
+  unsigned long ies_truncated;
+  unsigned long ies_malformed;
+  uint32_t device_inserts;
+  uint32_t devices_tracked;
+  uint32_t devices_capacity;
+  uint32_t device_evictions;
+} worker_totals_t;
+
+static void worker_totals(worker_totals_t* t) {
+  memset(t, 0, sizeof(*t));
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) {
+    const probe_worker_t& wk = workers[i];
+    t->ring_capacity += frame_ring_capacity(&wk.ring);
+    t->ring_occupancy += frame_ring_occupancy(&wk.ring);
+    t->ring_high_water += wk.ring.high_water;
+    t->ring_tail += wk.ring.tail.load(std::memory_order_acquire);
+    t->queue_full += wk.ring.dropped;
+    t->probes_parsed += wk.probes_parsed;
+    t->json_overflows += wk.json_overflows;
+    t->ies_truncated += wk.ies_truncated;
+    t->ies_malformed += wk.ies_malformed;
+    t->device_inserts += wk.cache.inserts;
+    t->devices_tracked += wk.cache.used;
+    t->devices_capacity += wk.cache.capacity;
+    t->device_evictions += wk.cache.evictions;
+  }
+}
 
-  for (int i = 0; known_vendors[i][0] != NULL; i++) {
-    if (strcmp(oui, known_vendors[i][0]) == 0) {
-      return String(known_vendors[i][1]);
+void print_system_stats() {
+  // Serialização em streaming (sem DOM nem String): nenhum heap no caminho periódico
+  static char output[STATS_BUFFER_SIZE];
+  json_writer_t w;
+  json_begin(&w, output, sizeof(output) - 1);
+
+  json_raw(&w, "# STATS: ");
+  json_object_begin(&w);
+  json_kv_string(&w, "type", "stats");
+  json_kv_uint(&w, "uptime_ms", millis() - stats.uptime_ms);
+  json_kv_uint(&w, "total_packets", stats.total_packets);
+
+  // Callbacks do driver por tipo e taxa desde o último STATS (compara os modos de CAPTURE_RX_FILTER)
+  static unsigned long last_rx_callbacks = 0;
+  static unsigned long last_rx_mgmt = 0;
+  static uint32_t last_rx_ms = 0;
+  uint32_t now_ms = millis();
+  unsigned long rx_callbacks = stats.rx_callbacks[WIFI_PKT_MGMT] + stats.rx_callbacks[WIFI_PKT_CTRL] +
+                               stats.rx_callbacks[WIFI_PKT_DATA] + stats.rx_callbacks[WIFI_PKT_MISC];
+  float rx_elapsed_s = (now_ms - (last_rx_ms != 0 ? last_rx_ms : stats.uptime_ms)) / 1000.0f;
+  if (rx_elapsed_s <= 0) rx_elapsed_s = 1;
+  json_key(&w, "rx");
+  json_object_begin(&w);
+  json_kv_string(&w, "filter", capture_rx_filter_name());
+  json_kv_uint(&w, "callbacks", rx_callbacks);
+  json_key(&w, "callbacks_per_s");
+  json_fixed(&w, (rx_callbacks - last_rx_callbacks) / rx_elapsed_s, 1);
+  json_key(&w, "mgmt_per_s");
+  json_fixed(&w, (stats.rx_callbacks[WIFI_PKT_MGMT] - last_rx_mgmt) / rx_elapsed_s, 1);
+  json_kv_uint(&w, "mgmt", stats.rx_callbacks[WIFI_PKT_MGMT]);
+  json_kv_uint(&w, "ctrl", stats.rx_callbacks[WIFI_PKT_CTRL]);
+  json_kv_uint(&w, "data", stats.rx_callbacks[WIFI_PKT_DATA]);
+  json_kv_uint(&w, "misc", stats.rx_callbacks[WIFI_PKT_MISC]);
+  json_object_end(&w);
+  last_rx_callbacks = rx_callbacks;
+  last_rx_mgmt = stats.rx_callbacks[WIFI_PKT_MGMT];
+  last_rx_ms = now_ms;
+
+  json_kv_uint(&w, "probe_requests", stats.probe_requests);
+  json_kv_uint(&w, "current_channel", stats.current_channel);
+  json_kv_uint(&w, "channel_sched_mode", channel_scheduler.mode);
+  json_kv_uint(&w, "dwell_id", channel_scheduler_dwell_id(&channel_scheduler));
+  json_kv_uint(&w, "hops", stats.hops);
+  json_kv_uint(&w, "last_hop_us", stats.last_hop_us);
+  json_kv_uint(&w, "hop_jitter_max_us", stats.hop_jitter_max_us);
+  json_kv_uint(&w, "late_frames", channel_scheduler.late_frames);
+
+  // Estatísticas por canal do escalonador (taxa em probes/s)
+  json_key(&w, "channels");
+  json_array_begin(&w);
+  for (uint8_t i = 0; i < channel_scheduler.count; i++) {
+    const channel_stats_t& cs = channel_scheduler.stats[i];
+    json_object_begin(&w);
+    json_kv_uint(&w, "ch", cs.channel);
+    json_kv_uint(&w, "probes", cs.probes);
+    json_kv_uint(&w, "dwell_ms", cs.dwell_ms);
+    json_key(&w, "rate");
+    json_fixed(&w, cs.rate_ewma / 256.0f, 2);
+    json_kv_uint(&w, "visits", cs.visits);
+    json_kv_uint(&w, "last_dwell_id", cs.last_dwell_id);
+    json_kv_uint(&w, "next_dwell_ms", channel_scheduler_dwell_for(&channel_scheduler, i));
+    json_object_end(&w);
+  }
+  json_array_end(&w);
+  // Rings e caches: soma dos workers (detalhe por worker em "workers")
+  worker_totals_t totals;
+  worker_totals(&totals);
+  json_kv_uint(&w, "ring_capacity", totals.ring_capacity);
+  json_kv_uint(&w, "ring_occupancy", totals.ring_occupancy);
+  json_kv_uint(&w, "ring_high_water", totals.ring_high_water);
+  json_kv_uint(&w, "probes_queued", stats.probes_queued);
+  json_kv_uint(&w, "probes_parsed", totals.probes_parsed);
+  // Distintos desde o boot: união dos HLL dos workers. Os registradores só
+  // crescem, então ler sem lock no máximo atrasa a estimativa em alguns probes.
+  static hll_t macs_seen;
+  hll_clear(&macs_seen);
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) hll_merge(&macs_seen, &workers[i].macs_seen);
+  json_kv_uint(&w, "unique_devices", hll_estimate(&macs_seen));
+  // Inserções no cache (reinserções após despejo contam de novo)
+  json_kv_uint(&w, "device_inserts", totals.device_inserts);
+  json_kv_uint(&w, "devices_tracked", totals.devices_tracked);
+  json_kv_uint(&w, "devices_capacity", totals.devices_capacity);
+  json_kv_uint(&w, "device_evictions", totals.device_evictions);
+#if TRACK_CORRELATION_ENABLED
+  // Trilhas: links = SAs novos atribuídos a uma trilha existente
+  json_key(&w, "tracks");
+  json_object_begin(&w);
+  json_kv_uint(&w, "entries", track_correlator.used);
+  json_kv_uint(&w, "capacity", track_correlator.capacity);
+  json_kv_uint(&w, "created", track_correlator.tracks);
+  json_kv_uint(&w, "links", track_correlator.links);
+  json_kv_uint(&w, "evictions", track_correlator.evictions);
+  json_object_end(&w);
+#endif
+  json_kv_uint(&w, "frames_clipped", stats.frames_clipped);
+  json_kv_uint(&w, "json_overflows", stats.json_overflows + totals.json_overflows);
+  json_kv_uint(&w, "ies_truncated", totals.ies_truncated);
+  json_kv_uint(&w, "ies_malformed", totals.ies_malformed);
+
+  // Utilização de cada worker desde o último STATS (busy_pct: tempo processando frames no core)
+  static uint64_t last_busy_us[PROBE_WORKER_COUNT] = {0};
+  json_key(&w, "workers");
+  json_array_begin(&w);
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) {
+    const probe_worker_t& wk = workers[i];
+    uint64_t busy_us = wk.busy_us;
+    json_object_begin(&w);
+    json_kv_uint(&w, "core", wk.core);
+    json_kv_uint(&w, "probes_parsed", wk.probes_parsed);
+    json_kv_uint(&w, "ring_occupancy", frame_ring_occupancy(&wk.ring));
+    json_kv_uint(&w, "ring_high_water", wk.ring.high_water);
+    json_kv_uint(&w, "queue_full", wk.ring.dropped);
+    json_kv_uint(&w, "devices_tracked", wk.cache.used);
+#if OUTPUT_BATCH_SIZE > 0
+    json_kv_uint(&w, "batches", wk.batches);
+#endif
+#if OUTPUT_DELTA_ENABLED
+    json_kv_uint(&w, "keyframes", wk.delta.keyframes);
+    json_kv_uint(&w, "delta_records", wk.delta.deltas);
+#endif
+    json_key(&w, "busy_pct");
+    json_fixed(&w, (busy_us - last_busy_us[i]) / (rx_elapsed_s * 10000.0f), 1);
+    json_object_end(&w);
+    last_busy_us[i] = busy_us;
+  }
+  json_array_end(&w);
+
+  // filter.accepted = probes_queued + queue_full
+  json_key(&w, "drops");
+  json_object_begin(&w);
+  json_kv_uint(&w, "queue_full", totals.queue_full);
+  json_kv_uint(&w, "truncated", stats.drops.truncated);
+  json_object_end(&w);
+
+  // Rejeições do pré-filtro por estágio (probe_requests - truncated = filter.checked)
+  json_key(&w, "filter");
+  json_object_begin(&w);
+  json_kv_uint(&w, "checked", probe_filter.counters.checked);
+  json_kv_uint(&w, "accepted", probe_filter.counters.accepted);
+  json_kv_uint(&w, "rssi", probe_filter.counters.rejected_rssi);
+  json_kv_uint(&w, "randomized", probe_filter.counters.rejected_randomized);
+  json_kv_uint(&w, "mac", probe_filter.counters.rejected_mac);
+  json_kv_uint(&w, "ssid", probe_filter.counters.rejected_ssid);
+  json_object_end(&w);
+
+  // Transporte de saída: overruns = registros descartados com o ring de TX cheio
+  const output_stats_t* out = output_get_stats();
+  json_key(&w, "output");
+  json_object_begin(&w);
+  json_kv_string(&w, "transport", output_transport_name());
+  json_kv_uint(&w, "baud", output_baud());
+  json_kv_uint(&w, "records", out->records);
+  json_kv_uint(&w, "bytes", out->bytes);
+  json_kv_uint(&w, "dropped_records", out->dropped_records);
+  json_kv_uint(&w, "dropped_bytes", out->dropped_bytes);
+  json_kv_uint(&w, "lock_timeouts", out->lock_timeouts);
+  json_kv_uint(&w, "tx_buffer", OUTPUT_TX_BUFFER_SIZE);
+  json_kv_uint(&w, "tx_free_min", out->tx_free_min);
+#if OUTPUT_SINK == OUTPUT_SINK_ESPNOW
+  // Sink ESP-NOW: seq - 1 é o último datagrama numerado (lacunas no gateway = perda)
+  const espnow_sink_stats_t* sink = espnow_sink_get_stats();
+  json_key(&w, "espnow");
+  json_object_begin(&w);
+  json_kv_uint(&w, "channel", ESPNOW_SINK_CHANNEL);
+  json_kv_uint(&w, "seq", sink->seq);
+  json_kv_uint(&w, "records", sink->records);
+  json_kv_uint(&w, "datagrams", sink->datagrams);
+  json_kv_uint(&w, "sent", sink->sent);
+  json_kv_uint(&w, "send_ok", sink->send_ok);
+  json_kv_uint(&w, "send_failed", sink->send_failed);
+  json_kv_uint(&w, "send_busy", sink->send_busy);
+  json_kv_uint(&w, "dropped", sink->dropped);
+  json_kv_uint(&w, "queued", espnow_sink_queued());
+  json_kv_uint(&w, "queue_high_water", sink->queue_high_water);
+  json_kv_uint(&w, "queue_capacity", sink->queue_capacity);
+  json_kv_uint(&w, "off_channel", sink->off_channel);
+  json_kv_uint(&w, "hop_holds", sink->hop_holds);
+  json_object_end(&w);
+#endif
+  json_object_end(&w);
+#if FLASH_LOG_ENABLED
+  flash_log_sink_stats_t log_stats;
+  flash_log_sink_get_stats(&log_stats);
+  json_key(&w, "flash_log");
+  json_object_begin(&w);
+  json_kv_uint(&w, "partition_size", log_stats.partition_size);
+  json_kv_uint(&w, "used_pages", log_stats.used_pages);
+  json_kv_uint(&w, "pages_written", log_stats.pages_written);
+  json_kv_uint(&w, "sector_erases", log_stats.sector_erases);
+  json_kv_uint(&w, "write_errors", log_stats.write_errors);
+  json_kv_uint(&w, "staging_pages", log_stats.staging_pages);
+  json_kv_uint(&w, "staged_pages", log_stats.staged_pages);
+  json_kv_uint(&w, "dropped_bytes", log_stats.dropped_bytes);
+  json_object_end(&w);
+#endif
+  json_kv_string(&w, "scanner_id", node_config.node_id);
+  json_kv_uint(&w, "cluster_index", node_config.cluster_index);
+  json_kv_uint(&w, "cluster_size", node_config.cluster_size);
+  json_kv_string(&w, "capture_id", current_capture_id);
+  json_kv_uint(&w, "free_heap", ESP.getFreeHeap());
+  json_kv_uint(&w, "min_free_heap", ESP.getMinFreeHeap());
+
+  // Onde cada buffer grande foi alocado no boot (psram=false: SRAM interna)
+  json_key(&w, "memory");
+  json_object_begin(&w);
+  json_kv_uint(&w, "psram_total", mem_psram_total());
+  json_kv_uint(&w, "psram_free", mem_psram_free());
+  json_key(&w, "regions");
+  json_array_begin(&w);
+  const mem_region_t* region_list;
+  uint8_t region_count = mem_regions(&region_list);
+  for (uint8_t i = 0; i < region_count; i++) {
+    json_object_begin(&w);
+    json_kv_string(&w, "name", region_list[i].name);
+    json_kv_uint(&w, "bytes", region_list[i].bytes);
+    json_kv_bool(&w, "psram", region_list[i].psram);
+    json_object_end(&w);
+  }
+  json_array_end(&w);
+  json_kv_uint(&w, "regions_dropped", mem_regions_dropped());
+  json_object_end(&w);
+
+  // Relógio de captura: origem do modelo timer -> epoch e offset rx -> timer
+  time_model_t clock = time_model_snapshot();
+  json_key(&w, "time");
+  json_object_begin(&w);
+  json_kv_string(&w, "source", time_source_name(clock.source));
+  json_kv_uint(&w, "adjustments", clock.adjustments);
+  json_kv_int(&w, "last_step_us", clock.last_step_us);
+  json_kv_uint(&w, "anchors", time_anchor_seq);
+  json_kv_uint(&w, "rx_offset_us", rx_offset_current());
+  json_object_end(&w);
+
+  // Monitor de saúde: last_trigger é o gatilho que causou o boot atual
+  uint32_t now = millis();
+  uint32_t largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  json_key(&w, "health");
+  json_object_begin(&w);
+  json_kv_string(&w, "reset_reason", reset_reason_name(boot_reset_reason));
+  json_kv_string(&w, "last_trigger", health_trigger_name(boot_health_trigger));
+  json_kv_uint(&w, "last_uptime_s", boot_health_uptime_s);
+  json_kv_uint(&w, "checks", health_monitor.checks);
+  json_kv_uint(&w, "largest_free_block", largest_block);
+  json_kv_uint(&w, "min_largest_free_block",
+               health_monitor.checks > 0 ? health_monitor.min_largest_block : largest_block);
+  json_kv_uint(&w, "heap_low_checks", health_monitor.heap_low_checks);
+  json_kv_uint(&w, "fragmented_checks", health_monitor.fragmented_checks);
+  json_kv_uint(&w, "worker_stalled_ms", now - health_monitor.ring_progress_ms);
+  json_kv_uint(&w, "rx_idle_ms", now - health_monitor.rx_progress_ms);
+  json_object_end(&w);
+
+#ifdef BUILD_TIME_UNIX
+  json_kv_string(&w, "timestamp_type", "unix_epoch");
+  json_kv_uint(&w, "current_time", get_current_timestamp());
+#else
+  json_kv_string(&w, "timestamp_type", "millis");
+  json_kv_uint(&w, "current_time", millis());
+#endif
+  json_object_end(&w);
+
+  if (w.overflow) {
+    stats.json_overflows++;
+  } else {
+    // "\n" cabe no espaço reservado por json_begin()
+    output[w.len++] = '\n';
+    output_write((const uint8_t*)output, w.len);
+  }
+
+#if OUTPUT_FORMAT == OUTPUT_FORMAT_BINARY
+  // Reenviar metadados da sessão para hosts que conectaram depois do boot
+  print_session_binary();
+#endif
+}
+
+#if PERF_ENABLED
+static void json_perf_hist(json_writer_t* w, const perf_hist_t* h) {
+  json_object_begin(w);
+  json_kv_uint(w, "count", h->count);
+  json_kv_uint(w, "min", h->min);
+  json_kv_uint(w, "avg", perf_hist_avg(h));
+  json_kv_uint(w, "p50", perf_hist_percentile(h, 500));
+  json_kv_uint(w, "p99", perf_hist_percentile(h, 990));
+  json_kv_uint(w, "max", h->max);
+  // Contagem por bucket b = [2^b, 2^(b+1)); zeros à direita omitidos
+  uint8_t last = PERF_HIST_BUCKETS;
+  while (last > 0 && h->buckets[last - 1] == 0) last--;
+  json_key(w, "buckets");
+  json_array_begin(w);
+  for (uint8_t b = 0; b < last; b++) json_uint(w, h->buckets[b]);
+  json_array_end(w);
+  json_object_end(w);
+}
+
+// Registro "# PERF:" da janela desde o anterior: ciclos por estágio,
+// ocupação do ring por frame consumido e latência chegada -> transporte
+void print_perf_stats() {
+  static char output[PERF_BUFFER_SIZE];
+  static perf_hist_t window[PERF_HIST_COUNT];
+  static uint32_t last_perf_ms = 0;
+  uint32_t now_ms = millis();
+  perf_snapshot(window);
+
+  json_writer_t w;
+  json_begin(&w, output, sizeof(output) - 1);
+  json_raw(&w, "# PERF: ");
+  json_object_begin(&w);
+  json_kv_string(&w, "type", "perf");
+  json_kv_uint(&w, "window_ms", now_ms - (last_perf_ms != 0 ? last_perf_ms : stats.uptime_ms));
+  json_kv_uint(&w, "cpu_mhz", getCpuFrequencyMhz());
+  json_key(&w, "stages");
+  json_object_begin(&w);
+  for (uint8_t i = 0; i < PERF_SAMPLE_RING_DEPTH; i++) {
+    json_key(&w, perf_hist_name(i));
+    json_perf_hist(&w, &window[i]);
+  }
+  json_object_end(&w);
+  for (uint8_t i = PERF_SAMPLE_RING_DEPTH; i < PERF_HIST_COUNT; i++) {
+    json_key(&w, perf_hist_name(i));
+    json_perf_hist(&w, &window[i]);
+  }
+  last_perf_ms = now_ms;
+
+  // Descartes acumulados desde o boot (os mesmos de "# STATS:")
+  const output_stats_t* out = output_get_stats();
+  worker_totals_t totals;
+  worker_totals(&totals);
+  json_key(&w, "drops");
+  json_object_begin(&w);
+  json_kv_uint(&w, "queue_full", totals.queue_full);
+  json_kv_uint(&w, "truncated", stats.drops.truncated);
+  json_kv_uint(&w, "json_overflows", stats.json_overflows + totals.json_overflows);
+  json_kv_uint(&w, "output_dropped", out->dropped_records);
+  json_kv_uint(&w, "output_lock_timeouts", out->lock_timeouts);
+  json_object_end(&w);
+  json_kv_uint(&w, "ring_capacity", totals.ring_capacity);
+  json_kv_uint(&w, "ring_high_water", totals.ring_high_water);
+  json_kv_uint(&w, "tx_free_min", out->tx_free_min);
+  json_object_end(&w);
+
+  if (w.overflow) {
+    stats.json_overflows++;
+    return;
+  }
+  output[w.len++] = '\n';
+  output_write((const uint8_t*)output, w.len);
+}
+#endif
+
+// Troca o sketch do worker na virada da janela e publica o que fechou. A loop()
+// lê o publicado enquanto o worker preenche o outro; ele só é zerado na virada
+// seguinte, SUMMARY_WINDOW_MS depois
+void worker_sketch_roll(probe_worker_t* worker, uint32_t now_ms) {
+#if SUMMARY_WINDOW_MS > 0
+  uint32_t window_id = now_ms / SUMMARY_WINDOW_MS + 1;
+  window_sketch_t* current = &worker->sketches[worker->sketch_current];
+  if (current->window_id == window_id) return;
+  if (current->window_id != 0) worker->sketch_closed.store(current, std::memory_order_release);
+  worker->sketch_current ^= 1;
+  window_sketch_reset(&worker->sketches[worker->sketch_current], window_id);
+#endif
+}
+
+#if SUMMARY_WINDOW_MS > 0
+static void json_topk(json_writer_t* w, const char* key, const window_sketch_t* const* closed, bool ssid) {
+  // Até SKETCH_TOPK_CAPACITY entradas por worker; SAs não se repetem entre workers
+  static topk_entry_t entries[SKETCH_TOPK_CAPACITY * PROBE_WORKER_COUNT];
+  const topk_t* sketches[PROBE_WORKER_COUNT];
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) {
+    sketches[i] = ssid ? &closed[i]->ssids : &closed[i]->talkers;
+  }
+  size_t n = topk_collect(sketches, PROBE_WORKER_COUNT, entries, SKETCH_TOPK_CAPACITY * PROBE_WORKER_COUNT);
+  if (n > SUMMARY_TOP_N) n = SUMMARY_TOP_N;
+
+  json_key(w, key);
+  json_array_begin(w);
+  for (size_t i = 0; i < n; i++) {
+    const topk_entry_t* e = &entries[i];
+    json_object_begin(w);
+    if (ssid) {
+      char label[SKETCH_LABEL_MAX + 1];
+      memcpy(label, e->label, e->label_len);
+      label[e->label_len] = '\0';
+      json_kv_string(w, "ssid", label);
+    } else {
+      json_key(w, "sa");
+      json_mac(w, e->label);
     }
+    json_kv_uint(w, "count", e->count);
+    json_kv_uint(w, "error", e->error);
+    json_object_end(w);
+  }
+  json_array_end(w);
+}
+#endif
+
+// Registro "# SUMMARY:" da última janela fechada por todos os workers: HLLs
+// combinados por máximo de registrador, top-N somado por chave
+void print_window_summary() {
+#if SUMMARY_WINDOW_MS > 0
+  static char output[SUMMARY_BUFFER_SIZE];
+  static hll_t macs;
+  static hll_t fingerprints;
+  static uint32_t last_window_id = 0;
+
+  const window_sketch_t* closed[PROBE_WORKER_COUNT];
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) {
+    closed[i] = workers[i].sketch_closed.load(std::memory_order_acquire);
+    if (closed[i] == NULL || closed[i]->window_id != closed[0]->window_id) return;
+  }
+  uint32_t window_id = closed[0]->window_id;
+  if (window_id == last_window_id) return;
+  last_window_id = window_id;
+
+  uint32_t probes = 0;
+  hll_clear(&macs);
+  hll_clear(&fingerprints);
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) {
+    probes += closed[i]->probes;
+    hll_merge(&macs, &closed[i]->macs);
+    hll_merge(&fingerprints, &closed[i]->fingerprints);
   }
 
-  return "Unknown";
+  json_writer_t w;
+  json_begin(&w, output, sizeof(output) - 1);
+  char ts[32];
+  uint32_t window_start_ms = (window_id - 1) * SUMMARY_WINDOW_MS;
+
+  json_raw(&w, "# SUMMARY: ");
+  json_object_begin(&w);
+  json_kv_string(&w, "type", "summary");
+  json_kv_string(&w, "capture_id", current_capture_id);
+  json_kv_string(&w, "scanner_id", node_config.node_id);
+  format_uptime_timestamp(ts, window_start_ms);
+  json_kv_string(&w, "window_start_ts", ts);
+  json_kv_uint(&w, "window_ms", SUMMARY_WINDOW_MS);
+  json_kv_uint(&w, "probes", probes);
+  json_kv_uint(&w, "unique_macs", hll_estimate(&macs));
+  json_kv_uint(&w, "unique_fingerprints", hll_estimate(&fingerprints));
+  json_kv_uint(&w, "hll_precision", HLL_PRECISION);
+  json_key(&w, "std_error");
+  json_fixed(&w, hll_std_error(), 4);
+  json_topk(&w, "top_talkers", closed, false);
+  json_topk(&w, "top_ssids", closed, true);
+  json_object_end(&w);
+
+  if (w.overflow) {
+    stats.json_overflows++;
+    return;
+  }
+  output[w.len++] = '\n';
+  output_write((const uint8_t*)output, w.len);
+#endif
 }
 
-String create_fingerprint(const packet_data_t& packet) {
-  String signature = "";
+// Buffers grandes da captura, alocados uma vez no boot. Com PSRAM recebem as
+// capacidades *_PSRAM; sem ela (ou se o bloco não couber) voltam aos tamanhos
+// de SRAM interna do platformio.ini. O índice do cache, consultado a cada
+// probe, fica sempre na SRAM interna.
+bool alloc_capture_buffers() {
+  uint32_t ring_capacity = FRAME_RING_CAPACITY_PSRAM;
+  frame_slot_t* slots = (frame_slot_t*)mem_alloc_psram("frame_ring", sizeof(frame_slot_t) * ring_capacity);
+  if (slots == NULL) {
+    ring_capacity = FRAME_RING_CAPACITY;
+    slots = (frame_slot_t*)mem_alloc_internal("frame_ring", sizeof(frame_slot_t) * ring_capacity);
+  }
 
-  // Adicionar informações sobre HT capabilities
-  if (packet.capabilities.ht_capabilities.present) {
-    signature += "HT+";
+  uint16_t cache_capacity = DEVICE_CACHE_CAPACITY_PSRAM;
+  device_entry_t* entries = (device_entry_t*)mem_alloc_psram("device_cache", sizeof(device_entry_t) * cache_capacity);
+  if (entries == NULL) {
+    cache_capacity = DEVICE_CACHE_CAPACITY;
+    entries = (device_entry_t*)mem_alloc_internal("device_cache", sizeof(device_entry_t) * cache_capacity);
   }
+  uint16_t* index = (uint16_t*)mem_alloc_internal("device_index", sizeof(uint16_t) * cache_capacity * 2);
+
+  if (slots == NULL || entries == NULL || index == NULL) return false;
 
-  // Adicionar vendor IEs
-  for (uint8_t i = 0; i < packet.vendor_ies_count; i++) {
-    signature += "VENDOR(";
-    char oui_str[9];
-    sprintf(oui_str, "%02x:%02x:%02x",
-            packet.vendor_ies[i].oui[0],
-            packet.vendor_ies[i].oui[1],
-            packet.vendor_ies[i].oui[2]);
-    signature += oui_str;
-    signature += ")+";
+#if TRACK_CORRELATION_ENABLED
+  uint16_t track_capacity = TRACK_CORRELATOR_CAPACITY_PSRAM;
+  track_entry_t* tracks = (track_entry_t*)mem_alloc_psram("track_table", sizeof(track_entry_t) * track_capacity);
+  if (tracks == NULL) {
+    track_capacity = TRACK_CORRELATOR_CAPACITY;
+    tracks = (track_entry_t*)mem_alloc_internal("track_table", sizeof(track_entry_t) * track_capacity);
   }
+  uint16_t* track_index = (uint16_t*)mem_alloc_internal("track_index", sizeof(uint16_t) * track_capacity * 2);
+  if (tracks == NULL || track_index == NULL) return false;
+  track_correlator_init(&track_correlator, tracks, track_capacity, track_index, track_capacity * 2);
+#endif
 
-  // Adicionar supported rates
-  if (packet.capabilities.supported_rates_count > 0) {
-    signature += "rates(";
-    for (uint8_t i = 0; i < packet.capabilities.supported_rates_count; i++) {
-      if (i > 0) signature += ",";
-      signature += String(packet.capabilities.supported_rates[i]);
-    }
-    signature += ")";
+  // Capacidades divididas entre os workers (continuam potências de 2)
+  uint32_t ring_share = ring_capacity / PROBE_WORKER_COUNT;
+  uint16_t cache_share = cache_capacity / PROBE_WORKER_COUNT;
+  for (uint8_t i = 0; i < PROBE_WORKER_COUNT; i++) {
+    frame_ring_init(&workers[i].ring, slots + i * ring_share, ring_share);
+    // Registros agregados só no modo aggregate; no modo frames o cache apenas deduplica
+    device_cache_init(&workers[i].cache, entries + i * cache_share, cache_share,
+                      index + i * cache_share * 2, cache_share * 2,
+                      OUTPUT_MODE == OUTPUT_MODE_AGGREGATE ? print_device_record : NULL, &workers[i]);
   }
 
-  return signature;
+  output_printf("Memória: PSRAM %u KB; ring de %u frames (%s), cache de %u dispositivos (%s), %u worker(s)\n",
+                (unsigned)(mem_psram_total() / 1024), ring_capacity, mem_is_psram(slots) ? "PSRAM" : "SRAM",
+                cache_capacity, mem_is_psram(entries) ? "PSRAM" : "SRAM", PROBE_WORKER_COUNT);
+  return true;
 }
 
-void switch_channel() {
-  current_channel++;
-  if (current_channel > MAX_CHANNELS) {
-    current_channel = 1;
+void health_boot() {
+  boot_reset_reason = esp_reset_reason();
+  if (boot_reset_reason == ESP_RST_SW && health_reset_magic == HEALTH_RESET_MAGIC) {
+    boot_health_trigger = health_reset_trigger;
+    boot_health_uptime_s = health_reset_uptime_s;
+  } else if (boot_reset_reason == ESP_RST_TASK_WDT || boot_reset_reason == ESP_RST_INT_WDT ||
+             boot_reset_reason == ESP_RST_WDT) {
+    boot_health_trigger = HEALTH_TRIGGER_TASK_WDT;
   }
+  health_reset_magic = 0;
 
-  esp_wifi_set_channel(current_channel, WIFI_SECOND_CHAN_NONE);
-  stats.current_channel = current_channel;
+  output_printf("# HEALTH: {\"event\":\"boot\",\"reset_reason\":\"%s\",\"trigger\":\"%s\",\"last_uptime_s\":%u}\n",
+                reset_reason_name(boot_reset_reason), health_trigger_name(boot_health_trigger),
+                boot_health_uptime_s);
 }
 
-void print_system_stats() {
-  JsonDocument doc;
-
-  unsigned long current_uptime = millis() - stats.uptime_ms;
-  unsigned long time_since_startup = millis() - startup_time;
-  unsigned long time_to_restart = RESTART_INTERVAL - time_since_startup;
-
-  doc["type"] = "stats";
-  doc["uptime_ms"] = current_uptime;
-  doc["time_to_restart_ms"] = time_to_restart;
-  doc["time_to_restart_minutes"] = time_to_restart / 60000;
-  doc["total_packets"] = stats.total_packets;
-  doc["probe_requests"] = stats.probe_requests;
-  doc["current_channel"] = stats.current_channel;
-  doc["scanner_id"] = NODE_ID;
-  doc["capture_id"] = current_capture_id;
-  doc["free_heap"] = ESP.getFreeHeap();
-  doc["min_free_heap"] = ESP.getMinFreeHeap();
+void health_check(uint32_t now_ms) {
+  health_sample_t sample;
+  sample.free_heap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  sample.largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  // Soma dos workers: um worker bloqueado com o outro ativo fica com o watchdog de tasks
+  worker_totals_t totals;
+  worker_totals(&totals);
+  sample.ring_occupancy = totals.ring_occupancy;
+  sample.ring_tail = totals.ring_tail;
+  sample.rx_frames = stats.total_packets;
+
+  uint8_t trigger = health_monitor_check(&health_monitor, &sample, now_ms);
+  if (trigger != HEALTH_TRIGGER_NONE) {
+    health_restart(trigger);
+  }
+}
 
-#ifdef BUILD_TIME_UNIX
-  doc["timestamp_type"] = "unix_epoch";
-  doc["current_time"] = get_current_timestamp();
-#else
-  doc["timestamp_type"] = "millis";
-  doc["current_time"] = millis();
+void health_restart(uint8_t trigger) {
+  uint32_t uptime_s = (millis() - stats.uptime_ms) / 1000;
+  output_printf("# HEALTH: {\"event\":\"restart\",\"trigger\":\"%s\",\"uptime_s\":%u,"
+                "\"free_heap\":%u,\"largest_free_block\":%u}\n",
+                health_trigger_name(trigger), uptime_s,
+                (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+                (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+
+  health_reset_trigger = trigger;
+  health_reset_uptime_s = uptime_s;
+  health_reset_magic = HEALTH_RESET_MAGIC;
+#if FLASH_LOG_ENABLED
+  flash_log_sink_flush();  // página parcial do staging não se perde no reboot
 #endif
+  Serial.flush();
+  delay(100);
+  ESP.restart();
+}
 
-  String output;
-  serializeJson(doc, output);
-  Serial.println("# STATS: " + output);
+const char* reset_reason_name(esp_reset_reason_t reason) {
+  switch (reason) {
+    case ESP_RST_POWERON: return "poweron";
+    case ESP_RST_EXT: return "external";
+    case ESP_RST_SW: return "software";
+    case ESP_RST_PANIC: return "panic";
+    case ESP_RST_INT_WDT: return "int_wdt";
+    case ESP_RST_TASK_WDT: return "task_wdt";
+    case ESP_RST_WDT: return "wdt";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    case ESP_RST_BROWNOUT: return "brownout";
+    case ESP_RST_SDIO: return "sdio";
+    default: return "unknown";
+  }
 }
 
 void setup_rtc_time() {
+  rx_clock_init(&rx_clock);
 #ifdef BUILD_TIME_UNIX
-  // Configurar RTC com tempo de compilação do PlatformIO
+  // Após um reset por software/watchdog o relógio do sistema continua valendo
+  // (tempo de boot guardado na memória RTC); só o power-on volta ao timestamp de compilação
   struct timeval tv;
+  gettimeofday(&tv, NULL);
+  if (boot_reset_reason != ESP_RST_POWERON && tv.tv_sec >= (time_t)BUILD_TIME_UNIX) {
+    time_model_init(&time_model, (int64_t)tv.tv_sec * 1000000 + tv.tv_usec, esp_timer_get_time(),
+                    TIME_SOURCE_BUILD);
+    output_printf("RTC preservado após reset (%s): %lu\n", reset_reason_name(boot_reset_reason),
+                  (unsigned long)tv.tv_sec);
+    return;
+  }
+
+  // Configurar RTC com tempo de compilação do PlatformIO
+  time_model_init(&time_model, (int64_t)BUILD_TIME_UNIX * 1000000, esp_timer_get_time(), TIME_SOURCE_BUILD);
   tv.tv_sec = BUILD_TIME_UNIX;
   tv.tv_usec = 0;
 
   if (settimeofday(&tv, NULL) == 0) {
-    Serial.printf("RTC configurado com timestamp de compilação: %lu\n", (unsigned long)BUILD_TIME_UNIX);
-
-    // Verificar se a configuração funcionou
-    time_t now;
-    time(&now);
-    struct tm* timeinfo = localtime(&now);
-
-    Serial.printf("Data/Hora atual: %04d-%02d-%02d %02d:%02d:%02d UTC\n",
-                  timeinfo->tm_year + 1900,
-                  timeinfo->tm_mon + 1,
-                  timeinfo->tm_mday,
-                  timeinfo->tm_hour,
-                  timeinfo->tm_min,
-                  timeinfo->tm_sec);
+    output_printf("RTC configurado com timestamp de compilação: %lu (ajuste com TIME <unix>)\n",
+                  (unsigned long)BUILD_TIME_UNIX);
   } else {
-    Serial.println("Erro: Falha ao configurar RTC");
+    output_printf("Erro: Falha ao configurar RTC\n");
   }
 #else
-  Serial.println("Aviso: BUILD_TIME_UNIX não definido, usando millis() para timestamps");
+  time_model_init(&time_model, 0, 0, TIME_SOURCE_NONE);
+  output_printf("Aviso: BUILD_TIME_UNIX não definido, usando o tempo desde o boot para timestamps\n");
+#endif
+}
+
+// Aplica uma nova referência de tempo ao modelo e ao relógio do sistema
+void time_sync_apply(int64_t epoch_us, int64_t timer_us, uint8_t source) {
+  portENTER_CRITICAL(&time_mux);
+  time_model_set(&time_model, epoch_us, timer_us, source);
+  portEXIT_CRITICAL(&time_mux);
+
+  time_model_t m = time_model_snapshot();
+  int64_t now = time_model_epoch_us(&m, esp_timer_get_time());
+  struct timeval tv;
+  tv.tv_sec = now / 1000000;
+  tv.tv_usec = now % 1000000;
+  settimeofday(&tv, NULL);
+}
+
+// Âncora "# TIME:" (texto também no formato binário, como "# STATS:"). Publica
+// o menor offset rx -> timer do intervalo e inicia uma nova janela.
+void print_time_anchor() {
+  if (rx_clock.valid.load(std::memory_order_acquire)) {
+    rx_offset_published.store(rx_clock.offset.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    rx_offset_ready.store(true, std::memory_order_release);
+    rx_clock.restart.store(true, std::memory_order_relaxed);
+  }
+
+  time_model_t m = time_model_snapshot();
+  time_anchor_t anchor;
+  time_anchor_make(&anchor, &m, rx_offset_current(), esp_timer_get_time(), time_anchor_seq++);
+  char rx_us[12] = "null";
+  if (rx_offset_known()) {
+    snprintf(rx_us, sizeof(rx_us), "%u", anchor.rx_us);
+  }
+  output_printf("# TIME: {\"type\":\"time_anchor\",\"seq\":%u,\"source\":\"%s\",\"epoch_s\":%u,"
+                "\"epoch_frac_us\":%u,\"rx_us\":%s,\"adjustments\":%u,\"last_step_us\":%d,"
+                "\"scanner_id\":\"%s\",\"capture_id\":\"%s\"}\n",
+                anchor.seq, time_source_name(anchor.source), anchor.epoch_s, anchor.epoch_frac_us,
+                rx_us, m.adjustments, (int)m.last_step_us, node_config.node_id, current_capture_id);
+}
+
+void IRAM_ATTR pps_isr() {
+  pps_edge_us = esp_timer_get_time();
+  pps_pending.store(true, std::memory_order_release);
+}
+
+void time_sync_poll(uint32_t now_ms) {
+  if (pps_pending.exchange(false, std::memory_order_acquire)) {
+    int64_t edge = pps_edge_us;
+    portENTER_CRITICAL(&time_mux);
+    time_model_pps(&time_model, edge);
+    int32_t step = time_model.last_step_us;
+    portEXIT_CRITICAL(&time_mux);
+    // Borda a cada segundo: âncora extra só quando a correção passa de 1 ms
+    if (step > 1000 || step < -1000) {
+      print_time_anchor();
+      last_anchor_print = now_ms;
+    }
+  }
+
+  // Primeira âncora assim que o primeiro frame fixar o offset rx -> timer
+  if (rx_offset_known() && (time_anchor_seq == 0 || now_ms - last_anchor_print >= TIME_ANCHOR_INTERVAL_MS)) {
+    print_time_anchor();
+    last_anchor_print = now_ms;
+  }
+}
+
+void cmd_time(const char* args) {
+  if (args[0] != '\0') {
+    int64_t epoch_us;
+    if (!time_parse_epoch(args, &epoch_us)) {
+      output_printf("# ERROR: {\"command\":\"TIME\",\"error\":\"usage: TIME [<unix_s>[.frac]]\"}\n");
+      return;
+    }
+    time_sync_apply(epoch_us, esp_timer_get_time(), TIME_SOURCE_HOST);
+    last_anchor_print = millis();
+  }
+  print_time_anchor();
+}
+
+#if REPLAY_ENABLED
+static uint32_t replay_filtered() {
+  return probe_filter.counters.checked - probe_filter.counters.accepted;
+}
+
+static void replay_sample_heap() {
+  uint32_t free_heap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  uint32_t largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (free_heap < replay.heap_min) replay.heap_min = free_heap;
+  if (largest_block < replay.largest_block_min) replay.largest_block_min = largest_block;
+}
+
+// rx_ctrl preenchido como pelo driver, com a chegada no relógio rx pelo offset
+// atual: epoch do registro e latência seguem o mesmo caminho dos frames reais
+static void replay_inject(replay_source_t* src, wifi_promiscuous_pkt_t* pkt) {
+  uint16_t len;
+  const replay_frame_t* f = replay_source_next(src, pkt->payload, REPLAY_FRAME_MAX, &len);
+  if (f == NULL) return;
+  memset(&pkt->rx_ctrl, 0, sizeof(pkt->rx_ctrl));
+  pkt->rx_ctrl.rssi = f->rssi;
+  pkt->rx_ctrl.channel = stats.current_channel;
+  pkt->rx_ctrl.sig_len = len;
+  pkt->rx_ctrl.timestamp = (uint32_t)esp_timer_get_time() - rx_offset_current();
+  wifi_promiscuous_rx(pkt, WIFI_PKT_MGMT);
+  replay.injected++;
+}
+
+// Uma execução por notificação: até REPLAY_BURST_MAX frames a cada tick para
+// acompanhar a taxa pedida, depois espera os rings esvaziarem
+static void replay_task(void* arg) {
+  static uint32_t buf[(sizeof(wifi_promiscuous_pkt_t) + REPLAY_FRAME_MAX + 3) / 4];  // alinhado como rx_ctrl
+  wifi_promiscuous_pkt_t* pkt = (wifi_promiscuous_pkt_t*)buf;
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    replay_source_t src;
+    if (replay.from_store) {
+      replay_source_init(&src, replay_store.frames, replay_store.count, replay.devices);
+    } else {
+      replay_source_init(&src, replay_flash_frames, PROBE_CORPUS_COUNT, replay.devices);
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    int64_t heap_sample_us = start_us;
+    uint64_t duration_us = (uint64_t)replay.duration_s * 1000000;
+    uint32_t sent = 0;
+    while (!replay.stop.load(std::memory_order_acquire)) {
+      int64_t now_us = esp_timer_get_time();
+      uint64_t elapsed_us = now_us - start_us;
+      if (duration_us != 0 && elapsed_us >= duration_us) break;
+
+      // Atrasada mais de um tick, a task não recupera tudo de uma vez: rate_actual fica abaixo de rate
+      uint32_t due = replay.rate != 0 ? replay_due(replay.rate, elapsed_us, sent) : REPLAY_BURST_MAX;
+      if (due > REPLAY_BURST_MAX) due = REPLAY_BURST_MAX;
+      for (uint32_t i = 0; i < due; i++) replay_inject(&src, pkt);
+      sent += due;
+
+      if (now_us - heap_sample_us >= 100000) {
+        replay_sample_heap();
+        heap_sample_us = now_us;
+      }
+      vTaskDelay(1);
+    }
+    replay.elapsed_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+
+    // parsed no relatório inclui o que ainda estava nos rings
+    uint32_t drain_start_ms = millis();
+    worker_totals_t totals;
+    do {
+      vTaskDelay(pdMS_TO_TICKS(10));
+      worker_totals(&totals);
+    } while (totals.ring_occupancy > 0 && millis() - drain_start_ms < REPLAY_DRAIN_TIMEOUT_MS);
+    replay_sample_heap();
+    replay.done.store(true, std::memory_order_release);
+  }
+}
+
+void replay_setup() {
+  for (size_t i = 0; i < PROBE_CORPUS_COUNT; i++) {
+    replay_flash_frames[i].frame = probe_corpus[i].frame;
+    replay_flash_frames[i].len = probe_corpus[i].len;
+    replay_flash_frames[i].rssi = probe_corpus[i].rssi;
+  }
+  // Pool de REPLAY ADD alocado só no primeiro uso
+  replay_store_init(&replay_store, NULL, 0);
+  xTaskCreatePinnedToCore(replay_task, "replay", REPLAY_TASK_STACK_SIZE, NULL, REPLAY_TASK_PRIORITY,
+                          &replay.handle, REPLAY_TASK_CORE);
+}
+
+static const char* replay_source_name() {
+  return replay.from_store ? "host" : "flash";
+}
+
+static void replay_start(uint32_t rate, uint32_t duration_s, uint32_t devices) {
+  replay.from_store = replay_store.count > 0;
+  replay.rate = rate;
+  replay.duration_s = duration_s;
+  replay.devices = devices;
+
+  // Captura real pausada: o callback do driver e a task de replay não podem
+  // produzir ao mesmo tempo nos rings SPSC (o delay cobre um callback em curso)
+  esp_wifi_set_promiscuous(false);
+  delay(10);
+
+  worker_totals_t totals;
+  worker_totals(&totals);
+  replay.base_queued = stats.probes_queued;
+  replay.base_queue_full = totals.queue_full;
+  replay.base_parsed = totals.probes_parsed;
+  replay.base_filtered = replay_filtered();
+  replay.base_output_dropped = output_get_stats()->dropped_records;
+  replay.injected = 0;
+  replay.heap_start = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  replay.heap_min = replay.heap_start;
+  replay.largest_block_min = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  replay.stop.store(false, std::memory_order_relaxed);
+  replay.done.store(false, std::memory_order_relaxed);
+  replay.running.store(true, std::memory_order_release);
+
+  output_printf("# REPLAY: {\"event\":\"start\",\"source\":\"%s\",\"frames\":%u,\"rate\":%u,"
+                "\"duration_s\":%u,\"devices\":%u}\n",
+                replay_source_name(), (unsigned)(replay.from_store ? replay_store.count : PROBE_CORPUS_COUNT),
+                rate, duration_s, devices);
+#if PERF_ENABLED
+  // Fecha a janela anterior: o próximo "# PERF:" cobre apenas o replay
+  print_perf_stats();
+#endif
+  xTaskNotifyGive(replay.handle);
+}
+
+void replay_poll() {
+  if (!replay.done.load(std::memory_order_acquire)) return;
+  replay.done.store(false, std::memory_order_relaxed);
+  replay.running.store(false, std::memory_order_release);
+
+  esp_wifi_set_promiscuous(true);
+  // Nova janela de mínimo do offset rx -> timer com os frames reais
+  rx_clock.restart.store(true, std::memory_order_relaxed);
+
+  worker_totals_t totals;
+  worker_totals(&totals);
+  uint32_t heap_end = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  uint32_t rate_actual = replay.elapsed_ms ? (uint32_t)((uint64_t)replay.injected * 1000 / replay.elapsed_ms) : 0;
+  output_printf("# REPLAY: {\"event\":\"done\",\"source\":\"%s\",\"rate\":%u,\"devices\":%u,\"injected\":%u,"
+                "\"elapsed_ms\":%u,\"rate_actual\":%u,\"queued\":%u,\"queue_full\":%u,\"filtered\":%u,"
+                "\"parsed\":%u,\"output_dropped\":%u,\"ring_high_water\":%u,\"ring_capacity\":%u,"
+                "\"heap_free_start\":%u,\"heap_free_min\":%u,\"heap_free_end\":%u,\"largest_block_min\":%u}\n",
+                replay_source_name(), replay.rate, replay.devices, replay.injected, replay.elapsed_ms,
+                rate_actual, (unsigned)(stats.probes_queued - replay.base_queued),
+                totals.queue_full - replay.base_queue_full, replay_filtered() - replay.base_filtered,
+                (unsigned)(totals.probes_parsed - replay.base_parsed),
+                output_get_stats()->dropped_records - replay.base_output_dropped, totals.ring_high_water,
+                totals.ring_capacity, replay.heap_start, replay.heap_min, heap_end, replay.largest_block_min);
+#if PERF_ENABLED
+  print_perf_stats();
+#endif
+}
+
+static void print_replay_status() {
+  output_printf("# REPLAY: {\"running\":%s,\"flash_frames\":%u,\"host_frames\":%u,\"pool_used\":%u,"
+                "\"pool_size\":%u,\"injected\":%u}\n",
+                replay.running.load(std::memory_order_acquire) ? "true" : "false",
+                (unsigned)PROBE_CORPUS_COUNT, (unsigned)replay_store.count, (unsigned)replay_store.pool_used,
+                (unsigned)replay_store.pool_size, replay.injected);
+}
+
+void cmd_replay(const char* args) {
+  char sub[8];
+  size_t n = 0;
+  while (args[n] && args[n] != ' ' && n < sizeof(sub) - 1) {
+    sub[n] = args[n];
+    n++;
+  }
+  sub[n] = '\0';
+  const char* value = args + n;
+  while (*value == ' ') value++;
+
+  bool running = replay.running.load(std::memory_order_acquire);
+  if (sub[0] == '\0') {
+    print_replay_status();
+    return;
+  }
+  if (strcasecmp(sub, "STOP") == 0) {
+    replay.stop.store(true, std::memory_order_release);
+    return;
+  }
+  if (running) {
+    output_printf("# ERROR: {\"command\":\"REPLAY\",\"error\":\"replay running (REPLAY STOP)\"}\n");
+    return;
+  }
+
+  if (strcasecmp(sub, "CLEAR") == 0) {
+    replay_store_clear(&replay_store);
+    print_replay_status();
+    return;
+  }
+  if (strcasecmp(sub, "ADD") == 0) {
+    if (replay_store.pool == NULL) {
+      uint8_t* pool = (uint8_t*)mem_alloc_psram("replay_pool", REPLAY_POOL_SIZE);
+      if (pool == NULL) pool = (uint8_t*)mem_alloc_internal("replay_pool", REPLAY_POOL_SIZE);
+      if (pool != NULL) replay_store_init(&replay_store, pool, REPLAY_POOL_SIZE);
+    }
+    // Silencioso no sucesso: o host envia várias linhas por frame
+    if (!replay_store_append_hex(&replay_store, value)) {
+      output_printf("# ERROR: {\"command\":\"REPLAY\",\"error\":\"invalid hex or pool full (frame discarded)\"}\n");
+    }
+    return;
+  }
+  if (strcasecmp(sub, "END") == 0) {
+    char* end;
+    long rssi = strtol(value, &end, 10);
+    size_t len = replay_store.pending_len;
+    if (end == value || *end != '\0' || rssi < -127 || rssi > 0 || len > REPLAY_FRAME_MAX ||
+        !replay_store_commit(&replay_store, (int8_t)rssi)) {
+      replay_store.pending_len = 0;
+      output_printf("# ERROR: {\"command\":\"REPLAY\",\"error\":\"usage: REPLAY END <rssi> "
+                    "after %u..%u bytes (frame discarded)\"}\n", REPLAY_MIN_FRAME_LEN, REPLAY_FRAME_MAX);
+      return;
+    }
+    output_printf("# REPLAY: {\"event\":\"frame\",\"index\":%u,\"len\":%u}\n",
+                  (unsigned)(replay_store.count - 1), (unsigned)len);
+    return;
+  }
+
+  // <rate>|MAX [<seconds>] [<devices>]
+  unsigned long rate = 0;
+  if (strcasecmp(sub, "MAX") != 0) {
+    char* end;
+    rate = strtoul(sub, &end, 10);
+    if (end == sub || *end != '\0' || rate == 0 || rate > REPLAY_BURST_MAX * 1000UL) {
+      output_printf("# ERROR: {\"command\":\"REPLAY\",\"error\":\"rate: 1..%u frames/s or MAX\"}\n",
+                    REPLAY_BURST_MAX * 1000);
+      return;
+    }
+  }
+  unsigned duration_s = 60;
+  unsigned devices = REPLAY_DEFAULT_DEVICES;
+  if (value[0] != '\0' && (sscanf(value, "%u %u", &duration_s, &devices) < 1 || devices > REPLAY_MAX_DEVICES)) {
+    output_printf("# ERROR: {\"command\":\"REPLAY\",\"error\":\"usage: REPLAY <rate>|MAX [<seconds>] [<devices>]\"}\n");
+    return;
+  }
+  replay_start(rate, duration_s, devices);
+}
 #endif
-}
\ No newline at end of file
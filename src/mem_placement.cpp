@@ -0,0 +1,59 @@
+#include <esp_heap_caps.h>
+#include "mem_placement.h"
+
+static mem_region_t regions[MEM_MAX_REGIONS];
+static uint8_t region_count = 0;
+static uint8_t region_dropped = 0;
+
+static void record_region(const void* ptr, const char* name, size_t bytes, bool psram) {
+  if (region_count >= MEM_MAX_REGIONS) {
+    region_dropped++;
+    return;
+  }
+  regions[region_count].ptr = ptr;
+  regions[region_count].name = name;
+  regions[region_count].bytes = bytes;
+  regions[region_count].psram = psram;
+  region_count++;
+}
+
+bool mem_psram_available() {
+  return heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0;
+}
+
+void* mem_alloc_psram(const char* name, size_t bytes) {
+  if (!mem_psram_available()) return NULL;
+  void* p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (p != NULL) record_region(p, name, bytes, true);
+  return p;
+}
+
+void* mem_alloc_internal(const char* name, size_t bytes) {
+  void* p = heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (p != NULL) record_region(p, name, bytes, false);
+  return p;
+}
+
+bool mem_is_psram(const void* ptr) {
+  for (uint8_t i = 0; i < region_count; i++) {
+    if (regions[i].ptr == ptr) return regions[i].psram;
+  }
+  return false;
+}
+
+size_t mem_psram_total() {
+  return heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+}
+
+size_t mem_psram_free() {
+  return heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+}
+
+uint8_t mem_regions(const mem_region_t** out) {
+  *out = regions;
+  return region_count;
+}
+
+uint8_t mem_regions_dropped() {
+  return region_dropped;
+}
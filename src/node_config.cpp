@@ -0,0 +1,82 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include "node_config.h"
+
+static void default_node_id(char* out, size_t out_size) {
+#ifdef NODE_ID
+  snprintf(out, out_size, "%s", NODE_ID);
+#else
+  // getEfuseMac() devolve o MAC base com o primeiro octeto no byte menos significativo
+  uint64_t mac = ESP.getEfuseMac();
+  snprintf(out, out_size, NODE_ID_PREFIX "%02x%02x%02x%02x%02x%02x",
+           (uint8_t)(mac), (uint8_t)(mac >> 8), (uint8_t)(mac >> 16),
+           (uint8_t)(mac >> 24), (uint8_t)(mac >> 32), (uint8_t)(mac >> 40));
+#endif
+}
+
+bool node_id_valid(const char* node_id) {
+  size_t len = 0;
+  for (; node_id[len]; len++) {
+    char c = node_id[len];
+    bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+              c == '.' || c == '_' || c == '-';
+    if (!ok || len >= NODE_ID_MAX_LEN) return false;
+  }
+  return true;
+}
+
+void node_config_load(node_config_t* cfg) {
+  Preferences prefs;
+  bool opened = prefs.begin(NODE_CONFIG_NAMESPACE, true);
+
+  cfg->node_id_from_nvs = false;
+  cfg->node_id[0] = '\0';
+  if (opened && prefs.isKey("node_id")) {
+    cfg->node_id_from_nvs = prefs.getString("node_id", cfg->node_id, sizeof(cfg->node_id)) > 0 &&
+                            node_id_valid(cfg->node_id);
+  }
+  if (!cfg->node_id_from_nvs) {
+    default_node_id(cfg->node_id, sizeof(cfg->node_id));
+  }
+
+  cfg->cluster_size = opened ? prefs.getUChar("cl_size", 1) : 1;
+  cfg->cluster_index = opened ? prefs.getUChar("cl_index", 0) : 0;
+  if (cfg->cluster_size == 0 || cfg->cluster_index >= cfg->cluster_size) {
+    cfg->cluster_size = 1;
+    cfg->cluster_index = 0;
+  }
+
+  if (opened) prefs.end();
+}
+
+bool node_config_save_node_id(const char* node_id) {
+  Preferences prefs;
+  if (!prefs.begin(NODE_CONFIG_NAMESPACE, false)) return false;
+  bool ok = (node_id[0] == '\0') ? prefs.remove("node_id") : prefs.putString("node_id", node_id) > 0;
+  prefs.end();
+  return ok;
+}
+
+bool node_config_save_cluster(uint8_t index, uint8_t size) {
+  Preferences prefs;
+  if (!prefs.begin(NODE_CONFIG_NAMESPACE, false)) return false;
+  bool ok = prefs.putUChar("cl_size", size) > 0 && prefs.putUChar("cl_index", index) > 0;
+  prefs.end();
+  return ok;
+}
+
+bool node_config_load_blob(const char* key, void* out, size_t size) {
+  Preferences prefs;
+  if (!prefs.begin(NODE_CONFIG_NAMESPACE, true)) return false;
+  bool ok = prefs.isKey(key) && prefs.getBytesLength(key) == size && prefs.getBytes(key, out, size) == size;
+  prefs.end();
+  return ok;
+}
+
+bool node_config_save_blob(const char* key, const void* data, size_t size) {
+  Preferences prefs;
+  if (!prefs.begin(NODE_CONFIG_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes(key, data, size) == size;
+  prefs.end();
+  return ok;
+}
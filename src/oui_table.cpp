@@ -0,0 +1,21 @@
+#include "oui_table.h"
+
+const char* oui_lookup(const uint8_t* mac) {
+  uint32_t key = ((uint32_t)mac[0] << 16) | ((uint32_t)mac[1] << 8) | mac[2];
+
+  uint32_t lo = 0;
+  uint32_t hi = oui_table_size;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (oui_keys[mid] < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (lo < oui_table_size && oui_keys[lo] == key) {
+    return oui_names + oui_name_offsets[oui_name_ids[lo]];
+  }
+  return NULL;
+}
@@ -0,0 +1,137 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "output_transport.h"
+
+static SemaphoreHandle_t output_mutex = NULL;
+static output_stats_t output_stats = {0};
+static const output_sink_t* output_sinks[OUTPUT_MAX_SINKS];
+static uint8_t output_sink_count = 0;
+
+void output_begin() {
+  output_mutex = xSemaphoreCreateMutex();
+
+  // Tamanhos dos rings precisam ser definidos antes de begin()
+  Serial.setRxBufferSize(OUTPUT_RX_BUFFER_SIZE);
+  Serial.setTxBufferSize(OUTPUT_TX_BUFFER_SIZE);
+#if OUTPUT_TRANSPORT == OUTPUT_TRANSPORT_USB_CDC
+  Serial.begin();
+  // Sem host conectado o write() do HWCDC esperaria o timeout a cada chamada
+  Serial.setTxTimeoutMs(0);
+#else
+  Serial.begin(OUTPUT_BAUD);
+#endif
+
+  output_stats.tx_free_min = Serial.availableForWrite();
+}
+
+bool output_write(const uint8_t* data, size_t len) {
+  return output_write_records(data, len, 1);
+}
+
+bool output_write_records(const uint8_t* data, size_t len, uint32_t records) {
+  if (output_mutex == NULL ||
+      xSemaphoreTake(output_mutex, pdMS_TO_TICKS(OUTPUT_LOCK_TIMEOUT_MS)) != pdTRUE) {
+    output_stats.lock_timeouts++;
+    output_stats.dropped_records += records;
+    output_stats.dropped_bytes += len;
+    return false;
+  }
+
+  size_t free_space = Serial.availableForWrite();
+  if (free_space < output_stats.tx_free_min) {
+    output_stats.tx_free_min = free_space;
+  }
+
+  bool written = free_space >= len;
+  if (written) {
+    Serial.write(data, len);
+    output_stats.records += records;
+    output_stats.bytes += len;
+  } else {
+    output_stats.dropped_records += records;
+    output_stats.dropped_bytes += len;
+  }
+
+  for (uint8_t i = 0; i < output_sink_count; i++) {
+    output_sinks[i]->write(data, len);
+  }
+
+  xSemaphoreGive(output_mutex);
+  return written;
+}
+
+bool output_add_sink(const output_sink_t* sink) {
+  if (output_mutex == NULL || output_sink_count >= OUTPUT_MAX_SINKS) return false;
+  xSemaphoreTake(output_mutex, portMAX_DELAY);
+  output_sinks[output_sink_count++] = sink;
+  xSemaphoreGive(output_mutex);
+  return true;
+}
+
+void output_lock() {
+  xSemaphoreTake(output_mutex, portMAX_DELAY);
+}
+
+void output_write_blocking(const uint8_t* data, size_t len) {
+  while (len > 0) {
+    size_t chunk = Serial.availableForWrite();
+    if (chunk == 0) {
+      vTaskDelay(1);
+      continue;
+    }
+    if (chunk > len) chunk = len;
+    Serial.write(data, chunk);
+    output_stats.bytes += chunk;
+    data += chunk;
+    len -= chunk;
+  }
+}
+
+void output_unlock() {
+  xSemaphoreGive(output_mutex);
+}
+
+void output_poll(uint32_t now_ms) {
+  if (output_sink_count == 0) return;
+  if (xSemaphoreTake(output_mutex, pdMS_TO_TICKS(OUTPUT_LOCK_TIMEOUT_MS)) != pdTRUE) return;
+  for (uint8_t i = 0; i < output_sink_count; i++) {
+    if (output_sinks[i]->poll) output_sinks[i]->poll(now_ms);
+  }
+  xSemaphoreGive(output_mutex);
+}
+
+bool output_printf(const char* fmt, ...) {
+  char line[OUTPUT_LINE_MAX];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(line, sizeof(line), fmt, args);
+  va_end(args);
+  if (len < 0) return false;
+  if ((size_t)len >= sizeof(line)) {
+    len = sizeof(line) - 1;
+    line[len - 1] = '\n';  // mantém uma linha por registro mesmo truncada
+  }
+  return output_write((const uint8_t*)line, len);
+}
+
+const char* output_transport_name() {
+#if OUTPUT_TRANSPORT == OUTPUT_TRANSPORT_USB_CDC
+  return "usb_cdc";
+#else
+  return "uart";
+#endif
+}
+
+uint32_t output_baud() {
+#if OUTPUT_TRANSPORT == OUTPUT_TRANSPORT_USB_CDC
+  return 0;
+#else
+  return OUTPUT_BAUD;
+#endif
+}
+
+const output_stats_t* output_get_stats() {
+  return &output_stats;
+}
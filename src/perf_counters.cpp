@@ -0,0 +1,63 @@
+#include "perf_counters.h"
+
+perf_hist_t perf_hists[PERF_SHARDS][PERF_HIST_COUNT];
+std::atomic<uint32_t> perf_window(1);  // histogramas zerados (window 0) começam vazios
+thread_local uint8_t perf_shard = 0;
+
+uint32_t perf_hist_percentile(const perf_hist_t* h, uint16_t permille) {
+  if (h->count == 0) return 0;
+  uint32_t rank = (uint32_t)(((uint64_t)h->count * permille + 999) / 1000);
+  if (rank == 0) rank = 1;
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < PERF_HIST_BUCKETS - 1; b++) {
+    seen += h->buckets[b];
+    if (seen >= rank) {
+      uint32_t upper = (2u << b) - 1;
+      return upper < h->max ? upper : h->max;
+    }
+  }
+  return h->max;
+}
+
+uint32_t perf_hist_avg(const perf_hist_t* h) {
+  return h->count ? (uint32_t)(h->sum / h->count) : 0;
+}
+
+static void perf_hist_merge(perf_hist_t* out, const perf_hist_t* h) {
+  if (h->count == 0) return;
+  if (out->count == 0 || h->min < out->min) out->min = h->min;
+  if (h->max > out->max) out->max = h->max;
+  out->count += h->count;
+  out->sum += h->sum;
+  for (uint8_t b = 0; b < PERF_HIST_BUCKETS; b++) out->buckets[b] += h->buckets[b];
+}
+
+void perf_snapshot(perf_hist_t* out) {
+  uint32_t window = perf_window.load(std::memory_order_relaxed);
+  for (uint8_t i = 0; i < PERF_HIST_COUNT; i++) {
+    perf_hist_clear(&out[i]);
+    out[i].window = window;
+    for (uint8_t shard = 0; shard < PERF_SHARDS; shard++) {
+      perf_hist_t h = perf_hists[shard][i];
+      // Nenhuma amostra nesta janela: o conteúdo ainda é o da anterior
+      if (h.window == window) perf_hist_merge(&out[i], &h);
+    }
+  }
+  perf_window.store(window + 1, std::memory_order_relaxed);
+}
+
+const char* perf_hist_name(uint8_t index) {
+  switch (index) {
+    case PERF_STAGE_RX_CALLBACK: return "rx_callback";
+    case PERF_STAGE_FRAME: return "process_frame";
+    case PERF_STAGE_PARSE: return "parse";
+    case PERF_STAGE_IE_PARSE: return "ie_parse";
+    case PERF_STAGE_VENDOR: return "vendor_lookup";
+    case PERF_STAGE_DEVICE_CACHE: return "device_cache";
+    case PERF_STAGE_SERIALIZE: return "serialize";
+    case PERF_STAGE_OUTPUT: return "output_write";
+    case PERF_SAMPLE_RING_DEPTH: return "ring_depth";
+    case PERF_SAMPLE_RX_TO_EMIT: return "rx_to_emit_us";
+    default: return "unknown";
+  }
+}
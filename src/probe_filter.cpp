@@ -0,0 +1,153 @@
+#include <string.h>
+#include "probe_filter.h"
+
+#define PROBE_FILTER_SA_OFFSET 10
+#define PROBE_FILTER_IES_OFFSET 24
+
+void probe_filter_rules_clear(probe_filter_rules_t* rules) {
+  memset(rules, 0, sizeof(probe_filter_rules_t));
+  rules->version = PROBE_FILTER_VERSION;
+  rules->rssi_min = PROBE_FILTER_RSSI_ANY;
+  rules->randomized = PROBE_FILTER_RANDOMIZED_ANY;
+}
+
+bool probe_filter_rules_valid(const probe_filter_rules_t* rules) {
+  if (rules->version != PROBE_FILTER_VERSION) return false;
+  if (rules->randomized > PROBE_FILTER_RANDOMIZED_EXCLUDE) return false;
+  if (rules->mac_count > PROBE_FILTER_MAX_MACS || rules->ssid_count > PROBE_FILTER_MAX_SSIDS) return false;
+  for (uint8_t i = 0; i < rules->mac_count; i++) {
+    const probe_filter_mac_t* m = &rules->macs[i];
+    if (m->prefix_bits == 0 || m->prefix_bits > 48 || m->action > PROBE_FILTER_MAC_DENY) return false;
+  }
+  for (uint8_t i = 0; i < rules->ssid_count; i++) {
+    if (memchr(rules->ssids[i], '\0', sizeof(rules->ssids[i])) == NULL) return false;
+  }
+  return true;
+}
+
+void probe_filter_init(probe_filter_t* filter) {
+  probe_filter_rules_clear(&filter->rules[0]);
+  probe_filter_rules_clear(&filter->rules[1]);
+  filter->active.store(0, std::memory_order_relaxed);
+  memset(&filter->counters, 0, sizeof(filter->counters));
+}
+
+void probe_filter_publish(probe_filter_t* filter, const probe_filter_rules_t* rules) {
+  uint8_t next = filter->active.load(std::memory_order_relaxed) ^ 1;
+  memcpy(&filter->rules[next], rules, sizeof(probe_filter_rules_t));
+  filter->active.store(next, std::memory_order_release);
+}
+
+static bool mac_prefix_match(const uint8_t* mac, const probe_filter_mac_t* entry) {
+  uint8_t bits = entry->prefix_bits;
+  for (uint8_t i = 0; i < 6 && bits > 0; i++) {
+    uint8_t mask = bits >= 8 ? 0xFF : (uint8_t)(0xFF << (8 - bits));
+    if ((mac[i] & mask) != (entry->addr[i] & mask)) return false;
+    bits = bits >= 8 ? bits - 8 : 0;
+  }
+  return true;
+}
+
+static bool mac_allowed(const probe_filter_rules_t* rules, const uint8_t* sa) {
+  bool has_allow = false;
+  bool allowed = false;
+  for (uint8_t i = 0; i < rules->mac_count; i++) {
+    const probe_filter_mac_t* entry = &rules->macs[i];
+    if (entry->action == PROBE_FILTER_MAC_DENY) {
+      if (mac_prefix_match(sa, entry)) return false;
+    } else {
+      has_allow = true;
+      if (!allowed && mac_prefix_match(sa, entry)) allowed = true;
+    }
+  }
+  return !has_allow || allowed;
+}
+
+static bool ssid_allowed(const probe_filter_rules_t* rules, const uint8_t* frame, size_t len) {
+  // Localizar o IE de SSID (normalmente o primeiro) sem fazer o parsing completo
+  const uint8_t* ssid = NULL;
+  uint8_t ssid_len = 0;
+  size_t offset = PROBE_FILTER_IES_OFFSET;
+  while (offset + 2 <= len) {
+    uint8_t id = frame[offset];
+    uint8_t ie_len = frame[offset + 1];
+    if (offset + 2 + ie_len > len) break;
+    if (id == 0) {
+      ssid = frame + offset + 2;
+      ssid_len = ie_len;
+      break;
+    }
+    offset += 2 + ie_len;
+  }
+  if (ssid == NULL || ssid_len == 0) return false;
+
+  for (uint8_t i = 0; i < rules->ssid_count; i++) {
+    const char* pattern = rules->ssids[i];
+    size_t plen = strlen(pattern);
+    if (plen > 0 && pattern[plen - 1] == '*') {
+      plen--;
+      if (ssid_len >= plen && memcmp(ssid, pattern, plen) == 0) return true;
+    } else if (ssid_len == plen && memcmp(ssid, pattern, plen) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool probe_filter_match(probe_filter_t* filter, const uint8_t* frame, size_t len, int8_t rssi) {
+  const probe_filter_rules_t* rules = probe_filter_rules(filter);
+  probe_filter_counters_t* c = &filter->counters;
+  const uint8_t* sa = frame + PROBE_FILTER_SA_OFFSET;
+
+  c->checked++;
+
+  if (rssi < rules->rssi_min) {
+    c->rejected_rssi++;
+    return false;
+  }
+
+  if (rules->randomized != PROBE_FILTER_RANDOMIZED_ANY) {
+    bool randomized = (sa[0] & 0x02) != 0;
+    if (randomized != (rules->randomized == PROBE_FILTER_RANDOMIZED_ONLY)) {
+      c->rejected_randomized++;
+      return false;
+    }
+  }
+
+  if (rules->mac_count > 0 && !mac_allowed(rules, sa)) {
+    c->rejected_mac++;
+    return false;
+  }
+
+  if (rules->ssid_count > 0 && !ssid_allowed(rules, frame, len)) {
+    c->rejected_ssid++;
+    return false;
+  }
+
+  c->accepted++;
+  return true;
+}
+
+bool probe_filter_add_mac(probe_filter_rules_t* rules, const uint8_t* addr, uint8_t prefix_bits,
+                          uint8_t action) {
+  if (rules->mac_count >= PROBE_FILTER_MAX_MACS) return false;
+  if (prefix_bits == 0 || prefix_bits > 48 || action > PROBE_FILTER_MAC_DENY) return false;
+
+  probe_filter_mac_t* entry = &rules->macs[rules->mac_count++];
+  memcpy(entry->addr, addr, 6);
+  entry->prefix_bits = prefix_bits;
+  entry->action = action;
+  return true;
+}
+
+bool probe_filter_add_ssid(probe_filter_rules_t* rules, const char* ssid) {
+  if (rules->ssid_count >= PROBE_FILTER_MAX_SSIDS) return false;
+
+  size_t len = strlen(ssid);
+  size_t max = PROBE_FILTER_SSID_MAX + ((len > 0 && ssid[len - 1] == '*') ? 1 : 0);
+  if (len == 0 || len > max) return false;
+
+  memcpy(rules->ssids[rules->ssid_count], ssid, len + 1);
+  rules->ssid_count++;
+  return true;
+}
@@ -0,0 +1,438 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "probe_record.h"
+#include "frame_ring.h"
+#include "json_writer.h"
+#include "oui_table.h"
+#include "perf_counters.h"
+#include "wire_format.h"
+
+// Função para gerar UUID simples baseado em timestamp e contador
+void format_packet_id(char* out, uint32_t pkt_seq, uint32_t epoch_s, uint16_t ms, uint16_t scanner_tag) {
+  sprintf(out, "%08x-%04x-%04x-%04x-%08x%04x",
+          epoch_s,
+          (uint16_t)(pkt_seq & 0xFFFF),
+          (uint16_t)((pkt_seq >> 16) & 0xFFFF),
+          scanner_tag,
+          epoch_s,
+          ms);
+}
+
+// Função para formatar timestamp ISO8601 (out com pelo menos 32 bytes)
+void format_iso8601_timestamp(char* out, uint32_t epoch_s, uint16_t ms) {
+#ifdef BUILD_TIME_UNIX
+  // Data e hora só são recalculadas quando o segundo muda; um cache por task
+  // (os workers de parsing formatam em paralelo)
+  static thread_local uint32_t cached_s = UINT32_MAX;
+  static thread_local char cached[20];
+  if (epoch_s != cached_s) {
+    time_t now = epoch_s;
+    struct tm timeinfo;
+    gmtime_r(&now, &timeinfo);
+    // Campos reduzidos à largura do formato: o compilador vê que cabem em 19 bytes
+    // (epoch u32 vai até 2106; os demais campos do tm já estão nessas faixas)
+    snprintf(cached, sizeof(cached), "%04u-%02u-%02uT%02u:%02u:%02u",
+             (unsigned)(timeinfo.tm_year + 1900) % 10000,
+             (unsigned)(timeinfo.tm_mon + 1) % 100,
+             (unsigned)timeinfo.tm_mday % 100,
+             (unsigned)timeinfo.tm_hour % 100,
+             (unsigned)timeinfo.tm_min % 100,
+             (unsigned)timeinfo.tm_sec % 100);
+    cached_s = epoch_s;
+  }
+  memcpy(out, cached, 19);
+  out[19] = '.';
+  out[20] = '0' + ms / 100;
+  out[21] = '0' + ms / 10 % 10;
+  out[22] = '0' + ms % 10;
+  out[23] = 'Z';
+  out[24] = '\0';
+#else
+  // Fallback: epoch_s contém segundos desde o boot (millis)
+  unsigned long seconds = epoch_s;
+  unsigned long minutes = seconds / 60;
+  unsigned long hours = minutes / 60;
+
+  sprintf(out, "1970-01-01T%02lu:%02lu:%02lu.%03uZ",
+          hours % 24,
+          minutes % 60,
+          seconds % 60,
+          (unsigned)ms);
+#endif
+}
+
+bool parse_probe_request(const uint8_t* frame, size_t len, bool has_fcs, int8_t rssi, uint8_t channel, capture_data_t& capture) {
+  if (len < sizeof(wifi_ieee80211_mac_hdr_t)) return false;
+
+  wifi_ieee80211_packet_t* pkt = (wifi_ieee80211_packet_t*)frame;
+
+  // Registro POD: pode ser zerado com memset e não toca o heap
+  memset(&capture, 0, sizeof(capture_data_t));
+
+  // Informações de rádio
+  capture.packet.radio.channel = channel;
+  capture.packet.radio.freq_mhz = CHANNEL_TO_FREQ(channel);
+  capture.packet.radio.band = "2.4GHz";
+  capture.packet.radio.bandwidth_mhz = 20;
+  capture.packet.radio.antenna = 0;
+
+  // Informações IEEE 802.11
+  capture.packet.ieee80211.type = "management";
+  capture.packet.ieee80211.subtype = "probe-request";
+  capture.packet.ieee80211.duration = pkt->hdr.duration_id;
+  capture.packet.ieee80211.seq_ctrl = (pkt->hdr.sequence_ctrl & 0xFFF0) >> 4;
+
+  // Endereços
+  memcpy(capture.packet.ieee80211.da, pkt->hdr.addr1, 6);    // destination
+  memcpy(capture.packet.ieee80211.sa, pkt->hdr.addr2, 6);    // source
+  memcpy(capture.packet.ieee80211.bssid, pkt->hdr.addr3, 6); // BSSID
+
+  // RSSI
+  capture.packet.rssi_dbm = rssi;
+
+  // Frame raw: apenas referência ao slot (convertido para hex na emissão)
+  capture.packet.frame = frame;
+  capture.packet.frame_len = (has_fcs && len >= WIFI_MGMT_HEADER_LEN + WIFI_FCS_LEN) ? len - WIFI_FCS_LEN : len;
+
+  // Analisar MAC randomization
+  capture.packet.mac_randomized = is_randomized_mac(pkt->hdr.addr2);
+
+  // Vendor (OUI é derivado do SA na emissão)
+  PERF_BEGIN(vendor_start);
+  capture.packet.vendor_inferred = get_vendor_from_mac(pkt->hdr.addr2);
+  PERF_END(PERF_STAGE_VENDOR, vendor_start);
+
+  // Visões dos IEs em uma passada. Probe requests não têm addr4 nem campos
+  // fixos: os IEs começam logo após o cabeçalho de 24 bytes e terminam antes do FCS.
+  PERF_BEGIN(ie_start);
+  ie_parse(&capture.packet.ies, frame, WIFI_MGMT_HEADER_LEN, capture.packet.frame_len);
+  PERF_END(PERF_STAGE_IE_PARSE, ie_start);
+
+  // Fingerprint calculado na mesma passada
+  capture.packet.fingerprint.ie_hash = capture.packet.ies.fp_hash;
+  capture.packet.fingerprint.confidence = 0.65; // valor padrão
+
+  return true;
+}
+
+void frame_to_hex(const uint8_t* frame, size_t len, char* out) {
+  hex_encode(frame, len, out);
+  out[len * 2] = '\0';
+}
+
+void mac_to_string(const uint8_t* mac, char* out) {
+  for (int i = 0; i < 6; i++) {
+    hex_encode(mac + i, 1, out + i * 3);
+    out[i * 3 + 2] = i < 5 ? ':' : '\0';
+  }
+}
+
+// "aa:bb:cc" (out com pelo menos 9 bytes)
+void format_oui(const uint8_t* oui, char* out) {
+  for (int i = 0; i < 3; i++) {
+    hex_encode(oui + i, 1, out + i * 3);
+    out[i * 3 + 2] = i < 2 ? ':' : '\0';
+  }
+}
+
+size_t format_capture_json(const capture_data_t& capture, char* out, size_t out_size) {
+  // Serialização em streaming direto para o buffer de saída (sem DOM nem heap)
+  if (out_size < 2) return 0;
+  json_writer_t w;
+  json_begin(&w, out, out_size - 2);
+
+  const packet_data_t& pkt = capture.packet;
+  char capture_ts[32];
+  char pkt_id[37];
+  char oui[9];
+
+  format_iso8601_timestamp(capture_ts, capture.capture_epoch_s, capture.capture_ms);
+  format_packet_id(pkt_id, pkt.pkt_seq, capture.capture_epoch_s, capture.capture_ms, capture.scanner_tag);
+
+  json_object_begin(&w);
+
+  // Campos obrigatórios do schema
+  json_kv_string(&w, "capture_id", capture.capture_id);
+  json_kv_string(&w, "capture_ts", capture_ts);
+  json_kv_string(&w, "scanner_id", capture.scanner_id);
+  json_kv_string(&w, "firmware", capture.firmware);
+
+  // Opcional: location (null por enquanto)
+  json_key(&w, "location");
+  json_raw(&w, "{\"lat\":null,\"lon\":null,\"label\":null}");
+
+  // Objeto packet (obrigatório)
+  json_key(&w, "packet");
+  json_object_begin(&w);
+  json_kv_string(&w, "pkt_id", pkt_id);
+
+  // Radio info
+  json_key(&w, "radio");
+  json_object_begin(&w);
+  json_kv_uint(&w, "channel", pkt.radio.channel);
+  json_kv_uint(&w, "freq_mhz", pkt.radio.freq_mhz);
+  json_kv_string(&w, "band", pkt.radio.band);
+  json_kv_uint(&w, "bandwidth_mhz", pkt.radio.bandwidth_mhz);
+  json_kv_uint(&w, "antenna", pkt.radio.antenna);
+  json_kv_uint(&w, "dwell_id", pkt.radio.dwell_id);
+  json_kv_uint(&w, "rx_us", pkt.radio.rx_us);
+  json_object_end(&w);
+
+  // IEEE 802.11 info
+  json_key(&w, "ieee80211");
+  json_object_begin(&w);
+  json_kv_string(&w, "type", pkt.ieee80211.type);
+  json_kv_string(&w, "subtype", pkt.ieee80211.subtype);
+  json_kv_uint(&w, "duration", pkt.ieee80211.duration);
+  json_key(&w, "da");
+  json_mac(&w, pkt.ieee80211.da);
+  json_key(&w, "sa");
+  json_mac(&w, pkt.ieee80211.sa);
+  json_key(&w, "bssid");
+  json_mac(&w, pkt.ieee80211.bssid);
+  json_kv_uint(&w, "seq_ctrl", pkt.ieee80211.seq_ctrl);
+  json_object_end(&w);
+
+  // Campos obrigatórios do packet
+  json_kv_int(&w, "rssi_dbm", pkt.rssi_dbm);
+  json_key(&w, "frame_raw_hex");
+  json_hex(&w, pkt.frame, pkt.frame_len > FRAME_RAW_MAX ? FRAME_RAW_MAX : pkt.frame_len);
+
+  // Decodificadores sobre as visões (corpos lidos direto do frame)
+  const ie_list_t& ies = pkt.ies;
+  char ssid[SSID_MAX_LEN + 1];
+  uint8_t rates[255];
+  size_t rates_count;
+
+  // Probe info
+  ie_decode_ssid(&ies, ssid, sizeof(ssid));
+  json_key(&w, "probe");
+  json_object_begin(&w);
+  json_kv_string(&w, "ssid", ssid);
+  json_kv_bool(&w, "ssid_hidden", false);
+  json_object_end(&w);
+
+  // Supported rates
+  rates_count = ie_decode_rates(&ies, ies.rates, rates, sizeof(rates));
+  if (rates_count > 0) {
+    json_key(&w, "supported_rates");
+    json_array_begin(&w);
+    for (size_t i = 0; i < rates_count; i++) {
+      json_uint(&w, rates[i]);
+    }
+    json_array_end(&w);
+  }
+
+  // Extended rates
+  rates_count = ie_decode_rates(&ies, ies.ext_rates, rates, sizeof(rates));
+  if (rates_count > 0) {
+    json_key(&w, "extended_rates");
+    json_array_begin(&w);
+    for (size_t i = 0; i < rates_count; i++) {
+      json_uint(&w, rates[i]);
+    }
+    json_array_end(&w);
+  }
+
+  // HT capabilities (Capability Information + Rx MCS bitmask)
+  json_key(&w, "ht_capabilities");
+  if (ies.ht != IE_VIEW_NONE) {
+    uint16_t info = ies.caps.ht_info;
+    int max_mcs = ie_ht_max_mcs(&ies.caps);
+    uint8_t streams = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+      if (ies.caps.ht_mcs[i]) streams = i + 1;
+    }
+    json_object_begin(&w);
+    json_kv_bool(&w, "present", true);
+    if (max_mcs >= 0) {
+      char mcs_set[8];
+      snprintf(mcs_set, sizeof(mcs_set), "0-%u", (unsigned)(uint8_t)max_mcs);  // MCS 0-31
+      json_kv_string(&w, "mcs_set", mcs_set);
+    } else {
+      json_kv_null(&w, "mcs_set");
+    }
+    json_kv_uint(&w, "spatial_streams", streams);
+    json_kv_bool(&w, "ldpc", info & 0x0001);
+    json_kv_bool(&w, "width_40mhz", info & 0x0002);
+    json_kv_bool(&w, "sgi_20", info & 0x0020);
+    json_kv_bool(&w, "sgi_40", info & 0x0040);
+    json_object_end(&w);
+  } else {
+    json_null(&w);
+  }
+
+  // VHT capabilities
+  json_key(&w, "vht_capabilities");
+  if (ies.vht != IE_VIEW_NONE) {
+    uint32_t info = ies.caps.vht_info;
+    json_object_begin(&w);
+    json_kv_bool(&w, "present", true);
+    json_kv_uint(&w, "spatial_streams", ie_mcs_map_streams(ies.caps.vht_rx_mcs_map));
+    json_kv_uint(&w, "channel_width_set", (info >> 2) & 0x03);
+    json_kv_bool(&w, "rx_ldpc", info & 0x00000010);
+    json_kv_bool(&w, "sgi_80", info & 0x00000020);
+    json_kv_bool(&w, "sgi_160", info & 0x00000040);
+    json_kv_bool(&w, "su_beamformee", info & 0x00001000);
+    json_kv_bool(&w, "mu_beamformee", info & 0x00100000);
+    json_object_end(&w);
+  } else {
+    json_null(&w);
+  }
+
+  // HE capabilities (Element ID Extension 35)
+  json_key(&w, "he_capabilities");
+  if (ies.he != IE_VIEW_NONE) {
+    json_object_begin(&w);
+    json_kv_bool(&w, "present", true);
+    json_kv_uint(&w, "spatial_streams", ie_mcs_map_streams(ies.caps.he_rx_mcs_80));
+    json_kv_uint(&w, "channel_width_set", (ies.caps.he_phy0 >> 1) & 0x7F);
+    json_kv_bool(&w, "twt_requester", ies.caps.he_mac0 & 0x02);
+    json_object_end(&w);
+  } else {
+    json_null(&w);
+  }
+
+  // EHT capabilities (Element ID Extension 108)
+  json_key(&w, "eht_capabilities");
+  if (ies.eht != IE_VIEW_NONE) {
+    json_raw(&w, "{\"present\":true}");
+  } else {
+    json_null(&w);
+  }
+
+  // Extended capabilities
+  json_key(&w, "extended_capabilities");
+  const ie_view_t* ext_caps = ie_get(&ies, ies.ext_caps);
+  if (ext_caps != NULL) {
+    json_object_begin(&w);
+    json_key(&w, "hex");
+    json_hex(&w, ie_body(&ies, ext_caps), ext_caps->len);
+    json_kv_bool(&w, "bss_transition", ie_ext_cap_bit(&ies, EXT_CAP_BSS_TRANSITION));
+    json_kv_bool(&w, "interworking", ie_ext_cap_bit(&ies, EXT_CAP_INTERWORKING));
+    json_kv_bool(&w, "opmode_notification", ie_ext_cap_bit(&ies, EXT_CAP_OPMODE_NOTIFICATION));
+    json_kv_bool(&w, "ftm_initiator", ie_ext_cap_bit(&ies, EXT_CAP_FTM_INITIATOR));
+    json_object_end(&w);
+  } else {
+    json_null(&w);
+  }
+
+  // Vendor IEs (payload completo, sem o limite antigo de 64 bytes)
+  json_key(&w, "vendor_ies");
+  json_array_begin(&w);
+  for (uint8_t i = 0; i < ies.count; i++) {
+    const ie_view_t& ie = ies.ies[i];
+    if (ie.id != IE_VENDOR_SPECIFIC || ie.len < 3) continue;
+    const uint8_t* body = ie_body(&ies, &ie);
+    json_object_begin(&w);
+    format_oui(body, oui);
+    json_kv_string(&w, "oui", oui);
+    json_kv_uint(&w, "vendor_type", ie.len > 3 ? body[3] : 0);
+    json_key(&w, "payload_hex");
+    json_hex(&w, body + 4, ie.len > 4 ? ie.len - 4 : 0);
+    json_kv_string(&w, "meaning", "");
+    json_object_end(&w);
+  }
+  json_array_end(&w);
+
+  // IEs raw
+  json_key(&w, "ies_raw");
+  json_array_begin(&w);
+  for (uint8_t i = 0; i < ies.count; i++) {
+    const ie_view_t& ie = ies.ies[i];
+    json_object_begin(&w);
+    json_kv_uint(&w, "id", ie.id);
+    json_kv_uint(&w, "len", ie.len);
+    json_key(&w, "value_hex");
+    json_hex(&w, ie_body(&ies, &ie), ie.len);
+    json_object_end(&w);
+  }
+  json_array_end(&w);
+
+  // MAC info
+  json_kv_bool(&w, "mac_randomized", pkt.mac_randomized);
+  format_oui(pkt.ieee80211.sa, oui);
+  json_kv_string(&w, "oui", oui);
+  json_kv_string(&w, "vendor_inferred", pkt.vendor_inferred);
+  if (pkt.track_id != 0) json_kv_uint(&w, "track_id", pkt.track_id);
+
+  // Fingerprint
+  json_key(&w, "fingerprint");
+  json_object_begin(&w);
+  char ie_hash[9];
+  hex_encode_u32(pkt.fingerprint.ie_hash, ie_hash);
+  json_kv_string(&w, "ie_signature", ie_hash);
+  json_key(&w, "confidence");
+  json_fixed(&w, pkt.fingerprint.confidence, 3);
+  json_object_end(&w);
+
+  json_object_end(&w);  // packet
+  json_object_end(&w);
+
+  if (w.overflow) return 0;
+
+  // Espaço para "\r\n" reservado em json_begin()
+  out[w.len++] = '\r';
+  out[w.len++] = '\n';
+  return w.len;
+}
+
+static size_t encode_capture_record(const capture_data_t& capture, wire_delta_t* delta,
+                                    uint8_t* out, size_t out_size) {
+  // Na pilha do chamador: cada worker de parsing codifica os próprios registros
+  uint8_t record[WIRE_PACKET_HEADER_SIZE + FRAME_RING_SLOT_SIZE];
+
+  const packet_data_t& pkt = capture.packet;
+  if (pkt.frame_len < WIFI_MGMT_HEADER_LEN) return 0;
+  const wifi_ieee80211_mac_hdr_t* hdr = (const wifi_ieee80211_mac_hdr_t*)pkt.frame;
+
+  wire_packet_header_t header;
+  header.pkt_seq = pkt.pkt_seq;
+  header.epoch_s = capture.capture_epoch_s;
+  header.epoch_ms = capture.capture_ms;
+  header.fp_hash = pkt.fingerprint.ie_hash;
+  header.dwell_id = pkt.radio.dwell_id;
+  header.rx_us = pkt.radio.rx_us;
+  header.delta_ref = WIRE_DELTA_REF_NONE;
+  header.track_id = pkt.track_id;
+  header.channel = pkt.radio.channel;
+  header.rssi_dbm = pkt.rssi_dbm;
+  header.frame_ctrl = hdr->frame_ctrl;
+  header.duration = hdr->duration_id;
+  memcpy(header.addr1, hdr->addr1, 6);
+  memcpy(header.addr2, hdr->addr2, 6);
+  memcpy(header.addr3, hdr->addr3, 6);
+  header.seq_ctrl = hdr->sequence_ctrl;
+
+  // Tagged parameters: tudo após o cabeçalho management, sem o FCS
+  uint16_t ies_len = pkt.frame_len - WIFI_MGMT_HEADER_LEN;
+  if (ies_len > FRAME_RING_SLOT_SIZE) ies_len = FRAME_RING_SLOT_SIZE;
+  const uint8_t* ies = pkt.frame + WIFI_MGMT_HEADER_LEN;
+
+  size_t record_len = delta != NULL
+      ? wire_encode_packet_delta(delta, record, sizeof(record), &header, ies, ies_len)
+      : wire_encode_packet(record, sizeof(record), &header, ies, ies_len);
+  if (record_len == 0) return 0;
+  return wire_frame(record, record_len, out, out_size);
+}
+
+size_t encode_capture_binary(const capture_data_t& capture, uint8_t* out, size_t out_size) {
+  return encode_capture_record(capture, NULL, out, out_size);
+}
+
+size_t encode_capture_binary_delta(const capture_data_t& capture, wire_delta_t* delta,
+                                   uint8_t* out, size_t out_size) {
+  return encode_capture_record(capture, delta, out, out_size);
+}
+
+bool is_randomized_mac(const uint8_t* mac) {
+  // Bit 1 do primeiro octeto indica MAC address randomizado (locally administered)
+  return (mac[0] & 0x02) != 0;
+}
+
+const char* get_vendor_from_mac(const uint8_t* mac) {
+  // Busca binária na tabela OUI gerada em build (flash)
+  const char* vendor = oui_lookup(mac);
+  return vendor ? vendor : "Unknown";
+}
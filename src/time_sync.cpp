@@ -0,0 +1,81 @@
+#include "time_sync.h"
+
+void time_model_init(time_model_t* m, int64_t epoch_us, int64_t timer_us, uint8_t source) {
+  m->offset_us = epoch_us - timer_us;
+  m->source = source;
+  m->adjustments = 0;
+  m->last_step_us = 0;
+}
+
+static int32_t saturate_step(int64_t step) {
+  if (step > INT32_MAX) return INT32_MAX;
+  if (step < INT32_MIN) return INT32_MIN;
+  return (int32_t)step;
+}
+
+void time_model_set(time_model_t* m, int64_t epoch_us, int64_t timer_us, uint8_t source) {
+  int64_t offset = epoch_us - timer_us;
+  m->last_step_us = saturate_step(offset - m->offset_us);
+  m->offset_us = offset;
+  m->source = source;
+  m->adjustments++;
+}
+
+void time_model_pps(time_model_t* m, int64_t edge_timer_us) {
+  int64_t epoch = time_model_epoch_us(m, edge_timer_us);
+  int64_t second = (epoch + 500000) / 1000000 * 1000000;
+  time_model_set(m, second, edge_timer_us, TIME_SOURCE_PPS);
+}
+
+void rx_clock_init(rx_clock_t* c) {
+  c->offset.store(0, std::memory_order_relaxed);
+  c->valid.store(false, std::memory_order_relaxed);
+  c->restart.store(false, std::memory_order_relaxed);
+}
+
+void time_anchor_make(time_anchor_t* out, const time_model_t* m, uint32_t rx_offset,
+                      int64_t timer_us, uint32_t seq) {
+  int64_t epoch = time_model_epoch_us(m, timer_us);
+  if (epoch < 0) epoch = 0;
+  out->seq = seq;
+  out->source = m->source;
+  out->epoch_s = (uint32_t)(epoch / 1000000);
+  out->epoch_frac_us = (uint32_t)(epoch % 1000000);
+  out->rx_us = (uint32_t)timer_us - rx_offset;
+}
+
+const char* time_source_name(uint8_t source) {
+  switch (source) {
+    case TIME_SOURCE_NONE: return "uptime";
+    case TIME_SOURCE_BUILD: return "build";
+    case TIME_SOURCE_HOST: return "host";
+    case TIME_SOURCE_PPS: return "pps";
+    default: return "unknown";
+  }
+}
+
+bool time_parse_epoch(const char* s, int64_t* epoch_us) {
+  int64_t seconds = 0;
+  uint8_t digits = 0;
+  while (*s >= '0' && *s <= '9') {
+    seconds = seconds * 10 + (*s++ - '0');
+    if (++digits > 10) return false;
+  }
+  if (digits == 0) return false;
+
+  int64_t frac = 0;
+  int64_t scale = 1000000;
+  if (*s == '.') {
+    s++;
+    while (*s >= '0' && *s <= '9') {
+      if (scale > 1) {
+        scale /= 10;
+        frac += (*s - '0') * scale;
+      }
+      s++;
+    }
+  }
+  if (*s != '\0' && *s != ' ') return false;
+  *epoch_us = seconds * 1000000 + frac;
+  return true;
+}
@@ -0,0 +1,171 @@
+#include <string.h>
+#include "track_correlator.h"
+#include "fnv_hash.h"
+
+static uint32_t key_hash(const uint8_t* sa, uint32_t fp_hash) {
+  // FNV-1a sobre SA + fingerprint, como no device_cache
+  uint32_t h = fnv1a_update(fnv1a_init(), sa, 6);
+  for (int i = 0; i < 4; i++) {
+    h = fnv1a_byte(h, (fp_hash >> (i * 8)) & 0xFF);
+  }
+  return h;
+}
+
+static inline bool key_equals(const track_entry_t* e, const uint8_t* sa, uint32_t fp_hash) {
+  return e->fp_hash == fp_hash && memcmp(e->sa, sa, 6) == 0;
+}
+
+static void lru_unlink(track_correlator_t* tc, uint16_t slot) {
+  track_entry_t* e = &tc->entries[slot];
+  if (e->lru_prev != TRACK_CORRELATOR_NONE) tc->entries[e->lru_prev].lru_next = e->lru_next;
+  else tc->lru_head = e->lru_next;
+  if (e->lru_next != TRACK_CORRELATOR_NONE) tc->entries[e->lru_next].lru_prev = e->lru_prev;
+  else tc->lru_tail = e->lru_prev;
+  e->lru_prev = e->lru_next = TRACK_CORRELATOR_NONE;
+}
+
+static void lru_push_front(track_correlator_t* tc, uint16_t slot) {
+  track_entry_t* e = &tc->entries[slot];
+  e->lru_prev = TRACK_CORRELATOR_NONE;
+  e->lru_next = tc->lru_head;
+  if (tc->lru_head != TRACK_CORRELATOR_NONE) tc->entries[tc->lru_head].lru_prev = slot;
+  tc->lru_head = slot;
+  if (tc->lru_tail == TRACK_CORRELATOR_NONE) tc->lru_tail = slot;
+}
+
+static uint16_t index_find(const track_correlator_t* tc, const uint8_t* sa, uint32_t fp_hash, bool* found) {
+  uint16_t pos = key_hash(sa, fp_hash) & tc->index_mask;
+  for (;;) {
+    uint16_t slot = tc->index[pos];
+    if (slot == TRACK_CORRELATOR_NONE) {
+      *found = false;
+      return pos;
+    }
+    if (key_equals(&tc->entries[slot], sa, fp_hash)) {
+      *found = true;
+      return pos;
+    }
+    pos = (pos + 1) & tc->index_mask;
+  }
+}
+
+// Remoção com backward-shift (ver device_cache.cpp)
+static void index_remove(track_correlator_t* tc, uint16_t pos) {
+  uint16_t hole = pos;
+  uint16_t next = (pos + 1) & tc->index_mask;
+  while (tc->index[next] != TRACK_CORRELATOR_NONE) {
+    const track_entry_t* e = &tc->entries[tc->index[next]];
+    uint16_t home = key_hash(e->sa, e->fp_hash) & tc->index_mask;
+    bool in_range = hole <= next ? (home > hole && home <= next) : (home > hole || home <= next);
+    if (!in_range) {
+      tc->index[hole] = tc->index[next];
+      hole = next;
+    }
+    next = (next + 1) & tc->index_mask;
+  }
+  tc->index[hole] = TRACK_CORRELATOR_NONE;
+}
+
+void track_correlator_init(track_correlator_t* tc, track_entry_t* entries, uint16_t capacity,
+                           uint16_t* index, uint16_t index_size) {
+  tc->entries = entries;
+  tc->index = index;
+  tc->capacity = capacity;
+  tc->index_mask = index_size - 1;
+  tc->used = 0;
+  tc->lru_head = tc->lru_tail = TRACK_CORRELATOR_NONE;
+  tc->next_track_id = 1;
+  tc->tracks = tc->links = tc->evictions = 0;
+  memset(entries, 0, sizeof(track_entry_t) * capacity);
+  for (uint16_t i = 0; i < index_size; i++) index[i] = TRACK_CORRELATOR_NONE;
+}
+
+// Entrada recente de que um SA novo herda a trilha, ou NULL
+static track_entry_t* find_predecessor(track_correlator_t* tc, const uint8_t* sa, uint32_t fp_hash,
+                                       bool mac_randomized, uint16_t seq, int8_t rssi, uint32_t now_ms) {
+  track_entry_t* best = NULL;
+  uint16_t best_gap = 0;
+  int best_rssi_delta = 0;
+  uint16_t scanned = 0;
+
+  for (uint16_t slot = tc->lru_head; slot != TRACK_CORRELATOR_NONE; slot = tc->entries[slot].lru_next) {
+    track_entry_t* e = &tc->entries[slot];
+    // LRU em ordem de recência: daqui em diante tudo está fora da janela
+    if (now_ms - e->last_seen_ms > TRACK_LINK_WINDOW_MS || ++scanned > TRACK_LINK_SCAN_MAX) break;
+
+    // Mesmo SA, outro conjunto de IEs: mesmo dispositivo
+    if (memcmp(e->sa, sa, 6) == 0) return e;
+
+    if (!mac_randomized || !e->mac_randomized || e->superseded || e->fp_hash != fp_hash) continue;
+    uint16_t gap = (seq - e->last_seq) & 0x0FFF;
+    int rssi_delta = rssi > e->last_rssi ? rssi - e->last_rssi : e->last_rssi - rssi;
+    if (gap == 0 || gap > TRACK_SEQ_MAX_GAP || rssi_delta > TRACK_RSSI_MAX_DELTA) continue;
+
+    if (best == NULL || gap < best_gap || (gap == best_gap && rssi_delta < best_rssi_delta)) {
+      best = e;
+      best_gap = gap;
+      best_rssi_delta = rssi_delta;
+    }
+  }
+  if (best != NULL) best->superseded = true;
+  return best;
+}
+
+static uint16_t evict_lru(track_correlator_t* tc) {
+  uint16_t slot = tc->lru_tail;
+  track_entry_t* e = &tc->entries[slot];
+  bool found;
+  uint16_t pos = index_find(tc, e->sa, e->fp_hash, &found);
+  if (found) index_remove(tc, pos);
+  lru_unlink(tc, slot);
+  e->in_use = false;
+  tc->evictions++;
+  return slot;
+}
+
+uint32_t track_correlator_observe(track_correlator_t* tc, const uint8_t* sa, uint32_t fp_hash,
+                                  bool mac_randomized, uint16_t seq, int8_t rssi, uint32_t now_ms) {
+  bool found;
+  uint16_t pos = index_find(tc, sa, fp_hash, &found);
+  uint16_t slot;
+
+  if (found) {
+    slot = tc->index[pos];
+    lru_unlink(tc, slot);
+  } else {
+    // Varredura antes da inserção: o par novo ainda não está na LRU
+    const track_entry_t* pred = find_predecessor(tc, sa, fp_hash, mac_randomized, seq, rssi, now_ms);
+    uint32_t track_id;
+    if (pred != NULL) {
+      track_id = pred->track_id;
+      tc->links++;
+    } else {
+      track_id = tc->next_track_id++;
+      if (tc->next_track_id == TRACK_ID_NONE) tc->next_track_id = 1;
+      tc->tracks++;
+    }
+
+    if (tc->used < tc->capacity) {
+      slot = tc->used++;
+    } else {
+      slot = evict_lru(tc);
+      // O backward-shift pode ter movido o ponto de inserção
+      pos = index_find(tc, sa, fp_hash, &found);
+    }
+    track_entry_t* e = &tc->entries[slot];
+    memcpy(e->sa, sa, 6);
+    e->fp_hash = fp_hash;
+    e->mac_randomized = mac_randomized;
+    e->superseded = false;
+    e->in_use = true;
+    e->track_id = track_id;
+    tc->index[pos] = slot;
+  }
+  lru_push_front(tc, slot);
+
+  track_entry_t* e = &tc->entries[slot];
+  e->last_seq = seq & 0x0FFF;
+  e->last_rssi = rssi;
+  e->last_seen_ms = now_ms;
+  return e->track_id;
+}
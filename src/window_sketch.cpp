@@ -0,0 +1,144 @@
+#include <math.h>
+#include <string.h>
+#include "window_sketch.h"
+#include "fnv_hash.h"
+
+uint32_t sketch_mix32(uint32_t h) {
+  // Finalizador do MurmurHash3
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
+void hll_clear(hll_t* hll) {
+  memset(hll->registers, 0, sizeof(hll->registers));
+}
+
+void hll_add(hll_t* hll, uint32_t hash) {
+  uint32_t index = hash >> (32 - HLL_PRECISION);
+  uint32_t rest = hash << HLL_PRECISION;
+  // Posição do primeiro bit 1 nos 32 - p bits restantes (rest == 0: todos zero)
+  uint8_t rank = rest ? (uint8_t)(__builtin_clz(rest) + 1) : (uint8_t)(32 - HLL_PRECISION + 1);
+  if (rank > hll->registers[index]) hll->registers[index] = rank;
+}
+
+void hll_merge(hll_t* dst, const hll_t* src) {
+  for (uint32_t i = 0; i < HLL_REGISTERS; i++) {
+    if (src->registers[i] > dst->registers[i]) dst->registers[i] = src->registers[i];
+  }
+}
+
+uint32_t hll_estimate(const hll_t* hll) {
+  const float m = (float)HLL_REGISTERS;
+  float sum = 0.0f;
+  uint32_t zeros = 0;
+  for (uint32_t i = 0; i < HLL_REGISTERS; i++) {
+    sum += ldexpf(1.0f, -(int)hll->registers[i]);
+    if (hll->registers[i] == 0) zeros++;
+  }
+  float alpha = 0.7213f / (1.0f + 1.079f / m);
+  float estimate = alpha * m * m / sum;
+
+  // Faixa pequena: contagem linear pelos registradores vazios
+  if (estimate <= 2.5f * m && zeros > 0) {
+    estimate = m * logf(m / (float)zeros);
+  } else if (estimate > 4294967296.0f / 30.0f) {
+    // Faixa grande: colisões do hash de 32 bits
+    estimate = -4294967296.0f * log1pf(-estimate / 4294967296.0f);
+  }
+  return (uint32_t)(estimate + 0.5f);
+}
+
+float hll_std_error() {
+  return 1.04f / sqrtf((float)HLL_REGISTERS);
+}
+
+void topk_clear(topk_t* topk) {
+  topk->used = 0;
+}
+
+static bool topk_same(const topk_entry_t* e, uint32_t key, const uint8_t* label, uint8_t label_len) {
+  return e->key == key && e->label_len == label_len && memcmp(e->label, label, label_len) == 0;
+}
+
+void topk_add(topk_t* topk, const uint8_t* label, uint8_t label_len) {
+  if (label_len > SKETCH_LABEL_MAX) label_len = SKETCH_LABEL_MAX;
+  uint32_t key = fnv1a_update(fnv1a_init(), label, label_len);
+
+  // Uma passada: procura a chave e, de quebra, o menor contador
+  topk_entry_t* min = NULL;
+  for (uint8_t i = 0; i < topk->used; i++) {
+    topk_entry_t* e = &topk->entries[i];
+    if (topk_same(e, key, label, label_len)) {
+      e->count++;
+      return;
+    }
+    if (min == NULL || e->count < min->count) min = e;
+  }
+
+  topk_entry_t* e;
+  uint32_t base = 0;
+  if (topk->used < SKETCH_TOPK_CAPACITY) {
+    e = &topk->entries[topk->used++];
+  } else {
+    // Space-Saving: o novo item herda o contador do menor como erro
+    e = min;
+    base = min->count;
+  }
+  e->key = key;
+  e->count = base + 1;
+  e->error = base;
+  e->label_len = label_len;
+  memcpy(e->label, label, label_len);
+}
+
+size_t topk_collect(const topk_t* const* sketches, uint8_t count, topk_entry_t* out, size_t out_cap) {
+  size_t n = 0;
+  for (uint8_t s = 0; s < count; s++) {
+    const topk_t* topk = sketches[s];
+    for (uint8_t i = 0; i < topk->used; i++) {
+      const topk_entry_t* e = &topk->entries[i];
+      size_t j = 0;
+      while (j < n && !topk_same(&out[j], e->key, e->label, e->label_len)) j++;
+      if (j < n) {
+        out[j].count += e->count;
+        out[j].error += e->error;
+      } else if (n < out_cap) {
+        out[n++] = *e;
+      }
+    }
+  }
+
+  // Inserção: poucas dezenas de entradas
+  for (size_t i = 1; i < n; i++) {
+    topk_entry_t e = out[i];
+    size_t j = i;
+    while (j > 0 && out[j - 1].count < e.count) {
+      out[j] = out[j - 1];
+      j--;
+    }
+    out[j] = e;
+  }
+  return n;
+}
+
+void window_sketch_reset(window_sketch_t* sketch, uint32_t window_id) {
+  sketch->window_id = window_id;
+  sketch->probes = 0;
+  hll_clear(&sketch->macs);
+  hll_clear(&sketch->fingerprints);
+  topk_clear(&sketch->talkers);
+  topk_clear(&sketch->ssids);
+}
+
+void window_sketch_observe(window_sketch_t* sketch, const uint8_t* sa, uint32_t fp_hash,
+                           const char* ssid, uint8_t ssid_len) {
+  sketch->probes++;
+  hll_add(&sketch->macs, sketch_mix32(fnv1a_update(fnv1a_init(), sa, 6)));
+  hll_add(&sketch->fingerprints, sketch_mix32(fp_hash));
+  topk_add(&sketch->talkers, sa, 6);
+  if (ssid_len > 0) topk_add(&sketch->ssids, (const uint8_t*)ssid, ssid_len);
+}
@@ -0,0 +1,275 @@
+#include <string.h>
+#include "wire_format.h"
+#include "fnv_hash.h"
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) com tabela de nibbles
+static const uint16_t crc16_nibble_table[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+  0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef
+};
+
+uint16_t wire_crc16(const uint8_t* data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc = (crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ crc16_nibble_table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+
+static inline uint8_t* put_u16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+  return p + 2;
+}
+
+static inline uint8_t* put_u32(uint8_t* p, uint32_t v) {
+  p[0] = v & 0xFF;
+  p[1] = (v >> 8) & 0xFF;
+  p[2] = (v >> 16) & 0xFF;
+  p[3] = v >> 24;
+  return p + 4;
+}
+
+static uint8_t* put_str8(uint8_t* p, const char* s) {
+  size_t len = s ? strlen(s) : 0;
+  if (len > 255) len = 255;
+  *p++ = (uint8_t)len;
+  memcpy(p, s, len);
+  return p + len;
+}
+
+size_t wire_encode_session(uint8_t* out, size_t out_size, const wire_session_t* session) {
+  size_t needed = 2 + 4 + 4 + 3;
+  needed += session->capture_id ? strlen(session->capture_id) : 0;
+  needed += session->scanner_id ? strlen(session->scanner_id) : 0;
+  needed += session->firmware ? strlen(session->firmware) : 0;
+  if (needed > out_size) return 0;
+
+  uint8_t* p = out;
+  *p++ = WIRE_RECORD_SESSION;
+  *p++ = WIRE_FORMAT_VERSION;
+  p = put_u32(p, session->epoch_s);
+  p = put_u32(p, session->uptime_ms);
+  p = put_str8(p, session->capture_id);
+  p = put_str8(p, session->scanner_id);
+  p = put_str8(p, session->firmware);
+  return p - out;
+}
+
+size_t wire_encode_packet(uint8_t* out, size_t out_size, const wire_packet_header_t* header,
+                          const uint8_t* ies, uint16_t ies_len) {
+  if ((size_t)WIRE_PACKET_HEADER_SIZE + ies_len > out_size) return 0;
+
+  uint8_t* p = out;
+  *p++ = WIRE_RECORD_PACKET;
+  *p++ = WIRE_FORMAT_VERSION;
+  p = put_u32(p, header->pkt_seq);
+  p = put_u32(p, header->epoch_s);
+  p = put_u16(p, header->epoch_ms);
+  *p++ = header->channel;
+  *p++ = (uint8_t)header->rssi_dbm;
+  p = put_u16(p, header->frame_ctrl);
+  p = put_u16(p, header->duration);
+  memcpy(p, header->addr1, 6); p += 6;
+  memcpy(p, header->addr2, 6); p += 6;
+  memcpy(p, header->addr3, 6); p += 6;
+  p = put_u16(p, header->seq_ctrl);
+  p = put_u32(p, header->fp_hash);
+  p = put_u32(p, header->dwell_id);
+  p = put_u32(p, header->rx_us);
+  *p++ = header->delta_ref;
+  p = put_u32(p, header->track_id);
+  p = put_u16(p, ies_len);
+  if (ies_len > 0) {
+    memcpy(p, ies, ies_len);
+    p += ies_len;
+  }
+  return p - out;
+}
+
+size_t wire_encode_device(uint8_t* out, size_t out_size, const wire_device_t* device) {
+  if (out_size < WIRE_DEVICE_RECORD_SIZE) return 0;
+
+  uint8_t* p = out;
+  *p++ = WIRE_RECORD_DEVICE;
+  *p++ = WIRE_FORMAT_VERSION;
+  p = put_u32(p, device->window_start_s);
+  p = put_u32(p, device->first_seen_s);
+  p = put_u32(p, device->last_seen_s);
+  memcpy(p, device->sa, 6); p += 6;
+  p = put_u32(p, device->fp_hash);
+  p = put_u32(p, device->count);
+  *p++ = (uint8_t)device->rssi_min;
+  *p++ = (uint8_t)device->rssi_max;
+  *p++ = (uint8_t)device->rssi_avg;
+  p = put_u16(p, device->channels_mask);
+  *p++ = device->flags;
+  p = put_u32(p, device->track_id);
+  return p - out;
+}
+
+size_t wire_encode_source(uint8_t* out, size_t out_size, const wire_source_t* source) {
+  if (out_size < WIRE_SOURCE_RECORD_SIZE) return 0;
+
+  uint8_t* p = out;
+  *p++ = WIRE_RECORD_SOURCE;
+  *p++ = WIRE_FORMAT_VERSION;
+  memcpy(p, source->src, 6); p += 6;
+  p = put_u32(p, source->session);
+  return p - out;
+}
+
+size_t wire_encode_pcap(uint8_t* out, size_t out_size, const wire_pcap_t* pcap,
+                        const uint8_t* frame, uint16_t frame_len) {
+  if ((size_t)WIRE_PCAP_HEADER_SIZE + frame_len > out_size) return 0;
+
+  uint8_t* p = out;
+  *p++ = WIRE_RECORD_PCAP;
+  *p++ = WIRE_FORMAT_VERSION;
+  p = put_u32(p, pcap->ts_sec);
+  p = put_u32(p, pcap->ts_usec);
+  p = put_u32(p, WIRE_RADIOTAP_SIZE + frame_len);
+  p = put_u32(p, WIRE_RADIOTAP_SIZE + pcap->orig_len);
+
+  // Radiotap: campos na ordem dos bits de present, cada um alinhado ao próprio tamanho
+  *p++ = 0;                                     // it_version
+  *p++ = 0;                                     // it_pad
+  p = put_u16(p, WIRE_RADIOTAP_SIZE);
+  p = put_u32(p, (1u << 0) | (1u << 1) | (1u << 3) | (1u << 5));  // TSFT, flags, canal, sinal
+  p = put_u32(p, pcap->rx_us);                  // TSFT (u64, offset 8)
+  p = put_u32(p, 0);
+  // Flags: FCS no fim do frame, só quando o frame veio inteiro (cortado, o fim são bytes do corpo)
+  *p++ = frame_len < pcap->orig_len ? 0x00 : 0x10;
+  *p++ = 0;                                     // alinhamento do canal
+  p = put_u16(p, pcap->freq_mhz);
+  p = put_u16(p, 0x0080);                       // canal de 2 GHz
+  *p++ = (uint8_t)pcap->rssi_dbm;
+
+  memcpy(p, frame, frame_len);
+  p += frame_len;
+  return p - out;
+}
+
+void wire_delta_init(wire_delta_t* delta, uint8_t ref_base) {
+  memset(delta, 0, sizeof(*delta));
+  delta->ref_base = ref_base;
+}
+
+size_t wire_encode_packet_delta(wire_delta_t* delta, uint8_t* out, size_t out_size,
+                                const wire_packet_header_t* header, const uint8_t* ies, uint16_t ies_len) {
+  // Byte alto do FNV: o mais misturado (a multiplicação só propaga para cima)
+  // e independente do bit baixo que escolheu o worker
+  uint32_t sa_hash = fnv1a_update(fnv1a_init(), header->addr2, 6);
+  uint8_t index = (sa_hash >> 24) % WIRE_DELTA_SLOTS;
+  wire_delta_slot_t* slot = &delta->slots[index];
+  uint32_t ies_hash = fnv1a_update(fnv1a_init(), ies, ies_len);
+
+  uint32_t seq_offset = header->pkt_seq - slot->key_seq;
+  uint32_t rx_offset = header->rx_us - slot->key_rx_us;
+  uint32_t dwell_offset = header->dwell_id - slot->key_dwell_id;
+  bool repeat = slot->valid && slot->deltas < WIRE_DELTA_KEYFRAME_INTERVAL &&
+                seq_offset <= 0xFFFF && dwell_offset <= 0xFFFF && rx_offset < WIRE_DELTA_KEYFRAME_US &&
+                slot->ies_len == ies_len && slot->ies_hash == ies_hash &&
+                slot->frame_ctrl == header->frame_ctrl && slot->duration == header->duration &&
+                slot->track_id == header->track_id &&
+                memcmp(slot->addr2, header->addr2, 6) == 0 && memcmp(slot->addr1, header->addr1, 6) == 0 &&
+                memcmp(slot->addr3, header->addr3, 6) == 0;
+
+  if (!repeat) {
+    wire_packet_header_t key = *header;
+    key.delta_ref = delta->ref_base + index;
+    size_t len = wire_encode_packet(out, out_size, &key, ies, ies_len);
+    if (len == 0) return 0;
+    slot->valid = true;
+    slot->deltas = 0;
+    slot->ies_len = ies_len;
+    slot->ies_hash = ies_hash;
+    slot->frame_ctrl = header->frame_ctrl;
+    slot->duration = header->duration;
+    memcpy(slot->addr1, header->addr1, 6);
+    memcpy(slot->addr2, header->addr2, 6);
+    memcpy(slot->addr3, header->addr3, 6);
+    slot->track_id = header->track_id;
+    slot->key_seq = header->pkt_seq;
+    slot->key_rx_us = header->rx_us;
+    slot->key_dwell_id = header->dwell_id;
+    delta->keyframes++;
+    return len;
+  }
+
+  if (out_size < WIRE_DELTA_RECORD_SIZE) return 0;
+  uint8_t* p = out;
+  *p++ = WIRE_RECORD_DELTA;
+  *p++ = WIRE_FORMAT_VERSION;
+  *p++ = delta->ref_base + index;
+  p = put_u16(p, (uint16_t)slot->key_seq);
+  p = put_u16(p, (uint16_t)seq_offset);
+  p = put_u32(p, rx_offset);
+  p = put_u16(p, (uint16_t)dwell_offset);
+  *p++ = header->channel;
+  *p++ = (uint8_t)header->rssi_dbm;
+  p = put_u16(p, header->seq_ctrl);
+  slot->deltas++;
+  delta->deltas++;
+  return p - out;
+}
+
+// Codificador COBS incremental (permite codificar registro + CRC sem cópia)
+typedef struct {
+  uint8_t* out;
+  uint8_t* end;
+  uint8_t* code_ptr;
+  uint8_t code;
+  bool overflow;
+} cobs_encoder_t;
+
+static void cobs_begin(cobs_encoder_t* enc, uint8_t* out, size_t out_size) {
+  enc->out = out + 1;
+  enc->end = out + out_size;
+  enc->code_ptr = out;
+  enc->code = 1;
+  enc->overflow = out_size == 0;
+}
+
+static void cobs_put(cobs_encoder_t* enc, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len && !enc->overflow; i++) {
+    if (data[i] != 0) {
+      if (enc->out >= enc->end) { enc->overflow = true; break; }
+      *enc->out++ = data[i];
+      enc->code++;
+    }
+    if (data[i] == 0 || enc->code == 0xFF) {
+      *enc->code_ptr = enc->code;
+      if (enc->out >= enc->end) { enc->overflow = true; break; }
+      enc->code_ptr = enc->out++;
+      enc->code = 1;
+    }
+  }
+}
+
+static size_t cobs_end(cobs_encoder_t* enc, uint8_t* out) {
+  if (enc->overflow) return 0;
+  *enc->code_ptr = enc->code;
+  return enc->out - out;
+}
+
+size_t wire_frame(const uint8_t* record, size_t record_len, uint8_t* out, size_t out_size) {
+  if (out_size < 2 || WIRE_FRAMED_SIZE(record_len) > out_size) return 0;
+
+  uint8_t crc_bytes[WIRE_CRC_SIZE];
+  put_u16(crc_bytes, wire_crc16(record, record_len));
+
+  // Delimitador inicial separa o registro de qualquer texto anterior
+  out[0] = 0x00;
+
+  cobs_encoder_t enc;
+  cobs_begin(&enc, out + 1, out_size - 2);
+  cobs_put(&enc, record, record_len);
+  cobs_put(&enc, crc_bytes, WIRE_CRC_SIZE);
+  size_t encoded = cobs_end(&enc, out + 1);
+  if (encoded == 0) return 0;
+
+  out[1 + encoded] = 0x00;
+  return encoded + 2;
+}
@@ -0,0 +1,111 @@
+#ifndef PROBE_CORPUS_H
+#define PROBE_CORPUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Corpus de probe requests para os testes e o benchmark (test/test_benchmark).
+// Frames completos como entregues pelo driver (cabeçalho de 24 bytes, IEs e
+// FCS), no layout dos dispositivos indicados; MACs e SSIDs são fictícios.
+// Gerado uma vez e mantido à mão: novos casos entram no fim de probe_corpus[].
+
+typedef struct {
+  const char* name;
+  const uint8_t* frame;
+  uint16_t len;              // inclui o FCS (como rx_ctrl.sig_len)
+  int8_t rssi;
+  uint8_t channel;
+} probe_corpus_frame_t;
+
+// iphone_ios17_wildcard
+static const uint8_t corpus_iphone_ios17_wildcard[148] = {
+  0x40, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xd2, 0xb8, 0xc3, 0xa1, 0x4e, 0x07,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x10, 0x6a, 0x00, 0x00, 0x01, 0x04, 0x02, 0x04, 0x0b, 0x16,
+  0x32, 0x08, 0x0c, 0x12, 0x18, 0x24, 0x30, 0x48, 0x6c, 0x60, 0x03, 0x01, 0x06, 0x2d, 0x1a, 0x2d,
+  0x40, 0x1b, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x08, 0x00, 0x00, 0x08, 0x04, 0x00,
+  0x00, 0x00, 0x40, 0xbf, 0x0c, 0xb2, 0x79, 0x90, 0x33, 0xfa, 0xff, 0x0c, 0x03, 0xfa, 0xff, 0x0c,
+  0x03, 0xff, 0x16, 0x23, 0x01, 0x00, 0x08, 0x00, 0x12, 0x00, 0x40, 0x20, 0x42, 0x0a, 0xc0, 0x0f,
+  0x00, 0x00, 0x00, 0xc0, 0x00, 0xfa, 0xff, 0xfa, 0xff, 0xdd, 0x0a, 0x00, 0x17, 0xf2, 0x0a, 0x00,
+  0x01, 0x04, 0x00, 0x00, 0x00, 0xdd, 0x09, 0x00, 0x10, 0x18, 0x02, 0x00, 0x00, 0x0c, 0x00, 0x00,
+  0x5a, 0xc3, 0x1e, 0x97,
+};
+
+// pixel_android14_directed
+static const uint8_t corpus_pixel_android14_directed[154] = {
+  0x40, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7a, 0x3f, 0x1c, 0x90, 0xb2, 0xe5,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x30, 0x0c, 0x00, 0x0c, 0x43, 0x61, 0x73, 0x61, 0x53, 0x69,
+  0x6c, 0x76, 0x61, 0x5f, 0x35, 0x47, 0x01, 0x08, 0x02, 0x04, 0x0b, 0x16, 0x0c, 0x12, 0x18, 0x24,
+  0x32, 0x04, 0x30, 0x48, 0x60, 0x6c, 0x03, 0x01, 0x01, 0x2d, 0x1a, 0xef, 0x01, 0x17, 0xff, 0xff,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x08, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x40, 0xbf,
+  0x0c, 0xb2, 0xf9, 0x83, 0x0f, 0xfa, 0xff, 0x00, 0x00, 0xfa, 0xff, 0x00, 0x20, 0xff, 0x16, 0x23,
+  0x0d, 0x00, 0x08, 0x12, 0x00, 0x10, 0x22, 0x3c, 0x02, 0xc0, 0x6f, 0x5b, 0x83, 0x80, 0x18, 0x00,
+  0x0c, 0xfa, 0xff, 0xfa, 0xff, 0xdd, 0x07, 0x50, 0x6f, 0x9a, 0x16, 0x03, 0x01, 0x03, 0xdd, 0x06,
+  0x00, 0x50, 0xf2, 0x08, 0x00, 0x11, 0x5a, 0xc3, 0x1e, 0x97,
+};
+
+// intel_ax201_wps
+static const uint8_t corpus_intel_ax201_wps[153] = {
+  0x40, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x40, 0xa3, 0xcc, 0xd4, 0x19, 0x02,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x10, 0x21, 0x00, 0x00, 0x01, 0x08, 0x02, 0x04, 0x0b, 0x16,
+  0x0c, 0x12, 0x18, 0x24, 0x32, 0x04, 0x30, 0x48, 0x60, 0x6c, 0x03, 0x01, 0x0b, 0x2d, 0x1a, 0x6f,
+  0x01, 0x17, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x08, 0x04, 0x00, 0x08, 0x00, 0x00,
+  0x00, 0x00, 0x40, 0xdd, 0x28, 0x00, 0x50, 0xf2, 0x04, 0x10, 0x4a, 0x00, 0x01, 0x10, 0x10, 0x3a,
+  0x00, 0x01, 0x00, 0x10, 0x08, 0x00, 0x02, 0x31, 0x48, 0x10, 0x47, 0x00, 0x10, 0x9c, 0xc0, 0x7a,
+  0x39, 0x3f, 0x6b, 0x5e, 0x29, 0xbd, 0x31, 0x72, 0xfa, 0xcf, 0x17, 0x3e, 0x5c, 0xff, 0x16, 0x23,
+  0x01, 0x03, 0x08, 0x12, 0x00, 0x00, 0x44, 0x30, 0x02, 0x00, 0x3f, 0x02, 0x00, 0xc0, 0x83, 0x18,
+  0x00, 0xfa, 0xff, 0xfa, 0xff, 0x5a, 0xc3, 0x1e, 0x97,
+};
+
+// esp8266_minimal
+static const uint8_t corpus_esp8266_minimal[55] = {
+  0x40, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x5c, 0xcf, 0x7f, 0x1a, 0x2b, 0x3c,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x10, 0x00, 0x00, 0x09, 0x69, 0x6f, 0x74, 0x2d, 0x73, 0x65,
+  0x74, 0x75, 0x70, 0x01, 0x08, 0x82, 0x84, 0x8b, 0x96, 0x0c, 0x12, 0x18, 0x24, 0x32, 0x04, 0x30,
+  0x48, 0x60, 0x6c, 0x5a, 0xc3, 0x1e, 0x97,
+};
+
+// samsung_s24_eht
+static const uint8_t corpus_samsung_s24_eht[149] = {
+  0x40, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xaa, 0x5e, 0x01, 0xc0, 0xff, 0xee,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0, 0x7f, 0x00, 0x00, 0x01, 0x08, 0x02, 0x04, 0x0b, 0x16,
+  0x0c, 0x12, 0x18, 0x24, 0x32, 0x04, 0x30, 0x48, 0x60, 0x6c, 0x03, 0x01, 0x06, 0x2d, 0x1a, 0xef,
+  0x09, 0x17, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x0a, 0x05, 0x00, 0x0a, 0x82, 0x01,
+  0x40, 0x00, 0x40, 0x01, 0x20, 0xbf, 0x0c, 0xb2, 0x79, 0xc3, 0x0f, 0xfa, 0xff, 0x00, 0x00, 0xfa,
+  0xff, 0x00, 0x00, 0xff, 0x16, 0x23, 0x0d, 0x00, 0x08, 0x12, 0x00, 0x10, 0x26, 0x3c, 0x02, 0xc0,
+  0x6f, 0x5b, 0x83, 0x80, 0x18, 0x00, 0x0c, 0xfa, 0xff, 0xfa, 0xff, 0xff, 0x0c, 0x6c, 0x00, 0x00,
+  0xe2, 0xff, 0xdb, 0xff, 0x18, 0x00, 0x24, 0x28, 0x10, 0xdd, 0x06, 0x00, 0x00, 0xf0, 0x22, 0x03,
+  0x01, 0x5a, 0xc3, 0x1e, 0x97,
+};
+
+// ssid_escapes
+static const uint8_t corpus_ssid_escapes[51] = {
+  0x40, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0x11, 0x22, 0x33, 0x44, 0xab,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x50, 0x15, 0x00, 0x0f, 0x43, 0x61, 0x66, 0xc3, 0xa9, 0x20,
+  0x22, 0x4c, 0x6f, 0x62, 0x62, 0x79, 0x22, 0x01, 0x5c, 0x01, 0x04, 0x82, 0x84, 0x8b, 0x96, 0x5a,
+  0xc3, 0x1e, 0x97,
+};
+
+// malformed_overrun
+static const uint8_t corpus_malformed_overrun[35] = {
+  0x40, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x02, 0xaa, 0xbb, 0xcc, 0xdd, 0xee,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x30, 0x33, 0x00, 0x01, 0x78, 0x01, 0x08, 0x82, 0x84, 0x5a,
+  0xc3, 0x1e, 0x97,
+};
+
+static const probe_corpus_frame_t probe_corpus[] = {
+  {"iphone_ios17_wildcard", corpus_iphone_ios17_wildcard, sizeof(corpus_iphone_ios17_wildcard), -61, 6},
+  {"pixel_android14_directed", corpus_pixel_android14_directed, sizeof(corpus_pixel_android14_directed), -48, 1},
+  {"intel_ax201_wps", corpus_intel_ax201_wps, sizeof(corpus_intel_ax201_wps), -70, 11},
+  {"esp8266_minimal", corpus_esp8266_minimal, sizeof(corpus_esp8266_minimal), -83, 1},
+  {"samsung_s24_eht", corpus_samsung_s24_eht, sizeof(corpus_samsung_s24_eht), -55, 6},
+  {"ssid_escapes", corpus_ssid_escapes, sizeof(corpus_ssid_escapes), -66, 11},
+  {"malformed_overrun", corpus_malformed_overrun, sizeof(corpus_malformed_overrun), -90, 3},
+};
+
+#define PROBE_CORPUS_COUNT (sizeof(probe_corpus) / sizeof(probe_corpus[0]))
+
+#endif // PROBE_CORPUS_H
@@ -0,0 +1,318 @@
+// Benchmark do caminho de captura por estágio: ie_parse(), parse_probe_request(),
+// format_capture_json(), encode_capture_binary() e encode_capture_binary_delta()
+// sobre o corpus de frames.
+//
+//   pio test -e native -f test_benchmark -v
+//   PROBE_CORPUS_FILE=capture.log pio test -e native -f test_benchmark -v
+//   pio test -e esp32-s3 -f test_benchmark -v      (também esp32-32u)
+//
+// Cada estágio reporta frames/s, ns/frame e alocações/frame (no alvo também
+// ciclos de CPU/frame). Alocações no caminho de captura falham o teste; os
+// tempos são informativos (compare com a saída da versão anterior).
+//
+// No native, PROBE_CORPUS_FILE aponta para uma captura em OUTPUT_FORMAT_BINARY
+// (serial em modo raw ou LOG DUMP): os frames são remontados a partir dos
+// registros de pacote (cabeçalho 802.11 + IEs) e substituem o corpus embutido.
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "probe_record.h"
+#include "wire_format.h"
+#include "../corpus/probe_corpus.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_timer.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_cpu.h>
+#endif
+#define BENCH_ITERATIONS 200
+#define BENCH_MAX_FRAMES PROBE_CORPUS_COUNT
+#else
+#include <chrono>
+#define BENCH_ITERATIONS 2000
+#define BENCH_MAX_FRAMES 4096
+#endif
+
+#define BENCH_SLOT_SIZE 512
+
+typedef struct {
+  uint16_t len;
+  int8_t rssi;
+  uint8_t channel;
+  uint8_t data[BENCH_SLOT_SIZE];
+} bench_frame_t;
+
+static bench_frame_t frames[BENCH_MAX_FRAMES];
+static capture_data_t captures[BENCH_MAX_FRAMES];
+static size_t frame_count = 0;
+static char json_out[4096];
+static uint8_t binary_out[WIRE_FRAMED_SIZE(WIRE_PACKET_HEADER_SIZE + BENCH_SLOT_SIZE)];
+static volatile size_t sink = 0;  // impede que o compilador descarte o trabalho
+
+// Alocações: operator new em todos os alvos; malloc/calloc/realloc apenas com glibc
+static volatile uint32_t alloc_count = 0;
+
+void* operator new(size_t n) {
+  alloc_count++;
+  void* p = malloc(n);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t n) {
+  alloc_count++;
+  void* p = malloc(n);
+  if (p == NULL) throw std::bad_alloc();
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#if defined(__GLIBC__) && !defined(ARDUINO)
+extern "C" void* __libc_malloc(size_t n);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* p, size_t n);
+extern "C" void* malloc(size_t n) {
+  alloc_count++;
+  return __libc_malloc(n);
+}
+extern "C" void* calloc(size_t n, size_t size) {
+  alloc_count++;
+  return __libc_calloc(n, size);
+}
+extern "C" void* realloc(void* p, size_t n) {
+  alloc_count++;
+  return __libc_realloc(p, n);
+}
+#endif
+
+static uint64_t bench_now_ns() {
+#ifdef ARDUINO
+  return (uint64_t)esp_timer_get_time() * 1000;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#ifdef ARDUINO
+static uint32_t bench_cycles() {
+#if ESP_IDF_VERSION_MAJOR >= 5
+  return (uint32_t)esp_cpu_get_cycle_count();
+#else
+  return ESP.getCycleCount();
+#endif
+}
+#endif
+
+static void add_frame(const uint8_t* data, size_t len, int8_t rssi, uint8_t channel) {
+  if (frame_count >= BENCH_MAX_FRAMES) return;
+  bench_frame_t* f = &frames[frame_count++];
+  if (len > BENCH_SLOT_SIZE) len = BENCH_SLOT_SIZE;  // como o slot do frame ring
+  memcpy(f->data, data, len);
+  f->len = len;
+  f->rssi = rssi;
+  f->channel = channel;
+}
+
+#ifndef ARDUINO
+static uint16_t get_u16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+// Registro de pacote (versão >= 1) -> frame como entregue pelo driver
+static void add_wire_packet(const uint8_t* r, size_t len) {
+  if (len < 2 || r[0] != WIRE_RECORD_PACKET || r[1] < 1 || r[1] > WIRE_FORMAT_VERSION) return;
+  // fp_hash (v2), dwell_id (v3), rx_us (v4), delta_ref (v5), track_id (v6); registros delta são ignorados
+  size_t header = r[1] >= 6 ? WIRE_PACKET_HEADER_SIZE : r[1] == 5 ? WIRE_PACKET_HEADER_SIZE - 4 : 40 + 4 * (r[1] - 1);
+  if (len < header) return;
+  uint16_t ies_len = get_u16(r + header - 2);
+  if (header + ies_len > len || WIFI_MGMT_HEADER_LEN + ies_len + WIFI_FCS_LEN > BENCH_SLOT_SIZE) return;
+
+  uint8_t frame[BENCH_SLOT_SIZE];
+  memcpy(frame, r + 14, 4);        // frame_ctrl, duration
+  memcpy(frame + 4, r + 18, 18);   // addr1..addr3
+  memcpy(frame + 22, r + 36, 2);   // seq_ctrl
+  memcpy(frame + WIFI_MGMT_HEADER_LEN, r + header, ies_len);
+  memset(frame + WIFI_MGMT_HEADER_LEN + ies_len, 0, WIFI_FCS_LEN);
+  add_frame(frame, WIFI_MGMT_HEADER_LEN + ies_len + WIFI_FCS_LEN, (int8_t)r[13], r[12]);
+}
+
+// Quadros COBS entre delimitadores 0x00; texto intercalado e CRC inválido são ignorados
+static void load_corpus_file(const char* path) {
+  FILE* f = fopen(path, "rb");
+  TEST_ASSERT_NOT_NULL_MESSAGE(f, path);
+  static uint8_t raw[2048];
+  static uint8_t record[2048];
+  size_t raw_len = 0;
+  int c;
+  while ((c = fgetc(f)) != EOF) {
+    if (c != 0) {
+      if (raw_len < sizeof(raw)) raw[raw_len++] = (uint8_t)c;
+      continue;
+    }
+    size_t n = 0;
+    size_t i = 0;
+    while (i < raw_len) {
+      uint8_t code = raw[i++];
+      if (code == 0) break;
+      for (uint8_t k = 1; k < code && i < raw_len; k++) record[n++] = raw[i++];
+      if (code != 0xFF && i < raw_len) record[n++] = 0;
+    }
+    raw_len = 0;
+    if (n <= WIRE_CRC_SIZE) continue;
+    n -= WIRE_CRC_SIZE;
+    if (wire_crc16(record, n) != get_u16(record + n)) continue;
+    add_wire_packet(record, n);
+  }
+  fclose(f);
+}
+#endif
+
+static void load_corpus() {
+  frame_count = 0;
+#ifndef ARDUINO
+  const char* path = getenv("PROBE_CORPUS_FILE");
+  if (path != NULL && path[0] != '\0') {
+    load_corpus_file(path);
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, frame_count, "nenhum registro de pacote no arquivo");
+    return;
+  }
+#endif
+  for (size_t i = 0; i < PROBE_CORPUS_COUNT; i++) {
+    add_frame(probe_corpus[i].frame, probe_corpus[i].len, probe_corpus[i].rssi, probe_corpus[i].channel);
+  }
+}
+
+static void prepare_captures() {
+  for (size_t i = 0; i < frame_count; i++) {
+    const bench_frame_t* f = &frames[i];
+    capture_data_t& c = captures[i];
+    parse_probe_request(f->data, f->len, true, f->rssi, f->channel, c);
+    c.capture_id = "6553f100-9abc-5678-4553-6553f1009abc";
+    c.scanner_id = "esp32-bench";
+    c.firmware = "bench";
+    c.scanner_tag = 0x9abc;
+    c.capture_epoch_s = 1700000000 + i / 100;
+    c.capture_ms = i % 1000;
+    c.packet.pkt_seq = i;
+    c.packet.radio.rx_us = i * 1000;
+  }
+}
+
+typedef void (*bench_stage_fn)(size_t index);
+
+static void stage_ie_parse(size_t i) {
+  static ie_list_t list;
+  const bench_frame_t* f = &frames[i];
+  ie_parse(&list, f->data, WIFI_MGMT_HEADER_LEN, f->len - WIFI_FCS_LEN);
+  sink += list.fp_hash;
+}
+
+static void stage_parse(size_t i) {
+  static capture_data_t capture;
+  const bench_frame_t* f = &frames[i];
+  sink += parse_probe_request(f->data, f->len, true, f->rssi, f->channel, capture);
+}
+
+static void stage_json(size_t i) {
+  sink += format_capture_json(captures[i], json_out, sizeof(json_out));
+}
+
+static void stage_binary(size_t i) {
+  sink += encode_capture_binary(captures[i], binary_out, sizeof(binary_out));
+}
+
+// Cada passada repete o corpus: mistura de deltas e keyframes periódicos
+static wire_delta_t delta;
+static void stage_binary_delta(size_t i) {
+  sink += encode_capture_binary_delta(captures[i], &delta, binary_out, sizeof(binary_out));
+}
+
+static void run_stage(const char* name, bench_stage_fn fn) {
+  // Aquecimento (caches, tabela OUI, cache de segundos do ISO8601)
+  for (size_t i = 0; i < frame_count; i++) fn(i);
+
+  uint32_t allocs_before = alloc_count;
+#ifdef ARDUINO
+  uint32_t cycles_before = bench_cycles();
+#endif
+  uint64_t start_ns = bench_now_ns();
+  for (uint32_t it = 0; it < BENCH_ITERATIONS; it++) {
+    for (size_t i = 0; i < frame_count; i++) fn(i);
+  }
+  uint64_t elapsed_ns = bench_now_ns() - start_ns;
+#ifdef ARDUINO
+  uint32_t cycles = bench_cycles() - cycles_before;
+#endif
+  uint32_t allocs = alloc_count - allocs_before;
+
+  double total = (double)BENCH_ITERATIONS * frame_count;
+  double ns_per_frame = elapsed_ns / total;
+  char line[160];
+#ifdef ARDUINO
+  snprintf(line, sizeof(line), "bench %-22s %8.0f frames/s %8.1f ns/frame %7.1f cycles/frame %.2f allocs/frame",
+           name, 1e9 / ns_per_frame, ns_per_frame, cycles / total, allocs / total);
+#else
+  snprintf(line, sizeof(line), "bench %-22s %9.0f frames/s %8.1f ns/frame %.2f allocs/frame",
+           name, 1e9 / ns_per_frame, ns_per_frame, allocs / total);
+#endif
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, allocs, name);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_bench_ie_parse() {
+  run_stage("ie_parse", stage_ie_parse);
+}
+
+void test_bench_parse_probe_request() {
+  run_stage("parse_probe_request", stage_parse);
+}
+
+void test_bench_format_capture_json() {
+  run_stage("format_capture_json", stage_json);
+}
+
+void test_bench_encode_capture_binary() {
+  run_stage("encode_capture_binary", stage_binary);
+}
+
+void test_bench_encode_capture_binary_delta() {
+  wire_delta_init(&delta, 0);
+  run_stage("encode_binary_delta", stage_binary_delta);
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  load_corpus();
+  prepare_captures();
+  char line[64];
+  snprintf(line, sizeof(line), "corpus: %u frames x %u iterations", (unsigned)frame_count, BENCH_ITERATIONS);
+  TEST_MESSAGE(line);
+  RUN_TEST(test_bench_ie_parse);
+  RUN_TEST(test_bench_parse_probe_request);
+  RUN_TEST(test_bench_format_capture_json);
+  RUN_TEST(test_bench_encode_capture_binary);
+  RUN_TEST(test_bench_encode_capture_binary_delta);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
@@ -0,0 +1,184 @@
+#include <unity.h>
+#include <string.h>
+#include "flash_log.h"
+
+// Flash NOR em RAM: erase leva o setor a 0xFF, gravação só limpa bits
+#define SECTORS 4
+#define PAGES (SECTORS * FLASH_LOG_PAGES_PER_SECTOR)
+
+static uint8_t flash[SECTORS * FLASH_LOG_SECTOR_SIZE];
+static uint32_t erases;
+static bool fail_erase;
+
+static bool ram_read(void*, uint32_t offset, void* out, size_t len) {
+  memcpy(out, flash + offset, len);
+  return true;
+}
+
+static bool ram_write(void*, uint32_t offset, const void* data, size_t len) {
+  const uint8_t* p = (const uint8_t*)data;
+  for (size_t i = 0; i < len; i++) flash[offset + i] &= p[i];
+  return true;
+}
+
+static bool ram_erase(void*, uint32_t offset) {
+  if (fail_erase) return false;
+  memset(flash + offset, 0xFF, FLASH_LOG_SECTOR_SIZE);
+  erases++;
+  return true;
+}
+
+static const flash_log_io_t io = {NULL, ram_read, ram_write, ram_erase, sizeof(flash)};
+static flash_log_t log_;
+
+// Payload de tamanho variável, marcado com n
+static uint16_t make_payload(uint8_t* out, uint32_t n) {
+  uint16_t len = 1 + n % FLASH_LOG_PAGE_PAYLOAD;
+  memset(out, (uint8_t)n, len);
+  memcpy(out, &n, len < 4 ? len : 4);
+  return len;
+}
+
+static void append_pages(uint32_t first, uint32_t count) {
+  uint8_t payload[FLASH_LOG_PAGE_PAYLOAD];
+  for (uint32_t n = first; n < first + count; n++) {
+    uint16_t len = make_payload(payload, n);
+    TEST_ASSERT_TRUE(flash_log_append(&log_, payload, len));
+  }
+}
+
+// Lê tudo pelo cursor e confere que os payloads são first, first + 1, ...
+static uint32_t read_all(uint32_t first) {
+  flash_log_cursor_t cursor;
+  uint8_t payload[FLASH_LOG_PAGE_PAYLOAD];
+  uint8_t expected[FLASH_LOG_PAGE_PAYLOAD];
+  uint32_t count = 0;
+  int len;
+  flash_log_cursor_begin(&log_, &cursor);
+  while ((len = flash_log_read_next(&log_, &cursor, payload)) > 0) {
+    uint16_t expected_len = make_payload(expected, first + count);
+    TEST_ASSERT_EQUAL(expected_len, len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, payload, len);
+    count++;
+  }
+  return count;
+}
+
+void setUp() {
+  memset(flash, 0xFF, sizeof(flash));
+  erases = 0;
+  fail_erase = false;
+  TEST_ASSERT_TRUE(flash_log_init(&log_, &io, 0));
+}
+
+void tearDown() {}
+
+void test_append_and_recover() {
+  TEST_ASSERT_EQUAL_UINT32(0, flash_log_used_pages(&log_));
+  TEST_ASSERT_EQUAL_UINT32(0, read_all(0));
+
+  // A primeira gravação apaga o setor 0
+  append_pages(0, 20);
+  TEST_ASSERT_EQUAL_UINT32(2, erases);
+  TEST_ASSERT_EQUAL_UINT32(20, log_.pages_written);
+  TEST_ASSERT_EQUAL_UINT32(20, flash_log_used_pages(&log_));
+  TEST_ASSERT_EQUAL_UINT32(20, read_all(0));
+
+  // Reboot: cabeça e sequência recuperadas da flash, sem novo erase no setor da cabeça
+  TEST_ASSERT_TRUE(flash_log_init(&log_, &io, 0));
+  TEST_ASSERT_EQUAL_UINT32(20, log_.head);
+  TEST_ASSERT_EQUAL_UINT32(20, log_.next_seq);
+  TEST_ASSERT_TRUE(log_.head_erased);
+  append_pages(20, 5);
+  TEST_ASSERT_EQUAL_UINT32(0, log_.sector_erases);
+  TEST_ASSERT_EQUAL_UINT32(25, read_all(0));
+}
+
+void test_wrap_overwrites_oldest_sector() {
+  // 70 páginas em 64: a volta apaga o setor 0 (seq 0..15)
+  append_pages(0, PAGES + 6);
+  TEST_ASSERT_EQUAL_UINT32(6, log_.head);
+  TEST_ASSERT_EQUAL_UINT32(FLASH_LOG_PAGES_PER_SECTOR, log_.oldest_seq);
+  TEST_ASSERT_EQUAL_UINT32(PAGES + 6 - FLASH_LOG_PAGES_PER_SECTOR, flash_log_used_pages(&log_));
+  TEST_ASSERT_EQUAL_UINT32(PAGES + 6 - FLASH_LOG_PAGES_PER_SECTOR, read_all(FLASH_LOG_PAGES_PER_SECTOR));
+
+  // A recuperação acha a cabeça pelo maior seq, não pela posição
+  TEST_ASSERT_TRUE(flash_log_init(&log_, &io, 0));
+  TEST_ASSERT_EQUAL_UINT32(6, log_.head);
+  TEST_ASSERT_EQUAL_UINT32(PAGES + 6, log_.next_seq);
+  TEST_ASSERT_EQUAL_UINT32(FLASH_LOG_PAGES_PER_SECTOR, log_.oldest_seq);
+  TEST_ASSERT_EQUAL_UINT32(PAGES + 6 - FLASH_LOG_PAGES_PER_SECTOR, read_all(FLASH_LOG_PAGES_PER_SECTOR));
+}
+
+void test_interrupted_write_skips_to_next_sector() {
+  append_pages(0, 5);
+  // Gravação da página 5 cortada no meio: nem apagada nem com CRC válido
+  memset(flash + 5 * FLASH_LOG_PAGE_SIZE, 0x00, FLASH_LOG_PAGE_SIZE / 2);
+
+  TEST_ASSERT_TRUE(flash_log_init(&log_, &io, 0));
+  TEST_ASSERT_EQUAL_UINT32(FLASH_LOG_PAGES_PER_SECTOR, log_.head);
+  TEST_ASSERT_EQUAL_UINT32(5, log_.next_seq);
+  TEST_ASSERT_FALSE(log_.head_erased);
+
+  append_pages(5, 1);
+  TEST_ASSERT_EQUAL_UINT32(1, log_.sector_erases);
+  TEST_ASSERT_EQUAL_UINT32(6, read_all(0));
+}
+
+void test_clear_is_logical() {
+  append_pages(0, 10);
+  uint32_t base = flash_log_clear(&log_);
+  TEST_ASSERT_EQUAL_UINT32(10, base);
+  TEST_ASSERT_EQUAL_UINT32(0, flash_log_used_pages(&log_));
+  TEST_ASSERT_EQUAL_UINT32(0, read_all(0));
+
+  // Com o base_seq persistido, o reboot não traz as páginas antigas de volta
+  TEST_ASSERT_TRUE(flash_log_init(&log_, &io, base));
+  TEST_ASSERT_EQUAL_UINT32(0, read_all(0));
+  append_pages(10, 3);
+  TEST_ASSERT_EQUAL_UINT32(3, flash_log_used_pages(&log_));
+  TEST_ASSERT_EQUAL_UINT32(3, read_all(10));
+}
+
+void test_erase_failure_and_limits() {
+  uint8_t payload[FLASH_LOG_PAGE_PAYLOAD + 1];
+  memset(payload, 0xA5, sizeof(payload));
+  TEST_ASSERT_FALSE(flash_log_append(&log_, payload, FLASH_LOG_PAGE_PAYLOAD + 1));
+
+  fail_erase = true;
+  TEST_ASSERT_FALSE(flash_log_append(&log_, payload, 16));
+  TEST_ASSERT_EQUAL_UINT32(1, log_.write_errors);
+  TEST_ASSERT_EQUAL_UINT32(0, log_.next_seq);
+
+  fail_erase = false;
+  TEST_ASSERT_TRUE(flash_log_append(&log_, payload, FLASH_LOG_PAGE_PAYLOAD));
+  TEST_ASSERT_EQUAL_UINT32(1, flash_log_used_pages(&log_));
+
+  // Região menor que um setor não tem páginas
+  flash_log_io_t tiny = io;
+  tiny.size = FLASH_LOG_SECTOR_SIZE - 1;
+  TEST_ASSERT_FALSE(flash_log_init(&log_, &tiny, 0));
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_append_and_recover);
+  RUN_TEST(test_wrap_overwrites_oldest_sector);
+  RUN_TEST(test_interrupted_write_skips_to_next_sector);
+  RUN_TEST(test_clear_is_logical);
+  RUN_TEST(test_erase_failure_and_limits);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
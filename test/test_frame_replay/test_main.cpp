@@ -0,0 +1,139 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "frame_replay.h"
+#include "../corpus/probe_corpus.h"
+
+static replay_frame_t frames[PROBE_CORPUS_COUNT];
+static replay_source_t src;
+static uint8_t out[512];
+static uint8_t pool[256];
+static replay_store_t store;
+
+void setUp() {
+  for (size_t i = 0; i < PROBE_CORPUS_COUNT; i++) {
+    frames[i].frame = probe_corpus[i].frame;
+    frames[i].len = probe_corpus[i].len;
+    frames[i].rssi = probe_corpus[i].rssi;
+  }
+  replay_store_init(&store, pool, sizeof(pool));
+}
+
+void tearDown() {}
+
+void test_population_rewrites_sa_and_seq() {
+  replay_source_init(&src, frames, 2, 3);
+  uint16_t len;
+  for (uint32_t n = 0; n < 6; n++) {
+    uint32_t device = n % 3;
+    const replay_frame_t* f = replay_source_next(&src, out, sizeof(out), &len);
+    TEST_ASSERT_EQUAL_PTR(&frames[device % 2], f);
+    TEST_ASSERT_EQUAL_UINT16(f->len, len);
+
+    // OUI e bit de randomização preservados, 3 últimos bytes xor (device + 1)
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(f->frame + 10, out + 10, 3);
+    TEST_ASSERT_EQUAL_HEX8(f->frame[13], out[13]);
+    TEST_ASSERT_EQUAL_HEX8(f->frame[14], out[14]);
+    TEST_ASSERT_EQUAL_HEX8(f->frame[15] ^ (device + 1), out[15]);
+
+    uint16_t seq_ctrl = out[22] | (out[23] << 8);
+    TEST_ASSERT_EQUAL_UINT16(n, seq_ctrl >> 4);
+    TEST_ASSERT_EQUAL_HEX8(f->frame[22] & 0x0F, seq_ctrl & 0x0F);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(f->frame + 24, out + 24, len - 24);
+  }
+  TEST_ASSERT_EQUAL_UINT32(6, src.generated);
+}
+
+void test_devices_zero_keeps_sa() {
+  replay_source_init(&src, frames, PROBE_CORPUS_COUNT, 0);
+  uint16_t len;
+  for (size_t n = 0; n < PROBE_CORPUS_COUNT + 1; n++) {
+    const replay_frame_t* f = replay_source_next(&src, out, sizeof(out), &len);
+    TEST_ASSERT_EQUAL_PTR(&frames[n % PROBE_CORPUS_COUNT], f);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(f->frame + 10, out + 10, 6);
+  }
+}
+
+void test_source_rejects_oversized_and_empty() {
+  replay_source_init(&src, frames, 1, 1);
+  uint16_t len;
+  TEST_ASSERT_NULL(replay_source_next(&src, out, frames[0].len - 1, &len));
+  TEST_ASSERT_NOT_NULL(replay_source_next(&src, out, frames[0].len, &len));
+  replay_source_init(&src, frames, 0, 1);
+  TEST_ASSERT_NULL(replay_source_next(&src, out, sizeof(out), &len));
+}
+
+void test_due_pacing() {
+  TEST_ASSERT_EQUAL_UINT32(0, replay_due(2000, 0, 0));
+  TEST_ASSERT_EQUAL_UINT32(2, replay_due(2000, 1000, 0));
+  TEST_ASSERT_EQUAL_UINT32(1, replay_due(2000, 1500, 2));
+  TEST_ASSERT_EQUAL_UINT32(0, replay_due(2000, 1000, 5));  // adiantado
+  // Uma hora a 64k frames/s: sem overflow no produto
+  TEST_ASSERT_EQUAL_UINT32(230400000u - 10, replay_due(64000, 3600000000ull, 10));
+}
+
+void test_store_hex_lines_and_commit() {
+  TEST_ASSERT_TRUE(replay_store_append_hex(&store, "400000000102030405"));
+  TEST_ASSERT_TRUE(replay_store_append_hex(&store, "A0B0c0d0e0f0"));
+  TEST_ASSERT_EQUAL(15, store.pending_len);
+  TEST_ASSERT_FALSE(replay_store_commit(&store, -60));  // curto demais
+  TEST_ASSERT_EQUAL(0, store.count);
+  TEST_ASSERT_EQUAL(0, store.pending_len);
+
+  const probe_corpus_frame_t* c = &probe_corpus[3];
+  char hex[3];
+  for (uint16_t i = 0; i < c->len; i++) {
+    snprintf(hex, sizeof(hex), "%02x", c->frame[i]);
+    TEST_ASSERT_TRUE(replay_store_append_hex(&store, hex));
+  }
+  TEST_ASSERT_TRUE(replay_store_commit(&store, -70));
+  TEST_ASSERT_EQUAL(1, store.count);
+  TEST_ASSERT_EQUAL_UINT16(c->len, store.frames[0].len);
+  TEST_ASSERT_EQUAL_INT8(-70, store.frames[0].rssi);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(c->frame, store.frames[0].frame, c->len);
+}
+
+void test_store_rejects_bad_hex_and_full_pool() {
+  TEST_ASSERT_TRUE(replay_store_append_hex(&store, "4000"));
+  TEST_ASSERT_FALSE(replay_store_append_hex(&store, "abc"));  // dígitos ímpares
+  TEST_ASSERT_EQUAL(0, store.pending_len);
+  TEST_ASSERT_FALSE(replay_store_append_hex(&store, "zz"));
+
+  char hex[2 * sizeof(pool) + 3];
+  memset(hex, 'a', sizeof(hex) - 1);
+  hex[sizeof(hex) - 1] = '\0';
+  TEST_ASSERT_FALSE(replay_store_append_hex(&store, hex));
+  hex[2 * sizeof(pool)] = '\0';
+  TEST_ASSERT_TRUE(replay_store_append_hex(&store, hex));
+  TEST_ASSERT_TRUE(replay_store_commit(&store, -50));
+  TEST_ASSERT_EQUAL(sizeof(pool), store.pool_used);
+  TEST_ASSERT_FALSE(replay_store_append_hex(&store, "00"));
+
+  replay_store_clear(&store);
+  TEST_ASSERT_EQUAL(0, store.count);
+  TEST_ASSERT_TRUE(replay_store_append_hex(&store, "00"));
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_population_rewrites_sa_and_seq);
+  RUN_TEST(test_devices_zero_keeps_sa);
+  RUN_TEST(test_source_rejects_oversized_and_empty);
+  RUN_TEST(test_due_pacing);
+  RUN_TEST(test_store_hex_lines_and_commit);
+  RUN_TEST(test_store_rejects_bad_hex_and_full_pool);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <string.h>
+#include "health_monitor.h"
+
+static health_monitor_t monitor;
+
+// Amostra saudável: heap folgado, ring vazio, driver entregando frames
+static health_sample_t healthy(uint32_t rx_frames) {
+  health_sample_t s;
+  s.free_heap = HEALTH_MIN_FREE_HEAP * 4;
+  s.largest_block = HEALTH_MIN_LARGEST_BLOCK * 4;
+  s.ring_occupancy = 0;
+  s.ring_tail = 0;
+  s.rx_frames = rx_frames;
+  return s;
+}
+
+void setUp() {
+  health_monitor_init(&monitor, 0);
+}
+
+void tearDown() {}
+
+void test_healthy_never_trips() {
+  for (uint32_t i = 1; i <= 100; i++) {
+    health_sample_t s = healthy(i);
+    TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, i * HEALTH_CHECK_INTERVAL_MS));
+  }
+  TEST_ASSERT_EQUAL_UINT32(100, monitor.checks);
+  TEST_ASSERT_EQUAL_UINT32(HEALTH_MIN_FREE_HEAP * 4, monitor.min_free_heap);
+}
+
+void test_heap_low_must_persist() {
+  health_sample_t s = healthy(0);
+  s.free_heap = HEALTH_MIN_FREE_HEAP - 1;
+  uint32_t now = 0;
+  for (uint32_t i = 1; i < HEALTH_HEAP_TRIP_CHECKS; i++) {
+    s.rx_frames++;
+    TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, now += 1000));
+  }
+
+  // Uma amostra boa zera a contagem
+  health_sample_t good = healthy(++s.rx_frames);
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &good, now += 1000));
+  TEST_ASSERT_EQUAL_UINT32(0, monitor.heap_low_checks);
+
+  for (uint32_t i = 1; i < HEALTH_HEAP_TRIP_CHECKS; i++) {
+    s.rx_frames++;
+    TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, now += 1000));
+  }
+  s.rx_frames++;
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_HEAP_LOW, health_monitor_check(&monitor, &s, now += 1000));
+  TEST_ASSERT_EQUAL_UINT32(HEALTH_MIN_FREE_HEAP - 1, monitor.min_free_heap);
+}
+
+void test_heap_fragmented() {
+  health_sample_t s = healthy(0);
+  s.largest_block = HEALTH_MIN_LARGEST_BLOCK - 1;
+  uint8_t trigger = HEALTH_TRIGGER_NONE;
+  for (uint32_t i = 1; i <= HEALTH_HEAP_TRIP_CHECKS; i++) {
+    s.rx_frames++;
+    trigger = health_monitor_check(&monitor, &s, i * 1000);
+  }
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_HEAP_FRAGMENTED, trigger);
+}
+
+void test_worker_stall_needs_pending_frames() {
+  // Ring vazio e tail parado: consumidor ocioso, não travado
+  health_sample_t s = healthy(1);
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, HEALTH_WORKER_STALL_MS * 2));
+
+  // Frames pendentes com o tail avançando: ok
+  uint32_t now = HEALTH_WORKER_STALL_MS * 2;
+  s.ring_occupancy = 10;
+  for (int i = 0; i < 5; i++) {
+    s.ring_tail++;
+    s.rx_frames++;
+    TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, now += HEALTH_WORKER_STALL_MS - 1));
+  }
+
+  // Tail parado com frames pendentes
+  s.rx_frames++;
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, now + HEALTH_WORKER_STALL_MS - 1));
+  s.rx_frames++;
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_WORKER_STALL, health_monitor_check(&monitor, &s, now + HEALTH_WORKER_STALL_MS));
+}
+
+void test_rx_stall() {
+  health_sample_t s = healthy(5);
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, 1000));
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, 1000 + HEALTH_RX_STALL_MS - 1));
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_RX_STALL, health_monitor_check(&monitor, &s, 1000 + HEALTH_RX_STALL_MS));
+
+  // Contador que voltou a andar (inclusive por wrap) limpa o gatilho
+  s.rx_frames = 0;
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, 2000 + HEALTH_RX_STALL_MS));
+}
+
+void test_millis_wrap() {
+  health_monitor_init(&monitor, UINT32_MAX - 500);
+  health_sample_t s = healthy(1);
+  s.ring_occupancy = 3;
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_NONE, health_monitor_check(&monitor, &s, 500));
+  s.rx_frames++;
+  TEST_ASSERT_EQUAL_UINT8(HEALTH_TRIGGER_WORKER_STALL,
+                          health_monitor_check(&monitor, &s, HEALTH_WORKER_STALL_MS - 501));
+}
+
+void test_trigger_names() {
+  TEST_ASSERT_EQUAL_STRING("none", health_trigger_name(HEALTH_TRIGGER_NONE));
+  TEST_ASSERT_EQUAL_STRING("heap_low", health_trigger_name(HEALTH_TRIGGER_HEAP_LOW));
+  TEST_ASSERT_EQUAL_STRING("heap_fragmented", health_trigger_name(HEALTH_TRIGGER_HEAP_FRAGMENTED));
+  TEST_ASSERT_EQUAL_STRING("worker_stall", health_trigger_name(HEALTH_TRIGGER_WORKER_STALL));
+  TEST_ASSERT_EQUAL_STRING("rx_stall", health_trigger_name(HEALTH_TRIGGER_RX_STALL));
+  TEST_ASSERT_EQUAL_STRING("task_wdt", health_trigger_name(HEALTH_TRIGGER_TASK_WDT));
+  TEST_ASSERT_EQUAL_STRING("unknown", health_trigger_name(99));
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_healthy_never_trips);
+  RUN_TEST(test_heap_low_must_persist);
+  RUN_TEST(test_heap_fragmented);
+  RUN_TEST(test_worker_stall_needs_pending_frames);
+  RUN_TEST(test_rx_stall);
+  RUN_TEST(test_millis_wrap);
+  RUN_TEST(test_trigger_names);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
@@ -0,0 +1,155 @@
+#include <unity.h>
+#include <string.h>
+#include "ie_parser.h"
+
+// Frame sintético: 24 bytes de cabeçalho (ignorado pelo parser) + IEs
+static uint8_t frame[1024];
+static size_t frame_len;
+static ie_list_t list;
+
+static void frame_reset() {
+  memset(frame, 0, 24);
+  frame_len = 24;
+}
+
+static void frame_add_ie(uint8_t id, const uint8_t* body, uint8_t len) {
+  frame[frame_len++] = id;
+  frame[frame_len++] = len;
+  memcpy(frame + frame_len, body, len);
+  frame_len += len;
+}
+
+static void parse() {
+  ie_parse(&list, frame, 24, frame_len);
+}
+
+void setUp() {
+  frame_reset();
+}
+
+void tearDown() {}
+
+void test_empty_frame() {
+  parse();
+  TEST_ASSERT_EQUAL_UINT8(0, list.count);
+  TEST_ASSERT_EQUAL(IE_VIEW_NONE, list.ssid);
+  TEST_ASSERT_FALSE(list.truncated);
+  TEST_ASSERT_FALSE(list.malformed);
+}
+
+void test_ssid_wildcard_and_printable() {
+  char ssid[33];
+  frame_add_ie(IE_SSID, NULL, 0);
+  parse();
+  TEST_ASSERT_EQUAL(0, ie_decode_ssid(&list, ssid, sizeof(ssid)));
+  TEST_ASSERT_EQUAL_STRING("", ssid);
+
+  frame_reset();
+  const uint8_t body[] = {'a', 0x00, 'b', 0x7f, 'c'};
+  frame_add_ie(IE_SSID, body, sizeof(body));
+  parse();
+  TEST_ASSERT_EQUAL(3, ie_decode_ssid(&list, ssid, sizeof(ssid)));
+  TEST_ASSERT_EQUAL_STRING("abc", ssid);
+}
+
+void test_rates_strip_basic_bit() {
+  const uint8_t rates[] = {0x82, 0x84, 0x8b, 0x96, 0x0c};
+  frame_add_ie(IE_SUPPORTED_RATES, rates, sizeof(rates));
+  parse();
+  uint8_t out[8];
+  TEST_ASSERT_EQUAL(5, ie_decode_rates(&list, list.rates, out, sizeof(out)));
+  const uint8_t expected[] = {2, 4, 11, 22, 12};
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, out, 5);
+  TEST_ASSERT_EQUAL(0, ie_decode_rates(&list, list.ext_rates, out, sizeof(out)));
+}
+
+void test_ht_and_vht_caps() {
+  uint8_t ht[26] = {0x6f, 0x01, 0x17, 0xff, 0xff};
+  uint8_t vht[12] = {0x92, 0x01, 0x80, 0x33, 0xfa, 0xff};
+  frame_add_ie(IE_HT_CAPABILITIES, ht, sizeof(ht));
+  frame_add_ie(IE_VHT_CAPABILITIES, vht, sizeof(vht));
+  parse();
+  TEST_ASSERT_EQUAL_HEX16(0x016f, list.caps.ht_info);
+  TEST_ASSERT_EQUAL_INT(15, ie_ht_max_mcs(&list.caps));
+  TEST_ASSERT_EQUAL_UINT8(2, ie_mcs_map_streams(list.caps.vht_rx_mcs_map));
+
+  // IE curto demais não é decodificado
+  frame_reset();
+  frame_add_ie(IE_HT_CAPABILITIES, ht, 10);
+  parse();
+  TEST_ASSERT_EQUAL(IE_VIEW_NONE, list.ht);
+  TEST_ASSERT_EQUAL_UINT8(1, list.count);
+}
+
+void test_ext_cap_bits() {
+  const uint8_t caps[] = {0x00, 0x00, 0x08, 0x80};
+  frame_add_ie(IE_EXTENDED_CAPABILITIES, caps, sizeof(caps));
+  parse();
+  TEST_ASSERT_TRUE(ie_ext_cap_bit(&list, EXT_CAP_BSS_TRANSITION));
+  TEST_ASSERT_TRUE(ie_ext_cap_bit(&list, EXT_CAP_INTERWORKING));
+  TEST_ASSERT_FALSE(ie_ext_cap_bit(&list, 0));
+  TEST_ASSERT_FALSE(ie_ext_cap_bit(&list, EXT_CAP_FTM_INITIATOR));  // além do IE
+}
+
+void test_malformed_last_ie() {
+  const uint8_t ssid[] = {'x'};
+  frame_add_ie(IE_SSID, ssid, sizeof(ssid));
+  frame[frame_len++] = IE_SUPPORTED_RATES;
+  frame[frame_len++] = 8;
+  frame[frame_len++] = 0x82;
+  parse();
+  TEST_ASSERT_TRUE(list.malformed);
+  TEST_ASSERT_EQUAL_UINT8(1, list.count);
+  TEST_ASSERT_EQUAL(IE_VIEW_NONE, list.rates);
+}
+
+void test_truncated_view_list() {
+  const uint8_t body[] = {0x00, 0x50, 0xf2, 0x04};
+  for (int i = 0; i < IE_PARSER_MAX_IES + 4; i++) {
+    frame_add_ie(IE_VENDOR_SPECIFIC, body, sizeof(body));
+  }
+  parse();
+  TEST_ASSERT_TRUE(list.truncated);
+  TEST_ASSERT_EQUAL_UINT8(IE_PARSER_MAX_IES, list.count);
+}
+
+void test_fingerprint_order_sensitive() {
+  const uint8_t rates[] = {0x82, 0x84};
+  const uint8_t ext[] = {0x0c, 0x12};
+  frame_add_ie(IE_SUPPORTED_RATES, rates, sizeof(rates));
+  frame_add_ie(IE_EXTENDED_RATES, ext, sizeof(ext));
+  parse();
+  uint32_t a = list.fp_hash;
+
+  frame_reset();
+  frame_add_ie(IE_EXTENDED_RATES, ext, sizeof(ext));
+  frame_add_ie(IE_SUPPORTED_RATES, rates, sizeof(rates));
+  parse();
+  TEST_ASSERT_NOT_EQUAL(a, list.fp_hash);
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_frame);
+  RUN_TEST(test_ssid_wildcard_and_printable);
+  RUN_TEST(test_rates_strip_basic_bit);
+  RUN_TEST(test_ht_and_vht_caps);
+  RUN_TEST(test_ext_cap_bits);
+  RUN_TEST(test_malformed_last_ie);
+  RUN_TEST(test_truncated_view_list);
+  RUN_TEST(test_fingerprint_order_sensitive);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
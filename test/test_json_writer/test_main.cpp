@@ -0,0 +1,107 @@
+#include <unity.h>
+#include <string.h>
+#include "json_writer.h"
+
+static char buf[256];
+static json_writer_t w;
+
+static const char* finish() {
+  TEST_ASSERT_FALSE(w.overflow);
+  buf[w.len] = '\0';
+  return buf;
+}
+
+void setUp() {
+  json_begin(&w, buf, sizeof(buf) - 1);
+}
+
+void tearDown() {}
+
+void test_nested_commas() {
+  json_object_begin(&w);
+  json_kv_uint(&w, "a", 1);
+  json_key(&w, "b");
+  json_array_begin(&w);
+  json_int(&w, -2);
+  json_bool(&w, true);
+  json_null(&w);
+  json_array_end(&w);
+  json_key(&w, "c");
+  json_object_begin(&w);
+  json_object_end(&w);
+  json_object_end(&w);
+  TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"b\":[-2,true,null],\"c\":{}}", finish());
+}
+
+void test_string_escapes() {
+  json_string(&w, "a\"b\\c\n\x01z");
+  TEST_ASSERT_EQUAL_STRING("\"a\\\"b\\\\c\\u000a\\u0001z\"", finish());
+}
+
+void test_integer_limits() {
+  json_array_begin(&w);
+  json_uint(&w, 0);
+  json_uint(&w, 4294967295u);
+  json_int(&w, -2147483647 - 1);
+  json_array_end(&w);
+  TEST_ASSERT_EQUAL_STRING("[0,4294967295,-2147483648]", finish());
+}
+
+void test_fixed_trims_zeros() {
+  json_array_begin(&w);
+  json_fixed(&w, 0.65f, 3);
+  json_fixed(&w, 2.0f, 2);
+  json_fixed(&w, -1.25f, 2);
+  json_fixed(&w, 0.0049f, 2);
+  json_array_end(&w);
+  TEST_ASSERT_EQUAL_STRING("[0.65,2,-1.25,0]", finish());
+}
+
+void test_hex_and_mac() {
+  const uint8_t data[] = {0x00, 0xab, 0x10};
+  const uint8_t mac[] = {0xda, 0xa1, 0x19, 0x01, 0x02, 0x03};
+  json_array_begin(&w);
+  json_hex(&w, data, sizeof(data));
+  json_mac(&w, mac);
+  json_array_end(&w);
+  TEST_ASSERT_EQUAL_STRING("[\"00ab10\",\"da:a1:19:01:02:03\"]", finish());
+
+  char out[9];
+  hex_encode_u32(0x892d46bc, out);
+  TEST_ASSERT_EQUAL_STRING("892d46bc", out);
+}
+
+void test_overflow_is_sticky() {
+  char small[8];
+  json_begin(&w, small, sizeof(small));
+  json_object_begin(&w);
+  json_kv_string(&w, "key", "value");
+  TEST_ASSERT_TRUE(w.overflow);
+  TEST_ASSERT_LESS_OR_EQUAL(sizeof(small), w.len);
+  json_object_end(&w);
+  TEST_ASSERT_TRUE(w.overflow);
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nested_commas);
+  RUN_TEST(test_string_escapes);
+  RUN_TEST(test_integer_limits);
+  RUN_TEST(test_fixed_trims_zeros);
+  RUN_TEST(test_hex_and_mac);
+  RUN_TEST(test_overflow_is_sticky);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
@@ -0,0 +1,114 @@
+#include <unity.h>
+#include <string.h>
+#include "perf_counters.h"
+
+static perf_hist_t hist;
+static perf_hist_t window[PERF_HIST_COUNT];
+
+void setUp() {
+  memset(&hist, 0, sizeof(hist));
+}
+
+void tearDown() {}
+
+void test_bucket_boundaries() {
+  TEST_ASSERT_EQUAL_UINT8(0, perf_bucket(0));
+  TEST_ASSERT_EQUAL_UINT8(0, perf_bucket(1));
+  TEST_ASSERT_EQUAL_UINT8(1, perf_bucket(2));
+  TEST_ASSERT_EQUAL_UINT8(1, perf_bucket(3));
+  TEST_ASSERT_EQUAL_UINT8(10, perf_bucket(1024));
+  TEST_ASSERT_EQUAL_UINT8(10, perf_bucket(2047));
+  TEST_ASSERT_EQUAL_UINT8(PERF_HIST_BUCKETS - 1, perf_bucket(1u << (PERF_HIST_BUCKETS - 1)));
+  TEST_ASSERT_EQUAL_UINT8(PERF_HIST_BUCKETS - 1, perf_bucket(UINT32_MAX));
+}
+
+void test_min_avg_max() {
+  perf_hist_add(&hist, 300);
+  perf_hist_add(&hist, 100);
+  perf_hist_add(&hist, 200);
+  TEST_ASSERT_EQUAL_UINT32(3, hist.count);
+  TEST_ASSERT_EQUAL_UINT32(100, hist.min);
+  TEST_ASSERT_EQUAL_UINT32(300, hist.max);
+  TEST_ASSERT_EQUAL_UINT32(200, perf_hist_avg(&hist));
+  TEST_ASSERT_EQUAL_UINT32(1, hist.buckets[6]);  // [64, 128)
+  TEST_ASSERT_EQUAL_UINT32(1, hist.buckets[7]);  // [128, 256)
+  TEST_ASSERT_EQUAL_UINT32(1, hist.buckets[8]);  // [256, 512)
+}
+
+void test_percentile_upper_bound() {
+  // 990 amostras em [128, 256) e 10 outliers em [8192, 16384)
+  for (int i = 0; i < 990; i++) perf_hist_add(&hist, 150);
+  for (int i = 0; i < 10; i++) perf_hist_add(&hist, 9000);
+  TEST_ASSERT_EQUAL_UINT32(255, perf_hist_percentile(&hist, 500));
+  TEST_ASSERT_EQUAL_UINT32(255, perf_hist_percentile(&hist, 990));
+  // Último bucket ocupado: limitado ao max observado
+  TEST_ASSERT_EQUAL_UINT32(9000, perf_hist_percentile(&hist, 999));
+  TEST_ASSERT_EQUAL_UINT32(9000, perf_hist_percentile(&hist, 1000));
+
+  perf_hist_add(&hist, 9000);  // 11 outliers em 1001: p99 já cai neles
+  TEST_ASSERT_EQUAL_UINT32(9000, perf_hist_percentile(&hist, 990));
+}
+
+void test_percentile_empty_and_zero() {
+  TEST_ASSERT_EQUAL_UINT32(0, perf_hist_percentile(&hist, 990));
+  TEST_ASSERT_EQUAL_UINT32(0, perf_hist_avg(&hist));
+  perf_hist_add(&hist, 0);
+  TEST_ASSERT_EQUAL_UINT32(0, perf_hist_percentile(&hist, 990));
+}
+
+void test_snapshot_starts_new_window() {
+  perf_record(PERF_STAGE_PARSE, 500);
+  perf_record(PERF_STAGE_PARSE, 700);
+  perf_snapshot(window);
+  TEST_ASSERT_EQUAL_UINT32(2, window[PERF_STAGE_PARSE].count);
+  TEST_ASSERT_EQUAL_UINT32(600, perf_hist_avg(&window[PERF_STAGE_PARSE]));
+
+  // Sem amostras na janela nova: snapshot vazio, mesmo com o conteúdo antigo no histograma
+  perf_snapshot(window);
+  TEST_ASSERT_EQUAL_UINT32(0, window[PERF_STAGE_PARSE].count);
+
+  perf_record(PERF_STAGE_PARSE, 40);
+  perf_snapshot(window);
+  TEST_ASSERT_EQUAL_UINT32(1, window[PERF_STAGE_PARSE].count);
+  TEST_ASSERT_EQUAL_UINT32(40, window[PERF_STAGE_PARSE].min);
+  TEST_ASSERT_EQUAL_UINT32(40, window[PERF_STAGE_PARSE].max);
+}
+
+void test_snapshot_merges_shards() {
+  perf_record(PERF_STAGE_SERIALIZE, 1000);
+  perf_shard = 1;
+  perf_record(PERF_STAGE_SERIALIZE, 3000);
+  perf_record(PERF_STAGE_SERIALIZE, 20);
+  perf_shard = 0;
+  perf_snapshot(window);
+  const perf_hist_t& h = window[PERF_STAGE_SERIALIZE];
+  TEST_ASSERT_EQUAL_UINT32(3, h.count);
+  TEST_ASSERT_EQUAL_UINT32(20, h.min);
+  TEST_ASSERT_EQUAL_UINT32(3000, h.max);
+  TEST_ASSERT_EQUAL_UINT32(1340, perf_hist_avg(&h));
+  TEST_ASSERT_EQUAL_UINT32(1, h.buckets[perf_bucket(1000)]);
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_bucket_boundaries);
+  RUN_TEST(test_min_avg_max);
+  RUN_TEST(test_percentile_upper_bound);
+  RUN_TEST(test_percentile_empty_and_zero);
+  RUN_TEST(test_snapshot_starts_new_window);
+  RUN_TEST(test_snapshot_merges_shards);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
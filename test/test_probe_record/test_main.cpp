@@ -0,0 +1,230 @@
+#include <unity.h>
+#include <string.h>
+#include "probe_record.h"
+#include "wire_format.h"
+#include "../corpus/probe_corpus.h"
+
+static capture_data_t capture;
+static char json[4096];
+
+static const probe_corpus_frame_t* corpus_frame(const char* name) {
+  for (size_t i = 0; i < PROBE_CORPUS_COUNT; i++) {
+    if (strcmp(probe_corpus[i].name, name) == 0) return &probe_corpus[i];
+  }
+  return NULL;
+}
+
+static bool parse_corpus(const char* name) {
+  const probe_corpus_frame_t* f = corpus_frame(name);
+  TEST_ASSERT_NOT_NULL(f);
+  bool ok = parse_probe_request(f->frame, f->len, true, f->rssi, f->channel, capture);
+  capture.capture_id = "6553f100-9abc-5678-4553-6553f1009abc";
+  capture.scanner_id = "esp32-test";
+  capture.firmware = "test";
+  capture.scanner_tag = 0x9abc;
+  capture.capture_epoch_s = 1700000123;
+  capture.capture_ms = 249;
+  return ok;
+}
+
+static size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t n = 0;
+  size_t i = 0;
+  while (i < len) {
+    uint8_t code = in[i++];
+    for (uint8_t k = 1; k < code && i < len; k++) out[n++] = in[i++];
+    if (code != 0xFF && i < len) out[n++] = 0;
+  }
+  return n;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_parse_header_fields() {
+  TEST_ASSERT_TRUE(parse_corpus("iphone_ios17_wildcard"));
+  const uint8_t sa[6] = {0xd2, 0xb8, 0xc3, 0xa1, 0x4e, 0x07};
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(sa, capture.packet.ieee80211.sa, 6);
+  TEST_ASSERT_EQUAL_UINT16(0x6a1, capture.packet.ieee80211.seq_ctrl);
+  TEST_ASSERT_EQUAL_UINT8(6, capture.packet.radio.channel);
+  TEST_ASSERT_EQUAL_UINT16(2437, capture.packet.radio.freq_mhz);
+  TEST_ASSERT_EQUAL_INT8(-61, capture.packet.rssi_dbm);
+  TEST_ASSERT_EQUAL_UINT16(corpus_frame("iphone_ios17_wildcard")->len - WIFI_FCS_LEN, capture.packet.frame_len);
+  TEST_ASSERT_TRUE(capture.packet.mac_randomized);
+  TEST_ASSERT_EQUAL_STRING("Unknown", capture.packet.vendor_inferred);
+}
+
+void test_parse_ies() {
+  TEST_ASSERT_TRUE(parse_corpus("iphone_ios17_wildcard"));
+  const ie_list_t& ies = capture.packet.ies;
+  TEST_ASSERT_FALSE(ies.malformed);
+  TEST_ASSERT_FALSE(ies.truncated);
+  TEST_ASSERT_EQUAL_UINT8(10, ies.count);
+  TEST_ASSERT_NOT_EQUAL(IE_VIEW_NONE, ies.ht);
+  TEST_ASSERT_NOT_EQUAL(IE_VIEW_NONE, ies.vht);
+  TEST_ASSERT_NOT_EQUAL(IE_VIEW_NONE, ies.he);
+  TEST_ASSERT_EQUAL(IE_VIEW_NONE, ies.eht);
+  TEST_ASSERT_EQUAL_UINT8(2, ies.vendor_count);
+  TEST_ASSERT_EQUAL_UINT32(ies.fp_hash, capture.packet.fingerprint.ie_hash);
+
+  TEST_ASSERT_TRUE(parse_corpus("samsung_s24_eht"));
+  TEST_ASSERT_NOT_EQUAL(IE_VIEW_NONE, capture.packet.ies.eht);
+}
+
+void test_parse_rejects_short_frame() {
+  const probe_corpus_frame_t* f = corpus_frame("esp8266_minimal");
+  TEST_ASSERT_FALSE(parse_probe_request(f->frame, 20, true, f->rssi, f->channel, capture));
+}
+
+void test_parse_malformed() {
+  TEST_ASSERT_TRUE(parse_corpus("malformed_overrun"));
+  TEST_ASSERT_TRUE(capture.packet.ies.malformed);
+  TEST_ASSERT_EQUAL_UINT8(1, capture.packet.ies.count);
+}
+
+void test_parse_clipped_keeps_tail() {
+  // Frame cortado exatamente no fim dos IEs: sem FCS, nenhum byte é descartado
+  const probe_corpus_frame_t* f = corpus_frame("iphone_ios17_wildcard");
+  size_t clipped = f->len - WIFI_FCS_LEN;
+  TEST_ASSERT_TRUE(parse_probe_request(f->frame, clipped, false, f->rssi, f->channel, capture));
+  TEST_ASSERT_EQUAL_UINT16(clipped, capture.packet.frame_len);
+  TEST_ASSERT_FALSE(capture.packet.ies.malformed);
+  uint8_t count = capture.packet.ies.count;
+
+  // Tratado como se tivesse FCS, o último IE perderia 4 bytes
+  TEST_ASSERT_TRUE(parse_probe_request(f->frame, clipped, true, f->rssi, f->channel, capture));
+  TEST_ASSERT_EQUAL_UINT16(clipped - WIFI_FCS_LEN, capture.packet.frame_len);
+  TEST_ASSERT_TRUE(capture.packet.ies.malformed || capture.packet.ies.count < count);
+}
+
+void test_vendor_lookup() {
+  TEST_ASSERT_TRUE(parse_corpus("intel_ax201_wps"));
+  TEST_ASSERT_FALSE(capture.packet.mac_randomized);
+  TEST_ASSERT_EQUAL_STRING("Intel Corporate", capture.packet.vendor_inferred);
+  TEST_ASSERT_TRUE(parse_corpus("esp8266_minimal"));
+  TEST_ASSERT_EQUAL_STRING("Espressif Inc.", capture.packet.vendor_inferred);
+}
+
+void test_fingerprint_ignores_ssid() {
+  const probe_corpus_frame_t* f = corpus_frame("pixel_android14_directed");
+  uint8_t frame[256];
+  memcpy(frame, f->frame, f->len);
+
+  TEST_ASSERT_TRUE(parse_probe_request(frame, f->len, true, f->rssi, f->channel, capture));
+  uint32_t hash = capture.packet.fingerprint.ie_hash;
+
+  // Mesmo tamanho de SSID, outro conteúdo: mesmo dispositivo
+  frame[WIFI_MGMT_HEADER_LEN + 2] ^= 0x20;
+  TEST_ASSERT_TRUE(parse_probe_request(frame, f->len, true, f->rssi, f->channel, capture));
+  TEST_ASSERT_EQUAL_HEX32(hash, capture.packet.fingerprint.ie_hash);
+
+  // Corpo do IE de rates faz parte do fingerprint
+  const ie_view_t* rates = ie_get(&capture.packet.ies, capture.packet.ies.rates);
+  TEST_ASSERT_NOT_NULL(rates);
+  frame[rates->offset] ^= 0x01;
+  TEST_ASSERT_TRUE(parse_probe_request(frame, f->len, true, f->rssi, f->channel, capture));
+  TEST_ASSERT_NOT_EQUAL(hash, capture.packet.fingerprint.ie_hash);
+}
+
+void test_json_record() {
+  TEST_ASSERT_TRUE(parse_corpus("pixel_android14_directed"));
+  size_t len = format_capture_json(capture, json, sizeof(json));
+  TEST_ASSERT_GREATER_THAN(0, len);
+  TEST_ASSERT_EQUAL_STRING_LEN("\r\n", json + len - 2, 2);
+  json[len] = '\0';
+
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"capture_ts\":\"2023-11-14T22:15:23.249Z\""));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"sa\":\"7a:3f:1c:90:b2:e5\""));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"ssid\":\"CasaSilva_5G\""));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"supported_rates\":[2,4,11,22,12,18,24,36]"));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"he_capabilities\":{\"present\":true"));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"eht_capabilities\":null"));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"pkt_id\":\"6553f17b-0000-0000-9abc-6553f17b00f9\""));
+  // track_id só aparece com o correlator ativo
+  TEST_ASSERT_NULL(strstr(json, "\"track_id\""));
+
+  capture.packet.track_id = 17;
+  len = format_capture_json(capture, json, sizeof(json));
+  json[len] = '\0';
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"vendor_inferred\":\"Unknown\",\"track_id\":17,"));
+}
+
+void test_json_ssid_escapes() {
+  TEST_ASSERT_TRUE(parse_corpus("ssid_escapes"));
+  size_t len = format_capture_json(capture, json, sizeof(json));
+  TEST_ASSERT_GREATER_THAN(0, len);
+  json[len] = '\0';
+  // Bytes fora de ASCII imprimível são descartados; aspas e barra escapadas
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"ssid\":\"Caf \\\"Lobby\\\"\\\\\""));
+}
+
+void test_json_overflow() {
+  TEST_ASSERT_TRUE(parse_corpus("intel_ax201_wps"));
+  TEST_ASSERT_EQUAL(0, format_capture_json(capture, json, 256));
+  TEST_ASSERT_EQUAL(0, format_capture_json(capture, json, 1));
+}
+
+void test_binary_record() {
+  TEST_ASSERT_TRUE(parse_corpus("samsung_s24_eht"));
+  capture.packet.pkt_seq = 7;
+  capture.packet.radio.dwell_id = 42;
+  capture.packet.radio.rx_us = 0x11223344;
+
+  static uint8_t framed[WIRE_FRAMED_SIZE(WIRE_PACKET_HEADER_SIZE + 512)];
+  size_t len = encode_capture_binary(capture, framed, sizeof(framed));
+  TEST_ASSERT_GREATER_THAN(0, len);
+  TEST_ASSERT_EQUAL_HEX8(0x00, framed[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x00, framed[len - 1]);
+  for (size_t i = 1; i < len - 1; i++) TEST_ASSERT_NOT_EQUAL(0, framed[i]);
+
+  uint8_t record[600];
+  size_t n = cobs_decode(framed + 1, len - 2, record);
+  uint16_t ies_len = capture.packet.frame_len - WIFI_MGMT_HEADER_LEN;
+  TEST_ASSERT_EQUAL(WIRE_PACKET_HEADER_SIZE + ies_len + WIRE_CRC_SIZE, n);
+  uint16_t crc = wire_crc16(record, n - WIRE_CRC_SIZE);
+  TEST_ASSERT_EQUAL_HEX16(crc, record[n - 2] | (record[n - 1] << 8));
+
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PACKET, record[0]);
+  TEST_ASSERT_EQUAL_UINT8(WIRE_FORMAT_VERSION, record[1]);
+  TEST_ASSERT_EQUAL_UINT32(7, record[2] | (record[3] << 8) | (record[4] << 16) | ((uint32_t)record[5] << 24));
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(capture.packet.frame + WIFI_MGMT_HEADER_LEN,
+                               record + WIRE_PACKET_HEADER_SIZE, ies_len);
+}
+
+void test_timestamp_format() {
+  char ts[32];
+  format_iso8601_timestamp(ts, 1700000123, 5);
+  TEST_ASSERT_EQUAL_STRING("2023-11-14T22:15:23.005Z", ts);
+  format_iso8601_timestamp(ts, 1700000124, 999);
+  TEST_ASSERT_EQUAL_STRING("2023-11-14T22:15:24.999Z", ts);
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_header_fields);
+  RUN_TEST(test_parse_ies);
+  RUN_TEST(test_parse_rejects_short_frame);
+  RUN_TEST(test_parse_malformed);
+  RUN_TEST(test_parse_clipped_keeps_tail);
+  RUN_TEST(test_vendor_lookup);
+  RUN_TEST(test_fingerprint_ignores_ssid);
+  RUN_TEST(test_json_record);
+  RUN_TEST(test_json_ssid_escapes);
+  RUN_TEST(test_json_overflow);
+  RUN_TEST(test_binary_record);
+  RUN_TEST(test_timestamp_format);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
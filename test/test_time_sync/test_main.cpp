@@ -0,0 +1,143 @@
+#include <unity.h>
+#include <string.h>
+#include "time_sync.h"
+
+static const int64_t EPOCH_US = 1700000000LL * 1000000;
+
+void setUp() {}
+void tearDown() {}
+
+void test_model_set_and_step() {
+  time_model_t m;
+  time_model_init(&m, EPOCH_US, 5000000, TIME_SOURCE_BUILD);
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US, time_model_epoch_us(&m, 5000000));
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US + 1000, time_model_epoch_us(&m, 5001000));
+  TEST_ASSERT_EQUAL_UINT32(0, m.adjustments);
+
+  // Host adianta 250 ms
+  time_model_set(&m, EPOCH_US + 10250000, 15000000, TIME_SOURCE_HOST);
+  TEST_ASSERT_EQUAL_INT32(250000, m.last_step_us);
+  TEST_ASSERT_EQUAL_UINT8(TIME_SOURCE_HOST, m.source);
+  TEST_ASSERT_EQUAL_UINT32(1, m.adjustments);
+
+  // Saltos maiores que int32 saturam em last_step_us, mas o offset é exato
+  time_model_set(&m, 0, 0, TIME_SOURCE_HOST);
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, m.last_step_us);
+  TEST_ASSERT_EQUAL_INT64(0, m.offset_us);
+}
+
+void test_pps_rounds_to_nearest_second() {
+  time_model_t m;
+  time_model_init(&m, EPOCH_US + 300000, 1000000, TIME_SOURCE_HOST);
+  // Borda em epoch ~ +0,3 s: o segundo inteiro mais próximo é o de baixo
+  time_model_pps(&m, 1000000);
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US, time_model_epoch_us(&m, 1000000));
+  TEST_ASSERT_EQUAL_INT32(-300000, m.last_step_us);
+  TEST_ASSERT_EQUAL_UINT8(TIME_SOURCE_PPS, m.source);
+
+  // Borda 0,7 s adiantada: sobe para o seguinte
+  time_model_init(&m, EPOCH_US + 700000, 1000000, TIME_SOURCE_HOST);
+  time_model_pps(&m, 1000000);
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US + 1000000, time_model_epoch_us(&m, 1000000));
+}
+
+void test_rx_clock_keeps_minimum_offset() {
+  rx_clock_t c;
+  rx_clock_init(&c);
+  TEST_ASSERT_FALSE(c.valid.load());
+
+  rx_clock_observe(&c, 1000500, 1000000);   // 500 us de latência
+  TEST_ASSERT_TRUE(c.valid.load());
+  TEST_ASSERT_EQUAL_UINT32(500, c.offset.load());
+  rx_clock_observe(&c, 2000900, 2000000);   // mais lenta: ignorada
+  TEST_ASSERT_EQUAL_UINT32(500, c.offset.load());
+  rx_clock_observe(&c, 3000120, 3000000);
+  TEST_ASSERT_EQUAL_UINT32(120, c.offset.load());
+
+  // Offset negativo (timer atrás do rx) comparado em aritmética modular
+  rx_clock_observe(&c, 100, 200);
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)-100, c.offset.load());
+
+  // Nova janela: o próximo valor substitui o mínimo mesmo sendo maior
+  c.restart.store(true);
+  rx_clock_observe(&c, 4000800, 4000000);
+  TEST_ASSERT_EQUAL_UINT32(800, c.offset.load());
+  TEST_ASSERT_FALSE(c.restart.load());
+}
+
+void test_rx_to_timer_across_wrap() {
+  // Pacote 500 us no passado
+  TEST_ASSERT_EQUAL_INT64(9999500, rx_clock_to_timer(9999000, 500, 10000000));
+
+  // timer passou de 32 bits e rx_us deu a volta
+  int64_t now = 0x100000100LL;
+  TEST_ASSERT_EQUAL_INT64(0xFFFFFF00LL, rx_clock_to_timer(0xFFFFFE00u, 0x100, now));
+  TEST_ASSERT_EQUAL_INT64(now - 0x50, rx_clock_to_timer(0x000000B0u - 0x100, 0x100, now));
+}
+
+void test_anchor_matches_model() {
+  time_model_t m;
+  time_model_init(&m, EPOCH_US + 123456, 7000000, TIME_SOURCE_HOST);
+  time_anchor_t a;
+  time_anchor_make(&a, &m, 400, 7000000, 9);
+  TEST_ASSERT_EQUAL_UINT32(9, a.seq);
+  TEST_ASSERT_EQUAL_UINT8(TIME_SOURCE_HOST, a.source);
+  TEST_ASSERT_EQUAL_UINT32(1700000000, a.epoch_s);
+  TEST_ASSERT_EQUAL_UINT32(123456, a.epoch_frac_us);
+  TEST_ASSERT_EQUAL_UINT32(7000000 - 400, a.rx_us);
+
+  // Epoch negativo (sem fonte, antes do boot) é preso em 0
+  time_model_init(&m, 0, 7000000, TIME_SOURCE_NONE);
+  time_anchor_make(&a, &m, 0, 1000, 10);
+  TEST_ASSERT_EQUAL_UINT32(0, a.epoch_s);
+  TEST_ASSERT_EQUAL_UINT32(0, a.epoch_frac_us);
+}
+
+void test_parse_epoch() {
+  int64_t us;
+  TEST_ASSERT_TRUE(time_parse_epoch("1700000000", &us));
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US, us);
+  TEST_ASSERT_TRUE(time_parse_epoch("1700000000.25", &us));
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US + 250000, us);
+  // Fração além de us é truncada; espaço encerra o número
+  TEST_ASSERT_TRUE(time_parse_epoch("1700000000.1234567 pps", &us));
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US + 123456, us);
+
+  TEST_ASSERT_FALSE(time_parse_epoch("", &us));
+  TEST_ASSERT_FALSE(time_parse_epoch(".5", &us));
+  TEST_ASSERT_FALSE(time_parse_epoch("17000000000", &us));
+  TEST_ASSERT_FALSE(time_parse_epoch("1700000000x", &us));
+}
+
+void test_source_names() {
+  TEST_ASSERT_EQUAL_STRING("uptime", time_source_name(TIME_SOURCE_NONE));
+  TEST_ASSERT_EQUAL_STRING("build", time_source_name(TIME_SOURCE_BUILD));
+  TEST_ASSERT_EQUAL_STRING("host", time_source_name(TIME_SOURCE_HOST));
+  TEST_ASSERT_EQUAL_STRING("pps", time_source_name(TIME_SOURCE_PPS));
+  TEST_ASSERT_EQUAL_STRING("unknown", time_source_name(42));
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_model_set_and_step);
+  RUN_TEST(test_pps_rounds_to_nearest_second);
+  RUN_TEST(test_rx_clock_keeps_minimum_offset);
+  RUN_TEST(test_rx_to_timer_across_wrap);
+  RUN_TEST(test_anchor_matches_model);
+  RUN_TEST(test_parse_epoch);
+  RUN_TEST(test_source_names);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
@@ -0,0 +1,123 @@
+#include <unity.h>
+#include <string.h>
+#include "track_correlator.h"
+
+#define CAPACITY 8
+
+static track_correlator_t tc;
+static track_entry_t entries[CAPACITY];
+static uint16_t index_table[CAPACITY * 2];
+
+static const uint32_t FP_PHONE = 0x1badcafe;
+static const uint32_t FP_OTHER = 0x0ddba11;
+
+static void random_sa(uint8_t* sa, uint8_t n) {
+  const uint8_t base[6] = {0xda, 0xa1, 0x19, 0x00, 0x00, 0x00};
+  memcpy(sa, base, 6);
+  sa[5] = n;
+}
+
+static uint32_t observe(uint8_t n, uint32_t fp, uint16_t seq, int8_t rssi, uint32_t now_ms) {
+  uint8_t sa[6];
+  random_sa(sa, n);
+  return track_correlator_observe(&tc, sa, fp, true, seq, rssi, now_ms);
+}
+
+void setUp() {
+  track_correlator_init(&tc, entries, CAPACITY, index_table, CAPACITY * 2);
+}
+
+void tearDown() {}
+
+void test_same_sa_keeps_track() {
+  uint32_t id = observe(1, FP_PHONE, 100, -60, 1000);
+  TEST_ASSERT_NOT_EQUAL(TRACK_ID_NONE, id);
+  TEST_ASSERT_EQUAL_UINT32(id, observe(1, FP_PHONE, 101, -62, 1200));
+  // Mesmo SA com outro conjunto de IEs continua na trilha
+  TEST_ASSERT_EQUAL_UINT32(id, observe(1, FP_OTHER, 102, -61, 1300));
+  TEST_ASSERT_EQUAL_UINT32(1, tc.tracks);
+  TEST_ASSERT_EQUAL_UINT32(1, tc.links);
+}
+
+void test_rotation_links_by_seq_and_rssi() {
+  uint32_t id = observe(1, FP_PHONE, 4090, -60, 1000);
+  // SA novo, mesmo fingerprint, sequência continua (com wrap) e RSSI próximo
+  TEST_ASSERT_EQUAL_UINT32(id, observe(2, FP_PHONE, 3, -64, 3000));
+  TEST_ASSERT_EQUAL_UINT32(1, tc.links);
+  // O SA antigo reaparecendo mantém a trilha
+  TEST_ASSERT_EQUAL_UINT32(id, observe(1, FP_PHONE, 4, -60, 3100));
+}
+
+void test_rotation_rejected() {
+  uint32_t id = observe(1, FP_PHONE, 100, -60, 1000);
+  // Outro fingerprint
+  TEST_ASSERT_NOT_EQUAL(id, observe(2, FP_OTHER, 101, -60, 1100));
+  // Sequência para trás ou com salto grande demais
+  TEST_ASSERT_NOT_EQUAL(id, observe(3, FP_PHONE, 90, -60, 1200));
+  TEST_ASSERT_NOT_EQUAL(id, observe(4, FP_PHONE, 100 + TRACK_SEQ_MAX_GAP + 1, -60, 1300));
+  // RSSI distante
+  TEST_ASSERT_NOT_EQUAL(id, observe(5, FP_PHONE, 101, -60 - TRACK_RSSI_MAX_DELTA - 1, 1400));
+  TEST_ASSERT_EQUAL_UINT32(5, tc.tracks);
+  TEST_ASSERT_EQUAL_UINT32(0, tc.links);
+
+  // Fora da janela
+  setUp();
+  id = observe(1, FP_PHONE, 100, -60, 1000);
+  TEST_ASSERT_NOT_EQUAL(id, observe(2, FP_PHONE, 101, -60, 1001 + TRACK_LINK_WINDOW_MS));
+
+  // MAC global não troca de endereço: não é ligado
+  setUp();
+  const uint8_t global_sa[6] = {0x00, 0x1b, 0x21, 0x01, 0x02, 0x03};
+  id = track_correlator_observe(&tc, global_sa, FP_PHONE, false, 100, -60, 1000);
+  TEST_ASSERT_NOT_EQUAL(id, observe(2, FP_PHONE, 101, -60, 1100));
+}
+
+void test_best_candidate_and_single_successor() {
+  // Dois aparelhos iguais (b à frente de a): o SA novo liga ao de sequência mais próxima
+  uint32_t b = observe(2, FP_PHONE, 110, -60, 1000);
+  uint32_t a = observe(1, FP_PHONE, 100, -60, 1000);
+  TEST_ASSERT_NOT_EQUAL(a, b);
+  TEST_ASSERT_EQUAL_UINT32(b, observe(3, FP_PHONE, 112, -60, 2000));
+  // A entrada de b já foi sucedida: um SA novo que só continuaria b vai para a
+  TEST_ASSERT_EQUAL_UINT32(a, observe(4, FP_PHONE, 111, -60, 2100));
+  // Nenhum candidato livre: trilha nova
+  uint32_t c = observe(5, FP_PHONE, 105, -60, 2200);
+  TEST_ASSERT_NOT_EQUAL(a, c);
+  TEST_ASSERT_NOT_EQUAL(b, c);
+}
+
+void test_eviction_keeps_capacity() {
+  for (uint8_t i = 0; i < CAPACITY * 3; i++) {
+    observe(i, FP_OTHER + i, 0, -60, 1000 + i);
+  }
+  TEST_ASSERT_EQUAL_UINT16(CAPACITY, tc.used);
+  TEST_ASSERT_EQUAL_UINT32(CAPACITY * 2, tc.evictions);
+  TEST_ASSERT_EQUAL_UINT32(CAPACITY * 3, tc.tracks);
+  // Os mais recentes continuam no índice (hit: nenhuma trilha nova)
+  uint32_t last = observe(CAPACITY * 3 - 1, FP_OTHER + CAPACITY * 3 - 1, 1, -60, 2000);
+  TEST_ASSERT_EQUAL_UINT32(CAPACITY * 3, last);
+  TEST_ASSERT_EQUAL_UINT32(CAPACITY * 3, tc.tracks);
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_same_sa_keeps_track);
+  RUN_TEST(test_rotation_links_by_seq_and_rssi);
+  RUN_TEST(test_rotation_rejected);
+  RUN_TEST(test_best_candidate_and_single_successor);
+  RUN_TEST(test_eviction_keeps_capacity);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "window_sketch.h"
+#include "fnv_hash.h"
+
+static window_sketch_t sketch;
+static window_sketch_t other;
+
+// MAC sintético i (prefixo localmente administrado, como os aleatórios)
+static void make_mac(uint32_t i, uint8_t* mac) {
+  mac[0] = 0xda;
+  mac[1] = 0xa1;
+  mac[2] = (uint8_t)(i >> 24);
+  mac[3] = (uint8_t)(i >> 16);
+  mac[4] = (uint8_t)(i >> 8);
+  mac[5] = (uint8_t)i;
+}
+
+static void assert_within(uint32_t expected, uint32_t estimate, float tolerance) {
+  float error = ((float)estimate - (float)expected) / (float)expected;
+  if (error < 0) error = -error;
+  char msg[64];
+  snprintf(msg, sizeof(msg), "esperado %u, estimado %u", expected, estimate);
+  TEST_ASSERT_TRUE_MESSAGE(error <= tolerance, msg);
+}
+
+void setUp() {
+  window_sketch_reset(&sketch, 1);
+  window_sketch_reset(&other, 1);
+}
+
+void tearDown() {}
+
+void test_hll_empty_and_small() {
+  TEST_ASSERT_EQUAL_UINT32(0, hll_estimate(&sketch.macs));
+  uint8_t mac[6];
+  for (uint32_t i = 0; i < 20; i++) {
+    make_mac(i, mac);
+    window_sketch_observe(&sketch, mac, i, "", 0);
+    window_sketch_observe(&sketch, mac, i, "", 0);  // repetidos não contam
+  }
+  TEST_ASSERT_EQUAL_UINT32(40, sketch.probes);
+  // Contagem linear: praticamente exata com poucos itens
+  TEST_ASSERT_UINT32_WITHIN(1, 20, hll_estimate(&sketch.macs));
+}
+
+void test_hll_accuracy() {
+  // 10k MACs distintos: dentro de 3 erros padrão
+  uint8_t mac[6];
+  for (uint32_t i = 0; i < 10000; i++) {
+    make_mac(i * 7919, mac);
+    hll_add(&sketch.macs, sketch_mix32(fnv1a_update(fnv1a_init(), mac, 6)));
+  }
+  assert_within(10000, hll_estimate(&sketch.macs), 3 * hll_std_error());
+
+  // Hashes FNV sequenciais (fp_hash) também se espalham após sketch_mix32
+  for (uint32_t i = 0; i < 5000; i++) {
+    hll_add(&sketch.fingerprints, sketch_mix32(0x811c9dc5 + i));
+  }
+  assert_within(5000, hll_estimate(&sketch.fingerprints), 3 * hll_std_error());
+}
+
+void test_hll_merge_is_union() {
+  uint8_t mac[6];
+  for (uint32_t i = 0; i < 3000; i++) {
+    make_mac(i, mac);
+    window_sketch_observe(i % 2 ? &sketch : &other, mac, 0, "", 0);
+    if (i < 1000) window_sketch_observe(&other, mac, 0, "", 0);  // sobreposição
+  }
+  hll_merge(&sketch.macs, &other.macs);
+  assert_within(3000, hll_estimate(&sketch.macs), 3 * hll_std_error());
+}
+
+void test_topk_heavy_hitters() {
+  // Três MACs frequentes no meio de muitos únicos: todos com count >= real
+  uint8_t mac[6];
+  uint8_t heavy[3][6];
+  for (uint8_t h = 0; h < 3; h++) make_mac(0xff000000 + h, heavy[h]);
+  for (uint32_t i = 0; i < 2000; i++) {
+    make_mac(i, mac);
+    window_sketch_observe(&sketch, mac, 0, "", 0);
+    if (i % 4 == 0) window_sketch_observe(&sketch, heavy[0], 0, "", 0);   // 500
+    if (i % 5 == 0) window_sketch_observe(&sketch, heavy[1], 0, "", 0);   // 400
+    if (i % 10 == 0) window_sketch_observe(&sketch, heavy[2], 0, "", 0);  // 200
+  }
+
+  topk_entry_t out[SKETCH_TOPK_CAPACITY];
+  const topk_t* sketches[] = {&sketch.talkers};
+  size_t n = topk_collect(sketches, 1, out, SKETCH_TOPK_CAPACITY);
+  TEST_ASSERT_EQUAL(SKETCH_TOPK_CAPACITY, n);
+  const uint32_t expected[] = {500, 400, 200};
+  for (uint8_t h = 0; h < 3; h++) {
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(heavy[h], out[h].label, 6);
+    TEST_ASSERT_TRUE(out[h].count >= expected[h]);
+    TEST_ASSERT_TRUE(out[h].count - out[h].error <= expected[h]);
+  }
+  for (size_t i = 1; i < n; i++) TEST_ASSERT_TRUE(out[i - 1].count >= out[i].count);
+}
+
+void test_topk_collect_merges_keys() {
+  window_sketch_observe(&sketch, (const uint8_t*)"\x01\x02\x03\x04\x05\x06", 0, "CasaSilva_5G", 12);
+  window_sketch_observe(&sketch, (const uint8_t*)"\x01\x02\x03\x04\x05\x06", 0, "eduroam", 7);
+  window_sketch_observe(&other, (const uint8_t*)"\x0a\x02\x03\x04\x05\x06", 0, "eduroam", 7);
+  window_sketch_observe(&other, (const uint8_t*)"\x0a\x02\x03\x04\x05\x06", 0, "", 0);  // wildcard
+
+  topk_entry_t out[8];
+  const topk_t* sketches[] = {&sketch.ssids, &other.ssids};
+  size_t n = topk_collect(sketches, 2, out, 8);
+  TEST_ASSERT_EQUAL(2, n);
+  TEST_ASSERT_EQUAL_UINT8(7, out[0].label_len);
+  TEST_ASSERT_EQUAL_MEMORY("eduroam", out[0].label, 7);
+  TEST_ASSERT_EQUAL_UINT32(2, out[0].count);
+  TEST_ASSERT_EQUAL_UINT32(0, out[0].error);
+  TEST_ASSERT_EQUAL_UINT32(1, out[1].count);
+
+  // out_cap limita as entradas distintas
+  TEST_ASSERT_EQUAL(1, topk_collect(sketches, 2, out, 1));
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_hll_empty_and_small);
+  RUN_TEST(test_hll_accuracy);
+  RUN_TEST(test_hll_merge_is_union);
+  RUN_TEST(test_topk_heavy_hitters);
+  RUN_TEST(test_topk_collect_merges_keys);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
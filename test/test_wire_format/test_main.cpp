@@ -0,0 +1,241 @@
+#include <unity.h>
+#include <string.h>
+#include "wire_format.h"
+
+static uint8_t record[600];
+static uint8_t framed[WIRE_FRAMED_SIZE(sizeof(record))];
+static uint8_t decoded[sizeof(record) + WIRE_CRC_SIZE];
+
+// Inverso de wire_frame() sem os delimitadores (como o WireDecoder do analisador)
+static size_t cobs_decode(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t n = 0;
+  size_t i = 0;
+  while (i < len) {
+    uint8_t code = in[i++];
+    for (uint8_t k = 1; k < code && i < len; k++) out[n++] = in[i++];
+    if (code != 0xFF && i < len) out[n++] = 0;
+  }
+  return n;
+}
+
+static size_t unframe(size_t framed_len) {
+  TEST_ASSERT_EQUAL_HEX8(0x00, framed[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x00, framed[framed_len - 1]);
+  for (size_t i = 1; i < framed_len - 1; i++) TEST_ASSERT_NOT_EQUAL(0, framed[i]);
+  size_t n = cobs_decode(framed + 1, framed_len - 2, decoded);
+  TEST_ASSERT_GREATER_THAN(WIRE_CRC_SIZE, n);
+  uint16_t crc = decoded[n - 2] | (decoded[n - 1] << 8);
+  TEST_ASSERT_EQUAL_HEX16(wire_crc16(decoded, n - WIRE_CRC_SIZE), crc);
+  return n - WIRE_CRC_SIZE;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_crc16_check_value() {
+  // Valor de verificação do CRC-16/CCITT-FALSE
+  TEST_ASSERT_EQUAL_HEX16(0x29B1, wire_crc16((const uint8_t*)"123456789", 9));
+  TEST_ASSERT_EQUAL_HEX16(0xFFFF, wire_crc16(NULL, 0));
+}
+
+void test_frame_zero_runs() {
+  // Zeros e um bloco de 300 bytes não nulos (força o código 0xFF do COBS)
+  memset(record, 0, 8);
+  for (size_t i = 8; i < 308; i++) record[i] = (uint8_t)(i | 1);
+  size_t len = wire_frame(record, 308, framed, sizeof(framed));
+  TEST_ASSERT_GREATER_THAN(0, len);
+  TEST_ASSERT_LESS_OR_EQUAL(WIRE_FRAMED_SIZE(308), len);
+  TEST_ASSERT_EQUAL(308, unframe(len));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(record, decoded, 308);
+}
+
+void test_frame_out_too_small() {
+  memset(record, 0x11, 32);
+  TEST_ASSERT_EQUAL(0, wire_frame(record, 32, framed, 20));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void test_packet_layout() {
+  wire_packet_header_t h;
+  memset(&h, 0, sizeof(h));
+  h.pkt_seq = 0x01020304;
+  h.channel = 11;
+  h.rssi_dbm = -70;
+  h.rx_us = 0xdeadbeef;
+  h.delta_ref = 0x42;
+  h.track_id = 0x00c0ffee;
+  const uint8_t ies[] = {0, 0, 1, 1, 0x82};
+  size_t len = wire_encode_packet(record, sizeof(record), &h, ies, sizeof(ies));
+  TEST_ASSERT_EQUAL(WIRE_PACKET_HEADER_SIZE + sizeof(ies), len);
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PACKET, record[0]);
+  TEST_ASSERT_EQUAL_UINT8(WIRE_FORMAT_VERSION, record[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x04, record[2]);
+  TEST_ASSERT_EQUAL_UINT8(11, record[12]);
+  TEST_ASSERT_EQUAL_INT8(-70, (int8_t)record[13]);
+  // rx_us, delta_ref, track_id e ies_len fecham o cabeçalho fixo
+  TEST_ASSERT_EQUAL_HEX8(0xef, record[WIRE_PACKET_HEADER_SIZE - 11]);
+  TEST_ASSERT_EQUAL_HEX8(0xde, record[WIRE_PACKET_HEADER_SIZE - 8]);
+  TEST_ASSERT_EQUAL_HEX8(0x42, record[WIRE_PACKET_HEADER_SIZE - 7]);
+  TEST_ASSERT_EQUAL_HEX32(0x00c0ffee, get_u32(record + WIRE_PACKET_HEADER_SIZE - 6));
+  TEST_ASSERT_EQUAL_UINT8(sizeof(ies), record[WIRE_PACKET_HEADER_SIZE - 2]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(ies, record + WIRE_PACKET_HEADER_SIZE, sizeof(ies));
+
+  TEST_ASSERT_EQUAL(0, wire_encode_packet(record, WIRE_PACKET_HEADER_SIZE, &h, ies, sizeof(ies)));
+}
+
+void test_session_and_device() {
+  wire_session_t s = {1700000000, 1234, "cap", "node-01", "fw"};
+  size_t len = wire_encode_session(record, sizeof(record), &s);
+  TEST_ASSERT_EQUAL(2 + 4 + 4 + 3 + 3 + 7 + 2, len);
+  TEST_ASSERT_EQUAL_UINT8(7, record[14]);  // len de scanner_id após "cap"
+
+  wire_device_t d;
+  memset(&d, 0, sizeof(d));
+  d.flags = WIRE_DEVICE_FLAG_RANDOMIZED;
+  d.track_id = 77;
+  len = wire_encode_device(record, sizeof(record), &d);
+  TEST_ASSERT_EQUAL(WIRE_DEVICE_RECORD_SIZE, len);
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_DEVICE, record[0]);
+  TEST_ASSERT_EQUAL_HEX8(WIRE_DEVICE_FLAG_RANDOMIZED, record[len - 5]);
+  TEST_ASSERT_EQUAL_UINT32(77, get_u32(record + len - 4));
+
+  wire_source_t src = {{0x24, 0x6f, 0x28, 0x01, 0x02, 0x03}, 0xcafe1234};
+  len = wire_encode_source(record, sizeof(record), &src);
+  TEST_ASSERT_EQUAL(WIRE_SOURCE_RECORD_SIZE, len);
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_SOURCE, record[0]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(src.src, record + 2, 6);
+  TEST_ASSERT_EQUAL_HEX32(0xcafe1234, get_u32(record + 8));
+  TEST_ASSERT_EQUAL(0, wire_encode_source(record, WIRE_SOURCE_RECORD_SIZE - 1, &src));
+}
+
+void test_delta_repeats_and_keyframes() {
+  static wire_delta_t delta;
+  wire_delta_init(&delta, 64);
+  wire_packet_header_t h;
+  memset(&h, 0, sizeof(h));
+  const uint8_t sa[6] = {0xda, 0xa1, 0x19, 0x01, 0x02, 0x03};
+  memcpy(h.addr2, sa, 6);
+  memset(h.addr1, 0xff, 6);
+  memset(h.addr3, 0xff, 6);
+  h.pkt_seq = 1000;
+  h.rx_us = 5000000;
+  h.dwell_id = 7;
+  uint8_t ies[] = {0, 4, 'c', 'a', 's', 'a', 1, 1, 0x82};
+
+  // Primeiro probe: keyframe com a referência do slot
+  size_t len = wire_encode_packet_delta(&delta, record, sizeof(record), &h, ies, sizeof(ies));
+  TEST_ASSERT_EQUAL(WIRE_PACKET_HEADER_SIZE + sizeof(ies), len);
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PACKET, record[0]);
+  uint8_t ref = record[WIRE_PACKET_HEADER_SIZE - 7];
+  TEST_ASSERT_TRUE(ref >= 64 && ref < 64 + WIRE_DELTA_SLOTS);
+
+  // Repetição em outro canal: delta relativo ao keyframe
+  h.pkt_seq = 1003;
+  h.rx_us = 5020000;
+  h.dwell_id = 8;
+  h.channel = 6;
+  h.rssi_dbm = -58;
+  h.seq_ctrl = 0x1230;
+  len = wire_encode_packet_delta(&delta, record, sizeof(record), &h, ies, sizeof(ies));
+  TEST_ASSERT_EQUAL(WIRE_DELTA_RECORD_SIZE, len);
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_DELTA, record[0]);
+  TEST_ASSERT_EQUAL_UINT8(ref, record[2]);
+  TEST_ASSERT_EQUAL_UINT16(1000, record[3] | (record[4] << 8));
+  TEST_ASSERT_EQUAL_UINT16(3, record[5] | (record[6] << 8));
+  TEST_ASSERT_EQUAL_UINT32(20000, get_u32(record + 7));
+  TEST_ASSERT_EQUAL_UINT16(1, record[11] | (record[12] << 8));
+  TEST_ASSERT_EQUAL_UINT8(6, record[13]);
+  TEST_ASSERT_EQUAL_INT8(-58, (int8_t)record[14]);
+  TEST_ASSERT_EQUAL_HEX16(0x1230, record[15] | (record[16] << 8));
+
+  // Outro SSID (mesmo tamanho): IEs diferentes, novo keyframe
+  ies[2] = 'C';
+  len = wire_encode_packet_delta(&delta, record, sizeof(record), &h, ies, sizeof(ies));
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PACKET, record[0]);
+
+  // Outra trilha para o mesmo SA (entrada do correlator recriada): novo keyframe
+  h.track_id = 9;
+  wire_encode_packet_delta(&delta, record, sizeof(record), &h, ies, sizeof(ies));
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PACKET, record[0]);
+
+  // Keyframe periódico após WIRE_DELTA_KEYFRAME_INTERVAL deltas
+  for (uint8_t i = 0; i < WIRE_DELTA_KEYFRAME_INTERVAL; i++) {
+    h.pkt_seq++;
+    wire_encode_packet_delta(&delta, record, sizeof(record), &h, ies, sizeof(ies));
+    TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_DELTA, record[0]);
+  }
+  h.pkt_seq++;
+  wire_encode_packet_delta(&delta, record, sizeof(record), &h, ies, sizeof(ies));
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PACKET, record[0]);
+
+  // Keyframe também quando o offset de tempo passa de WIRE_DELTA_KEYFRAME_US
+  h.rx_us += WIRE_DELTA_KEYFRAME_US;
+  wire_encode_packet_delta(&delta, record, sizeof(record), &h, ies, sizeof(ies));
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PACKET, record[0]);
+  TEST_ASSERT_EQUAL_UINT32(5, delta.keyframes);
+  TEST_ASSERT_EQUAL_UINT32(1 + WIRE_DELTA_KEYFRAME_INTERVAL, delta.deltas);
+}
+
+void test_pcap_radiotap_layout() {
+  wire_pcap_t pcap = {1700000123, 250000, 0x11223344, 2437, -61, 120};
+  uint8_t frame[100];
+  for (size_t i = 0; i < sizeof(frame); i++) frame[i] = (uint8_t)i;
+  size_t len = wire_encode_pcap(record, sizeof(record), &pcap, frame, sizeof(frame));
+  TEST_ASSERT_EQUAL(WIRE_PCAP_HEADER_SIZE + sizeof(frame), len);
+  TEST_ASSERT_EQUAL_HEX8(WIRE_RECORD_PCAP, record[0]);
+
+  // Cabeçalho do registro pcap: cortado (incl_len < orig_len), ambos com o radiotap
+  const uint8_t* rec = record + 2;
+  TEST_ASSERT_EQUAL_UINT32(1700000123, get_u32(rec));
+  TEST_ASSERT_EQUAL_UINT32(250000, get_u32(rec + 4));
+  TEST_ASSERT_EQUAL_UINT32(WIRE_RADIOTAP_SIZE + 100, get_u32(rec + 8));
+  TEST_ASSERT_EQUAL_UINT32(WIRE_RADIOTAP_SIZE + 120, get_u32(rec + 12));
+
+  // Radiotap: TSFT alinhado em 8, canal alinhado em 2
+  const uint8_t* rt = rec + 16;
+  TEST_ASSERT_EQUAL_UINT8(0, rt[0]);
+  TEST_ASSERT_EQUAL_UINT16(WIRE_RADIOTAP_SIZE, rt[2] | (rt[3] << 8));
+  TEST_ASSERT_EQUAL_HEX32(0x2b, get_u32(rt + 4));
+  TEST_ASSERT_EQUAL_HEX32(0x11223344, get_u32(rt + 8));
+  TEST_ASSERT_EQUAL_HEX32(0, get_u32(rt + 12));
+  TEST_ASSERT_EQUAL_HEX8(0x00, rt[16]);  // cortado: os últimos 4 bytes não são o FCS
+  TEST_ASSERT_EQUAL_UINT16(2437, rt[18] | (rt[19] << 8));
+  TEST_ASSERT_EQUAL_INT8(-61, (int8_t)rt[22]);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(frame, rt + WIRE_RADIOTAP_SIZE, sizeof(frame));
+
+  TEST_ASSERT_EQUAL(0, wire_encode_pcap(record, WIRE_PCAP_HEADER_SIZE + 99, &pcap, frame, sizeof(frame)));
+
+  // Frame inteiro (incl_len == orig_len): o FCS está no fim e a flag vai marcada
+  pcap.orig_len = sizeof(frame);
+  wire_encode_pcap(record, sizeof(record), &pcap, frame, sizeof(frame));
+  TEST_ASSERT_EQUAL_UINT32(get_u32(rec + 8), get_u32(rec + 12));
+  TEST_ASSERT_EQUAL_HEX8(0x10, rt[16]);
+}
+
+static int run_tests() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc16_check_value);
+  RUN_TEST(test_frame_zero_runs);
+  RUN_TEST(test_frame_out_too_small);
+  RUN_TEST(test_packet_layout);
+  RUN_TEST(test_session_and_device);
+  RUN_TEST(test_delta_repeats_and_keyframes);
+  RUN_TEST(test_pcap_radiotap_layout);
+  return UNITY_END();
+}
+
+#ifdef ARDUINO
+#include <Arduino.h>
+void setup() {
+  delay(2000);  // aguarda o monitor serial do test runner
+  run_tests();
+}
+void loop() {}
+#else
+int main() {
+  return run_tests();
+}
+#endif
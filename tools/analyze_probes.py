@@ -7,6 +7,7 @@ Versão atualizada para trabalhar com o novo formato JSON Schema completo
 
 import json
 import argparse
+import struct
 import pandas as pd
 import matplotlib.pyplot as plt
 import numpy as np
@@ -15,7 +16,7 @@ from datetime import datetime, timedelta
 import seaborn as sns
 import re
 import os
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 from typing import Dict, List, Set, Optional, Tuple
 import warnings
 warnings.filterwarnings('ignore')
@@ -178,7 +179,8 @@ PROBE_DATA_SCHEMA = {
                         "channel": {"type": "integer"},
                         "freq_mhz": {"type": "integer"},
                         "band": {"type": "string"},
-                        "bandwidth_mhz": {"type": "integer"}
+                        "bandwidth_mhz": {"type": "integer"},
+                        "dwell_id": {"type": "integer"}
                     }
                 },
                 "ieee80211": {"type": "object"},
@@ -192,6 +194,572 @@ PROBE_DATA_SCHEMA = {
 }
 
 
+class WireDecoder:
+    """Decodificador do formato binário enquadrado do firmware (ver include/wire_format.h)
+
+    O stream é dividido em blocos pelo delimitador 0x00. Cada bloco é
+    decodificado via COBS e validado pelo CRC-16/CCITT-FALSE; blocos que não
+    passam na validação são tratados como texto (banner, "# STATS:" etc).
+    Registros de pacote são convertidos para o mesmo dicionário do formato
+    JSON Schema, para que o restante da análise funcione sem alterações.
+    """
+
+    # Versão 2 adicionou o fp_hash, a 3 o dwell_id, a 4 o rx_us, a 5 o
+    # delta_ref e a 6 o track_id (também no registro de dispositivo) ao
+    # registro de pacote; versões anteriores ainda são aceitas
+    FORMAT_VERSIONS = (1, 2, 3, 4, 5, 6)
+    RECORD_SESSION = 0x01
+    RECORD_PACKET = 0x02
+    RECORD_DEVICE = 0x03
+    RECORD_DELTA = 0x04
+    RECORD_SOURCE = 0x06
+    DELTA_REF_NONE = 0xFF
+    PACKET_HEADER_V1 = struct.Struct('<BBIIHBbHH6s6s6sHH')
+    PACKET_HEADER_V2 = struct.Struct('<BBIIHBbHH6s6s6sHIH')
+    PACKET_HEADER_V3 = struct.Struct('<BBIIHBbHH6s6s6sHIIH')
+    PACKET_HEADER_V4 = struct.Struct('<BBIIHBbHH6s6s6sHIIIH')
+    PACKET_HEADER_V5 = struct.Struct('<BBIIHBbHH6s6s6sHIIIBH')
+    PACKET_HEADER = struct.Struct('<BBIIHBbHH6s6s6sHIIIBIH')
+    DEVICE_RECORD_V5 = struct.Struct('<BBIII6sIIbbbHB')
+    DEVICE_RECORD = struct.Struct('<BBIII6sIIbbbHBI')
+    DELTA_RECORD = struct.Struct('<BBBHHIHBbH')
+    SOURCE_RECORD = struct.Struct('<BB6sI')
+
+    def __init__(self):
+        self.session = None
+        self.crc_errors = 0
+        self.unknown_records = 0
+        self.delta_refs = {}        # delta_ref -> campos do último keyframe
+        self.delta_records = 0
+        self.delta_unresolved = 0   # deltas cujo keyframe não foi recebido
+        # Stream do gateway ESP-NOW: sessão e keyframes por nó, selecionados
+        # pelos registros de origem (sem eles o stream é de um nó só)
+        self.source = None
+        self.sources = {}
+
+    @staticmethod
+    def crc16(data):
+        """CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)"""
+        crc = 0xFFFF
+        for byte in data:
+            crc ^= byte << 8
+            for _ in range(8):
+                crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+                crc &= 0xFFFF
+        return crc
+
+    @staticmethod
+    def cobs_decode(block):
+        """Decodifica um bloco COBS; retorna None se o bloco for inválido"""
+        out = bytearray()
+        i = 0
+        while i < len(block):
+            code = block[i]
+            if code == 0 or i + code > len(block):
+                return None
+            out += block[i + 1:i + code]
+            i += code
+            if code < 0xFF and i < len(block):
+                out.append(0)
+        return bytes(out)
+
+    def decode(self, content):
+        """Gera tuplas ('text', linha) ou ('record', dict) a partir do stream bruto"""
+        for block in content.split(b'\x00'):
+            if not block:
+                continue
+            record = self._decode_block(block)
+            if record is None:
+                # Não é um registro válido: tratar como texto
+                for line in block.decode('utf-8', errors='replace').splitlines():
+                    yield ('text', line)
+            elif record is not False:
+                yield ('record', record)
+
+    def _decode_block(self, block):
+        raw = self.cobs_decode(block)
+        if raw is None or len(raw) < 4:
+            return None
+        body, crc = raw[:-2], struct.unpack('<H', raw[-2:])[0]
+        if self.crc16(body) != crc:
+            if body[0] in (self.RECORD_SESSION, self.RECORD_PACKET, self.RECORD_DEVICE,
+                           self.RECORD_DELTA, self.RECORD_SOURCE) \
+                    and body[1] in self.FORMAT_VERSIONS:
+                self.crc_errors += 1
+            return None
+
+        record_type = body[0]
+        if record_type == self.RECORD_SESSION:
+            self.session = self._parse_session(body)
+            return False
+        if record_type == self.RECORD_PACKET:
+            return self._parse_packet(body)
+        if record_type == self.RECORD_DEVICE:
+            return self._parse_device(body)
+        if record_type == self.RECORD_DELTA:
+            return self._parse_delta(body)
+        if record_type == self.RECORD_SOURCE and len(body) >= self.SOURCE_RECORD.size:
+            self._select_source(body)
+            return False
+
+        self.unknown_records += 1
+        return False
+
+    def _select_source(self, body):
+        """Registro de origem do gateway: troca sessão e keyframes para os do nó"""
+        _, _, src, session = self.SOURCE_RECORD.unpack_from(body, 0)
+        self.sources[self.source] = (self.session, self.delta_refs)
+        self.source = (src, session)
+        self.session, self.delta_refs = self.sources.get(self.source, (None, {}))
+
+    def _parse_session(self, body):
+        epoch_s, uptime_ms = struct.unpack_from('<II', body, 2)
+        offset = 10
+        fields = []
+        for _ in range(3):
+            length = body[offset]
+            fields.append(body[offset + 1:offset + 1 + length].decode('utf-8', errors='replace'))
+            offset += 1 + length
+        return {
+            'epoch_s': epoch_s,
+            'uptime_ms': uptime_ms,
+            'capture_id': fields[0],
+            'scanner_id': fields[1],
+            'firmware': fields[2]
+        }
+
+    @staticmethod
+    def _mac(raw):
+        return ':'.join(f'{b:02x}' for b in raw)
+
+    def _parse_packet(self, body):
+        delta_ref = self.DELTA_REF_NONE
+        track_id = None
+        if body[1] == 1:
+            header = self.PACKET_HEADER_V1
+            (_, _, pkt_seq, epoch_s, epoch_ms, channel, rssi, frame_ctrl, duration,
+             addr1, addr2, addr3, seq_ctrl, ies_len) = header.unpack_from(body, 0)
+            fp_hash = dwell_id = rx_us = None
+        elif body[1] == 2:
+            header = self.PACKET_HEADER_V2
+            (_, _, pkt_seq, epoch_s, epoch_ms, channel, rssi, frame_ctrl, duration,
+             addr1, addr2, addr3, seq_ctrl, fp_hash, ies_len) = header.unpack_from(body, 0)
+            dwell_id = rx_us = None
+        elif body[1] == 3:
+            header = self.PACKET_HEADER_V3
+            (_, _, pkt_seq, epoch_s, epoch_ms, channel, rssi, frame_ctrl, duration,
+             addr1, addr2, addr3, seq_ctrl, fp_hash, dwell_id, ies_len) = header.unpack_from(body, 0)
+            rx_us = None
+        elif body[1] == 4:
+            header = self.PACKET_HEADER_V4
+            (_, _, pkt_seq, epoch_s, epoch_ms, channel, rssi, frame_ctrl, duration,
+             addr1, addr2, addr3, seq_ctrl, fp_hash, dwell_id, rx_us, ies_len) = header.unpack_from(body, 0)
+        elif body[1] == 5:
+            header = self.PACKET_HEADER_V5
+            (_, _, pkt_seq, epoch_s, epoch_ms, channel, rssi, frame_ctrl, duration,
+             addr1, addr2, addr3, seq_ctrl, fp_hash, dwell_id, rx_us, delta_ref,
+             ies_len) = header.unpack_from(body, 0)
+        else:
+            header = self.PACKET_HEADER
+            (_, _, pkt_seq, epoch_s, epoch_ms, channel, rssi, frame_ctrl, duration,
+             addr1, addr2, addr3, seq_ctrl, fp_hash, dwell_id, rx_us, delta_ref,
+             track_id, ies_len) = header.unpack_from(body, 0)
+        fields = {
+            'pkt_seq': pkt_seq, 'epoch_s': epoch_s, 'epoch_ms': epoch_ms, 'channel': channel,
+            'rssi': rssi, 'frame_ctrl': frame_ctrl, 'duration': duration, 'addr1': addr1,
+            'addr2': addr2, 'addr3': addr3, 'seq_ctrl': seq_ctrl, 'fp_hash': fp_hash,
+            'dwell_id': dwell_id, 'rx_us': rx_us, 'track_id': track_id,
+            'ies': body[header.size:header.size + ies_len]
+        }
+        if delta_ref != self.DELTA_REF_NONE:
+            self.delta_refs[delta_ref] = fields
+        return self._build_packet(fields)
+
+    def _parse_delta(self, body):
+        """Repetição de um keyframe: só canal, RSSI, seq_ctrl e instante mudam"""
+        (_, _, ref, key_seq, seq_offset, rx_offset_us, dwell_offset, channel, rssi,
+         seq_ctrl) = self.DELTA_RECORD.unpack_from(body, 0)
+        key = self.delta_refs.get(ref)
+        if key is None or key['pkt_seq'] & 0xFFFF != key_seq:
+            # Keyframe perdido ou anterior à conexão: aguardar o próximo
+            self.delta_unresolved += 1
+            return False
+        self.delta_records += 1
+        fields = dict(key)
+        key_ms = key['epoch_s'] * 1000 + key['epoch_ms'] + rx_offset_us // 1000
+        fields.update({
+            'pkt_seq': (key['pkt_seq'] + seq_offset) & 0xFFFFFFFF,
+            'epoch_s': key_ms // 1000,
+            'epoch_ms': key_ms % 1000,
+            'channel': channel,
+            'rssi': rssi,
+            'seq_ctrl': seq_ctrl,
+            'dwell_id': (key['dwell_id'] + dwell_offset) & 0xFFFFFFFF,
+            'rx_us': (key['rx_us'] + rx_offset_us) & 0xFFFFFFFF
+        })
+        return self._build_packet(fields)
+
+    def _build_packet(self, f):
+        """Dicionário no formato JSON Schema a partir dos campos do registro"""
+        pkt_seq, epoch_s, epoch_ms = f['pkt_seq'], f['epoch_s'], f['epoch_ms']
+        channel, rssi, seq_ctrl = f['channel'], f['rssi'], f['seq_ctrl']
+        frame_ctrl, duration = f['frame_ctrl'], f['duration']
+        addr1, addr2, addr3, ies = f['addr1'], f['addr2'], f['addr3'], f['ies']
+        fp_hash, dwell_id, rx_us, track_id = f['fp_hash'], f['dwell_id'], f['rx_us'], f['track_id']
+
+        # Reconstruir o frame (cabeçalho management + IEs) para frame_raw_hex
+        frame = struct.pack('<HH6s6s6sH', frame_ctrl, duration, addr1, addr2, addr3, seq_ctrl) + ies
+
+        session = self.session or {}
+        capture_ts = datetime.utcfromtimestamp(epoch_s).strftime('%Y-%m-%dT%H:%M:%S')
+        capture_ts += f'.{epoch_ms:03d}Z'
+
+        packet = {
+            'pkt_id': (f'{epoch_s:08x}-{pkt_seq & 0xFFFF:04x}-{(pkt_seq >> 16) & 0xFFFF:04x}-'
+                       f'0000-{epoch_s:08x}{epoch_ms:04x}'),
+            'radio': {
+                'channel': channel,
+                'freq_mhz': 2412 + (channel - 1) * 5,
+                'band': '2.4GHz',
+                'bandwidth_mhz': 20,
+                'antenna': 0
+            },
+            'ieee80211': {
+                'type': 'management',
+                'subtype': 'probe-request',
+                'duration': duration,
+                'da': self._mac(addr1),
+                'sa': self._mac(addr2),
+                'bssid': self._mac(addr3),
+                'seq_ctrl': seq_ctrl >> 4
+            },
+            'rssi_dbm': rssi,
+            'frame_raw_hex': frame[:32].hex(),
+            'mac_randomized': bool(addr2[0] & 0x02),
+            'oui': self._mac(addr2[:3]),
+            'vendor_inferred': 'Unknown'
+        }
+        packet.update(self._parse_ies(ies))
+        if fp_hash is not None:
+            packet['fingerprint']['ie_signature'] = f'{fp_hash:08x}'
+        if dwell_id is not None:
+            packet['radio']['dwell_id'] = dwell_id
+        if rx_us is not None:
+            packet['radio']['rx_us'] = rx_us
+        if track_id:
+            packet['track_id'] = track_id
+
+        return {
+            'capture_id': session.get('capture_id', ''),
+            'capture_ts': capture_ts,
+            'scanner_id': session.get('scanner_id', ''),
+            'firmware': session.get('firmware'),
+            'location': {'lat': None, 'lon': None, 'label': None},
+            'packet': packet
+        }
+
+    @staticmethod
+    def _iso(epoch_s):
+        return datetime.utcfromtimestamp(epoch_s).strftime('%Y-%m-%dT%H:%M:%S.000Z')
+
+    def _parse_device(self, body):
+        """Registro agregado: mesmo formato das linhas "# DEVICE:" do modo JSON"""
+        track_id = None
+        if body[1] < 6:
+            (_, _, window_start_s, first_seen_s, last_seen_s, sa, fp_hash, count,
+             rssi_min, rssi_max, rssi_avg, channels_mask, flags) = self.DEVICE_RECORD_V5.unpack_from(body, 0)
+        else:
+            (_, _, window_start_s, first_seen_s, last_seen_s, sa, fp_hash, count,
+             rssi_min, rssi_max, rssi_avg, channels_mask, flags,
+             track_id) = self.DEVICE_RECORD.unpack_from(body, 0)
+        session = self.session or {}
+        record = {
+            'type': 'device',
+            'capture_id': session.get('capture_id', ''),
+            'scanner_id': session.get('scanner_id', ''),
+            'window_start_ts': self._iso(window_start_s),
+            'sa': self._mac(sa),
+            'oui': self._mac(sa[:3]),
+            'mac_randomized': bool(flags & 0x01),
+            'vendor_inferred': 'Unknown',
+            'fp_hash': f'{fp_hash:08x}',
+            'first_seen_ts': self._iso(first_seen_s),
+            'last_seen_ts': self._iso(last_seen_s),
+            'count': count,
+            'rssi_min': rssi_min,
+            'rssi_max': rssi_max,
+            'rssi_avg': rssi_avg,
+            'channels': [ch for ch in range(1, 15) if channels_mask & (1 << ch)]
+        }
+        if track_id:
+            record['track_id'] = track_id
+        return record
+
+    @staticmethod
+    def _fnv1a(h, data):
+        for byte in data:
+            h = ((h ^ byte) * 16777619) & 0xFFFFFFFF
+        return h
+
+    @staticmethod
+    def _mcs_map_streams(mcs_map):
+        """Spatial streams de um mapa VHT/HE (2 bits por stream, 3 = não suportado)"""
+        streams = 0
+        for nss in range(8):
+            if (mcs_map >> (nss * 2)) & 0x03 != 0x03:
+                streams = nss + 1
+        return streams
+
+    @staticmethod
+    def _decode_ht(value):
+        info = int.from_bytes(value[0:2], 'little')
+        mcs = int.from_bytes(value[3:7], 'little')
+        return {
+            'present': True,
+            'mcs_set': f'0-{mcs.bit_length() - 1}' if mcs else None,
+            'spatial_streams': max((i + 1 for i in range(4) if value[3 + i]), default=0),
+            'ldpc': bool(info & 0x0001),
+            'width_40mhz': bool(info & 0x0002),
+            'sgi_20': bool(info & 0x0020),
+            'sgi_40': bool(info & 0x0040)
+        }
+
+    @classmethod
+    def _decode_vht(cls, value):
+        info = int.from_bytes(value[0:4], 'little')
+        return {
+            'present': True,
+            'spatial_streams': cls._mcs_map_streams(int.from_bytes(value[4:6], 'little')),
+            'channel_width_set': (info >> 2) & 0x03,
+            'rx_ldpc': bool(info & 0x00000010),
+            'sgi_80': bool(info & 0x00000020),
+            'sgi_160': bool(info & 0x00000040),
+            'su_beamformee': bool(info & 0x00001000),
+            'mu_beamformee': bool(info & 0x00100000)
+        }
+
+    @classmethod
+    def _decode_he(cls, value):
+        return {
+            'present': True,
+            'spatial_streams': cls._mcs_map_streams(int.from_bytes(value[18:20], 'little')),
+            'channel_width_set': (value[7] >> 1) & 0x7F,
+            'twt_requester': bool(value[1] & 0x02)
+        }
+
+    @staticmethod
+    def _decode_ext_caps(value):
+        def bit(n):
+            return n // 8 < len(value) and bool((value[n // 8] >> (n % 8)) & 0x01)
+        return {
+            'hex': value.hex(),
+            'bss_transition': bit(19),
+            'interworking': bit(31),
+            'opmode_notification': bit(62),
+            'ftm_initiator': bit(71)
+        }
+
+    @classmethod
+    def _parse_ies(cls, ies):
+        """Extrai os mesmos campos que o firmware gera no formato JSON"""
+        fields = {
+            'probe': {'ssid': '', 'ssid_hidden': False},
+            'ht_capabilities': None,
+            'vht_capabilities': None,
+            'he_capabilities': None,
+            'eht_capabilities': None,
+            'extended_capabilities': None,
+            'vendor_ies': [],
+            'ies_raw': []
+        }
+        supported_rates = []
+        extended_rates = []
+        fp = 2166136261
+
+        offset = 0
+        while offset + 2 <= len(ies):
+            ie_id, ie_len = ies[offset], ies[offset + 1]
+            value = ies[offset + 2:offset + 2 + ie_len]
+            if len(value) < ie_len:
+                break
+
+            # Mesmo fingerprint do firmware: IDs em ordem + corpos dos IEs de capacidade
+            fp = cls._fnv1a(fp, bytes([ie_id]))
+            if ie_id in (1, 50, 45, 191, 127, 255):
+                fp = cls._fnv1a(fp, value)
+            elif ie_id == 221:
+                fp = cls._fnv1a(fp, value[:4])
+
+            fields['ies_raw'].append({'id': ie_id, 'len': ie_len, 'value_hex': value.hex()})
+
+            if ie_id == 0 and 0 < ie_len <= 32:
+                fields['probe']['ssid'] = ''.join(chr(c) for c in value if 32 <= c <= 126)
+            elif ie_id == 1:
+                supported_rates += [r & 0x7F for r in value]
+            elif ie_id == 50:
+                extended_rates += [r & 0x7F for r in value]
+            elif ie_id == 45 and ie_len >= 26 and fields['ht_capabilities'] is None:
+                fields['ht_capabilities'] = cls._decode_ht(value)
+            elif ie_id == 191 and ie_len >= 12 and fields['vht_capabilities'] is None:
+                fields['vht_capabilities'] = cls._decode_vht(value)
+            elif ie_id == 127 and fields['extended_capabilities'] is None:
+                fields['extended_capabilities'] = cls._decode_ext_caps(value)
+            elif ie_id == 255 and ie_len >= 1:
+                # Element ID Extension: o primeiro byte identifica o elemento
+                if value[0] == 35 and ie_len >= 22 and fields['he_capabilities'] is None:
+                    fields['he_capabilities'] = cls._decode_he(value)
+                elif value[0] == 108 and ie_len >= 12 and fields['eht_capabilities'] is None:
+                    fields['eht_capabilities'] = {'present': True}
+            elif ie_id == 221 and ie_len >= 3:
+                fields['vendor_ies'].append({
+                    'oui': ':'.join(f'{b:02x}' for b in value[:3]),
+                    'vendor_type': value[3] if ie_len > 3 else 0,
+                    'payload_hex': value[4:].hex(),
+                    'meaning': ''
+                })
+            offset += 2 + ie_len
+
+        if supported_rates:
+            fields['supported_rates'] = supported_rates
+        if extended_rates:
+            fields['extended_rates'] = extended_rates
+
+        fields['fingerprint'] = {'ie_signature': f'{fp:08x}', 'confidence': 0.65}
+
+        return fields
+
+
+class ColumnarReader:
+    """Leitor do arquivo colunar .pcol gerado por tools/ingest (probe_ingest)
+
+    Cada coluna é um array contíguo mapeado direto com np.memmap. O
+    probe_ingest já validou, deduplicou e aplicou as âncoras "# TIME:", então
+    os probes são montados com os campos que o restante da análise usa; o
+    detalhe por IE (vendor_ies, ies_raw, capacidades HT/VHT) não é carregado
+    nesse caminho. As linhas de meta ("# STATS:", "# SUMMARY:", "# INGEST:")
+    seguem como texto.
+    """
+
+    MAGIC = b'PROBECOL'
+    VERSION = 1
+    HEADER = struct.Struct('<8sII')
+    DIR_ENTRY = struct.Struct('<12s20s8sQQQ')
+    # Flags da coluna probes.flags (INGEST_PROBE_* em tools/ingest/ingest.h)
+    PROBE_RANDOMIZED = 0x01
+    PROBE_HAS_RX_US = 0x02
+    PROBE_HAS_FP = 0x08
+    PROBE_ANCHORED = 0x10
+    DEVICE_RANDOMIZED = 0x01
+
+    def __init__(self, path):
+        data = np.memmap(path, dtype=np.uint8, mode='r')
+        magic, version, count = self.HEADER.unpack_from(data, 0)
+        if magic != self.MAGIC or version != self.VERSION:
+            raise ValueError(f'{path}: arquivo .pcol com versão {version} não suportada')
+        self.tables = defaultdict(dict)
+        for i in range(count):
+            table, name, dtype, offset, length, _ = self.DIR_ENTRY.unpack_from(
+                data, self.HEADER.size + i * self.DIR_ENTRY.size)
+            dtype = np.dtype(dtype.rstrip(b'\0').decode())
+            column = np.frombuffer(data, dtype=dtype, count=length, offset=offset)
+            self.tables[table.rstrip(b'\0').decode()][name.rstrip(b'\0').decode()] = column
+
+        offsets = self.tables['strings']['offsets'].tolist()
+        blob = self.tables['strings']['blob'].tobytes()
+        self.strings = [blob[offsets[i]:offsets[i + 1]].decode('utf-8', errors='replace')
+                        for i in range(len(offsets) - 1)]
+
+    @staticmethod
+    def _macs(sa):
+        """SA em u64 -> strings "aa:bb:..", convertendo cada MAC distinto uma vez"""
+        unique, inverse = np.unique(sa, return_inverse=True)
+        names = [':'.join(f'{(v >> shift) & 0xFF:02x}' for shift in range(40, -8, -8))
+                 for v in unique.tolist()]
+        return [names[i] for i in inverse.tolist()]
+
+    @staticmethod
+    def _iso(ts_us):
+        return [ts + 'Z' for ts in np.datetime_as_string(ts_us.astype('datetime64[us]'), unit='ms')]
+
+    def meta_lines(self):
+        return [self.strings[i] for i in self.tables['meta']['line'].tolist()]
+
+    def probes(self):
+        """Probes no formato do dicionário JSON Schema (campos usados na análise)"""
+        # Colunas como listas: indexar arrays numpy elemento a elemento é lento
+        c = {name: column.tolist() for name, column in self.tables['probes'].items()}
+        strings = self.strings
+        macs = self._macs(self.tables['probes']['sa'])
+        capture_ts = self._iso(self.tables['probes']['ts_us'])
+        probes = []
+        for i, sa in enumerate(macs):
+            flags = c['flags'][i]
+            channel = c['channel'][i]
+            radio = {'channel': channel, 'freq_mhz': 2412 + (channel - 1) * 5,
+                     'dwell_id': c['dwell_id'][i]}
+            if flags & self.PROBE_HAS_RX_US:
+                radio['rx_us'] = c['rx_us'][i]
+            packet = {
+                'radio': radio,
+                'ieee80211': {'sa': sa, 'seq_ctrl': c['seq'][i]},
+                'rssi_dbm': c['rssi'][i],
+                'mac_randomized': bool(flags & self.PROBE_RANDOMIZED),
+                'oui': sa[:8],
+                'vendor_inferred': strings[c['vendor'][i]],
+                'probe': {'ssid': strings[c['ssid'][i]]}
+            }
+            if flags & self.PROBE_HAS_FP:
+                packet['fingerprint'] = {'ie_signature': f'{c["fp_hash"][i]:08x}'}
+            if c['track_id'][i]:
+                packet['track_id'] = c['track_id'][i]
+            probe = {
+                'capture_id': strings[c['capture'][i]],
+                'capture_ts': capture_ts[i],
+                'scanner_id': strings[c['scanner'][i]],
+                'packet': packet
+            }
+            if flags & self.PROBE_ANCHORED:
+                probe['timestamp_us'] = c['ts_us'][i]
+            probes.append(probe)
+        return probes
+
+    def devices(self):
+        """Registros agregados com as mesmas chaves de WireDecoder._parse_device"""
+        c = {name: column.tolist() for name, column in self.tables['devices'].items()}
+        strings = self.strings
+        macs = self._macs(self.tables['devices']['sa'])
+        window_start = self._iso(self.tables['devices']['window_start_us'])
+        first_seen = self._iso(self.tables['devices']['first_seen_us'])
+        last_seen = self._iso(self.tables['devices']['last_seen_us'])
+        records = []
+        for i, sa in enumerate(macs):
+            mask = c['channels_mask'][i]
+            record = {
+                'type': 'device',
+                'capture_id': strings[c['capture'][i]],
+                'scanner_id': strings[c['scanner'][i]],
+                'window_start_ts': window_start[i],
+                'sa': sa,
+                'oui': sa[:8],
+                'mac_randomized': bool(c['flags'][i] & self.DEVICE_RANDOMIZED),
+                'vendor_inferred': strings[c['vendor'][i]],
+                'fp_hash': f'{c["fp_hash"][i]:08x}',
+                'first_seen_ts': first_seen[i],
+                'last_seen_ts': last_seen[i],
+                'count': c['count'][i],
+                'rssi_min': c['rssi_min'][i],
+                'rssi_max': c['rssi_max'][i],
+                'rssi_avg': c['rssi_avg'][i],
+                'channels': [ch for ch in range(1, 15) if mask & (1 << ch)]
+            }
+            if c['window_ms'][i]:
+                record['window_ms'] = c['window_ms'][i]
+            if c['track_id'][i]:
+                record['track_id'] = c['track_id'][i]
+            records.append(record)
+        return records
+
+
 @dataclass
 class DeviceInfo:
     """Estrutura para armazenar informações de dispositivos"""
@@ -207,6 +775,8 @@ class DeviceInfo:
     vendor_ies: Set[str]
     fingerprints: Set[str]
     ssids: Set[str]
+    # (scanner_id, capture_id, track_id): os track_id recomeçam a cada boot do nó
+    tracks: Set[Tuple[str, str, int]] = field(default_factory=set)
 
 
 def validate_probe_data(data):
@@ -336,6 +906,9 @@ class ProbeAnalyzer:
         self.log_file = log_file
         self.probe_data = []
         self.stats_data = []
+        self.device_records = []  # registros agregados "device seen" (OUTPUT_MODE_AGGREGATE)
+        self.time_anchors = {}    # última âncora "# TIME:" por (scanner_id, capture_id)
+        self.window_summaries = []  # linhas "# SUMMARY:" (HLL e top-N por janela)
         self.date_suffix = self._extract_date_suffix(log_file)
         self.devices = {}  # Dicionário de DeviceInfo por MAC
 
@@ -351,7 +924,7 @@ class ProbeAnalyzer:
     def _extract_date_suffix(self, log_file):
         """Extrai o sufixo de data do nome do arquivo de log"""
         basename = os.path.basename(log_file)
-        match = re.search(r'_(\d{8}_\d{6})\.log$', basename)
+        match = re.search(r'_(\d{8}_\d{6})\.(log|pcol)$', basename)
         if match:
             return match.group(1)
         return datetime.now().strftime("%Y%m%d_%H%M%S")
@@ -364,61 +937,103 @@ class ProbeAnalyzer:
         invalid_count = 0
         schema_errors = defaultdict(int)
 
-        with open(self.log_file, 'r') as f:
-            for line_num, line in enumerate(f, 1):
-                line = line.strip()
-                if not line or line.startswith('Warning!') or line.startswith('==='):
+        with open(self.log_file, 'rb') as f:
+            content = f.read(len(ColumnarReader.MAGIC))
+            if content != ColumnarReader.MAGIC:
+                content += f.read()
+
+        if content == ColumnarReader.MAGIC:
+            # Já validado pelo probe_ingest: descartes vêm na linha "# INGEST:"
+            print("Arquivo colunar do probe_ingest detectado...")
+            reader = ColumnarReader(self.log_file)
+            self.probe_data = reader.probes()
+            self.device_records = reader.devices()
+            valid_count = len(self.probe_data)
+            decoder = None
+            entries = (('text', line) for line in reader.meta_lines())
+        # Logs do formato binário contêm delimitadores 0x00; texto puro não
+        elif b'\x00' in content:
+            print("Formato binário detectado, decodificando registros...")
+            decoder = WireDecoder()
+            entries = decoder.decode(content)
+        else:
+            decoder = None
+            entries = (('text', line) for line in
+                       content.decode('utf-8', errors='replace').splitlines())
+
+        for line_num, (kind, entry) in enumerate(entries, 1):
+            if kind == 'record' and entry.get('type') == 'device':
+                self.device_records.append(entry)
+                continue
+            if kind == 'record':
+                self._apply_time_anchor(entry)
+                if self._accept_probe(entry, schema_errors):
+                    valid_count += 1
+                else:
+                    invalid_count += 1
+                continue
+
+            line = entry.strip()
+            if not line or line.startswith('Warning!') or line.startswith('==='):
+                continue
+
+            try:
+                if line.startswith('# STATS:'):
+                    # Linha de estatísticas
+                    json_part = line.replace('# STATS: ', '')
+                    data = json.loads(json_part)
+                    self.stats_data.append(data)
+                elif line.startswith('# TIME:'):
+                    # Âncora do relógio de captura (rx_us -> epoch)
+                    anchor = json.loads(line[len('# TIME:'):])
+                    if anchor.get('rx_us') is not None:
+                        key = (anchor.get('scanner_id', ''), anchor.get('capture_id', ''))
+                        self.time_anchors[key] = anchor
+                elif line.startswith('# DEVICE:'):
+                    # Registro agregado por dispositivo
+                    self.device_records.append(json.loads(line[len('# DEVICE:'):]))
+                elif line.startswith('# SUMMARY:'):
+                    # Resumo por janela: estimativas de dispositivos distintos e top-N
+                    self.window_summaries.append(json.loads(line[len('# SUMMARY:'):]))
+                elif line.startswith('# INGEST:'):
+                    # Contadores do probe_ingest: registros descartados antes do .pcol
+                    report = json.loads(line[len('# INGEST:'):])
+                    invalid_count += report.get('invalid', 0)
+                    for error, count in report.get('errors', {}).items():
+                        schema_errors[error] += count
+                    if report.get('duplicates'):
+                        print(f"probe_ingest descartou {report['duplicates']} registros repetidos")
+                elif line.startswith('#') or 'configurado' in line.lower():
+                    # Linhas de log do sistema, ignorar
                     continue
+                else:
+                    # Dados de probe request no formato JSON Schema
+                    data = json.loads(line)
+                    self._apply_time_anchor(data)
 
-                try:
-                    if line.startswith('# STATS:'):
-                        # Linha de estatísticas
-                        json_part = line.replace('# STATS: ', '')
-                        data = json.loads(json_part)
-                        self.stats_data.append(data)
-                    elif line.startswith('#') or 'configurado' in line.lower():
-                        # Linhas de log do sistema, ignorar
-                        continue
+                    if self._accept_probe(data, schema_errors):
+                        valid_count += 1
                     else:
-                        # Dados de probe request no formato JSON Schema
-                        data = json.loads(line)
-
-                        # Validar contra JSON Schema
-                        is_valid, error_msg = validate_probe_data(data)
-
-                        if is_valid:
-                            # Validação adicional dos campos IEEE 802.11
-                            packet = data.get('packet', {})
-                            ieee80211 = packet.get('ieee80211', {})
-
-                            if validate_ieee80211_required_fields(ieee80211):
-                                # Validação adicional de integridade do packet
-                                packet_valid, packet_error = \
-                                    validate_packet_integrity(packet)
-
-                                if packet_valid:
-                                    self.probe_data.append(data)
-                                    valid_count += 1
-                                else:
-                                    invalid_count += 1
-                                    error_key = ("packet_integrity: " +
-                                                 f"{packet_error}")
-                                    schema_errors[error_key] += 1
-                            else:
-                                invalid_count += 1
-                                schema_errors["ieee80211_invalid"] += 1
-                        else:
-                            invalid_count += 1
-                            schema_errors[error_msg] += 1
-
-                except json.JSONDecodeError as e:
-                    print(f"Erro JSON na linha {line_num}: {e}")
-                    invalid_count += 1
-                    schema_errors["json_decode_error"] += 1
-                except Exception as e:
-                    print(f"Erro inesperado na linha {line_num}: {e}")
-                    invalid_count += 1
-                    schema_errors["unexpected_error"] += 1
+                        invalid_count += 1
+
+            except json.JSONDecodeError as e:
+                print(f"Erro JSON na linha {line_num}: {e}")
+                invalid_count += 1
+                schema_errors["json_decode_error"] += 1
+            except Exception as e:
+                print(f"Erro inesperado na linha {line_num}: {e}")
+                invalid_count += 1
+                schema_errors["unexpected_error"] += 1
+
+        if decoder is not None and decoder.crc_errors > 0:
+            invalid_count += decoder.crc_errors
+            schema_errors["binary_crc_error"] += decoder.crc_errors
+        if decoder is not None and decoder.delta_unresolved > 0:
+            # Deltas sem keyframe (início do stream ou registros perdidos)
+            invalid_count += decoder.delta_unresolved
+            schema_errors["binary_delta_unresolved"] += decoder.delta_unresolved
+        if decoder is not None and decoder.delta_records > 0:
+            print(f"Reconstruídos {decoder.delta_records} probes a partir de registros delta")
 
         # Relatório de validação
         total_entries = valid_count + invalid_count
@@ -431,6 +1046,18 @@ class ProbeAnalyzer:
             'valid_rate': valid_count/total_entries*100 if total_entries > 0 else 0
         }
 
+        if self.device_records:
+            print(f"Carregados {len(self.device_records)} registros agregados de dispositivos")
+        if self.window_summaries:
+            peak = max(self.window_summaries, key=lambda s: s.get('unique_macs', 0))
+            print(f"Carregados {len(self.window_summaries)} resumos de janela; pico de "
+                  f"~{peak.get('unique_macs', 0)} MACs / ~{peak.get('unique_fingerprints', 0)} "
+                  f"fingerprints distintos (±{peak.get('std_error', 0) * 100:.1f}%) "
+                  f"em {peak.get('window_start_ts', '?')}")
+
+        self._report_output_overruns()
+        self._report_health_resets()
+
         if total_entries > 0:
             print(f"Carregados {valid_count} probe requests válidos e "
                   f"{len(self.stats_data)} estatísticas")
@@ -456,6 +1083,46 @@ class ProbeAnalyzer:
         # Processar dados dos dispositivos
         self._process_devices()
 
+    def _apply_time_anchor(self, data):
+        """Recalcula capture_ts a partir de rx_us e da última âncora do mesmo boot"""
+        packet = data.get('packet')
+        if not isinstance(packet, dict):
+            return
+        rx_us = (packet.get('radio') or {}).get('rx_us')
+        anchor = self.time_anchors.get((data.get('scanner_id', ''), data.get('capture_id', '')))
+        if rx_us is None or anchor is None:
+            return
+        # rx_us é um contador de 32 bits: diferença com sinal em relação à âncora
+        delta = ((rx_us - anchor['rx_us'] + 2**31) % 2**32) - 2**31
+        epoch_us = anchor['epoch_s'] * 1000000 + anchor['epoch_frac_us'] + delta
+        data['timestamp_us'] = epoch_us
+        data['capture_ts'] = datetime.utcfromtimestamp(epoch_us / 1e6).strftime(
+            '%Y-%m-%dT%H:%M:%S.%f')[:-3] + 'Z'
+
+    def _accept_probe(self, data, schema_errors):
+        """Valida um probe request decodificado e o armazena se for válido"""
+        # Validar contra JSON Schema
+        is_valid, error_msg = validate_probe_data(data)
+        if not is_valid:
+            schema_errors[error_msg] += 1
+            return False
+
+        # Validação adicional dos campos IEEE 802.11
+        packet = data.get('packet', {})
+        ieee80211 = packet.get('ieee80211', {})
+        if not validate_ieee80211_required_fields(ieee80211):
+            schema_errors["ieee80211_invalid"] += 1
+            return False
+
+        # Validação adicional de integridade do packet
+        packet_valid, packet_error = validate_packet_integrity(packet)
+        if not packet_valid:
+            schema_errors[f"packet_integrity: {packet_error}"] += 1
+            return False
+
+        self.probe_data.append(data)
+        return True
+
     def _get_output_directories(self, base_dir='./data/analyze'):
         """Retorna os diretórios de saída organizados por timestamp"""
         # Diretório principal para o markdown
@@ -513,6 +1180,39 @@ class ProbeAnalyzer:
         except Exception as e:
             print(f"Erro ao gerar relatório de validação: {e}")
 
+    def _report_output_overruns(self):
+        """Avisa quando o firmware descartou registros com o ring de TX cheio"""
+        # Contadores acumulados desde o boot: vale a última estatística de cada nó
+        last_output = {}
+        for stats in self.stats_data:
+            if 'output' in stats:
+                last_output[stats.get('scanner_id', '')] = stats['output']
+
+        for scanner_id, output in last_output.items():
+            dropped = output.get('dropped_records', 0)
+            if dropped > 0:
+                baud = output.get('baud', 0)
+                link = f"{baud} baud" if baud else output.get('transport', '')
+                print(f"Aviso: {scanner_id} descartou {dropped} registros "
+                      f"({output.get('dropped_bytes', 0)} bytes) na saída {link}; "
+                      f"aumente monitor_speed ou use OUTPUT_FORMAT_BINARY")
+
+    def _report_health_resets(self):
+        """Lista os boots causados pelo monitor de saúde ou pelo watchdog"""
+        # Um aviso por boot (capture_id muda a cada boot)
+        seen = set()
+        for stats in self.stats_data:
+            health = stats.get('health')
+            if not health or health.get('last_trigger', 'none') == 'none':
+                continue
+            key = (stats.get('scanner_id', ''), stats.get('capture_id', ''))
+            if key in seen:
+                continue
+            seen.add(key)
+            print(f"Aviso: {key[0]} reiniciou por {health['last_trigger']} "
+                  f"após {health.get('last_uptime_s', 0)}s (reset: "
+                  f"{health.get('reset_reason', '?')}); capture {key[1]}")
+
     def _process_devices(self):
         """Processa dados de dispositivos a partir dos probe requests"""
         for probe in self.probe_data:
@@ -569,6 +1269,45 @@ class ProbeAnalyzer:
                 if ssid:
                     device.ssids.add(ssid)
 
+            if packet.get('track_id'):
+                device.tracks.add((probe.get('scanner_id', ''), probe.get('capture_id', ''),
+                                   packet['track_id']))
+
+        # Registros agregados: cada um resume vários probes de um dispositivo
+        for record in self.device_records:
+            mac = record['sa']
+            first_seen = datetime.fromisoformat(record['first_seen_ts'].replace('Z', '+00:00'))
+            last_seen = datetime.fromisoformat(record['last_seen_ts'].replace('Z', '+00:00'))
+
+            if mac not in self.devices:
+                self.devices[mac] = DeviceInfo(
+                    mac=mac,
+                    vendor=self.vendor_db.get_vendor_name(mac),
+                    randomized=self.vendor_db.is_randomized_mac(mac),
+                    first_seen=first_seen,
+                    last_seen=last_seen,
+                    probe_count=0,
+                    channels=set(),
+                    rssi_values=[],
+                    frequencies=set(),
+                    vendor_ies=set(),
+                    fingerprints=set(),
+                    ssids=set()
+                )
+
+            device = self.devices[mac]
+            device.first_seen = min(device.first_seen, first_seen)
+            device.last_seen = max(device.last_seen, last_seen)
+            device.probe_count += record['count']
+            device.channels.update(record['channels'])
+            device.frequencies.update(2412 + (ch - 1) * 5 for ch in record['channels'])
+            device.rssi_values.append(record['rssi_avg'])
+            if record.get('fp_hash'):
+                device.fingerprints.add(record['fp_hash'])
+            if record.get('track_id'):
+                device.tracks.add((record.get('scanner_id', ''), record.get('capture_id', ''),
+                                   record['track_id']))
+
     def analyze_devices(self):
         """Análise avançada de dispositivos detectados"""
         total_devices = len(self.devices)
@@ -579,14 +1318,25 @@ class ProbeAnalyzer:
         vendor_count = Counter(dev.vendor for dev in self.devices.values())
         known_vendors = sum(1 for d in self.devices.values() if d.vendor != 'Unknown')
 
+        # Dispositivos físicos: MACs da mesma trilha do correlator do nó contam uma vez
+        tracks = set()
+        for dev in self.devices.values():
+            tracks.update(dev.tracks)
+        untracked = sum(1 for dev in self.devices.values() if not dev.tracks)
+        physical_devices = len(tracks) + untracked if tracks else None
+
         # Mostrar apenas resumo no console
         print(f"\n📱 Dispositivos: {total_devices} únicos, {known_vendors} identificados, {randomized_devices} randomizados")
+        if physical_devices is not None:
+            print(f"🔗 Trilhas: {len(tracks)} (MACs randomizados ligados no nó), ~{physical_devices} dispositivos físicos")
 
         # Armazenar estatísticas para o markdown
         self._device_stats = {
             'total_devices': total_devices,
             'randomized_devices': randomized_devices,
             'known_vendors': known_vendors,
+            'tracks': len(tracks),
+            'physical_devices': physical_devices,
             'vendor_count': vendor_count,
             'most_active': sorted(self.devices.items(),
                                 key=lambda x: x[1].probe_count, reverse=True)[:10]
@@ -1199,6 +1949,10 @@ class ProbeAnalyzer:
                 f.write(f"- **Total de dispositivos únicos:** {total_devices}\n")
                 f.write(f"- **Dispositivos com MAC randomizado:** {randomized} ({randomized/total_devices*100:.1f}%)\n")
                 f.write(f"- **Fabricantes identificados:** {known_vendors} ({known_vendors/total_devices*100:.1f}%)\n")
+                device_stats = getattr(self, '_device_stats', {})
+                if device_stats.get('physical_devices') is not None:
+                    f.write(f"- **Trilhas (track_id):** {device_stats['tracks']}, "
+                            f"~{device_stats['physical_devices']} dispositivos físicos\n")
 
                 # Informações da base de vendors
                 if self.vendor_db.loaded:
@@ -1383,7 +2137,7 @@ def main():
     try:
         analyzer = ProbeAnalyzer(args.log_file, args.vendors)
 
-        if not analyzer.probe_data:
+        if not analyzer.probe_data and not analyzer.device_records:
             print("Erro: Nenhum dado válido encontrado no arquivo de log")
             return 1
 
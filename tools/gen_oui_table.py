@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""
+Gera src/oui_table_data.cpp a partir de tools/vendors/mac-vendors-export.json
+
+Tabela ordenada de OUIs de 24 bits (blocos MA-L) para busca binária no
+firmware, com os nomes deduplicados em um único pool de strings. Todos os
+arrays são const e ficam na flash (.rodata), sem custo de RAM.
+
+Executado automaticamente pelo PlatformIO (extra_scripts = pre:...) antes de
+cada build; só regenera quando o JSON ou este script mudam. Também pode ser
+executado manualmente:
+
+    python3 tools/gen_oui_table.py
+"""
+
+import json
+import os
+import sys
+
+
+
+def project_paths(root):
+    return (os.path.join(root, 'tools', 'vendors', 'mac-vendors-export.json'),
+            os.path.join(root, 'src', 'oui_table_data.cpp'),
+            os.path.join(root, 'tools', 'gen_oui_table.py'))
+
+
+def c_string(raw):
+    """Literal C com escapes octais (nunca ambíguos com o caractere seguinte)"""
+    out = []
+    for b in raw:
+        if b in (0x22, 0x5C) or b < 0x20 or b > 0x7E or b == 0x3F:
+            out.append('\\%03o' % b)
+        else:
+            out.append(chr(b))
+    return '"' + ''.join(out) + '\\0"'
+
+
+def load_entries(path):
+    with open(path, 'r', encoding='utf-8') as f:
+        vendors = json.load(f)
+
+    entries = {}
+    for vendor in vendors:
+        if vendor.get('blockType') != 'MA-L':
+            continue
+        prefix = vendor.get('macPrefix', '').replace(':', '')
+        name = ' '.join(vendor.get('vendorName', '').split())
+        if len(prefix) != 6 or not name:
+            continue
+        entries.setdefault(int(prefix, 16), name)
+    return sorted(entries.items())
+
+
+def generate(source, output):
+    entries = load_entries(source)
+
+    names = []
+    name_ids = {}
+    offsets = []
+    pool_size = 0
+    for _, name in entries:
+        if name not in name_ids:
+            name_ids[name] = len(names)
+            names.append(name)
+            offsets.append(pool_size)
+            pool_size += len(name.encode('utf-8')) + 1
+
+    if len(names) > 0xFFFF:
+        raise ValueError('mais de 65535 vendors distintos: oui_name_ids precisa de 32 bits')
+
+    lines = [
+        '// Arquivo gerado por tools/gen_oui_table.py - não editar',
+        f'// Fonte: tools/vendors/mac-vendors-export.json ({len(entries)} OUIs, {len(names)} vendors)',
+        '',
+        '#include "oui_table.h"',
+        '',
+        f'const uint32_t oui_table_size = {len(entries)};',
+        '',
+        'const uint32_t oui_keys[] = {',
+    ]
+    for i in range(0, len(entries), 8):
+        lines.append('  ' + ', '.join(f'0x{oui:06X}' for oui, _ in entries[i:i + 8]) + ',')
+    lines += ['};', '', 'const uint16_t oui_name_ids[] = {']
+    for i in range(0, len(entries), 12):
+        lines.append('  ' + ', '.join(str(name_ids[name]) for _, name in entries[i:i + 12]) + ',')
+    lines += ['};', '', 'const uint32_t oui_name_offsets[] = {']
+    for i in range(0, len(offsets), 10):
+        lines.append('  ' + ', '.join(str(o) for o in offsets[i:i + 10]) + ',')
+    lines += ['};', '', 'const char oui_names[] =']
+    for name in names:
+        lines.append('  ' + c_string(name.encode('utf-8')))
+    lines += ['  ;', '']
+
+    with open(output, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(lines))
+
+    print(f'gen_oui_table: {len(entries)} OUIs, {len(names)} vendors, pool {pool_size} bytes -> {output}')
+
+
+def needs_update(source, output, script):
+    if not os.path.exists(output):
+        return True
+    mtime = os.path.getmtime(output)
+    return os.path.getmtime(source) > mtime or os.path.getmtime(script) > mtime
+
+
+if __name__ == '__main__':
+    source, output, _ = project_paths(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+    generate(source, output)
+    sys.exit(0)
+
+# Execução como extra_script do PlatformIO (SCons não define __file__)
+try:
+    Import('env')  # noqa: F821
+    source, output, script = project_paths(env.subst('$PROJECT_DIR'))  # noqa: F821
+    if needs_update(source, output, script):
+        generate(source, output)
+except NameError:
+    pass
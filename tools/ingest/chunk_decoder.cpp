@@ -0,0 +1,641 @@
+#include <string.h>
+#include "ingest.h"
+#include "json_reader.h"
+#include "wire_format.h"
+#include "probe_record.h"
+#include "ie_parser.h"
+
+// Fase 1: bytes de um chunk -> eventos. Espelha WireDecoder e load_data()
+// de tools/analyze_probes.py; nada aqui depende de chunks anteriores.
+
+const char* const ingest_reject_names[INGEST_REJECT_COUNT] = {
+  "json_decode_error",
+  "Campo obrigatório ausente: capture_id",
+  "Campo obrigatório ausente: capture_ts",
+  "Campo obrigatório ausente: scanner_id",
+  "Campo obrigatório ausente: packet",
+  "Campo obrigatório do packet ausente: pkt_id",
+  "Campo obrigatório do packet ausente: ieee80211",
+  "Campo obrigatório do packet ausente: rssi_dbm",
+  "Campo obrigatório do packet ausente: frame_raw_hex",
+  "Tipo de campo inválido",
+  "capture_ts deve estar em formato ISO8601",
+  "ieee80211_invalid",
+  "packet_integrity: RSSI fora do range válido",
+  "packet_integrity: Canal WiFi inválido",
+  "packet_integrity: Formato MAC inválido",
+  "binary_crc_error",
+  "binary_delta_unresolved"
+};
+
+uint64_t ingest_mac_u64(const uint8_t* mac) {
+  uint64_t v = 0;
+  for (int i = 0; i < 6; i++) v = (v << 8) | mac[i];
+  return v;
+}
+
+// Dias desde 1970-01-01 (algoritmo days_from_civil)
+static int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  unsigned yoe = (unsigned)(y - era * 400);
+  unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int64_t)doe - 719468;
+}
+
+static bool read_digits(const char* s, size_t n, unsigned* out) {
+  unsigned v = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (s[i] < '0' || s[i] > '9') return false;
+    v = v * 10 + (s[i] - '0');
+  }
+  *out = v;
+  return true;
+}
+
+// "YYYY-MM-DDTHH:MM:SS[.frac][Z|±HH:MM]", como format_iso8601_timestamp()
+bool ingest_parse_iso8601(const char* s, size_t len, int64_t* epoch_us) {
+  unsigned year, month, day, hour, minute, second;
+  if (len < 19 || s[4] != '-' || s[7] != '-' || (s[10] != 'T' && s[10] != ' ') ||
+      s[13] != ':' || s[16] != ':') return false;
+  if (!read_digits(s, 4, &year) || !read_digits(s + 5, 2, &month) || !read_digits(s + 8, 2, &day) ||
+      !read_digits(s + 11, 2, &hour) || !read_digits(s + 14, 2, &minute) ||
+      !read_digits(s + 17, 2, &second)) return false;
+  if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 59) return false;
+
+  size_t i = 19;
+  int64_t frac_us = 0;
+  if (i < len && s[i] == '.') {
+    int64_t scale = 100000;
+    size_t digits = 0;
+    for (i++; i < len && s[i] >= '0' && s[i] <= '9'; i++, digits++) {
+      frac_us += (s[i] - '0') * scale;
+      scale /= 10;
+    }
+    if (digits == 0) return false;
+  }
+  int64_t offset_s = 0;
+  if (i < len && s[i] == 'Z') {
+    i++;
+  } else if (i < len && (s[i] == '+' || s[i] == '-')) {
+    unsigned oh, om;
+    if (len - i < 6 || s[i + 3] != ':' || !read_digits(s + i + 1, 2, &oh) || !read_digits(s + i + 4, 2, &om)) {
+      return false;
+    }
+    offset_s = (s[i] == '+' ? 1 : -1) * (int64_t)(oh * 3600 + om * 60);
+    i += 6;
+  }
+  if (i != len) return false;
+
+  int64_t days = days_from_civil(year, month, day);
+  *epoch_us = ((days * 86400 + hour * 3600 + minute * 60 + second) - offset_s) * 1000000 + frac_us;
+  return true;
+}
+
+size_t ingest_safe_cut(const uint8_t* data, size_t len, bool binary) {
+  uint8_t delim = binary ? 0x00 : '\n';
+  for (size_t i = len; i > 0; i--) {
+    if (data[i - 1] == delim) return i;
+  }
+  return 0;
+}
+
+static inline uint16_t get_u16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get_u32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Estado de trabalho de um decode_chunk() (um por chamada, reaproveitado entre linhas)
+typedef struct {
+  const ingest_chunk_t* chunk;
+  ingest_chunk_result_t* out;
+  json_doc_t doc;
+  std::vector<uint8_t> raw;
+  capture_data_t capture;
+  ie_list_t ies;
+  char text[512];
+} decoder_t;
+
+static ingest_event_t* new_event(decoder_t* d, uint8_t kind) {
+  ingest_event_t e;
+  memset(&e, 0, sizeof(e));
+  e.kind = kind;
+  e.delta_ref = WIRE_DELTA_REF_NONE;
+  d->out->events.push_back(e);
+  return &d->out->events.back();
+}
+
+static void reject(decoder_t* d, uint8_t reason) {
+  new_event(d, INGEST_EVENT_REJECT)->reject = reason;
+}
+
+static ingest_str_t arena_add(decoder_t* d, const char* s, size_t len) {
+  ingest_str_t ref;
+  ref.offset = (uint32_t)d->out->arena.size();
+  ref.len = (uint32_t)len;
+  d->out->arena.append(s, len);
+  return ref;
+}
+
+static ingest_str_t arena_json_string(decoder_t* d, int node) {
+  if (node < 0) return arena_add(d, "", 0);
+  size_t len = json_get_string(&d->doc, node, d->text, sizeof(d->text));
+  return arena_add(d, d->text, len);
+}
+
+// ---- Registros binários -----------------------------------------------------
+
+// Tamanho do cabeçalho do registro de pacote por versão
+static size_t packet_header_size(uint8_t version) {
+  static const uint8_t sizes[] = {40, 44, 48, 52, 53, WIRE_PACKET_HEADER_SIZE};
+  return version >= 1 && version <= WIRE_FORMAT_VERSION ? sizes[version - 1] : 0;
+}
+
+static ingest_str_t arena_str8(decoder_t* d, const uint8_t* body, size_t len, size_t* offset) {
+  if (*offset >= len) return arena_add(d, "", 0);
+  size_t n = body[*offset];
+  const char* s = (const char*)body + *offset + 1;
+  if (*offset + 1 + n > len) n = len - *offset - 1;
+  *offset += 1 + n;
+  return arena_add(d, s, n);
+}
+
+static void decode_session(decoder_t* d, const uint8_t* body, size_t len) {
+  if (len < 10) return;
+  ingest_event_t* e = new_event(d, INGEST_EVENT_SESSION);
+  e->ts_us = (int64_t)get_u32(body + 2) * 1000000;
+  e->last_us = get_u32(body + 6);
+  size_t offset = 10;
+  // new_event() não é chamado de novo: o ponteiro continua válido
+  e->capture_id = arena_str8(d, body, len, &offset);
+  e->scanner_id = arena_str8(d, body, len, &offset);
+  e->text = arena_str8(d, body, len, &offset);
+}
+
+static void decode_source(decoder_t* d, const uint8_t* body, size_t len) {
+  if (len < WIRE_SOURCE_RECORD_SIZE) {
+    d->out->unknown_records++;
+    return;
+  }
+  ingest_event_t* e = new_event(d, INGEST_EVENT_SOURCE);
+  memcpy(e->sa, body + 2, 6);
+  e->pkt_seq = get_u32(body + 8);
+}
+
+static void decode_packet(decoder_t* d, const uint8_t* body, size_t len) {
+  uint8_t version = body[1];
+  size_t header = packet_header_size(version);
+  if (header == 0 || len < header) {
+    d->out->unknown_records++;
+    return;
+  }
+  size_t ies_len = get_u16(body + header - 2);
+  if (header + ies_len > len) ies_len = len - header;
+
+  ingest_event_t* e = new_event(d, INGEST_EVENT_PROBE);
+  e->flags = INGEST_PROBE_BINARY | INGEST_PROBE_HAS_SEQ | INGEST_PROBE_HAS_FP;
+  e->pkt_seq = get_u32(body + 2);
+  e->ts_us = (int64_t)get_u32(body + 6) * 1000000 + (int64_t)get_u16(body + 10) * 1000;
+  e->channel = body[12];
+  e->rssi = (int8_t)body[13];
+  memcpy(e->sa, body + 24, 6);
+  e->seq = get_u16(body + 36) >> 4;
+  if (e->sa[0] & 0x02) e->flags |= INGEST_PROBE_RANDOMIZED;
+
+  // Mesma passada de IEs do firmware: SSID e, no formato v1, o fingerprint
+  ie_parse(&d->ies, body, header, header + ies_len);
+  e->fp_hash = version >= 2 ? get_u32(body + 38) : d->ies.fp_hash;
+  if (version >= 3) e->dwell_id = get_u32(body + 42);
+  if (version >= 4) {
+    e->rx_us = get_u32(body + 46);
+    e->flags |= INGEST_PROBE_HAS_RX_US;
+  }
+  if (version >= 5) e->delta_ref = body[50];
+  if (version >= 6) e->track_id = get_u32(body + 51);
+
+  char ssid[SSID_MAX_LEN + 1];
+  size_t ssid_len = ie_decode_ssid(&d->ies, ssid, sizeof(ssid));
+  e->text = arena_add(d, ssid, ssid_len);
+}
+
+static void decode_delta(decoder_t* d, const uint8_t* body, size_t len) {
+  if (len < WIRE_DELTA_RECORD_SIZE) {
+    d->out->unknown_records++;
+    return;
+  }
+  ingest_event_t* e = new_event(d, INGEST_EVENT_DELTA);
+  e->delta_ref = body[2];
+  e->key_seq = get_u16(body + 3);
+  e->pkt_seq = get_u16(body + 5);
+  e->rx_us = get_u32(body + 7);
+  e->dwell_id = get_u16(body + 11);
+  e->channel = body[13];
+  e->rssi = (int8_t)body[14];
+  e->seq = get_u16(body + 15) >> 4;
+}
+
+static void decode_device(decoder_t* d, const uint8_t* body, size_t len) {
+  uint8_t version = body[1];
+  if (len < (version < 6 ? WIRE_DEVICE_RECORD_SIZE - 4 : WIRE_DEVICE_RECORD_SIZE)) {
+    d->out->unknown_records++;
+    return;
+  }
+  ingest_event_t* e = new_event(d, INGEST_EVENT_DEVICE);
+  e->ts_us = (int64_t)get_u32(body + 2) * 1000000;
+  e->first_us = (int64_t)get_u32(body + 6) * 1000000;
+  e->last_us = (int64_t)get_u32(body + 10) * 1000000;
+  memcpy(e->sa, body + 14, 6);
+  e->fp_hash = get_u32(body + 20);
+  e->count = get_u32(body + 24);
+  e->rssi_min = (int8_t)body[28];
+  e->rssi_max = (int8_t)body[29];
+  e->rssi = (int8_t)body[30];
+  e->channels_mask = get_u16(body + 31);
+  e->flags = body[33];
+  if (version >= 6) e->track_id = get_u32(body + 34);
+}
+
+static void decode_pcap(decoder_t* d, const uint8_t* body, size_t len) {
+  if (len < WIRE_PCAP_HEADER_SIZE) {
+    d->out->unknown_records++;
+    return;
+  }
+  const uint8_t* radiotap = body + 18;
+  const uint8_t* frame = body + WIRE_PCAP_HEADER_SIZE;
+  size_t frame_len = len - WIRE_PCAP_HEADER_SIZE;
+  // Só probe requests viram linhas; os demais frames de gerenciamento ficam no .pcap
+  uint8_t fc = frame_len > 0 ? frame[0] : 0xFF;
+  if (((fc >> 2) & 0x03) != WIFI_FRAME_TYPE_MANAGEMENT || (fc >> 4) != WIFI_FRAME_SUBTYPE_PROBE_REQ) {
+    d->out->pcap_skipped++;
+    return;
+  }
+  uint16_t freq = get_u16(radiotap + 18);
+  uint8_t channel = freq == 2484 ? 14 : (freq > 2407 ? (freq - 2407) / 5 : 0);
+  int8_t rssi = (int8_t)radiotap[22];
+  // Flag FCS do radiotap: ausente quando o firmware cortou o frame
+  bool has_fcs = (radiotap[16] & 0x10) != 0;
+  if (!parse_probe_request(frame, frame_len, has_fcs, rssi, channel, d->capture)) {
+    d->out->pcap_skipped++;
+    return;
+  }
+
+  const packet_data_t& pkt = d->capture.packet;
+  ingest_event_t* e = new_event(d, INGEST_EVENT_PROBE);
+  e->flags = INGEST_PROBE_BINARY | INGEST_PROBE_HAS_RX_US | INGEST_PROBE_HAS_FP;
+  if (pkt.mac_randomized) e->flags |= INGEST_PROBE_RANDOMIZED;
+  e->ts_us = (int64_t)get_u32(body + 2) * 1000000 + get_u32(body + 6);
+  e->rx_us = get_u32(radiotap + 8);
+  e->channel = channel;
+  e->rssi = rssi;
+  memcpy(e->sa, pkt.ieee80211.sa, 6);
+  e->seq = pkt.ieee80211.seq_ctrl;
+  e->fp_hash = pkt.fingerprint.ie_hash;
+
+  char ssid[SSID_MAX_LEN + 1];
+  size_t ssid_len = ie_decode_ssid(&pkt.ies, ssid, sizeof(ssid));
+  e->text = arena_add(d, ssid, ssid_len);
+}
+
+// Decodifica um bloco entre delimitadores; false se não for um registro
+// (o bloco é então tratado como texto)
+static bool decode_block(decoder_t* d, const uint8_t* block, size_t len) {
+  d->raw.resize(len);
+  uint8_t* raw = d->raw.data();
+  size_t n = 0;
+  size_t i = 0;
+  while (i < len) {
+    uint8_t code = block[i];
+    if (code == 0 || i + code > len) return false;
+    memcpy(raw + n, block + i + 1, code - 1);
+    n += code - 1;
+    i += code;
+    if (code < 0xFF && i < len) raw[n++] = 0;
+  }
+  if (n < 4) return false;
+
+  size_t body_len = n - WIRE_CRC_SIZE;
+  if (wire_crc16(raw, body_len) != get_u16(raw + body_len)) {
+    // Registro corrompido no link: conta o erro em vez de gerar lixo como texto
+    if (raw[0] >= WIRE_RECORD_SESSION && raw[0] <= WIRE_RECORD_SOURCE &&
+        raw[1] >= 1 && raw[1] <= WIRE_FORMAT_VERSION) {
+      reject(d, INGEST_REJECT_CRC);
+      return true;
+    }
+    return false;
+  }
+
+  d->out->records++;
+  switch (raw[0]) {
+    case WIRE_RECORD_SESSION: decode_session(d, raw, body_len); break;
+    case WIRE_RECORD_PACKET: decode_packet(d, raw, body_len); break;
+    case WIRE_RECORD_DEVICE: decode_device(d, raw, body_len); break;
+    case WIRE_RECORD_DELTA: decode_delta(d, raw, body_len); break;
+    case WIRE_RECORD_PCAP: decode_pcap(d, raw, body_len); break;
+    case WIRE_RECORD_SOURCE: decode_source(d, raw, body_len); break;
+    default: d->out->unknown_records++; break;
+  }
+  return true;
+}
+
+// ---- Linhas de texto ---------------------------------------------------------
+
+static bool parse_mac(const char* s, size_t len, uint8_t* mac) {
+  if (len != 17) return false;
+  for (int i = 0; i < 6; i++) {
+    if (i < 5 && s[i * 3 + 2] != ':') return false;
+    int v = 0;
+    for (int k = 0; k < 2; k++) {
+      char c = s[i * 3 + k];
+      if (c >= 'A' && c <= 'F') c += 'a' - 'A';
+      if (c >= '0' && c <= '9') v = (v << 4) | (c - '0');
+      else if (c >= 'a' && c <= 'f') v = (v << 4) | (c - 'a' + 10);
+      else return false;
+    }
+    mac[i] = (uint8_t)v;
+  }
+  return true;
+}
+
+static bool parse_hex32(const char* s, size_t len, uint32_t* out) {
+  if (len == 0 || len > 8) return false;
+  uint32_t v = 0;
+  for (size_t i = 0; i < len; i++) {
+    char c = s[i];
+    if (c >= '0' && c <= '9') v = (v << 4) | (c - '0');
+    else if (c >= 'a' && c <= 'f') v = (v << 4) | (c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F') v = (v << 4) | (c - 'A' + 10);
+    else return false;
+  }
+  *out = v;
+  return true;
+}
+
+static const json_node_t* node(decoder_t* d, int i) {
+  return &d->doc.nodes[i];
+}
+
+static bool get_uint32(decoder_t* d, int i, uint32_t* out) {
+  int64_t v;
+  if (!json_get_int(&d->doc, i, &v) || v < 0 || v > 0xFFFFFFFFLL) return false;
+  *out = (uint32_t)v;
+  return true;
+}
+
+// Linha de probe no formato JSON Schema: validate_probe_data(),
+// validate_ieee80211_required_fields() e validate_packet_integrity()
+static void decode_json_probe(decoder_t* d) {
+  json_doc_t* doc = &d->doc;
+  int capture_id = json_find(doc, 0, "capture_id");
+  int capture_ts = json_find(doc, 0, "capture_ts");
+  int scanner_id = json_find(doc, 0, "scanner_id");
+  int packet = json_find(doc, 0, "packet");
+  if (capture_id < 0) return reject(d, INGEST_REJECT_MISSING_CAPTURE_ID);
+  if (capture_ts < 0) return reject(d, INGEST_REJECT_MISSING_CAPTURE_TS);
+  if (scanner_id < 0) return reject(d, INGEST_REJECT_MISSING_SCANNER_ID);
+  if (packet < 0) return reject(d, INGEST_REJECT_MISSING_PACKET);
+  if (node(d, capture_id)->type != JSON_NODE_STRING || node(d, capture_ts)->type != JSON_NODE_STRING ||
+      node(d, scanner_id)->type != JSON_NODE_STRING || node(d, packet)->type != JSON_NODE_OBJECT) {
+    return reject(d, INGEST_REJECT_BAD_TYPE);
+  }
+
+  int pkt_id = json_find(doc, packet, "pkt_id");
+  int ieee80211 = json_find(doc, packet, "ieee80211");
+  int rssi = json_find(doc, packet, "rssi_dbm");
+  int frame_raw = json_find(doc, packet, "frame_raw_hex");
+  if (pkt_id < 0) return reject(d, INGEST_REJECT_MISSING_PKT_ID);
+  if (ieee80211 < 0) return reject(d, INGEST_REJECT_MISSING_IEEE80211);
+  if (rssi < 0) return reject(d, INGEST_REJECT_MISSING_RSSI);
+  if (frame_raw < 0) return reject(d, INGEST_REJECT_MISSING_FRAME_RAW);
+  int64_t rssi_dbm;
+  if (node(d, pkt_id)->type != JSON_NODE_STRING || node(d, ieee80211)->type != JSON_NODE_OBJECT ||
+      !json_get_int(doc, rssi, &rssi_dbm) || node(d, frame_raw)->type != JSON_NODE_STRING) {
+    return reject(d, INGEST_REJECT_BAD_TYPE);
+  }
+
+  int64_t ts_us;
+  if (!ingest_parse_iso8601(node(d, capture_ts)->start, node(d, capture_ts)->len, &ts_us)) {
+    return reject(d, INGEST_REJECT_BAD_TIMESTAMP);
+  }
+
+  int radio = json_find_type(doc, packet, "radio", JSON_NODE_OBJECT);
+  int channel = json_find(doc, radio, "channel");
+  int64_t channel_v = 0;
+  if (channel >= 0 && !json_get_int(doc, channel, &channel_v)) return reject(d, INGEST_REJECT_BAD_TYPE);
+  int freq = json_find(doc, radio, "freq_mhz");
+  int64_t freq_v;
+  if (freq >= 0 && !json_get_int(doc, freq, &freq_v)) return reject(d, INGEST_REJECT_BAD_TYPE);
+  int vendor_ies = json_find(doc, packet, "vendor_ies");
+  if (vendor_ies >= 0 && node(d, vendor_ies)->type != JSON_NODE_ARRAY) return reject(d, INGEST_REJECT_BAD_TYPE);
+
+  int sa = json_find(doc, ieee80211, "sa");
+  if (sa < 0) return reject(d, INGEST_REJECT_IEEE80211);
+  if (rssi_dbm < -120 || rssi_dbm > 0) return reject(d, INGEST_REJECT_RSSI_RANGE);
+  if (channel >= 0 && (channel_v < 1 || channel_v > 14)) return reject(d, INGEST_REJECT_CHANNEL_RANGE);
+  uint8_t mac[6];
+  if (node(d, sa)->type != JSON_NODE_STRING || !parse_mac(node(d, sa)->start, node(d, sa)->len, mac)) {
+    return reject(d, INGEST_REJECT_MAC_FORMAT);
+  }
+
+  ingest_event_t* e = new_event(d, INGEST_EVENT_PROBE);
+  e->ids = INGEST_IDS_RECORD;
+  e->ts_us = ts_us;
+  e->rssi = (int8_t)rssi_dbm;
+  e->channel = (uint8_t)channel_v;
+  memcpy(e->sa, mac, 6);
+
+  // pkt_id: "%08x-%04x-%04x-..." com os 16 bits baixos e altos de pkt_seq
+  const json_node_t* id = node(d, pkt_id);
+  uint32_t lo, hi;
+  if (id->len >= 19 && id->start[8] == '-' && id->start[13] == '-' && id->start[18] == '-' &&
+      parse_hex32(id->start + 9, 4, &lo) && parse_hex32(id->start + 14, 4, &hi)) {
+    e->pkt_seq = (hi << 16) | lo;
+    e->flags |= INGEST_PROBE_HAS_SEQ;
+  }
+
+  if (get_uint32(d, json_find(doc, radio, "rx_us"), &e->rx_us)) e->flags |= INGEST_PROBE_HAS_RX_US;
+  get_uint32(d, json_find(doc, radio, "dwell_id"), &e->dwell_id);
+  uint32_t seq = 0;
+  get_uint32(d, json_find(doc, ieee80211, "seq_ctrl"), &seq);
+  e->seq = (uint16_t)seq;
+  get_uint32(d, json_find(doc, packet, "track_id"), &e->track_id);
+
+  int randomized = json_find_type(doc, packet, "mac_randomized", JSON_NODE_BOOL);
+  if (randomized >= 0 ? node(d, randomized)->flag : (mac[0] & 0x02) != 0) e->flags |= INGEST_PROBE_RANDOMIZED;
+
+  int fingerprint = json_find_type(doc, packet, "fingerprint", JSON_NODE_OBJECT);
+  int signature = json_find_type(doc, fingerprint, "ie_signature", JSON_NODE_STRING);
+  if (signature >= 0 && parse_hex32(node(d, signature)->start, node(d, signature)->len, &e->fp_hash)) {
+    e->flags |= INGEST_PROBE_HAS_FP;
+  }
+
+  // arena_* só cresce a arena: e continua válido
+  e->capture_id = arena_json_string(d, capture_id);
+  e->scanner_id = arena_json_string(d, scanner_id);
+  int probe = json_find_type(doc, packet, "probe", JSON_NODE_OBJECT);
+  e->text = arena_json_string(d, json_find_type(doc, probe, "ssid", JSON_NODE_STRING));
+}
+
+// "# DEVICE: {...}" (print_device_record no modo JSON)
+static void decode_json_device(decoder_t* d) {
+  json_doc_t* doc = &d->doc;
+  int sa = json_find_type(doc, 0, "sa", JSON_NODE_STRING);
+  int first = json_find_type(doc, 0, "first_seen_ts", JSON_NODE_STRING);
+  int last = json_find_type(doc, 0, "last_seen_ts", JSON_NODE_STRING);
+  int window = json_find_type(doc, 0, "window_start_ts", JSON_NODE_STRING);
+  int channels = json_find_type(doc, 0, "channels", JSON_NODE_ARRAY);
+  uint8_t mac[6];
+  int64_t first_us, last_us, window_us = 0;
+  int64_t rssi_avg;
+  ingest_event_t e;
+  memset(&e, 0, sizeof(e));
+  if (sa < 0 || first < 0 || last < 0 || channels < 0 ||
+      !parse_mac(node(d, sa)->start, node(d, sa)->len, mac) ||
+      !ingest_parse_iso8601(node(d, first)->start, node(d, first)->len, &first_us) ||
+      !ingest_parse_iso8601(node(d, last)->start, node(d, last)->len, &last_us) ||
+      (window >= 0 && !ingest_parse_iso8601(node(d, window)->start, node(d, window)->len, &window_us)) ||
+      !get_uint32(d, json_find(doc, 0, "count"), &e.count) ||
+      !json_get_int(doc, json_find(doc, 0, "rssi_avg"), &rssi_avg)) {
+    return reject(d, INGEST_REJECT_BAD_TYPE);
+  }
+
+  int64_t v;
+  if (json_get_int(doc, json_find(doc, 0, "rssi_min"), &v)) e.rssi_min = (int8_t)v;
+  if (json_get_int(doc, json_find(doc, 0, "rssi_max"), &v)) e.rssi_max = (int8_t)v;
+  e.rssi = (int8_t)rssi_avg;
+  get_uint32(d, json_find(doc, 0, "window_ms"), &e.window_ms);
+  get_uint32(d, json_find(doc, 0, "track_id"), &e.track_id);
+  int fp = json_find_type(doc, 0, "fp_hash", JSON_NODE_STRING);
+  if (fp >= 0) parse_hex32(node(d, fp)->start, node(d, fp)->len, &e.fp_hash);
+  int randomized = json_find_type(doc, 0, "mac_randomized", JSON_NODE_BOOL);
+  if (randomized >= 0 ? node(d, randomized)->flag : (mac[0] & 0x02) != 0) e.flags = WIRE_DEVICE_FLAG_RANDOMIZED;
+  for (uint32_t i = channels + 1, k = 0; k < node(d, channels)->children; k++, i = node(d, i)->next) {
+    int64_t ch;
+    if (json_get_int(doc, i, &ch) && ch >= 0 && ch < 16) e.channels_mask |= 1u << ch;
+  }
+
+  e.kind = INGEST_EVENT_DEVICE;
+  e.ids = INGEST_IDS_RECORD;
+  e.delta_ref = WIRE_DELTA_REF_NONE;
+  e.ts_us = window_us;
+  e.first_us = first_us;
+  e.last_us = last_us;
+  memcpy(e.sa, mac, 6);
+  e.capture_id = arena_json_string(d, json_find_type(doc, 0, "capture_id", JSON_NODE_STRING));
+  e.scanner_id = arena_json_string(d, json_find_type(doc, 0, "scanner_id", JSON_NODE_STRING));
+  d->out->events.push_back(e);
+}
+
+// "# TIME: {...}": âncora rx_us -> epoch (print_time_anchor)
+static void decode_json_time(decoder_t* d) {
+  json_doc_t* doc = &d->doc;
+  uint32_t rx_us, epoch_s, frac_us = 0;
+  // rx_us null: âncora sem referência do contador de rx, não se aplica
+  if (!get_uint32(d, json_find(doc, 0, "rx_us"), &rx_us) ||
+      !get_uint32(d, json_find(doc, 0, "epoch_s"), &epoch_s)) return;
+  get_uint32(d, json_find(doc, 0, "epoch_frac_us"), &frac_us);
+
+  ingest_event_t* e = new_event(d, INGEST_EVENT_TIME);
+  e->ids = INGEST_IDS_RECORD;
+  e->rx_us = rx_us;
+  e->ts_us = (int64_t)epoch_s * 1000000 + frac_us;
+  e->capture_id = arena_json_string(d, json_find_type(doc, 0, "capture_id", JSON_NODE_STRING));
+  e->scanner_id = arena_json_string(d, json_find_type(doc, 0, "scanner_id", JSON_NODE_STRING));
+}
+
+static bool starts_with(const char* s, size_t len, const char* prefix) {
+  size_t n = strlen(prefix);
+  return len >= n && memcmp(s, prefix, n) == 0;
+}
+
+static bool contains_ci(const char* s, size_t len, const char* word) {
+  size_t n = strlen(word);
+  for (size_t i = 0; i + n <= len; i++) {
+    size_t k = 0;
+    while (k < n && (s[i + k] | 0x20) == word[k]) k++;
+    if (k == n) return true;
+  }
+  return false;
+}
+
+static inline bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// Mesma classificação de linhas de load_data()
+static void decode_line(decoder_t* d, const char* s, size_t len) {
+  while (len > 0 && is_space(*s)) {
+    s++;
+    len--;
+  }
+  while (len > 0 && is_space(s[len - 1])) len--;
+  if (len == 0 || starts_with(s, len, "Warning!") || starts_with(s, len, "===")) return;
+  d->out->lines++;
+
+  if (s[0] == '#') {
+    // "# NAME: {...}"
+    const char* colon = (const char*)memchr(s, ':', len);
+    if (colon == NULL) return;
+    const char* payload = colon + 1;
+    size_t payload_len = len - (payload - s);
+    bool known = starts_with(s, len, "# STATS:") || starts_with(s, len, "# SUMMARY:") ||
+                 starts_with(s, len, "# TIME:") || starts_with(s, len, "# DEVICE:");
+    if (!json_parse(&d->doc, payload, payload_len) || d->doc.nodes[0].type != JSON_NODE_OBJECT) {
+      if (known) reject(d, INGEST_REJECT_JSON_DECODE);
+      return;
+    }
+    if (starts_with(s, len, "# TIME:")) {
+      decode_json_time(d);
+    } else if (starts_with(s, len, "# DEVICE:")) {
+      decode_json_device(d);
+    } else {
+      // STATS, SUMMARY e os demais registros de texto seguem para o analisador
+      ingest_event_t* e = new_event(d, INGEST_EVENT_META);
+      e->text = arena_add(d, s, len);
+    }
+    return;
+  }
+  if (contains_ci(s, len, "configurado")) return;
+
+  if (!json_parse(&d->doc, s, len) || d->doc.nodes[0].type != JSON_NODE_OBJECT) {
+    return reject(d, INGEST_REJECT_JSON_DECODE);
+  }
+  decode_json_probe(d);
+}
+
+static void decode_text(decoder_t* d, const uint8_t* data, size_t len) {
+  const char* s = (const char*)data;
+  while (len > 0) {
+    const char* nl = (const char*)memchr(s, '\n', len);
+    size_t line_len = nl ? (size_t)(nl - s) : len;
+    decode_line(d, s, line_len);
+    if (nl == NULL) break;
+    len -= line_len + 1;
+    s = nl + 1;
+  }
+}
+
+void decode_chunk(const ingest_chunk_t* chunk, ingest_chunk_result_t* out) {
+  decoder_t d;
+  d.chunk = chunk;
+  d.out = out;
+  out->clear();
+
+  if (!chunk->binary) {
+    decode_text(&d, chunk->data, chunk->len);
+    return;
+  }
+  // Blocos entre delimitadores 0x00: registro COBS ou texto intercalado
+  const uint8_t* p = chunk->data;
+  const uint8_t* end = chunk->data + chunk->len;
+  while (p < end) {
+    const uint8_t* zero = (const uint8_t*)memchr(p, 0x00, end - p);
+    const uint8_t* block_end = zero ? zero : end;
+    size_t block_len = block_end - p;
+    if (block_len > 0 && !decode_block(&d, p, block_len)) decode_text(&d, p, block_len);
+    p = block_end + 1;
+  }
+}
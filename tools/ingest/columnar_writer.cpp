@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "columnar_writer.h"
+
+// Colunas gravadas como estão na memória: os dtypes "<" assumem little-endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "columnar_writer: host big-endian não suportado"
+#endif
+
+template <typename T>
+static void add(std::vector<pcol_column_t>* columns, const char* table, const char* name,
+                const char* dtype, const std::vector<T>& v) {
+  pcol_column_t c;
+  c.table = table;
+  c.name = name;
+  c.dtype = dtype;
+  c.data = v.empty() ? NULL : &v[0];
+  c.count = v.size();
+  c.elem_size = sizeof(T);
+  columns->push_back(c);
+}
+
+void ingest_collect_columns(const ingest_stitcher_t* st, std::vector<pcol_column_t>* columns) {
+  const ingest_probe_columns_t& p = st->probes;
+  add(columns, "probes", "ts_us", "<i8", p.ts_us);
+  add(columns, "probes", "scanner", "<u4", p.scanner);
+  add(columns, "probes", "capture", "<u4", p.capture);
+  add(columns, "probes", "pkt_seq", "<u4", p.pkt_seq);
+  add(columns, "probes", "sa", "<u8", p.sa);
+  add(columns, "probes", "fp_hash", "<u4", p.fp_hash);
+  add(columns, "probes", "dwell_id", "<u4", p.dwell_id);
+  add(columns, "probes", "rx_us", "<u4", p.rx_us);
+  add(columns, "probes", "track_id", "<u4", p.track_id);
+  add(columns, "probes", "vendor", "<u4", p.vendor);
+  add(columns, "probes", "ssid", "<u4", p.ssid);
+  add(columns, "probes", "seq", "<u2", p.seq);
+  add(columns, "probes", "channel", "|u1", p.channel);
+  add(columns, "probes", "rssi", "|i1", p.rssi);
+  add(columns, "probes", "flags", "|u1", p.flags);
+
+  const ingest_device_columns_t& d = st->devices;
+  add(columns, "devices", "window_start_us", "<i8", d.window_start_us);
+  add(columns, "devices", "first_seen_us", "<i8", d.first_seen_us);
+  add(columns, "devices", "last_seen_us", "<i8", d.last_seen_us);
+  add(columns, "devices", "scanner", "<u4", d.scanner);
+  add(columns, "devices", "capture", "<u4", d.capture);
+  add(columns, "devices", "sa", "<u8", d.sa);
+  add(columns, "devices", "fp_hash", "<u4", d.fp_hash);
+  add(columns, "devices", "track_id", "<u4", d.track_id);
+  add(columns, "devices", "count", "<u4", d.count);
+  add(columns, "devices", "window_ms", "<u4", d.window_ms);
+  add(columns, "devices", "vendor", "<u4", d.vendor);
+  add(columns, "devices", "channels_mask", "<u2", d.channels_mask);
+  add(columns, "devices", "rssi_min", "|i1", d.rssi_min);
+  add(columns, "devices", "rssi_max", "|i1", d.rssi_max);
+  add(columns, "devices", "rssi_avg", "|i1", d.rssi_avg);
+  add(columns, "devices", "flags", "|u1", d.flags);
+
+  add(columns, "meta", "line", "<u4", st->meta);
+  add(columns, "strings", "offsets", "<u4", st->strings.offsets);
+
+  pcol_column_t blob;
+  blob.table = "strings";
+  blob.name = "blob";
+  blob.dtype = "|u1";
+  blob.data = st->strings.blob.data();
+  blob.count = st->strings.blob.size();
+  blob.elem_size = 1;
+  columns->push_back(blob);
+}
+
+static inline size_t align_up(size_t v) {
+  return (v + PCOL_ALIGN - 1) & ~(size_t)(PCOL_ALIGN - 1);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (v >> (i * 8)) & 0xFF;
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+  for (int i = 0; i < 8; i++) p[i] = (v >> (i * 8)) & 0xFF;
+}
+
+static void put_name(uint8_t* p, size_t size, const char* s) {
+  memset(p, 0, size);
+  size_t len = strlen(s);
+  memcpy(p, s, len < size - 1 ? len : size - 1);
+}
+
+bool pcol_write(const char* path, const std::vector<pcol_column_t>& columns) {
+  // Cabeçalho + diretório; as colunas começam alinhadas logo depois
+  std::vector<uint8_t> head(PCOL_HEADER_SIZE + columns.size() * PCOL_DIR_ENTRY_SIZE, 0);
+  memcpy(&head[0], PCOL_MAGIC, 8);
+  put_u32(&head[8], PCOL_VERSION);
+  put_u32(&head[12], (uint32_t)columns.size());
+
+  size_t offset = align_up(head.size());
+  for (size_t i = 0; i < columns.size(); i++) {
+    const pcol_column_t& c = columns[i];
+    uint8_t* e = &head[PCOL_HEADER_SIZE + i * PCOL_DIR_ENTRY_SIZE];
+    size_t bytes = c.count * c.elem_size;
+    put_name(e, 12, c.table);
+    put_name(e + 12, 20, c.name);
+    put_name(e + 32, 8, c.dtype);
+    put_u64(e + 40, offset);
+    put_u64(e + 48, c.count);
+    put_u64(e + 56, bytes);
+    offset = align_up(offset + bytes);
+  }
+
+  std::string tmp = std::string(path) + ".tmp";
+  FILE* f = fopen(tmp.c_str(), "wb");
+  if (f == NULL) return false;
+  static const uint8_t zeros[PCOL_ALIGN] = {0};
+  bool ok = fwrite(&head[0], 1, head.size(), f) == head.size();
+  size_t written = head.size();
+  for (size_t i = 0; ok && i < columns.size(); i++) {
+    const pcol_column_t& c = columns[i];
+    size_t pad = align_up(written) - written;
+    ok = fwrite(zeros, 1, pad, f) == pad;
+    written += pad;
+    size_t bytes = c.count * c.elem_size;
+    if (ok && bytes > 0) ok = fwrite(c.data, 1, bytes, f) == bytes;
+    written += bytes;
+  }
+  if (fclose(f) != 0) ok = false;
+  if (!ok || rename(tmp.c_str(), path) != 0) {
+    remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
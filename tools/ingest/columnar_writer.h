@@ -0,0 +1,48 @@
+#ifndef COLUMNAR_WRITER_H
+#define COLUMNAR_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "ingest.h"
+
+// Arquivo colunar .pcol: cada coluna é um array contíguo que o analisador
+// mapeia direto (np.memmap / np.frombuffer), sem parsing. Little-endian:
+//
+//   char magic[8]        "PROBECOL"
+//   u32  version         PCOL_VERSION
+//   u32  column_count
+//   column_count entradas de diretório de PCOL_DIR_ENTRY_SIZE bytes:
+//     char table[12]     "probes", "devices", "strings" ou "meta" (com '\0')
+//     char name[20]
+//     char dtype[8]      dtype do numpy ("<i8", "<u4", "|i1", ...)
+//     u64  offset        do início do arquivo, múltiplo de 8
+//     u64  count         elementos
+//     u64  bytes
+//   dados das colunas
+//
+// Strings (scanner, capture, vendor, ssid, linhas de meta) são índices no
+// dicionário: strings.offsets (count + 1 offsets) sobre strings.blob (UTF-8).
+
+#define PCOL_MAGIC "PROBECOL"
+#define PCOL_VERSION 1
+#define PCOL_HEADER_SIZE 16
+#define PCOL_DIR_ENTRY_SIZE 64
+#define PCOL_ALIGN 8
+
+typedef struct {
+  const char* table;
+  const char* name;
+  const char* dtype;
+  const void* data;
+  size_t count;
+  size_t elem_size;
+} pcol_column_t;
+
+// Colunas das tabelas do stitcher (referenciam os vetores, sem cópia)
+void ingest_collect_columns(const ingest_stitcher_t* st, std::vector<pcol_column_t>* columns);
+
+// Grava em path.tmp e renomeia: um leitor nunca vê arquivo pela metade
+bool pcol_write(const char* path, const std::vector<pcol_column_t>& columns);
+
+#endif // COLUMNAR_WRITER_H
@@ -0,0 +1,268 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+// Ingestão de capturas no host (tools/ingest): decodifica logs JSON e binários
+// (include/wire_format.h) com os mesmos encoders/parsers do firmware e grava
+// um arquivo colunar (.pcol, ver columnar_writer.h) que o analisador carrega
+// direto, sem json.loads nem validação por linha em Python.
+//
+// Duas fases:
+//   1. decode_chunk() (paralela): um chunk cortado em um ponto seguro (0x00 no
+//      modo binário, '\n' no texto) vira uma lista ordenada de eventos. Não
+//      depende de nenhum estado anterior do stream.
+//   2. ingest_stitcher_t (sequencial, na ordem do stream): aplica o que
+//      depende do que veio antes — sessão corrente dos registros binários,
+//      keyframes dos deltas, âncoras "# TIME:" — e faz vendor lookup,
+//      deduplicação e o append nas colunas.
+
+// Motivos de descarte, com os mesmos nomes do schema_errors do analisador
+enum {
+  INGEST_REJECT_JSON_DECODE = 0,
+  INGEST_REJECT_MISSING_CAPTURE_ID,
+  INGEST_REJECT_MISSING_CAPTURE_TS,
+  INGEST_REJECT_MISSING_SCANNER_ID,
+  INGEST_REJECT_MISSING_PACKET,
+  INGEST_REJECT_MISSING_PKT_ID,
+  INGEST_REJECT_MISSING_IEEE80211,
+  INGEST_REJECT_MISSING_RSSI,
+  INGEST_REJECT_MISSING_FRAME_RAW,
+  INGEST_REJECT_BAD_TYPE,
+  INGEST_REJECT_BAD_TIMESTAMP,
+  INGEST_REJECT_IEEE80211,
+  INGEST_REJECT_RSSI_RANGE,
+  INGEST_REJECT_CHANNEL_RANGE,
+  INGEST_REJECT_MAC_FORMAT,
+  INGEST_REJECT_CRC,
+  INGEST_REJECT_DELTA_UNRESOLVED,
+  INGEST_REJECT_COUNT
+};
+
+extern const char* const ingest_reject_names[INGEST_REJECT_COUNT];
+
+// Flags de uma linha de probe (coluna probes.flags)
+#define INGEST_PROBE_RANDOMIZED 0x01
+#define INGEST_PROBE_HAS_RX_US  0x02   // rx_us válido (formato v4+ ou JSON com rx_us)
+#define INGEST_PROBE_HAS_SEQ    0x04   // pkt_seq válido (pcap não tem)
+#define INGEST_PROBE_HAS_FP     0x08
+#define INGEST_PROBE_ANCHORED   0x10   // ts_us recalculado por uma âncora "# TIME:"
+#define INGEST_PROBE_DELTA      0x20   // reconstruído de um registro delta
+#define INGEST_PROBE_BINARY     0x40   // veio do formato binário (senão JSON)
+
+enum {
+  INGEST_EVENT_SESSION = 0,
+  INGEST_EVENT_TIME,
+  INGEST_EVENT_PROBE,
+  INGEST_EVENT_DELTA,
+  INGEST_EVENT_DEVICE,
+  INGEST_EVENT_META,
+  INGEST_EVENT_REJECT,
+  INGEST_EVENT_SOURCE
+};
+
+// Fonte de scanner/capture de um evento: a sessão binária corrente ou as
+// strings do próprio registro JSON
+enum {
+  INGEST_IDS_SESSION = 0,
+  INGEST_IDS_RECORD
+};
+
+// Faixa de bytes na arena de strings do chunk
+typedef struct {
+  uint32_t offset;
+  uint32_t len;
+} ingest_str_t;
+
+typedef struct {
+  uint8_t kind;
+  uint8_t ids;              // INGEST_IDS_*
+  uint8_t reject;           // INGEST_EVENT_REJECT
+  uint8_t flags;            // INGEST_PROBE_* / WIRE_DEVICE_FLAG_*
+  uint8_t channel;
+  int8_t rssi;              // device: rssi_avg
+  int8_t rssi_min;
+  int8_t rssi_max;
+  uint8_t delta_ref;        // WIRE_DELTA_REF_NONE se não referenciável
+  uint16_t seq;             // número de sequência 802.11 (sem fragmento)
+  uint16_t key_seq;         // delta: 16 bits baixos do pkt_seq do keyframe
+  uint16_t channels_mask;   // device
+  uint8_t sa[6];            // source: MAC do nó
+  uint32_t pkt_seq;         // delta: seq_offset; source: session
+  uint32_t fp_hash;
+  uint32_t dwell_id;        // delta: dwell_offset
+  uint32_t rx_us;           // delta: rx_offset_us; time: rx_us da âncora
+  uint32_t track_id;
+  uint32_t count;           // device
+  uint32_t window_ms;       // device (só no JSON)
+  int64_t ts_us;            // epoch do registro; device: window_start; time: epoch da âncora
+  int64_t first_us;         // device
+  int64_t last_us;          // device; session: uptime_ms
+  ingest_str_t capture_id;
+  ingest_str_t scanner_id;
+  ingest_str_t text;        // probe: SSID; session: firmware; meta: linha
+} ingest_event_t;
+
+// Entrada da fase 1: bytes de um chunk e o modo do arquivo
+typedef struct {
+  const uint8_t* data;
+  size_t len;
+  bool binary;
+} ingest_chunk_t;
+
+struct ingest_chunk_result_t {
+  std::vector<ingest_event_t> events;
+  std::string arena;
+  uint64_t records;         // registros binários com CRC válido
+  uint64_t lines;           // linhas de texto
+  uint64_t unknown_records;
+  uint64_t pcap_skipped;    // registros pcap que não são probe requests
+
+  void clear() {
+    events.clear();
+    arena.clear();
+    records = lines = unknown_records = pcap_skipped = 0;
+  }
+};
+
+// Fase 1. Thread-safe: nenhum estado global.
+void decode_chunk(const ingest_chunk_t* chunk, ingest_chunk_result_t* out);
+
+// Cortes seguros: posição logo após o último delimitador em [0, len), ou 0
+size_t ingest_safe_cut(const uint8_t* data, size_t len, bool binary);
+
+// Colunas das tabelas (struct-of-arrays, gravadas como estão no .pcol)
+struct ingest_probe_columns_t {
+  std::vector<int64_t> ts_us;
+  std::vector<uint32_t> scanner;       // índice no dicionário de strings
+  std::vector<uint32_t> capture;
+  std::vector<uint32_t> pkt_seq;
+  std::vector<uint64_t> sa;            // octeto 0 no byte mais significativo dos 48 bits
+  std::vector<uint32_t> fp_hash;
+  std::vector<uint32_t> dwell_id;
+  std::vector<uint32_t> rx_us;
+  std::vector<uint32_t> track_id;
+  std::vector<uint32_t> vendor;
+  std::vector<uint32_t> ssid;
+  std::vector<uint16_t> seq;
+  std::vector<uint8_t> channel;
+  std::vector<int8_t> rssi;
+  std::vector<uint8_t> flags;
+};
+
+struct ingest_device_columns_t {
+  std::vector<int64_t> window_start_us;
+  std::vector<int64_t> first_seen_us;
+  std::vector<int64_t> last_seen_us;
+  std::vector<uint32_t> scanner;
+  std::vector<uint32_t> capture;
+  std::vector<uint64_t> sa;
+  std::vector<uint32_t> fp_hash;
+  std::vector<uint32_t> track_id;
+  std::vector<uint32_t> count;
+  std::vector<uint32_t> window_ms;
+  std::vector<uint32_t> vendor;
+  std::vector<uint16_t> channels_mask;
+  std::vector<int8_t> rssi_min;
+  std::vector<int8_t> rssi_max;
+  std::vector<int8_t> rssi_avg;
+  std::vector<uint8_t> flags;
+};
+
+// Dicionário de strings (índice 0 = ""). Sondagem linear sobre o FNV-1a dos
+// bytes, sem construir std::string por consulta.
+struct ingest_strings_t {
+  std::vector<uint32_t> table;         // índice + 1 (0 = vazio), tamanho potência de 2
+  std::vector<uint32_t> hashes;        // hash de cada string
+  std::vector<uint32_t> offsets;       // count + 1 offsets em blob
+  std::string blob;
+
+  ingest_strings_t();
+  uint32_t intern(const char* s, size_t len);
+  size_t count() const { return offsets.size() - 1; }
+};
+
+// Linha de probe antes do append (também guarda os keyframes dos deltas)
+typedef struct {
+  int64_t ts_us;
+  uint32_t scanner;
+  uint32_t capture;
+  uint32_t pkt_seq;
+  uint64_t sa;
+  uint32_t fp_hash;
+  uint32_t dwell_id;
+  uint32_t rx_us;
+  uint32_t track_id;
+  uint32_t vendor;
+  uint32_t ssid;
+  uint16_t seq;
+  uint8_t channel;
+  int8_t rssi;
+  uint8_t flags;
+} ingest_probe_row_t;
+
+// Sessão e keyframes de um nó. No stream do gateway ESP-NOW cada registro
+// WIRE_RECORD_SOURCE seleciona o nó dos registros seguintes; sem ele o
+// stream é de um nó só (origem 0)
+typedef struct {
+  uint32_t session_scanner;
+  uint32_t session_capture;
+  bool delta_valid[256];
+  ingest_probe_row_t delta_key[256];   // campos do último keyframe de cada delta_ref
+} ingest_source_t;
+
+typedef struct {
+  bool dedup;               // descarta probes/devices já vistos (logs sobrepostos)
+} ingest_options_t;
+
+typedef struct {
+  uint32_t rx_us;
+  int64_t epoch_us;
+} ingest_anchor_t;
+
+struct ingest_stitcher_t {
+  ingest_options_t options;
+  ingest_probe_columns_t probes;
+  ingest_device_columns_t devices;
+  ingest_strings_t strings;
+  std::vector<uint32_t> meta;          // linhas "# NAME: {...}" (índices de string)
+
+  // Contadores
+  uint64_t inputs;
+  uint64_t chunks;
+  uint64_t records;
+  uint64_t lines;
+  uint64_t unknown_records;
+  uint64_t pcap_skipped;
+  uint64_t delta_records;
+  uint64_t anchored;
+  uint64_t duplicates;
+  uint64_t rejects[INGEST_REJECT_COUNT];
+
+  // Estado do stream corrente (reiniciado por ingest_stitcher_begin_input)
+  std::unordered_map<uint64_t, ingest_source_t> sources;  // (MAC, session) do nó -> estado
+  ingest_source_t* source;             // origem dos registros binários seguintes
+
+  std::unordered_map<uint64_t, ingest_anchor_t> anchors;   // (scanner, capture) -> âncora
+  std::unordered_set<uint64_t> seen;
+  std::unordered_map<const char*, uint32_t> vendor_index;  // ponteiros da tabela OUI
+};
+
+void ingest_stitcher_init(ingest_stitcher_t* st, const ingest_options_t* options);
+void ingest_stitcher_begin_input(ingest_stitcher_t* st);
+// Fase 2: consome um chunk na ordem do stream
+void ingest_stitch(ingest_stitcher_t* st, const ingest_chunk_result_t* chunk);
+// Inválidos = soma de rejects; linha "# INGEST: {...}" com os contadores
+uint64_t ingest_invalid_count(const ingest_stitcher_t* st);
+std::string ingest_report_json(const ingest_stitcher_t* st);
+
+// Auxiliares compartilhados entre as fases
+uint64_t ingest_mac_u64(const uint8_t* mac);
+bool ingest_parse_iso8601(const char* s, size_t len, int64_t* epoch_us);
+
+#endif // INGEST_H
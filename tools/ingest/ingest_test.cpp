@@ -0,0 +1,482 @@
+// Testes do probe_ingest (ctest): logs gerados com os encoders do firmware
+// e o corpus de test/corpus, decodificados pelo pipeline e conferidos coluna
+// a coluna. Sem Unity: a ferramenta do host não passa pelo PlatformIO.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string>
+#include <vector>
+#include "ingest.h"
+#include "json_reader.h"
+#include "pipeline.h"
+#include "columnar_writer.h"
+#include "probe_record.h"
+#include "wire_format.h"
+#include "corpus/probe_corpus.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(expected, actual) do { \
+    long long e_ = (long long)(expected), a_ = (long long)(actual); \
+    if (e_ != a_) { \
+      fprintf(stderr, "%s:%d: falhou: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #expected, #actual, e_, a_); \
+      failures++; \
+    } \
+  } while (0)
+
+static const char* CAPTURE_ID = "6553f100-9abc-5678-4553-6553f1009abc";
+static const char* SCANNER_ID = "esp32-test";
+static const uint32_t EPOCH_S = 1700000123;
+
+static capture_data_t capture;
+
+static const probe_corpus_frame_t* corpus_frame(const char* name) {
+  for (size_t i = 0; i < PROBE_CORPUS_COUNT; i++) {
+    if (strcmp(probe_corpus[i].name, name) == 0) return &probe_corpus[i];
+  }
+  return NULL;
+}
+
+static void parse_corpus(const probe_corpus_frame_t* f, uint32_t pkt_seq) {
+  parse_probe_request(f->frame, f->len, true, f->rssi, f->channel, capture);
+  capture.capture_id = CAPTURE_ID;
+  capture.scanner_id = SCANNER_ID;
+  capture.firmware = "test";
+  capture.scanner_tag = 0x9abc;
+  capture.capture_epoch_s = EPOCH_S + pkt_seq / 10;
+  capture.capture_ms = (pkt_seq % 10) * 100;
+  capture.packet.pkt_seq = pkt_seq;
+  capture.packet.radio.rx_us = 5000000 + pkt_seq * 100000;
+  capture.packet.radio.dwell_id = pkt_seq / 4;
+  capture.packet.track_id = 1 + (pkt_seq % 3);
+}
+
+static void append_framed(std::string* log, const uint8_t* record, size_t len) {
+  uint8_t framed[WIRE_FRAMED_SIZE(1024)];
+  size_t n = wire_frame(record, len, framed, sizeof(framed));
+  log->append((const char*)framed, n);
+}
+
+static std::string string_at(const ingest_stitcher_t* st, uint32_t id) {
+  const ingest_strings_t& s = st->strings;
+  return std::string(s.blob.data() + s.offsets[id], s.offsets[id + 1] - s.offsets[id]);
+}
+
+static bool has_meta(const ingest_stitcher_t* st, const char* prefix) {
+  for (size_t i = 0; i < st->meta.size(); i++) {
+    if (string_at(st, st->meta[i]).compare(0, strlen(prefix), prefix) == 0) return true;
+  }
+  return false;
+}
+
+// Grava o log em um arquivo temporário e o ingere pelo caminho de mmap (ou streaming)
+static void ingest_log(ingest_stitcher_t* st, const std::string& log, unsigned threads, size_t chunk_size,
+                       bool stream, bool dedup = true) {
+  char path[] = "/tmp/ingest_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK(fd >= 0);
+  CHECK_EQ(log.size(), write(fd, log.data(), log.size()));
+  lseek(fd, 0, SEEK_SET);
+
+  ingest_options_t options;
+  options.dedup = dedup;
+  ingest_stitcher_init(st, &options);
+  ingest_pipeline_options_t pipeline_options;
+  pipeline_options.threads = threads;
+  pipeline_options.chunk_size = chunk_size;
+  pipeline_options.stop = NULL;
+  ingest_pipeline_t pipeline;
+  ingest_pipeline_start(&pipeline, &pipeline_options, st);
+  CHECK(stream ? ingest_pipeline_stream(&pipeline, fd) : ingest_pipeline_file(&pipeline, fd, log.size()));
+  ingest_pipeline_finish(&pipeline);
+  close(fd);
+  unlink(path);
+}
+
+// ---- Leitor JSON e timestamps ------------------------------------------------
+
+static void test_json_reader() {
+  json_doc_t doc;
+  const char* text = " {\"a\":[1,2,{\"b\":\"x\\\"y\\u00e9\\ud83d\\ude00\"}],\"c\":-3.5e2,\"d\":true,\"e\":null,\"f\":-42} ";
+  CHECK(json_parse(&doc, text, strlen(text)));
+  int a = json_find_type(&doc, 0, "a", JSON_NODE_ARRAY);
+  CHECK(a >= 0);
+  CHECK_EQ(3, doc.nodes[a].children);
+  // Terceiro elemento do array, pulando os anteriores por next
+  int third = doc.nodes[doc.nodes[a + 1].next].next;
+  char s[32];
+  CHECK_EQ(9, json_get_string(&doc, json_find(&doc, third, "b"), s, sizeof(s)));
+  CHECK(strcmp(s, "x\"y\xc3\xa9\xf0\x9f\x98\x80") == 0);
+
+  int64_t v;
+  CHECK(!json_get_int(&doc, json_find(&doc, 0, "c"), &v));   // não inteiro
+  CHECK(json_get_int(&doc, json_find(&doc, 0, "f"), &v));
+  CHECK_EQ(-42, v);
+  CHECK(doc.nodes[json_find(&doc, 0, "d")].flag);
+  CHECK_EQ(JSON_NODE_NULL, doc.nodes[json_find(&doc, 0, "e")].type);
+  CHECK_EQ(-1, json_find(&doc, 0, "zz"));
+
+  const char* invalid[] = {"{\"a\":1,}", "[1 2]", "{\"a\":1} x", "{\"a\":01}", "\"abc", "{\"a\":tru}", ""};
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    CHECK(!json_parse(&doc, invalid[i], strlen(invalid[i])));
+  }
+}
+
+static void test_iso8601() {
+  int64_t us;
+  CHECK(ingest_parse_iso8601("2023-11-14T22:15:23.249Z", 24, &us));
+  CHECK_EQ(1700000123249000LL, us);
+  CHECK(ingest_parse_iso8601("2023-11-14T22:15:23+00:00", 25, &us));
+  CHECK_EQ(1700000123000000LL, us);
+  CHECK(ingest_parse_iso8601("1970-01-01T00:00:00.000001Z", 27, &us));
+  CHECK_EQ(1, us);
+  CHECK(!ingest_parse_iso8601("2023-11-14 22:15", 16, &us));
+  CHECK(!ingest_parse_iso8601("2023-13-14T22:15:23Z", 20, &us));
+  CHECK(!ingest_parse_iso8601("2023-11-14T22:15:23.Z", 21, &us));
+}
+
+// ---- Formato binário -----------------------------------------------------------
+
+#define BINARY_PACKETS 40
+
+// Flag de delta esperada por pacote, conforme o codificador decidiu
+static std::vector<bool> binary_is_delta;
+
+static std::string binary_log() {
+  std::string log = "ESP-ROM:esp32s3-20210327\r\nbanner de boot\r\n";
+  uint8_t record[1024];
+  uint8_t framed[WIRE_FRAMED_SIZE(1024)];
+
+  wire_session_t session = {EPOCH_S, 1234, CAPTURE_ID, SCANNER_ID, "test"};
+  append_framed(&log, record, wire_encode_session(record, sizeof(record), &session));
+
+  // Âncora: rx_us 5 s <-> epoch 1700000200.5
+  log += "# TIME: {\"type\":\"time_anchor\",\"seq\":1,\"source\":\"sntp\",\"epoch_s\":1700000200,"
+         "\"epoch_frac_us\":500000,\"rx_us\":5000000,\"adjustments\":1,\"last_step_us\":0,"
+         "\"scanner_id\":\"esp32-test\",\"capture_id\":\"6553f100-9abc-5678-4553-6553f1009abc\"}\r\n";
+
+  // Rajadas do mesmo dispositivo: keyframe seguido de deltas
+  static wire_delta_t delta;
+  wire_delta_init(&delta, 0);
+  binary_is_delta.clear();
+  for (uint32_t i = 0; i < BINARY_PACKETS; i++) {
+    parse_corpus(&probe_corpus[(i / 4) % 5], i);
+    capture.packet.track_id = 7;
+    uint32_t deltas = delta.deltas;
+    log.append((const char*)framed, encode_capture_binary_delta(capture, &delta, framed, sizeof(framed)));
+    binary_is_delta.push_back(delta.deltas != deltas);
+    if (i == 20) log += "# STATS: {\"type\":\"stats\",\"packets\":21}\r\n";
+  }
+
+  // Registro com CRC quebrado no meio do stream
+  parse_corpus(corpus_frame("intel_ax201_wps"), 1000);
+  size_t n = encode_capture_binary(capture, framed, sizeof(framed));
+  // Troca um byte de dados (não um código COBS) a partir do meio do registro
+  size_t code = 1;
+  while (code < n / 2 || framed[code] < 2) code += framed[code];
+  framed[code + 1] = framed[code + 1] == 0x41 ? 0x42 : 0x41;
+  log.append((const char*)framed, n);
+
+  wire_device_t device;
+  memset(&device, 0, sizeof(device));
+  device.window_start_s = EPOCH_S;
+  device.first_seen_s = EPOCH_S + 1;
+  device.last_seen_s = EPOCH_S + 9;
+  memcpy(device.sa, corpus_frame("esp8266_minimal")->frame + 10, 6);
+  device.fp_hash = 0xdeadbeef;
+  device.count = 12;
+  device.rssi_min = -90;
+  device.rssi_max = -70;
+  device.rssi_avg = -80;
+  device.channels_mask = (1 << 1) | (1 << 6);
+  device.track_id = 99;
+  append_framed(&log, record, wire_encode_device(record, sizeof(record), &device));
+
+  // Registro pcap de um probe request sem pkt_seq
+  const probe_corpus_frame_t* f = corpus_frame("pixel_android14_directed");
+  wire_pcap_t pcap = {EPOCH_S + 50, 250000, 7000000, 2412, -48, f->len};
+  append_framed(&log, record, wire_encode_pcap(record, sizeof(record), &pcap, f->frame, f->len));
+  return log;
+}
+
+static void test_binary_stream() {
+  ingest_stitcher_t* st = new ingest_stitcher_t();
+  ingest_log(st, binary_log(), 1, INGEST_DEFAULT_CHUNK_SIZE, false);
+
+  const ingest_probe_columns_t& p = st->probes;
+  CHECK_EQ(BINARY_PACKETS + 1, p.ts_us.size());
+  CHECK_EQ(1, st->rejects[INGEST_REJECT_CRC]);
+  CHECK_EQ(0, st->rejects[INGEST_REJECT_DELTA_UNRESOLVED]);
+  CHECK(st->delta_records >= BINARY_PACKETS / 2);
+  CHECK(has_meta(st, "# STATS: {"));
+
+  for (uint32_t i = 0; i < BINARY_PACKETS && i < p.ts_us.size(); i++) {
+    const probe_corpus_frame_t* f = &probe_corpus[(i / 4) % 5];
+    CHECK_EQ(i, p.pkt_seq[i]);
+    CHECK_EQ(ingest_mac_u64(f->frame + 10), p.sa[i]);
+    CHECK_EQ(f->rssi, p.rssi[i]);
+    CHECK_EQ(f->channel, p.channel[i]);
+    CHECK_EQ(7, p.track_id[i]);
+    CHECK_EQ(i / 4, p.dwell_id[i]);
+    // Epoch pela âncora: 1700000200.5 + (rx_us - 5 s)
+    CHECK_EQ(1700000200500000LL + (int64_t)i * 100000, p.ts_us[i]);
+    CHECK(p.flags[i] & INGEST_PROBE_ANCHORED);
+    CHECK_EQ(binary_is_delta[i], (p.flags[i] & INGEST_PROBE_DELTA) != 0);
+    CHECK(string_at(st, p.scanner[i]) == SCANNER_ID);
+    CHECK(string_at(st, p.capture[i]) == CAPTURE_ID);
+  }
+  CHECK(string_at(st, p.ssid[4]) == "CasaSilva_5G");
+  CHECK(string_at(st, p.vendor[8]) == "Intel Corporate");
+
+  // pcap: sem pkt_seq; o TSFT é o mesmo relógio de rx_us e passa pela âncora
+  size_t last = BINARY_PACKETS;
+  CHECK_EQ(1700000202500000LL, p.ts_us[last]);
+  CHECK(p.flags[last] & INGEST_PROBE_ANCHORED);
+  CHECK_EQ(0, p.flags[last] & INGEST_PROBE_HAS_SEQ);
+  CHECK(string_at(st, p.ssid[last]) == "CasaSilva_5G");
+
+  const ingest_device_columns_t& d = st->devices;
+  CHECK_EQ(1, d.sa.size());
+  CHECK_EQ(12, d.count[0]);
+  CHECK_EQ(-80, d.rssi_avg[0]);
+  CHECK_EQ(99, d.track_id[0]);
+  CHECK_EQ((int64_t)(EPOCH_S + 9) * 1000000, d.last_seen_us[0]);
+  CHECK(string_at(st, d.vendor[0]) == "Espressif Inc.");
+  delete st;
+}
+
+// Chunks pequenos em várias threads e em streaming: mesmo resultado da passada única
+static void test_chunking_is_transparent() {
+  std::string log = binary_log();
+  ingest_stitcher_t* a = new ingest_stitcher_t();
+  ingest_stitcher_t* b = new ingest_stitcher_t();
+  ingest_stitcher_t* c = new ingest_stitcher_t();
+  ingest_log(a, log, 1, INGEST_DEFAULT_CHUNK_SIZE, false);
+  ingest_log(b, log, 4, 200, false);
+  ingest_log(c, log, 3, 300, true);
+  CHECK(b->chunks > 10);
+
+  const ingest_stitcher_t* others[] = {b, c};
+  for (int k = 0; k < 2; k++) {
+    const ingest_stitcher_t* o = others[k];
+    CHECK(a->probes.ts_us == o->probes.ts_us);
+    CHECK(a->probes.sa == o->probes.sa);
+    CHECK(a->probes.pkt_seq == o->probes.pkt_seq);
+    CHECK(a->probes.flags == o->probes.flags);
+    CHECK(a->probes.ssid == o->probes.ssid);
+    CHECK(a->devices.sa == o->devices.sa);
+    CHECK(a->meta == o->meta);
+    CHECK(a->strings.blob == o->strings.blob);
+    CHECK_EQ(ingest_invalid_count(a), ingest_invalid_count(o));
+  }
+  delete a;
+  delete b;
+  delete c;
+}
+
+static void test_delta_without_keyframe() {
+  // Conexão no meio de uma rajada: o primeiro registro é um delta
+  static wire_delta_t delta;
+  wire_delta_init(&delta, 0);
+  uint8_t framed[WIRE_FRAMED_SIZE(1024)];
+  std::string log;
+  for (uint32_t i = 0; i < 3; i++) {
+    parse_corpus(corpus_frame("iphone_ios17_wildcard"), i);
+    capture.packet.track_id = 1;
+    size_t n = encode_capture_binary_delta(capture, &delta, framed, sizeof(framed));
+    if (i > 0) log.append((const char*)framed, n);
+  }
+  ingest_stitcher_t* st = new ingest_stitcher_t();
+  ingest_log(st, log, 1, INGEST_DEFAULT_CHUNK_SIZE, false);
+  CHECK_EQ(0, st->probes.ts_us.size());
+  CHECK_EQ(2, st->rejects[INGEST_REJECT_DELTA_UNRESOLVED]);
+  delete st;
+}
+
+// Stream do gateway: dois nós vendo o mesmo dispositivo usam o mesmo delta_ref;
+// sessão e keyframes de cada um são separados pelos registros de origem
+static void test_gateway_sources() {
+  static wire_delta_t delta[2];
+  const char* scanners[2] = {"node-a", "node-b"};
+  uint8_t record[256];
+  uint8_t framed[WIRE_FRAMED_SIZE(1024)];
+  std::string log;
+  for (int n = 0; n < 2; n++) wire_delta_init(&delta[n], 0);
+  for (uint32_t i = 0; i < 6; i++) {
+    for (int n = 0; n < 2; n++) {
+      wire_source_t source = {{0x24, 0x6f, 0x28, 0x00, 0x00, (uint8_t)n}, 0x1000u + n};
+      append_framed(&log, record, wire_encode_source(record, sizeof(record), &source));
+      if (i == 0) {
+        wire_session_t session = {EPOCH_S, 0, CAPTURE_ID, scanners[n], "test"};
+        append_framed(&log, record, wire_encode_session(record, sizeof(record), &session));
+      }
+      parse_corpus(corpus_frame("iphone_ios17_wildcard"), i + n * 1000);
+      capture.packet.track_id = 1;
+      log.append((const char*)framed, encode_capture_binary_delta(capture, &delta[n], framed, sizeof(framed)));
+    }
+  }
+
+  ingest_stitcher_t* st = new ingest_stitcher_t();
+  ingest_log(st, log, 1, INGEST_DEFAULT_CHUNK_SIZE, false);
+  const ingest_probe_columns_t& p = st->probes;
+  CHECK_EQ(12, p.ts_us.size());
+  CHECK_EQ(10, st->delta_records);
+  CHECK_EQ(0, ingest_invalid_count(st));
+  for (size_t i = 0; i < p.ts_us.size(); i++) {
+    int n = p.pkt_seq[i] >= 1000 ? 1 : 0;
+    CHECK(string_at(st, p.scanner[i]) == scanners[n]);
+    CHECK_EQ(i / 2 + n * 1000, p.pkt_seq[i]);
+  }
+  delete st;
+}
+
+// ---- Formato JSON --------------------------------------------------------------
+
+static void test_json_stream() {
+  static char json[4096];
+  std::string log = "=== WiFi Probe Monitor ===\r\nCanal configurado: 6\r\nets Jun  8 2016 00:22:57\r\n";
+  for (uint32_t i = 0; i < 10; i++) {
+    parse_corpus(&probe_corpus[i % 5], i);
+    size_t len = format_capture_json(capture, json, sizeof(json));
+    log.append(json, len);
+  }
+  std::string first = log.substr(log.find('{'), log.find("\r\n{", log.find('{')) - log.find('{') + 2);
+
+  // Repetido (log sobreposto), RSSI fora do range e campo ausente
+  log += first;
+  std::string bad_rssi = first;
+  size_t pos = bad_rssi.find("\"rssi_dbm\":");
+  bad_rssi.replace(pos, bad_rssi.find(',', pos) - pos, "\"rssi_dbm\":-130");
+  bad_rssi.replace(bad_rssi.find("-0000-"), 6, "-0001-");
+  log += bad_rssi;
+  log += "{\"capture_id\":\"x\",\"capture_ts\":\"2023-11-14T22:15:23.249Z\",\"packet\":{}}\r\n";
+  log += "{\"capture_id\":\"x\",\"scanner_id\":\"y\",\"capture_ts\":\"ontem\",\"packet\":{\"pkt_id\":\"a\","
+         "\"ieee80211\":{\"sa\":\"00:11:22:33:44:55\"},\"rssi_dbm\":-50,\"frame_raw_hex\":\"\"}}\r\n";
+  log += "# STATS: {\"type\":\"stats\"\r\n";
+  log += "# SUMMARY: {\"type\":\"summary\",\"unique_macs\":3}\r\n";
+  log += "# DEVICE: {\"type\":\"device\",\"capture_id\":\"6553f100-9abc-5678-4553-6553f1009abc\","
+         "\"scanner_id\":\"esp32-test\",\"window_start_ts\":\"2023-11-14T22:15:00.000Z\",\"window_ms\":60000,"
+         "\"sa\":\"7a:3f:1c:90:b2:e5\",\"oui\":\"7a:3f:1c\",\"mac_randomized\":true,\"vendor_inferred\":\"Unknown\","
+         "\"fp_hash\":\"1badcafe\",\"track_id\":5,\"first_seen_ts\":\"2023-11-14T22:15:01.000Z\","
+         "\"last_seen_ts\":\"2023-11-14T22:15:30.000Z\",\"count\":4,\"total_count\":9,\"rssi_min\":-60,"
+         "\"rssi_max\":-40,\"rssi_avg\":-50,\"channels\":[1,6,11]}\r\n";
+
+  ingest_stitcher_t* st = new ingest_stitcher_t();
+  ingest_log(st, log, 2, 512, false);
+
+  const ingest_probe_columns_t& p = st->probes;
+  CHECK_EQ(10, p.ts_us.size());
+  CHECK_EQ(1, st->duplicates);
+  CHECK_EQ(1, st->rejects[INGEST_REJECT_RSSI_RANGE]);
+  CHECK_EQ(1, st->rejects[INGEST_REJECT_MISSING_SCANNER_ID]);
+  CHECK_EQ(1, st->rejects[INGEST_REJECT_BAD_TIMESTAMP]);
+  // Linha de boot e "# STATS:" truncado
+  CHECK_EQ(2, st->rejects[INGEST_REJECT_JSON_DECODE]);
+  CHECK(has_meta(st, "# SUMMARY: {"));
+  CHECK(!has_meta(st, "# STATS:"));
+
+  for (uint32_t i = 0; i < 10 && i < p.ts_us.size(); i++) {
+    const probe_corpus_frame_t* f = &probe_corpus[i % 5];
+    CHECK_EQ(i, p.pkt_seq[i]);
+    CHECK_EQ(ingest_mac_u64(f->frame + 10), p.sa[i]);
+    CHECK_EQ((int64_t)(EPOCH_S + i / 10) * 1000000 + (i % 10) * 100000, p.ts_us[i]);
+    CHECK_EQ(5000000 + i * 100000, p.rx_us[i]);
+    CHECK_EQ(1 + (i % 3), p.track_id[i]);
+    CHECK(p.flags[i] & INGEST_PROBE_HAS_FP);
+    CHECK(string_at(st, p.capture[i]) == CAPTURE_ID);
+  }
+  CHECK(string_at(st, p.ssid[1]) == "CasaSilva_5G");
+  CHECK(string_at(st, p.vendor[2]) == "Intel Corporate");
+
+  const ingest_device_columns_t& d = st->devices;
+  CHECK_EQ(1, d.sa.size());
+  CHECK_EQ(0x7a3f1c90b2e5ULL, d.sa[0]);
+  CHECK_EQ((1 << 1) | (1 << 6) | (1 << 11), d.channels_mask[0]);
+  CHECK_EQ(0x1badcafe, d.fp_hash[0]);
+  CHECK_EQ(60000, d.window_ms[0]);
+  CHECK_EQ(WIRE_DEVICE_FLAG_RANDOMIZED, d.flags[0]);
+  CHECK_EQ(1700000101000000LL, d.first_seen_us[0]);
+
+  // Sem deduplicação a linha repetida entra
+  ingest_stitcher_t* all = new ingest_stitcher_t();
+  ingest_log(all, log, 1, INGEST_DEFAULT_CHUNK_SIZE, true, false);
+  CHECK_EQ(11, all->probes.ts_us.size());
+  delete all;
+  delete st;
+}
+
+// ---- Arquivo colunar -----------------------------------------------------------
+
+static uint64_t get_u64(const uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+  return v;
+}
+
+static void test_columnar_file() {
+  ingest_stitcher_t* st = new ingest_stitcher_t();
+  ingest_log(st, binary_log(), 1, INGEST_DEFAULT_CHUNK_SIZE, false);
+  std::vector<pcol_column_t> columns;
+  ingest_collect_columns(st, &columns);
+  const char* path = "/tmp/ingest_test.pcol";
+  CHECK(pcol_write(path, columns));
+
+  FILE* f = fopen(path, "rb");
+  CHECK(f != NULL);
+  std::vector<uint8_t> file;
+  if (f != NULL) {
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) file.insert(file.end(), buf, buf + n);
+    fclose(f);
+  }
+  unlink(path);
+  CHECK(file.size() > PCOL_HEADER_SIZE && memcmp(&file[0], PCOL_MAGIC, 8) == 0);
+  if (failures > 0) {
+    delete st;
+    return;
+  }
+  CHECK_EQ(PCOL_VERSION, file[8]);
+  uint32_t count = file[12] | (file[13] << 8);
+  CHECK_EQ(columns.size(), count);
+
+  bool found = false;
+  for (uint32_t i = 0; i < count; i++) {
+    const uint8_t* e = &file[PCOL_HEADER_SIZE + i * PCOL_DIR_ENTRY_SIZE];
+    uint64_t offset = get_u64(e + 40);
+    uint64_t bytes = get_u64(e + 56);
+    CHECK_EQ(0, offset % PCOL_ALIGN);
+    CHECK(offset + bytes <= file.size());
+    if (strcmp((const char*)e, "probes") == 0 && strcmp((const char*)e + 12, "ts_us") == 0) {
+      found = true;
+      CHECK(strcmp((const char*)e + 32, "<i8") == 0);
+      CHECK_EQ(st->probes.ts_us.size(), get_u64(e + 48));
+      CHECK(memcmp(&file[offset], &st->probes.ts_us[0], bytes) == 0);
+    }
+  }
+  CHECK(found);
+  delete st;
+}
+
+int main() {
+  test_json_reader();
+  test_iso8601();
+  test_binary_stream();
+  test_chunking_is_transparent();
+  test_delta_without_keyframe();
+  test_gateway_sources();
+  test_json_stream();
+  test_columnar_file();
+  if (failures == 0) printf("ingest_test: OK\n");
+  return failures == 0 ? 0 : 1;
+}
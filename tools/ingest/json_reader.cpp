@@ -0,0 +1,274 @@
+#include <string.h>
+#include <stdlib.h>
+#include "json_reader.h"
+
+typedef struct {
+  const char* p;
+  const char* end;
+  json_doc_t* doc;
+} json_parser_t;
+
+static inline void skip_ws(json_parser_t* ps) {
+  while (ps->p < ps->end && (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r')) ps->p++;
+}
+
+static inline bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static uint32_t push_node(json_parser_t* ps, uint8_t type, const char* start) {
+  json_node_t n;
+  n.type = type;
+  n.flag = false;
+  n.len = 0;
+  n.start = start;
+  n.next = 0;
+  n.children = 0;
+  ps->doc->nodes.push_back(n);
+  return (uint32_t)ps->doc->nodes.size() - 1;
+}
+
+static bool parse_string(json_parser_t* ps) {
+  const char* start = ++ps->p;  // após a aspa
+  bool escaped = false;
+  while (ps->p < ps->end) {
+    unsigned char c = (unsigned char)*ps->p;
+    if (c == '"') {
+      uint32_t i = push_node(ps, JSON_NODE_STRING, start);
+      ps->doc->nodes[i].len = (uint32_t)(ps->p - start);
+      ps->doc->nodes[i].flag = escaped;
+      ps->doc->nodes[i].next = i + 1;
+      ps->p++;
+      return true;
+    }
+    if (c < 0x20) return false;
+    if (c == '\\') {
+      escaped = true;
+      if (++ps->p >= ps->end) return false;
+      char e = *ps->p;
+      if (e == 'u') {
+        if (ps->end - ps->p < 5) return false;
+        for (int k = 1; k <= 4; k++) {
+          char h = ps->p[k];
+          if (!is_digit(h) && !(h >= 'a' && h <= 'f') && !(h >= 'A' && h <= 'F')) return false;
+        }
+        ps->p += 4;
+      } else if (!strchr("\"\\/bfnrt", e)) {
+        return false;
+      }
+    }
+    ps->p++;
+  }
+  return false;
+}
+
+static bool parse_number(json_parser_t* ps) {
+  const char* start = ps->p;
+  bool integer = true;
+  if (ps->p < ps->end && *ps->p == '-') ps->p++;
+  if (ps->p >= ps->end) return false;
+  if (*ps->p == '0') {
+    ps->p++;
+  } else if (is_digit(*ps->p)) {
+    while (ps->p < ps->end && is_digit(*ps->p)) ps->p++;
+  } else {
+    return false;
+  }
+  if (ps->p < ps->end && *ps->p == '.') {
+    integer = false;
+    if (++ps->p >= ps->end || !is_digit(*ps->p)) return false;
+    while (ps->p < ps->end && is_digit(*ps->p)) ps->p++;
+  }
+  if (ps->p < ps->end && (*ps->p == 'e' || *ps->p == 'E')) {
+    integer = false;
+    if (++ps->p < ps->end && (*ps->p == '+' || *ps->p == '-')) ps->p++;
+    if (ps->p >= ps->end || !is_digit(*ps->p)) return false;
+    while (ps->p < ps->end && is_digit(*ps->p)) ps->p++;
+  }
+  uint32_t i = push_node(ps, JSON_NODE_NUMBER, start);
+  ps->doc->nodes[i].len = (uint32_t)(ps->p - start);
+  ps->doc->nodes[i].flag = integer;
+  ps->doc->nodes[i].next = i + 1;
+  return true;
+}
+
+static bool parse_literal(json_parser_t* ps, const char* word, uint8_t type, bool value) {
+  size_t n = strlen(word);
+  if ((size_t)(ps->end - ps->p) < n || memcmp(ps->p, word, n) != 0) return false;
+  uint32_t i = push_node(ps, type, ps->p);
+  ps->doc->nodes[i].flag = value;
+  ps->doc->nodes[i].next = i + 1;
+  ps->p += n;
+  return true;
+}
+
+static bool parse_value(json_parser_t* ps, int depth) {
+  skip_ws(ps);
+  if (ps->p >= ps->end) return false;
+  switch (*ps->p) {
+    case '"': return parse_string(ps);
+    case 't': return parse_literal(ps, "true", JSON_NODE_BOOL, true);
+    case 'f': return parse_literal(ps, "false", JSON_NODE_BOOL, false);
+    case 'n': return parse_literal(ps, "null", JSON_NODE_NULL, false);
+    case '{':
+    case '[': {
+      if (depth >= JSON_READER_MAX_DEPTH) return false;
+      bool object = *ps->p == '{';
+      char close = object ? '}' : ']';
+      uint32_t i = push_node(ps, object ? JSON_NODE_OBJECT : JSON_NODE_ARRAY, ps->p);
+      uint32_t children = 0;
+      ps->p++;
+      skip_ws(ps);
+      if (ps->p < ps->end && *ps->p == close) {
+        ps->p++;
+      } else {
+        for (;;) {
+          if (object) {
+            skip_ws(ps);
+            if (ps->p >= ps->end || *ps->p != '"' || !parse_string(ps)) return false;
+            skip_ws(ps);
+            if (ps->p >= ps->end || *ps->p != ':') return false;
+            ps->p++;
+          }
+          if (!parse_value(ps, depth + 1)) return false;
+          children++;
+          skip_ws(ps);
+          if (ps->p >= ps->end) return false;
+          if (*ps->p == ',') {
+            ps->p++;
+            continue;
+          }
+          if (*ps->p != close) return false;
+          ps->p++;
+          break;
+        }
+      }
+      // Referência refeita: push_node pode ter realocado o vetor
+      json_node_t& n = ps->doc->nodes[i];
+      n.children = children;
+      n.next = (uint32_t)ps->doc->nodes.size();
+      n.len = (uint32_t)(ps->p - n.start);
+      return true;
+    }
+    default:
+      return parse_number(ps);
+  }
+}
+
+bool json_parse(json_doc_t* doc, const char* text, size_t len) {
+  json_parser_t ps;
+  ps.p = text;
+  ps.end = text + len;
+  ps.doc = doc;
+  doc->nodes.clear();
+  if (!parse_value(&ps, 0)) return false;
+  skip_ws(&ps);
+  return ps.p == ps.end;
+}
+
+int json_find(const json_doc_t* doc, int object, const char* key) {
+  if (object < 0 || doc->nodes[object].type != JSON_NODE_OBJECT) return -1;
+  size_t key_len = strlen(key);
+  uint32_t i = object + 1;
+  for (uint32_t k = 0; k < doc->nodes[object].children; k++) {
+    const json_node_t& name = doc->nodes[i];
+    if (name.len == key_len && memcmp(name.start, key, key_len) == 0) return (int)(i + 1);
+    i = doc->nodes[i + 1].next;
+  }
+  return -1;
+}
+
+int json_find_type(const json_doc_t* doc, int object, const char* key, uint8_t type) {
+  int i = json_find(doc, object, key);
+  return i >= 0 && doc->nodes[i].type == type ? i : -1;
+}
+
+bool json_get_int(const json_doc_t* doc, int node, int64_t* out) {
+  if (node < 0) return false;
+  const json_node_t& n = doc->nodes[node];
+  if (n.type != JSON_NODE_NUMBER || !n.flag || n.len > 19) return false;
+  bool negative = n.start[0] == '-';
+  int64_t v = 0;
+  for (uint32_t k = negative ? 1 : 0; k < n.len; k++) v = v * 10 + (n.start[k] - '0');
+  *out = negative ? -v : v;
+  return true;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return c - 'A' + 10;
+}
+
+static size_t put_utf8(char* out, uint32_t cp) {
+  if (cp < 0x80) {
+    out[0] = (char)cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = (char)(0xC0 | (cp >> 6));
+    out[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = (char)(0xE0 | (cp >> 12));
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  out[0] = (char)(0xF0 | (cp >> 18));
+  out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+  out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+  out[3] = (char)(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+size_t json_get_string(const json_doc_t* doc, int node, char* out, size_t out_size) {
+  if (out_size == 0) return 0;
+  const json_node_t& n = doc->nodes[node];
+  size_t len = 0;
+  if (!n.flag) {
+    len = n.len < out_size - 1 ? n.len : out_size - 1;
+    memcpy(out, n.start, len);
+    out[len] = '\0';
+    return len;
+  }
+
+  const char* p = n.start;
+  const char* end = n.start + n.len;
+  while (p < end && len + 4 < out_size) {
+    if (*p != '\\') {
+      out[len++] = *p++;
+      continue;
+    }
+    char e = p[1];
+    p += 2;
+    switch (e) {
+      case 'b': out[len++] = '\b'; break;
+      case 'f': out[len++] = '\f'; break;
+      case 'n': out[len++] = '\n'; break;
+      case 'r': out[len++] = '\r'; break;
+      case 't': out[len++] = '\t'; break;
+      case 'u': {
+        uint32_t cp = 0;
+        for (int k = 0; k < 4; k++) cp = (cp << 4) | hex_value(p[k]);
+        p += 4;
+        // Par de surrogates UTF-16
+        if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+          uint32_t low = 0;
+          for (int k = 0; k < 4; k++) low = (low << 4) | hex_value(p[2 + k]);
+          if (low >= 0xDC00 && low < 0xE000) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            p += 6;
+          }
+        }
+        if (cp >= 0xD800 && cp < 0xE000) cp = 0xFFFD;
+        len += put_utf8(out + len, cp);
+        break;
+      }
+      default: out[len++] = e; break;   // \" \\ \/
+    }
+  }
+  out[len] = '\0';
+  return len;
+}
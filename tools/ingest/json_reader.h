@@ -0,0 +1,51 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Leitor JSON mínimo para as linhas do firmware (contraparte de
+// include/json_writer.h). O documento vira um vetor plano de nós em ordem de
+// pré-ordem; strings e números ficam como faixas do buffer de entrada, sem
+// cópia. Um objeto é seguido dos pares chave (string) + valor; next aponta
+// para o nó seguinte à subárvore, então pular um valor é O(1).
+// Gramática do RFC 8259 (json.loads aceita o mesmo nesses logs).
+
+#define JSON_READER_MAX_DEPTH 32
+
+enum {
+  JSON_NODE_NULL = 0,
+  JSON_NODE_BOOL,
+  JSON_NODE_NUMBER,
+  JSON_NODE_STRING,
+  JSON_NODE_OBJECT,
+  JSON_NODE_ARRAY
+};
+
+typedef struct {
+  uint8_t type;
+  bool flag;             // bool: valor; number: inteiro (sem fração/expoente); string: tem escapes
+  uint32_t len;          // string: bytes sem as aspas; number: texto
+  const char* start;
+  uint32_t next;         // índice do nó após a subárvore
+  uint32_t children;     // objeto: pares; array: elementos
+} json_node_t;
+
+typedef struct {
+  std::vector<json_node_t> nodes;
+} json_doc_t;
+
+// false se o texto não for um único documento JSON válido
+bool json_parse(json_doc_t* doc, const char* text, size_t len);
+
+// Índice do valor da chave no objeto, ou -1 (comparação sobre a forma escapada)
+int json_find(const json_doc_t* doc, int object, const char* key);
+// Atalho: json_find seguido de checagem do tipo; -1 se ausente ou de outro tipo
+int json_find_type(const json_doc_t* doc, int object, const char* key, uint8_t type);
+
+bool json_get_int(const json_doc_t* doc, int node, int64_t* out);   // só inteiros
+// String decodificada (UTF-8) terminada em '\0'; retorna o tamanho, truncado em out_size - 1
+size_t json_get_string(const json_doc_t* doc, int node, char* out, size_t out_size);
+
+#endif // JSON_READER_H
@@ -0,0 +1,213 @@
+// probe_ingest: converte capturas do WiFi Probe Monitor (JSON ou binário,
+// de arquivos de log, stdin ou direto da porta serial) para o arquivo colunar
+// .pcol lido por tools/analyze_probes.py.
+//
+//   probe_ingest capture.log                      -> capture.pcol
+//   probe_ingest -o todos.pcol -j 8 node1.log node2.log
+//   probe_ingest -o live.pcol --baud 921600 /dev/ttyUSB0   (Ctrl-C encerra)
+//   pio device monitor --raw | probe_ingest -o live.pcol -
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ingest.h"
+#include "pipeline.h"
+#include "columnar_writer.h"
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void on_sigint(int) {
+  interrupted = 1;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "uso: probe_ingest [-o saida.pcol] [-j threads] [--chunk-mb N] [--baud N] [--no-dedup] entrada...\n"
+          "  entrada: arquivo de log (JSON ou binário), '-' para stdin ou porta serial (/dev/tty*)\n"
+          "  -o           arquivo colunar (padrão: primeira entrada com extensão .pcol)\n"
+          "  -j           threads de decodificação (padrão: núcleos disponíveis)\n"
+          "  --chunk-mb   tamanho dos chunks em MiB (padrão: %u)\n"
+          "  --baud       velocidade da porta serial (padrão: 921600, o monitor_speed do projeto)\n"
+          "  --no-dedup   mantém probes e registros de dispositivo repetidos\n",
+          (unsigned)(INGEST_DEFAULT_CHUNK_SIZE >> 20));
+}
+
+static speed_t baud_constant(long baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+#ifdef B460800
+    case 460800: return B460800;
+#endif
+#ifdef B921600
+    case 921600: return B921600;
+#endif
+#ifdef B1500000
+    case 1500000: return B1500000;
+#endif
+#ifdef B2000000
+    case 2000000: return B2000000;
+#endif
+    default: return 0;
+  }
+}
+
+// Porta serial em modo raw (8N1, sem eco nem tradução de fim de linha)
+static bool configure_tty(int fd, long baud) {
+  speed_t speed = baud_constant(baud);
+  if (speed == 0) {
+    fprintf(stderr, "probe_ingest: baud %ld não suportado\n", baud);
+    return false;
+  }
+  struct termios tio;
+  if (tcgetattr(fd, &tio) != 0) return false;
+  cfmakeraw(&tio);
+  tio.c_cflag |= CLOCAL | CREAD;
+  tio.c_cc[VMIN] = 1;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+static std::string default_output(const char* input) {
+  std::string path = input;
+  size_t slash = path.find_last_of('/');
+  size_t dot = path.find_last_of('.');
+  if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) path.erase(dot);
+  return path + ".pcol";
+}
+
+static bool ingest_input(ingest_pipeline_t* pl, const char* path, long baud) {
+  if (strcmp(path, "-") == 0) return ingest_pipeline_stream(pl, STDIN_FILENO);
+
+  int fd = open(path, O_RDONLY | O_NOCTTY);
+  if (fd < 0) return false;
+  struct stat st;
+  bool ok;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    ok = ingest_pipeline_file(pl, fd, (size_t)st.st_size);
+  } else {
+    ok = (!isatty(fd) || configure_tty(fd, baud)) && ingest_pipeline_stream(pl, fd);
+  }
+  int saved = errno;
+  close(fd);
+  errno = saved;
+  return ok;
+}
+
+static double now_s() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+  std::string output;
+  unsigned threads = std::thread::hardware_concurrency();
+  size_t chunk_size = INGEST_DEFAULT_CHUNK_SIZE;
+  long baud = 921600;
+  ingest_options_t options;
+  options.dedup = true;
+  std::vector<const char*> inputs;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (strcmp(arg, "-o") == 0 && has_value) {
+      output = argv[++i];
+    } else if (strcmp(arg, "-j") == 0 && has_value) {
+      threads = (unsigned)atoi(argv[++i]);
+    } else if (strcmp(arg, "--chunk-mb") == 0 && has_value) {
+      chunk_size = (size_t)atoi(argv[++i]) << 20;
+    } else if (strcmp(arg, "--baud") == 0 && has_value) {
+      baud = atol(argv[++i]);
+    } else if (strcmp(arg, "--no-dedup") == 0) {
+      options.dedup = false;
+    } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+      usage();
+      return 0;
+    } else if (arg[0] == '-' && arg[1] != '\0') {
+      usage();
+      return 2;
+    } else {
+      inputs.push_back(arg);
+    }
+  }
+  if (inputs.empty() || chunk_size == 0) {
+    usage();
+    return 2;
+  }
+  if (output.empty()) {
+    if (strcmp(inputs[0], "-") == 0) {
+      fprintf(stderr, "probe_ingest: -o é obrigatório com stdin\n");
+      return 2;
+    }
+    output = default_output(inputs[0]);
+  }
+
+  // Sem SA_RESTART: o read() da porta serial retorna com EINTR no Ctrl-C
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = on_sigint;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  // Alocado no heap: a tabela de keyframes e os contadores somam dezenas de KB
+  ingest_stitcher_t* stitcher = new ingest_stitcher_t();
+  ingest_stitcher_init(stitcher, &options);
+
+  ingest_pipeline_options_t pipeline_options;
+  pipeline_options.threads = threads;
+  pipeline_options.chunk_size = chunk_size;
+  pipeline_options.stop = &interrupted;
+  ingest_pipeline_t pipeline;
+  ingest_pipeline_start(&pipeline, &pipeline_options, stitcher);
+
+  double start = now_s();
+  int status = 0;
+  for (size_t i = 0; i < inputs.size() && !interrupted; i++) {
+    if (!ingest_input(&pipeline, inputs[i], baud)) {
+      fprintf(stderr, "probe_ingest: %s: %s\n", inputs[i], strerror(errno));
+      status = 1;
+    }
+  }
+  ingest_pipeline_finish(&pipeline);
+  double elapsed = now_s() - start;
+
+  // Contadores da ingestão seguem junto com as linhas "# STATS:" e "# SUMMARY:"
+  std::string report = "# INGEST: " + ingest_report_json(stitcher);
+  stitcher->meta.push_back(stitcher->strings.intern(report.data(), report.size()));
+
+  std::vector<pcol_column_t> columns;
+  ingest_collect_columns(stitcher, &columns);
+  if (!pcol_write(output.c_str(), columns)) {
+    fprintf(stderr, "probe_ingest: %s: %s\n", output.c_str(), strerror(errno));
+    delete stitcher;
+    return 1;
+  }
+
+  fprintf(stderr,
+          "probe_ingest: %zu probes, %zu registros de dispositivo, %llu inválidos, %llu duplicados; "
+          "%.1f MB em %.2fs (%.0f MB/s, %u threads) -> %s\n",
+          stitcher->probes.ts_us.size(), stitcher->devices.sa.size(),
+          (unsigned long long)ingest_invalid_count(stitcher), (unsigned long long)stitcher->duplicates,
+          pipeline.bytes / 1e6, elapsed, elapsed > 0 ? pipeline.bytes / 1e6 / elapsed : 0.0,
+          threads > 1 ? threads : 1, output.c_str());
+  delete stitcher;
+  return status;
+}
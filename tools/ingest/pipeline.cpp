@@ -0,0 +1,196 @@
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "pipeline.h"
+
+static void worker_main(ingest_pipeline_t* pl) {
+  std::unique_lock<std::mutex> lock(pl->mutex);
+  for (;;) {
+    while (pl->queue.empty() && !pl->stopping) pl->work_cv.wait(lock);
+    if (pl->queue.empty()) return;
+    ingest_job_t* job = pl->queue.front();
+    pl->queue.pop_front();
+    lock.unlock();
+    decode_chunk(&job->chunk, &job->result);
+    lock.lock();
+    job->done = true;
+    pl->done_cv.notify_all();
+  }
+}
+
+void ingest_pipeline_start(ingest_pipeline_t* pl, const ingest_pipeline_options_t* options,
+                           ingest_stitcher_t* stitcher) {
+  pl->options = *options;
+  if (pl->options.chunk_size == 0) pl->options.chunk_size = INGEST_DEFAULT_CHUNK_SIZE;
+  pl->stitcher = stitcher;
+  pl->bytes = 0;
+  pl->stopping = false;
+  pl->next_input_start = false;
+  if (pl->options.threads > 1) {
+    for (unsigned i = 0; i < pl->options.threads; i++) pl->workers.push_back(std::thread(worker_main, pl));
+  }
+}
+
+static void stitch_job(ingest_pipeline_t* pl, ingest_job_t* job) {
+  if (job->input_start) ingest_stitcher_begin_input(pl->stitcher);
+  ingest_stitch(pl->stitcher, &job->result);
+}
+
+// Costura os chunks prontos na ordem; espera enquanto houver mais de
+// max_inflight em voo (0 = até esvaziar)
+static void drain(ingest_pipeline_t* pl, size_t max_inflight) {
+  std::unique_lock<std::mutex> lock(pl->mutex);
+  for (;;) {
+    if (pl->inflight.empty()) return;
+    ingest_job_t* job = pl->inflight.front();
+    if (!job->done) {
+      if (pl->inflight.size() <= max_inflight) return;
+      pl->done_cv.wait(lock);
+      continue;
+    }
+    pl->inflight.pop_front();
+    lock.unlock();
+    stitch_job(pl, job);
+    lock.lock();
+    pl->free_jobs.push_back(job);
+  }
+}
+
+static ingest_job_t* new_job(ingest_pipeline_t* pl) {
+  ingest_job_t* job;
+  {
+    std::lock_guard<std::mutex> lock(pl->mutex);
+    if (pl->free_jobs.empty()) {
+      job = new ingest_job_t();
+    } else {
+      job = pl->free_jobs.back();
+      pl->free_jobs.pop_back();
+    }
+  }
+  job->done = false;
+  job->input_start = pl->next_input_start;
+  pl->next_input_start = false;
+  return job;
+}
+
+static void submit(ingest_pipeline_t* pl, ingest_job_t* job) {
+  pl->bytes += job->chunk.len;
+  if (pl->workers.empty()) {
+    decode_chunk(&job->chunk, &job->result);
+    stitch_job(pl, job);
+    std::lock_guard<std::mutex> lock(pl->mutex);
+    pl->free_jobs.push_back(job);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(pl->mutex);
+    pl->queue.push_back(job);
+    pl->inflight.push_back(job);
+  }
+  pl->work_cv.notify_one();
+  drain(pl, pl->workers.size() * 2);
+}
+
+bool ingest_pipeline_file(ingest_pipeline_t* pl, int fd, size_t size) {
+  pl->next_input_start = true;
+  if (size == 0) {
+    ingest_stitcher_begin_input(pl->stitcher);
+    pl->next_input_start = false;
+    return true;
+  }
+  void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) return false;
+  madvise(map, size, MADV_SEQUENTIAL);
+  const uint8_t* data = (const uint8_t*)map;
+
+  // Logs do formato binário contêm delimitadores 0x00; texto puro não
+  bool binary = memchr(data, 0x00, size) != NULL;
+  uint8_t delim = binary ? 0x00 : '\n';
+
+  size_t pos = 0;
+  while (pos < size) {
+    size_t end = size - pos > pl->options.chunk_size ? pos + pl->options.chunk_size : size;
+    if (end < size) {
+      size_t cut = ingest_safe_cut(data + pos, end - pos, binary);
+      if (cut > 0) {
+        end = pos + cut;
+      } else {
+        // Linha (ou bloco) maior que o chunk: estende até o próximo delimitador
+        const uint8_t* next = (const uint8_t*)memchr(data + end, delim, size - end);
+        end = next ? (size_t)(next - data) + 1 : size;
+      }
+    }
+    ingest_job_t* job = new_job(pl);
+    job->owned.clear();
+    job->chunk.data = data + pos;
+    job->chunk.len = end - pos;
+    job->chunk.binary = binary;
+    submit(pl, job);
+    pos = end;
+  }
+  // Os chunks apontam para o mapeamento: costura tudo antes do munmap
+  drain(pl, 0);
+  munmap(map, size);
+  return true;
+}
+
+static void submit_owned(ingest_pipeline_t* pl, std::vector<uint8_t>* pending, size_t len, bool binary) {
+  ingest_job_t* job = new_job(pl);
+  job->owned.assign(pending->begin(), pending->begin() + len);
+  pending->erase(pending->begin(), pending->begin() + len);
+  job->chunk.data = job->owned.data();
+  job->chunk.len = len;
+  job->chunk.binary = binary;
+  submit(pl, job);
+}
+
+bool ingest_pipeline_stream(ingest_pipeline_t* pl, int fd) {
+  pl->next_input_start = true;
+  std::vector<uint8_t> pending;
+  std::vector<uint8_t> buf(64 * 1024);
+  bool binary = false;
+  bool ok = true;
+
+  for (;;) {
+    if (pl->options.stop && *pl->options.stop) break;
+    ssize_t n = read(fd, buf.data(), buf.size());
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ok = false;
+      break;
+    }
+    if (n == 0) break;
+    // Nada antes do primeiro 0x00 pode ser parte de um registro: texto até lá
+    if (!binary && memchr(buf.data(), 0x00, n) != NULL) binary = true;
+    pending.insert(pending.end(), buf.begin(), buf.begin() + n);
+
+    if (pending.size() >= pl->options.chunk_size) {
+      size_t cut = ingest_safe_cut(pending.data(), pending.size(), binary);
+      // Sem delimitador em 4 chunks (lixo no link): corta assim mesmo
+      if (cut == 0 && pending.size() >= 4 * pl->options.chunk_size) cut = pending.size();
+      if (cut > 0) submit_owned(pl, &pending, cut, binary);
+    }
+  }
+  if (!pending.empty()) submit_owned(pl, &pending, pending.size(), binary);
+  if (pl->next_input_start) {
+    // Entrada vazia: ainda conta como início de entrada
+    ingest_stitcher_begin_input(pl->stitcher);
+    pl->next_input_start = false;
+  }
+  drain(pl, 0);
+  return ok;
+}
+
+void ingest_pipeline_finish(ingest_pipeline_t* pl) {
+  drain(pl, 0);
+  {
+    std::lock_guard<std::mutex> lock(pl->mutex);
+    pl->stopping = true;
+  }
+  pl->work_cv.notify_all();
+  for (size_t i = 0; i < pl->workers.size(); i++) pl->workers[i].join();
+  pl->workers.clear();
+  for (size_t i = 0; i < pl->free_jobs.size(); i++) delete pl->free_jobs[i];
+  pl->free_jobs.clear();
+}
@@ -0,0 +1,65 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <signal.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ingest.h"
+
+// Leitura das entradas e distribuição dos chunks: a thread chamadora lê e
+// costura (ingest_stitch) na ordem do stream; threads workers rodam
+// decode_chunk() em paralelo. No máximo 2 * threads chunks em voo.
+//
+// Arquivos regulares são mapeados (mmap) e cortados em chunks de chunk_size
+// sem cópia. stdin, pipes e portas seriais são lidos em streaming: o resto
+// após o último corte seguro fica para o próximo chunk.
+
+#ifndef INGEST_DEFAULT_CHUNK_SIZE
+#define INGEST_DEFAULT_CHUNK_SIZE (4u << 20)
+#endif
+
+typedef struct {
+  unsigned threads;                      // 0 ou 1 = decodifica na própria thread
+  size_t chunk_size;
+  const volatile sig_atomic_t* stop;     // interrompe a leitura de streams (SIGINT)
+} ingest_pipeline_options_t;
+
+struct ingest_job_t {
+  ingest_chunk_t chunk;
+  std::vector<uint8_t> owned;            // bytes do chunk em streaming
+  ingest_chunk_result_t result;
+  bool input_start;
+  bool done;
+};
+
+struct ingest_pipeline_t {
+  ingest_pipeline_options_t options;
+  ingest_stitcher_t* stitcher;
+  uint64_t bytes;
+
+  std::mutex mutex;
+  std::condition_variable work_cv;
+  std::condition_variable done_cv;
+  std::deque<ingest_job_t*> queue;       // aguardando um worker
+  std::deque<ingest_job_t*> inflight;    // ordem do stream
+  std::vector<ingest_job_t*> free_jobs;  // reaproveitados (vetores mantêm a capacidade)
+  std::vector<std::thread> workers;
+  bool stopping;
+  bool next_input_start;
+};
+
+void ingest_pipeline_start(ingest_pipeline_t* pl, const ingest_pipeline_options_t* options,
+                           ingest_stitcher_t* stitcher);
+// Arquivo regular (mmap); false com errno em caso de erro
+bool ingest_pipeline_file(ingest_pipeline_t* pl, int fd, size_t size);
+// Lê fd até EOF ou *options.stop
+bool ingest_pipeline_stream(ingest_pipeline_t* pl, int fd);
+// Costura tudo o que está em voo e encerra os workers
+void ingest_pipeline_finish(ingest_pipeline_t* pl);
+
+#endif // PIPELINE_H
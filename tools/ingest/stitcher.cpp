@@ -0,0 +1,335 @@
+#include <string.h>
+#include <stdio.h>
+#include "ingest.h"
+#include "wire_format.h"
+#include "probe_record.h"
+
+// Fase 2: aplica, na ordem do stream, o estado que atravessa chunks
+
+static uint32_t fnv1a32(const char* s, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) h = (h ^ (uint8_t)s[i]) * 16777619u;
+  return h;
+}
+
+static uint64_t mix64(uint64_t h, uint64_t v) {
+  // FNV-1a de 64 bits, palavra a palavra (chaves de deduplicação)
+  for (int i = 0; i < 8; i++) h = (h ^ ((v >> (i * 8)) & 0xFF)) * 1099511628211ull;
+  return h;
+}
+
+ingest_strings_t::ingest_strings_t() : table(1024, 0) {
+  offsets.push_back(0);
+  intern("", 0);
+}
+
+static void strings_rehash(ingest_strings_t* s) {
+  std::vector<uint32_t> table(s->table.size() * 2, 0);
+  size_t mask = table.size() - 1;
+  for (uint32_t id = 0; id < s->hashes.size(); id++) {
+    size_t pos = s->hashes[id] & mask;
+    while (table[pos] != 0) pos = (pos + 1) & mask;
+    table[pos] = id + 1;
+  }
+  s->table.swap(table);
+}
+
+uint32_t ingest_strings_t::intern(const char* s, size_t len) {
+  uint32_t h = fnv1a32(s, len);
+  size_t mask = table.size() - 1;
+  for (size_t pos = h & mask;; pos = (pos + 1) & mask) {
+    uint32_t slot = table[pos];
+    if (slot == 0) break;
+    uint32_t id = slot - 1;
+    if (hashes[id] == h && offsets[id + 1] - offsets[id] == len && memcmp(blob.data() + offsets[id], s, len) == 0) {
+      return id;
+    }
+  }
+
+  uint32_t id = (uint32_t)hashes.size();
+  blob.append(s, len);
+  offsets.push_back((uint32_t)blob.size());
+  hashes.push_back(h);
+  // Carga máxima de 1/2, como os índices do firmware
+  if (hashes.size() * 2 > table.size()) {
+    strings_rehash(this);
+  } else {
+    size_t pos = h & mask;
+    while (table[pos] != 0) pos = (pos + 1) & mask;
+    table[pos] = id + 1;
+  }
+  return id;
+}
+
+void ingest_stitcher_init(ingest_stitcher_t* st, const ingest_options_t* options) {
+  st->options = *options;
+  st->inputs = st->chunks = st->records = st->lines = 0;
+  st->unknown_records = st->pcap_skipped = st->delta_records = 0;
+  st->anchored = st->duplicates = 0;
+  memset(st->rejects, 0, sizeof(st->rejects));
+  ingest_stitcher_begin_input(st);
+  st->inputs = 0;
+}
+
+void ingest_stitcher_begin_input(ingest_stitcher_t* st) {
+  // Sessão e keyframes são do link de um nó; âncoras e dedup valem entre arquivos
+  st->inputs++;
+  st->sources.clear();
+  st->source = &st->sources[0];
+}
+
+static inline uint64_t session_key(uint32_t scanner, uint32_t capture) {
+  return ((uint64_t)scanner << 32) | capture;
+}
+
+// Primeira ocorrência da chave? (sempre true sem deduplicação)
+static bool first_seen(ingest_stitcher_t* st, uint64_t key) {
+  if (!st->options.dedup) return true;
+  if (st->seen.insert(key).second) return true;
+  st->duplicates++;
+  return false;
+}
+
+static uint32_t vendor_id(ingest_stitcher_t* st, const uint64_t sa) {
+  uint8_t mac[6];
+  for (int i = 0; i < 6; i++) mac[i] = (sa >> (40 - i * 8)) & 0xFF;
+  const char* vendor = get_vendor_from_mac(mac);
+  // Nomes vêm do pool da tabela OUI: o ponteiro identifica o vendor
+  std::unordered_map<const char*, uint32_t>::iterator it = st->vendor_index.find(vendor);
+  if (it != st->vendor_index.end()) return it->second;
+  uint32_t id = st->strings.intern(vendor, strlen(vendor));
+  st->vendor_index[vendor] = id;
+  return id;
+}
+
+static void event_ids(ingest_stitcher_t* st, const ingest_chunk_result_t* chunk, const ingest_event_t* e,
+                      uint32_t* scanner, uint32_t* capture) {
+  if (e->ids == INGEST_IDS_SESSION) {
+    *scanner = st->source->session_scanner;
+    *capture = st->source->session_capture;
+    return;
+  }
+  const char* arena = chunk->arena.data();
+  *scanner = st->strings.intern(arena + e->scanner_id.offset, e->scanner_id.len);
+  *capture = st->strings.intern(arena + e->capture_id.offset, e->capture_id.len);
+}
+
+// Validação de integridade do analisador, também para os registros binários
+static bool probe_valid(ingest_stitcher_t* st, const ingest_probe_row_t* row) {
+  if (row->rssi < -120 || row->rssi > 0) {
+    st->rejects[INGEST_REJECT_RSSI_RANGE]++;
+    return false;
+  }
+  if (row->channel < 1 || row->channel > 14) {
+    st->rejects[INGEST_REJECT_CHANNEL_RANGE]++;
+    return false;
+  }
+  return true;
+}
+
+static void append_probe(ingest_stitcher_t* st, ingest_probe_row_t row) {
+  if (!probe_valid(st, &row)) return;
+
+  uint64_t key;
+  if (row.flags & INGEST_PROBE_HAS_SEQ) {
+    key = mix64(mix64(1469598103934665603ull, session_key(row.scanner, row.capture)), row.pkt_seq);
+  } else {
+    // pcap: sem pkt_seq, o par (rx_us, seq 802.11) do mesmo SA identifica o frame
+    key = mix64(mix64(mix64(1469598103934665603ull ^ 1, session_key(row.scanner, row.capture)), row.sa),
+                ((uint64_t)row.rx_us << 16) | row.seq);
+  }
+  if (!first_seen(st, key)) return;
+
+  // Epoch preciso pela última âncora do mesmo boot (_apply_time_anchor)
+  if (row.flags & INGEST_PROBE_HAS_RX_US) {
+    std::unordered_map<uint64_t, ingest_anchor_t>::const_iterator it =
+        st->anchors.find(session_key(row.scanner, row.capture));
+    if (it != st->anchors.end()) {
+      // rx_us é um contador de 32 bits: diferença com sinal em relação à âncora
+      int32_t delta = (int32_t)(row.rx_us - it->second.rx_us);
+      row.ts_us = it->second.epoch_us + delta;
+      row.flags |= INGEST_PROBE_ANCHORED;
+      st->anchored++;
+    }
+  }
+
+  row.vendor = vendor_id(st, row.sa);
+  ingest_probe_columns_t& c = st->probes;
+  c.ts_us.push_back(row.ts_us);
+  c.scanner.push_back(row.scanner);
+  c.capture.push_back(row.capture);
+  c.pkt_seq.push_back(row.pkt_seq);
+  c.sa.push_back(row.sa);
+  c.fp_hash.push_back(row.fp_hash);
+  c.dwell_id.push_back(row.dwell_id);
+  c.rx_us.push_back(row.rx_us);
+  c.track_id.push_back(row.track_id);
+  c.vendor.push_back(row.vendor);
+  c.ssid.push_back(row.ssid);
+  c.seq.push_back(row.seq);
+  c.channel.push_back(row.channel);
+  c.rssi.push_back(row.rssi);
+  c.flags.push_back(row.flags);
+}
+
+static void stitch_probe(ingest_stitcher_t* st, const ingest_chunk_result_t* chunk, const ingest_event_t* e) {
+  ingest_probe_row_t row;
+  event_ids(st, chunk, e, &row.scanner, &row.capture);
+  row.ts_us = e->ts_us;
+  row.pkt_seq = e->pkt_seq;
+  row.sa = ingest_mac_u64(e->sa);
+  row.fp_hash = e->fp_hash;
+  row.dwell_id = e->dwell_id;
+  row.rx_us = e->rx_us;
+  row.track_id = e->track_id;
+  row.vendor = 0;
+  row.ssid = st->strings.intern(chunk->arena.data() + e->text.offset, e->text.len);
+  row.seq = e->seq;
+  row.channel = e->channel;
+  row.rssi = e->rssi;
+  row.flags = e->flags;
+
+  // Keyframe guardado antes da âncora, como no WireDecoder
+  if (e->delta_ref != WIRE_DELTA_REF_NONE) {
+    st->source->delta_valid[e->delta_ref] = true;
+    st->source->delta_key[e->delta_ref] = row;
+  }
+  append_probe(st, row);
+}
+
+static void stitch_delta(ingest_stitcher_t* st, const ingest_event_t* e) {
+  const ingest_probe_row_t* key = &st->source->delta_key[e->delta_ref];
+  if (!st->source->delta_valid[e->delta_ref] || (key->pkt_seq & 0xFFFF) != e->key_seq) {
+    // Keyframe perdido ou anterior à conexão: aguardar o próximo
+    st->rejects[INGEST_REJECT_DELTA_UNRESOLVED]++;
+    return;
+  }
+  st->delta_records++;
+  ingest_probe_row_t row = *key;
+  row.pkt_seq = key->pkt_seq + e->pkt_seq;
+  row.ts_us = key->ts_us + e->rx_us;
+  row.rx_us = key->rx_us + e->rx_us;
+  row.dwell_id = key->dwell_id + e->dwell_id;
+  row.channel = e->channel;
+  row.rssi = e->rssi;
+  row.seq = e->seq;
+  row.flags |= INGEST_PROBE_DELTA;
+  append_probe(st, row);
+}
+
+static void stitch_device(ingest_stitcher_t* st, const ingest_chunk_result_t* chunk, const ingest_event_t* e) {
+  uint32_t scanner, capture;
+  event_ids(st, chunk, e, &scanner, &capture);
+  uint64_t sa = ingest_mac_u64(e->sa);
+  uint64_t key = mix64(mix64(mix64(1469598103934665603ull ^ 2, session_key(scanner, capture)), sa),
+                       ((uint64_t)e->fp_hash << 32) ^ (uint64_t)e->ts_us);
+  if (!first_seen(st, key)) return;
+
+  ingest_device_columns_t& c = st->devices;
+  c.window_start_us.push_back(e->ts_us);
+  c.first_seen_us.push_back(e->first_us);
+  c.last_seen_us.push_back(e->last_us);
+  c.scanner.push_back(scanner);
+  c.capture.push_back(capture);
+  c.sa.push_back(sa);
+  c.fp_hash.push_back(e->fp_hash);
+  c.track_id.push_back(e->track_id);
+  c.count.push_back(e->count);
+  c.window_ms.push_back(e->window_ms);
+  c.vendor.push_back(vendor_id(st, sa));
+  c.channels_mask.push_back(e->channels_mask);
+  c.rssi_min.push_back(e->rssi_min);
+  c.rssi_max.push_back(e->rssi_max);
+  c.rssi_avg.push_back(e->rssi);
+  c.flags.push_back(e->flags);
+}
+
+void ingest_stitch(ingest_stitcher_t* st, const ingest_chunk_result_t* chunk) {
+  st->chunks++;
+  st->records += chunk->records;
+  st->lines += chunk->lines;
+  st->unknown_records += chunk->unknown_records;
+  st->pcap_skipped += chunk->pcap_skipped;
+
+  const char* arena = chunk->arena.data();
+  for (size_t i = 0; i < chunk->events.size(); i++) {
+    const ingest_event_t* e = &chunk->events[i];
+    switch (e->kind) {
+      case INGEST_EVENT_SESSION:
+        st->source->session_capture = st->strings.intern(arena + e->capture_id.offset, e->capture_id.len);
+        st->source->session_scanner = st->strings.intern(arena + e->scanner_id.offset, e->scanner_id.len);
+        break;
+      case INGEST_EVENT_SOURCE:
+        // Ponteiros para elementos de unordered_map sobrevivem a rehash
+        st->source = &st->sources[mix64(mix64(1469598103934665603ull ^ 3, ingest_mac_u64(e->sa)), e->pkt_seq)];
+        break;
+      case INGEST_EVENT_TIME: {
+        uint32_t scanner, capture;
+        event_ids(st, chunk, e, &scanner, &capture);
+        ingest_anchor_t anchor;
+        anchor.rx_us = e->rx_us;
+        anchor.epoch_us = e->ts_us;
+        st->anchors[session_key(scanner, capture)] = anchor;
+        break;
+      }
+      case INGEST_EVENT_PROBE:
+        stitch_probe(st, chunk, e);
+        break;
+      case INGEST_EVENT_DELTA:
+        stitch_delta(st, e);
+        break;
+      case INGEST_EVENT_DEVICE:
+        stitch_device(st, chunk, e);
+        break;
+      case INGEST_EVENT_META:
+        st->meta.push_back(st->strings.intern(arena + e->text.offset, e->text.len));
+        break;
+      case INGEST_EVENT_REJECT:
+        st->rejects[e->reject]++;
+        break;
+    }
+  }
+}
+
+uint64_t ingest_invalid_count(const ingest_stitcher_t* st) {
+  uint64_t total = 0;
+  for (int i = 0; i < INGEST_REJECT_COUNT; i++) total += st->rejects[i];
+  return total;
+}
+
+static void append_json_string(std::string* out, const char* s) {
+  out->push_back('"');
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') out->push_back('\\');
+    out->push_back(*s);
+  }
+  out->push_back('"');
+}
+
+std::string ingest_report_json(const ingest_stitcher_t* st) {
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "{\"type\":\"ingest\",\"inputs\":%llu,\"chunks\":%llu,\"records\":%llu,\"lines\":%llu,"
+           "\"probes\":%llu,\"devices\":%llu,\"valid\":%llu,\"invalid\":%llu,\"duplicates\":%llu,"
+           "\"delta_records\":%llu,\"anchored\":%llu,\"unknown_records\":%llu,\"pcap_skipped\":%llu,"
+           "\"errors\":{",
+           (unsigned long long)st->inputs, (unsigned long long)st->chunks,
+           (unsigned long long)st->records, (unsigned long long)st->lines,
+           (unsigned long long)st->probes.ts_us.size(), (unsigned long long)st->devices.sa.size(),
+           (unsigned long long)st->probes.ts_us.size(), (unsigned long long)ingest_invalid_count(st),
+           (unsigned long long)st->duplicates, (unsigned long long)st->delta_records,
+           (unsigned long long)st->anchored, (unsigned long long)st->unknown_records,
+           (unsigned long long)st->pcap_skipped);
+  std::string out = buf;
+  bool first = true;
+  for (int i = 0; i < INGEST_REJECT_COUNT; i++) {
+    if (st->rejects[i] == 0) continue;
+    if (!first) out.push_back(',');
+    first = false;
+    append_json_string(&out, ingest_reject_names[i]);
+    snprintf(buf, sizeof(buf), ":%llu", (unsigned long long)st->rejects[i]);
+    out += buf;
+  }
+  out += "}}";
+  return out;
+}
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""
+Extrai um arquivo .pcap (radiotap, linktype 127) do stream serial bruto de um
+nó com -DOUTPUT_FORMAT=OUTPUT_FORMAT_PCAP.
+
+Cada frame chega como um registro WIRE_RECORD_PCAP enquadrado (COBS + CRC-16,
+ver include/wire_format.h) cujo corpo já é um registro pcap completo; o
+extrator só valida o CRC, escreve o cabeçalho global e copia os registros. As
+linhas de texto intercaladas ("# STATS:", "# HEALTH:", ...) vão para --text
+(ou são descartadas).
+
+Em tempo real (run.sh faz isso com ambientes OUTPUT_FORMAT_PCAP):
+
+    pio device monitor --raw | python3 tools/pcap_extract.py - data/raw/captura.pcap --text captura.log
+
+Ou a partir de uma captura salva (serial em modo raw ou LOG DUMP):
+
+    python3 tools/pcap_extract.py captura.log captura.pcap
+
+O .pcap é gravado a cada registro, então o Wireshark pode acompanhá-lo
+durante a captura (wireshark -k -i - < <(tail -c +1 -f captura.pcap)).
+"""
+
+import argparse
+import struct
+import sys
+
+RECORD_PCAP = 0x05
+LINKTYPE_RADIOTAP = 127
+SNAPLEN = 65535
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(block):
+    """Decodifica um bloco COBS; retorna None se o bloco for inválido"""
+    out = bytearray()
+    i = 0
+    while i < len(block):
+        code = block[i]
+        if code == 0 or i + code > len(block):
+            return None
+        out += block[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(block):
+            out.append(0)
+    return bytes(out)
+
+
+class PcapExtractor:
+    def __init__(self, out, text=None):
+        self.out = out
+        self.text = text
+        self.pending = b''
+        self.frames = 0
+        self.crc_errors = 0
+        self.other_records = 0
+        out.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, SNAPLEN, LINKTYPE_RADIOTAP))
+        out.flush()
+
+    def feed(self, chunk):
+        """Processa um trecho do stream; o último bloco incompleto fica pendente"""
+        blocks = (self.pending + chunk).split(b'\x00')
+        self.pending = blocks.pop()
+        for block in blocks:
+            if block:
+                self._block(block)
+        self.out.flush()
+
+    def finish(self):
+        if self.pending:
+            self._text(self.pending)
+            self.pending = b''
+        self.out.flush()
+
+    def _block(self, block):
+        raw = cobs_decode(block)
+        if raw is None or len(raw) < 4 or crc16(raw[:-2]) != struct.unpack('<H', raw[-2:])[0]:
+            if raw is not None and len(raw) > 18 and raw[0] == RECORD_PCAP:
+                self.crc_errors += 1
+            self._text(block)
+            return
+        if raw[0] != RECORD_PCAP:
+            self.other_records += 1
+            return
+        self.out.write(raw[2:-2])
+        self.frames += 1
+
+    def _text(self, block):
+        if self.text is not None:
+            self.text.write(block.decode('utf-8', errors='replace'))
+            self.text.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Extrai .pcap do stream OUTPUT_FORMAT_PCAP')
+    parser.add_argument('input', help='captura bruta ou "-" para stdin')
+    parser.add_argument('output', help='arquivo .pcap de saída')
+    parser.add_argument('--text', help='arquivo para as linhas de texto intercaladas')
+    args = parser.parse_args()
+
+    source = sys.stdin.buffer if args.input == '-' else open(args.input, 'rb')
+    text = open(args.text, 'w') if args.text else None
+    with open(args.output, 'wb') as out:
+        extractor = PcapExtractor(out, text)
+        try:
+            while True:
+                # read1: entrega o que já chegou (sem esperar encher o buffer)
+                chunk = source.read1(65536) if hasattr(source, 'read1') else source.read(65536)
+                if not chunk:
+                    break
+                extractor.feed(chunk)
+        except KeyboardInterrupt:
+            pass
+        extractor.finish()
+
+    if text is not None:
+        text.close()
+    print(f"{extractor.frames} frames gravados em {args.output}"
+          f" ({extractor.crc_errors} com CRC inválido, {extractor.other_records} outros registros)",
+          file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
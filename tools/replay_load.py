@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+Carrega probe requests de um .pcap no corpus de replay de um nó com
+-DREPLAY_ENABLED=1 (comandos REPLAY ADD / REPLAY END, ver include/frame_replay.h).
+
+Aceita .pcap com radiotap (linktype 127, como os de tools/pcap_extract.py) ou
+802.11 puro (linktype 105). Cada frame distinto vira algumas linhas
+"REPLAY ADD <hex>" (limitadas por HOST_COMMAND_LINE_MAX) e um "REPLAY END <rssi>"
+com o RSSI do radiotap. Frames repetidos (mesmo conteúdo fora o seq_ctrl) são
+enviados uma vez só: a população de dispositivos vem do próprio REPLAY.
+
+    python3 tools/replay_load.py data/raw/venue.pcap --port /dev/ttyUSB0
+    python3 tools/replay_load.py venue.pcap > replay_cmds.txt
+
+Depois, no monitor serial: REPLAY 2000 60 500 (taxa, segundos, dispositivos).
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+LINKTYPE_IEEE802_11 = 105
+LINKTYPE_RADIOTAP = 127
+PROBE_REQUEST_FC = 0x40
+MAX_FRAMES = 64            # REPLAY_STORE_MAX_FRAMES
+POOL_SIZE = 16384          # REPLAY_POOL_SIZE
+FRAME_MAX = 1600           # REPLAY_FRAME_MAX
+HEX_PER_LINE = 80          # "REPLAY ADD " + 80 dígitos < HOST_COMMAND_LINE_MAX (96)
+DEFAULT_RSSI = -60
+
+# (alinhamento, tamanho) dos campos radiotap até o sinal em dBm (bit 5)
+RADIOTAP_FIELDS = [(8, 8), (1, 1), (1, 1), (2, 4), (1, 2), (1, 1)]
+
+
+def read_pcap(path):
+    """Gera (linktype, dados) de cada registro de um .pcap clássico"""
+    with open(path, 'rb') as f:
+        header = f.read(24)
+        if len(header) < 24:
+            raise ValueError('arquivo pcap vazio')
+        magic = struct.unpack('<I', header[:4])[0]
+        if magic in (0xa1b2c3d4, 0xa1b23c4d):
+            endian = '<'
+        elif magic in (0xd4c3b2a1, 0x4d3cb2a1):
+            endian = '>'
+        else:
+            raise ValueError('não é um pcap clássico (pcapng não é suportado)')
+        linktype = struct.unpack(endian + 'I', header[20:24])[0]
+        while True:
+            record = f.read(16)
+            if len(record) < 16:
+                return
+            incl_len = struct.unpack(endian + 'I', record[8:12])[0]
+            data = f.read(incl_len)
+            if len(data) < incl_len:
+                return
+            yield linktype, data
+
+
+def parse_radiotap(data):
+    """Retorna (frame 802.11 com FCS, rssi)"""
+    if len(data) < 8:
+        return None, DEFAULT_RSSI
+    length, = struct.unpack('<H', data[2:4])
+    present, = struct.unpack('<I', data[4:8])
+    offset = 8
+    word = present
+    while word & 0x80000000 and offset + 4 <= length:
+        word, = struct.unpack('<I', data[offset:offset + 4])
+        offset += 4
+
+    rssi = DEFAULT_RSSI
+    flags = 0
+    for bit, (align, size) in enumerate(RADIOTAP_FIELDS):
+        if not present & (1 << bit):
+            continue
+        offset = (offset + align - 1) & ~(align - 1)
+        if offset + size > length:
+            break
+        if bit == 1:
+            flags = data[offset]
+        elif bit == 5:
+            rssi = struct.unpack('b', data[offset:offset + 1])[0]
+        offset += size
+
+    frame = data[length:]
+    if not flags & 0x10:
+        frame += b'\x00' * 4  # sig_len do driver inclui o FCS
+    return frame, rssi
+
+
+def collect_frames(path, all_mgmt, limit):
+    frames = []
+    seen = set()
+    pool_used = 0
+    for linktype, data in read_pcap(path):
+        if linktype == LINKTYPE_RADIOTAP:
+            frame, rssi = parse_radiotap(data)
+        elif linktype == LINKTYPE_IEEE802_11:
+            frame, rssi = data + b'\x00' * 4, DEFAULT_RSSI
+        else:
+            raise ValueError(f'linktype {linktype} não suportado')
+        if frame is None or len(frame) < 28 or len(frame) > FRAME_MAX:
+            continue
+        if frame[0] & 0x0C != 0 or (not all_mgmt and frame[0] != PROBE_REQUEST_FC):
+            continue
+        key = frame[:22] + frame[24:-4]
+        if key in seen:
+            continue
+        if len(frames) == limit or pool_used + len(frame) > POOL_SIZE:
+            break
+        seen.add(key)
+        frames.append((frame, rssi))
+        pool_used += len(frame)
+    return frames
+
+
+def command_lines(frames):
+    yield 'REPLAY CLEAR'
+    for frame, rssi in frames:
+        hex_frame = frame.hex()
+        for i in range(0, len(hex_frame), HEX_PER_LINE):
+            yield 'REPLAY ADD ' + hex_frame[i:i + HEX_PER_LINE]
+        yield f'REPLAY END {max(-127, min(0, rssi))}'
+    yield 'REPLAY'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Carrega frames de um .pcap no corpus de REPLAY')
+    parser.add_argument('pcap', help='captura .pcap (radiotap ou 802.11)')
+    parser.add_argument('--port', help='porta serial (sem ela os comandos vão para stdout)')
+    parser.add_argument('--baud', type=int, default=921600)
+    parser.add_argument('--all-mgmt', action='store_true', help='todos os frames management, não só probe requests')
+    parser.add_argument('--limit', type=int, default=MAX_FRAMES, help=f'máximo de frames (até {MAX_FRAMES})')
+    parser.add_argument('--line-delay', type=float, default=0.02,
+                        help='pausa entre linhas (s): o firmware lê os comandos a cada ~10 ms')
+    args = parser.parse_args()
+
+    frames = collect_frames(args.pcap, args.all_mgmt, min(args.limit, MAX_FRAMES))
+    if not frames:
+        print('nenhum frame utilizável no pcap', file=sys.stderr)
+        sys.exit(1)
+
+    if args.port is None:
+        for line in command_lines(frames):
+            print(line)
+    else:
+        import serial  # pyserial, instalado junto com o platformio
+        with serial.Serial(args.port, args.baud, timeout=0) as port:
+            for line in command_lines(frames):
+                port.write((line + '\n').encode('ascii'))
+                time.sleep(args.line_delay)
+                reply = port.read(4096).decode('utf-8', errors='replace')
+                for text in reply.splitlines():
+                    if text.startswith('# REPLAY') or text.startswith('# ERROR'):
+                        print(text, file=sys.stderr)
+
+    print(f'{len(frames)} frames ({sum(len(f) for f, _ in frames)} bytes) de {args.pcap}', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()